@@ -0,0 +1,535 @@
+/*!
+ *@author   chenghua.wang
+ *@file     checkpoint.hpp
+ *@brief    The checkpoint: many CPU tensors streamed to one file by a background I/O thread, and
+ * streamed back into tensors already allocated.
+ *@details  Add copies the rows of a tensor into staging chunks of MGLORIA_CKPT_CHUNK bytes and
+ * queues them, the I/O thread writes each chunk with one write and gives it back. There are at
+ * least two chunks, one filled while the other is written, and at most MGLORIA_CKPT_STAGING bytes
+ * of them: when a checkpoint fits, Add only waits for memcpy, the tensors can be changed as soon as
+ * it returns, and the disk is waited for by Finish alone.
+ *
+ * The file is a CheckpointHeader, then for each tensor a CheckpointRecord, its name, and its
+ * elements with no padding, in chunks of m_chunk_bytes each followed by the XXH64 of its bytes.
+ * A CheckpointRecord tagged "END" with the number of tensors closes it. The file is written as
+ * path.tmp, synced and renamed over path: a checkpoint on disk is always a whole one.
+ *@note     The header and the data are of the byte order of the host that saved them.
+ */
+
+#ifndef _MGLORIA_CHECKPOINT_HPP_
+#define _MGLORIA_CHECKPOINT_HPP_
+
+#pragma once
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "tensor_cpu.hpp"
+
+namespace mgloria {
+
+/*!
+ *@brief    XXH64 of bytes, the checksum of a chunk.
+ */
+MGLORIA_INLINE_NORMAL uint64_t CheckpointChecksum(const void* data, size_t bytes,
+                                                  uint64_t seed = 0) {
+  const uint64_t P1 = 11400714785074694791ULL, P2 = 14029467366897019727ULL;
+  const uint64_t P3 = 1609587929392839161ULL, P4 = 9650029242287828579ULL;
+  const uint64_t P5 = 2870177450012600261ULL;
+  auto __rotl__ = [](uint64_t x, int r) { return (x << r) | (x >> (64 - r)); };
+  auto __round__ = [&](uint64_t acc, uint64_t in) { return __rotl__(acc + in * P2, 31) * P1; };
+  auto __read64__ = [](const unsigned char* p) {
+    uint64_t v;
+    std::memcpy(&v, p, 8);
+    return v;
+  };
+  const unsigned char* __p__ = static_cast<const unsigned char*>(data);
+  const unsigned char* const __end__ = __p__ + bytes;
+  uint64_t h;
+  if (bytes >= 32) {
+    uint64_t v1 = seed + P1 + P2, v2 = seed + P2, v3 = seed, v4 = seed - P1;
+    for (; __p__ + 32 <= __end__; __p__ += 32) {
+      v1 = __round__(v1, __read64__(__p__));
+      v2 = __round__(v2, __read64__(__p__ + 8));
+      v3 = __round__(v3, __read64__(__p__ + 16));
+      v4 = __round__(v4, __read64__(__p__ + 24));
+    }
+    h = __rotl__(v1, 1) + __rotl__(v2, 7) + __rotl__(v3, 12) + __rotl__(v4, 18);
+    for (uint64_t v : {v1, v2, v3, v4}) { h = (h ^ __round__(0, v)) * P1 + P4; }
+  } else {
+    h = seed + P5;
+  }
+  h += bytes;
+  for (; __p__ + 8 <= __end__; __p__ += 8) {
+    h = __rotl__(h ^ __round__(0, __read64__(__p__)), 27) * P1 + P4;
+  }
+  if (__p__ + 4 <= __end__) {
+    uint32_t __k__;
+    std::memcpy(&__k__, __p__, 4);
+    h = __rotl__(h ^ (uint64_t(__k__) * P1), 23) * P2 + P3;
+    __p__ += 4;
+  }
+  for (; __p__ < __end__; ++__p__) { h = __rotl__(h ^ (*__p__ * P5), 11) * P1; }
+  h ^= h >> 33;
+  h *= P2;
+  h ^= h >> 29;
+  h *= P3;
+  h ^= h >> 32;
+  return h;
+}
+
+/*!
+ *@brief    The head of a checkpoint file.
+ */
+struct CheckpointHeader {
+  static const uint32_t ms_Version = 1;
+
+  char m_magic[8];          ///! "MGLCKPT", 0 ended.
+  uint32_t m_version;       ///! ms_Version.
+  uint32_t m_reserved;      ///! 0.
+  uint64_t m_chunk_bytes;   ///! The elements of a tensor are checksummed by chunks of this.
+
+  MGLORIA_INLINE_NORMAL static const char* Magic() { return "MGLCKPT"; }
+};
+
+/*!
+ *@brief    The head of a tensor in a checkpoint file, followed by m_name_bytes of its name.
+ */
+struct CheckpointRecord {
+  static const int ms_MaxDims = 8;
+  static const uint32_t ms_MaxNameBytes = 1u << 16;
+
+  char m_tag[4];                 ///! "TNS" for a tensor, "END" for the end, 0 ended.
+  uint8_t m_type;                ///! TypeType of the elements.
+  uint8_t m_elem_bytes;          ///! sizeof an element.
+  uint16_t m_dims;               ///! Dimensions.
+  uint32_t m_name_bytes;         ///! Bytes of the name.
+  uint32_t m_reserved;           ///! 0.
+  uint64_t m_bytes;              ///! Bytes of the elements, of "END": the number of tensors.
+  uint64_t m_shape[ms_MaxDims];  ///! The shape, the unused ones are 0.
+
+  ///! Bytes on the disk of m_bytes of elements with their checksums.
+  MGLORIA_INLINE_NORMAL static uint64_t DiskBytes(uint64_t bytes, uint64_t chunk_bytes) {
+    return bytes + (bytes + chunk_bytes - 1) / chunk_bytes * sizeof(uint64_t);
+  }
+};
+
+/*!
+ *@brief    Writes a checkpoint in the background. Add returns once the tensor is copied.
+ *@example  CheckpointWriter __ckpt__;
+ *          __ckpt__.Open("step_1000.ckpt");
+ *          __ckpt__.Add("fc1.weight", W1);
+ *          __ckpt__.Add("fc1.bias", b1);
+ *          // ... the next steps run while the file is written.
+ *          bool ok = __ckpt__.Finish();
+ */
+class CheckpointWriter {
+ public:
+  CheckpointWriter()
+      : m_fd(-1), m_chunk_bytes(MGLORIA_CKPT_CHUNK), m_max_chunks(0), m_records(0),
+        m_cur(nullptr), m_fill(0), m_ok(false), m_stop(false) {}
+
+  ~CheckpointWriter() {
+    if (m_fd >= 0) { Finish(); }
+  }
+
+  CheckpointWriter(const CheckpointWriter&) = delete;
+  CheckpointWriter& operator=(const CheckpointWriter&) = delete;
+
+  ///! Start a checkpoint to path, with at most staging bytes of tensors copied and not written.
+  MGLORIA_INLINE_NORMAL bool Open(const std::string& path,
+                                  size_t staging = MGLORIA_CKPT_STAGING) {
+    if (m_fd >= 0) { Finish(); }
+    m_path = path;
+    m_fd = ::open((path + ".tmp").c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (m_fd < 0) {
+      LOG_WARN << "The checkpoint " << path << ".tmp can not be created." << std::endl;
+      return false;
+    }
+    m_max_chunks = staging / m_chunk_bytes > 2 ? staging / m_chunk_bytes : 2;
+    m_records = 0;
+    m_ok = true;
+    m_stop = false;
+    CheckpointHeader __h__;
+    std::memset(&__h__, 0, sizeof(__h__));
+    std::memcpy(__h__.m_magic, CheckpointHeader::Magic(), 8);
+    __h__.m_version = CheckpointHeader::ms_Version;
+    __h__.m_chunk_bytes = m_chunk_bytes;
+    m_head.assign(reinterpret_cast<const char*>(&__h__), sizeof(__h__));
+    m_thread = std::thread(&CheckpointWriter::Run, this);
+    return true;
+  }
+
+  ///! Queue a copy of T as name. false if the checkpoint is not open or failed to be written, or
+  ///! if the name is longer than a reader takes; then the tensor is left out.
+  template<int Dims, typename DataType>
+  MGLORIA_INLINE_NORMAL bool Add(const std::string& name, const Tensor<CPU, Dims, DataType>& T) {
+    static_assert(Dims <= CheckpointRecord::ms_MaxDims, "Too many dimensions for a checkpoint.");
+    if (m_fd < 0 || !m_ok) { return false; }
+    if (name.size() > CheckpointRecord::ms_MaxNameBytes) {
+      LOG_WARN << "The name of " << name.size() << " bytes is too long for the checkpoint "
+               << m_path << "." << std::endl;
+      return false;
+    }
+    const size_t __line__ = T.size(Dims - 1) * sizeof(DataType);
+    const size_t __rows__ = T.m_Shape.Flatten2D()[0];
+    CheckpointRecord __r__;
+    std::memset(&__r__, 0, sizeof(__r__));
+    std::memcpy(__r__.m_tag, "TNS", 4);
+    __r__.m_type = static_cast<uint8_t>(ElementType<DataType>::Type);
+    __r__.m_elem_bytes = sizeof(DataType);
+    __r__.m_dims = Dims;
+    __r__.m_name_bytes = static_cast<uint32_t>(name.size());
+    __r__.m_bytes = __line__ * __rows__;
+    for (int i = 0; i < Dims; ++i) { __r__.m_shape[i] = static_cast<uint64_t>(T.size(i)); }
+    m_head.append(reinterpret_cast<const char*>(&__r__), sizeof(__r__));
+    m_head.append(name);
+
+    // Chunks are counted from the start of each tensor, the reader checks them the same way.
+    const char* __data__ = reinterpret_cast<const char*>(T.__data_ptr);
+    const size_t __pitch__ = T.m_Stride_ * sizeof(DataType);
+    for (size_t r = 0; r < __rows__; ++r) {
+      const char* __src__ = __data__ + r * __pitch__;
+      for (size_t __left__ = __line__; __left__ > 0;) {
+        if (m_cur == nullptr) { m_cur = Take(); }
+        const size_t __n__ = std::min(__left__, m_chunk_bytes - m_fill);
+        std::memcpy(m_cur + m_fill, __src__, __n__);
+        m_fill += __n__;
+        __src__ += __n__;
+        __left__ -= __n__;
+        if (m_fill == m_chunk_bytes) { Push(); }
+      }
+    }
+    Push();
+    ++m_records;
+    return m_ok;
+  }
+
+  ///! Wait for the I/O thread, close the file and move it to path. false if it failed.
+  MGLORIA_INLINE_NORMAL bool Finish() {
+    if (m_fd < 0) { return false; }
+    CheckpointRecord __r__;
+    std::memset(&__r__, 0, sizeof(__r__));
+    std::memcpy(__r__.m_tag, "END", 4);
+    __r__.m_bytes = m_records;
+    m_head.append(reinterpret_cast<const char*>(&__r__), sizeof(__r__));
+    Push();
+    {
+      std::lock_guard<std::mutex> __lock__(m_mutex);
+      m_stop = true;
+    }
+    m_ready.notify_one();
+    m_thread.join();
+
+    bool __ok__ = m_ok && ::fdatasync(m_fd) == 0;
+    __ok__ = ::close(m_fd) == 0 && __ok__;
+    m_fd = -1;
+    const std::string __tmp__ = m_path + ".tmp";
+    if (__ok__) { __ok__ = std::rename(__tmp__.c_str(), m_path.c_str()) == 0; }
+    if (!__ok__) {
+      std::remove(__tmp__.c_str());
+      LOG_WARN << "The checkpoint " << m_path << " can not be written." << std::endl;
+    }
+    for (char* c : m_chunks) { HostPoolFree(c); }
+    m_chunks.clear();
+    m_free.clear();
+    m_cur = nullptr;
+    return __ok__;
+  }
+
+ private:
+  struct Block {
+    std::string m_head;  ///! Written first, the heads of the records.
+    char* m_data;        ///! A staging chunk or nullptr.
+    size_t m_bytes;      ///! Bytes of m_data.
+  };
+
+  ///! A free staging chunk, a new one while there are less than m_max_chunks.
+  MGLORIA_INLINE_NORMAL char* Take() {
+    std::unique_lock<std::mutex> __lock__(m_mutex);
+    if (m_free.empty() && m_chunks.size() < m_max_chunks) {
+      size_t __pitch__;
+      m_chunks.push_back(static_cast<char*>(HostPoolMallocPitch(&__pitch__, m_chunk_bytes, 1)));
+      return m_chunks.back();
+    }
+    m_given.wait(__lock__, [this] { return !m_free.empty(); });
+    char* __c__ = m_free.back();
+    m_free.pop_back();
+    return __c__;
+  }
+
+  ///! Queue the heads and the chunk being filled.
+  MGLORIA_INLINE_NORMAL void Push() {
+    if (m_head.empty() && m_fill == 0) { return; }
+    Block __b__{std::string(), m_fill == 0 ? nullptr : m_cur, m_fill};
+    __b__.m_head.swap(m_head);
+    if (m_fill > 0) {
+      m_cur = nullptr;
+      m_fill = 0;
+    }
+    {
+      std::lock_guard<std::mutex> __lock__(m_mutex);
+      m_queue.push_back(std::move(__b__));
+    }
+    m_ready.notify_one();
+  }
+
+  MGLORIA_INLINE_NORMAL bool WriteAll(const void* data, size_t bytes) {
+    const char* __p__ = static_cast<const char*>(data);
+    while (bytes > 0) {
+      const ssize_t __n__ = ::write(m_fd, __p__, bytes);
+      if (__n__ < 0 && errno == EINTR) { continue; }
+      if (__n__ <= 0) { return false; }
+      __p__ += __n__;
+      bytes -= static_cast<size_t>(__n__);
+    }
+    return true;
+  }
+
+  ///! The I/O thread.
+  MGLORIA_INLINE_NORMAL void Run() {
+    for (;;) {
+      Block __b__;
+      {
+        std::unique_lock<std::mutex> __lock__(m_mutex);
+        m_ready.wait(__lock__, [this] { return m_stop || !m_queue.empty(); });
+        if (m_queue.empty()) { return; }
+        __b__ = std::move(m_queue.front());
+        m_queue.pop_front();
+      }
+      if (m_ok && !__b__.m_head.empty()) {
+        m_ok = WriteAll(__b__.m_head.data(), __b__.m_head.size());
+      }
+      if (__b__.m_data != nullptr) {
+        if (m_ok) {
+          const uint64_t __sum__ = CheckpointChecksum(__b__.m_data, __b__.m_bytes);
+          m_ok = WriteAll(__b__.m_data, __b__.m_bytes) && WriteAll(&__sum__, sizeof(__sum__));
+        }
+        {
+          std::lock_guard<std::mutex> __lock__(m_mutex);
+          m_free.push_back(__b__.m_data);
+        }
+        m_given.notify_one();
+      }
+    }
+  }
+
+  std::string m_path;
+  int m_fd;
+  size_t m_chunk_bytes;
+  size_t m_max_chunks;
+  size_t m_records;
+  std::string m_head;  ///! The heads not queued yet.
+  char* m_cur;         ///! The chunk being filled by Add.
+  size_t m_fill;       ///! Its bytes filled.
+  std::atomic<bool> m_ok;
+
+  std::thread m_thread;
+  std::mutex m_mutex;
+  std::condition_variable m_ready;  ///! A block is queued, or m_stop.
+  std::condition_variable m_given;  ///! A chunk is given back.
+  std::deque<Block> m_queue;
+  std::vector<char*> m_chunks;      ///! All the staging chunks.
+  std::vector<char*> m_free;        ///! The ones written.
+  bool m_stop;
+};
+
+/*!
+ *@brief    Reads a checkpoint into tensors already allocated, in any order, a chunk at a time.
+ *@example  CheckpointReader __ckpt__;
+ *          if (__ckpt__.Open("step_1000.ckpt")) { __ckpt__.Read("fc1.weight", &W1); }
+ */
+class CheckpointReader {
+ public:
+  CheckpointReader() : m_fd(-1), m_chunk_bytes(0), m_buffer(nullptr) {}
+
+  ~CheckpointReader() { Close(); }
+
+  CheckpointReader(const CheckpointReader&) = delete;
+  CheckpointReader& operator=(const CheckpointReader&) = delete;
+
+  ///! Open path and index its tensors, false if it is not a whole checkpoint.
+  MGLORIA_INLINE_NORMAL bool Open(const std::string& path) {
+    Close();
+    m_path = path;
+    m_fd = ::open(path.c_str(), O_RDONLY);
+    if (m_fd < 0) { return Fail("can not be opened"); }
+    CheckpointHeader __h__;
+    if (!ReadAt(&__h__, sizeof(__h__), 0)
+        || std::memcmp(__h__.m_magic, CheckpointHeader::Magic(), 8) != 0
+        || __h__.m_version != CheckpointHeader::ms_Version) {
+      return Fail("is not a checkpoint");
+    }
+    if (__h__.m_chunk_bytes == 0 || __h__.m_chunk_bytes > (uint64_t(1) << 30)) {
+      return Fail("has a bad chunk size");
+    }
+    m_chunk_bytes = static_cast<size_t>(__h__.m_chunk_bytes);
+    struct stat __st__;
+    if (::fstat(m_fd, &__st__) != 0) { return Fail("can not be opened"); }
+    const uint64_t __size__ = static_cast<uint64_t>(__st__.st_size);
+    uint64_t __offset__ = sizeof(__h__);
+    for (;;) {
+      Entry __e__;
+      if (!ReadAt(&__e__.m_record, sizeof(__e__.m_record), __offset__)) {
+        return Fail("is not complete");
+      }
+      __offset__ += sizeof(__e__.m_record);
+      const CheckpointRecord& __r__ = __e__.m_record;
+      if (std::memcmp(__r__.m_tag, "END", 4) == 0) {
+        if (__r__.m_bytes != m_names.size()) { return Fail("has lost tensors"); }
+        break;
+      }
+      if (std::memcmp(__r__.m_tag, "TNS", 4) != 0
+          || __r__.m_name_bytes > CheckpointRecord::ms_MaxNameBytes) {
+        return Fail("has a bad record");
+      }
+      std::string __name__(__r__.m_name_bytes, '\0');
+      if (!ReadAt(&__name__[0], __name__.size(), __offset__)) { return Fail("is not complete"); }
+      __offset__ += __name__.size();
+      __e__.m_offset = __offset__;
+      // Bounded by the file first, so that a forged size can not wrap the offset.
+      if (__r__.m_bytes > __size__ - __offset__
+          || CheckpointRecord::DiskBytes(__r__.m_bytes, m_chunk_bytes) > __size__ - __offset__) {
+        return Fail("has a bad record");
+      }
+      __offset__ += CheckpointRecord::DiskBytes(__r__.m_bytes, m_chunk_bytes);
+      if (!m_index.emplace(__name__, __e__).second) { return Fail("holds a name twice"); }
+      m_names.push_back(__name__);
+    }
+#ifdef POSIX_FADV_SEQUENTIAL
+    ::posix_fadvise(m_fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+    size_t __pitch__;
+    m_buffer = static_cast<char*>(
+        HostPoolMallocPitch(&__pitch__, m_chunk_bytes + sizeof(uint64_t), 1));
+    return true;
+  }
+
+  MGLORIA_INLINE_NORMAL void Close() {
+    if (m_fd >= 0) { ::close(m_fd); }
+    if (m_buffer != nullptr) { HostPoolFree(m_buffer); }
+    m_fd = -1;
+    m_buffer = nullptr;
+    m_index.clear();
+    m_names.clear();
+  }
+
+  MGLORIA_INLINE_NORMAL bool Empty() const { return m_fd < 0; }
+
+  ///! The names of the tensors, in the order they were added.
+  MGLORIA_INLINE_NORMAL const std::vector<std::string>& Names() const { return m_names; }
+
+  MGLORIA_INLINE_NORMAL bool Has(const std::string& name) const {
+    return m_index.find(name) != m_index.end();
+  }
+
+  ///! Read name into T, of the same shape and type. false if it is not, or a chunk is bad.
+  template<int Dims, typename DataType>
+  MGLORIA_INLINE_NORMAL bool Read(const std::string& name, Tensor<CPU, Dims, DataType>* T) {
+    auto __it__ = m_index.find(name);
+    if (m_fd < 0 || __it__ == m_index.end()) { return Warn(name, "is not in"); }
+    const CheckpointRecord& __r__ = __it__->second.m_record;
+    bool __same__ = __r__.m_type == static_cast<uint8_t>(ElementType<DataType>::Type)
+                    && __r__.m_elem_bytes == sizeof(DataType) && __r__.m_dims == Dims;
+    for (int i = 0; i < Dims && __same__; ++i) {
+      __same__ = __r__.m_shape[i] == static_cast<uint64_t>(T->size(i));
+    }
+    if (!__same__) { return Warn(name, "has another type or shape in"); }
+
+    const size_t __line__ = T->size(Dims - 1) * sizeof(DataType);
+    // The heads are not checksummed: the bytes must fill T and no more.
+    uint64_t __rows__ = 1;
+    for (int i = 0; i < Dims - 1; ++i) { __rows__ *= static_cast<uint64_t>(T->size(i)); }
+    if (__r__.m_bytes != __rows__ * __line__) {
+      return Warn(name, "has a bad size in");
+    }
+    const size_t __pitch__ = T->m_Stride_ * sizeof(DataType);
+    char* __dst__ = reinterpret_cast<char*>(T->__data_ptr);
+    size_t __row__ = 0, __col__ = 0;
+    uint64_t __offset__ = __it__->second.m_offset;
+    for (uint64_t __left__ = __r__.m_bytes; __left__ > 0;) {
+      const size_t __n__ = static_cast<size_t>(std::min<uint64_t>(__left__, m_chunk_bytes));
+#ifdef POSIX_FADV_WILLNEED
+      // The next chunk is read by the kernel while this one is checked and copied.
+      ::posix_fadvise(m_fd, __offset__ + __n__ + sizeof(uint64_t), m_chunk_bytes,
+                      POSIX_FADV_WILLNEED);
+#endif
+      if (!ReadAt(m_buffer, __n__ + sizeof(uint64_t), __offset__)) {
+        return Warn(name, "is cut in");
+      }
+      uint64_t __sum__;
+      std::memcpy(&__sum__, m_buffer + __n__, sizeof(__sum__));
+      if (__sum__ != CheckpointChecksum(m_buffer, __n__)) {
+        return Warn(name, "has a bad checksum in");
+      }
+      for (size_t __done__ = 0; __done__ < __n__;) {
+        const size_t __m__ = std::min(__n__ - __done__, __line__ - __col__);
+        std::memcpy(__dst__ + __row__ * __pitch__ + __col__, m_buffer + __done__, __m__);
+        __done__ += __m__;
+        __col__ += __m__;
+        if (__col__ == __line__) {
+          ++__row__;
+          __col__ = 0;
+        }
+      }
+      __offset__ += __n__ + sizeof(uint64_t);
+      __left__ -= __n__;
+    }
+    return true;
+  }
+
+ private:
+  struct Entry {
+    CheckpointRecord m_record;
+    uint64_t m_offset;  ///! Of the first chunk.
+  };
+
+  MGLORIA_INLINE_NORMAL bool ReadAt(void* data, size_t bytes, uint64_t offset) {
+    char* __p__ = static_cast<char*>(data);
+    while (bytes > 0) {
+      const ssize_t __n__ = ::pread(m_fd, __p__, bytes, static_cast<off_t>(offset));
+      if (__n__ < 0 && errno == EINTR) { continue; }
+      if (__n__ <= 0) { return false; }
+      __p__ += __n__;
+      offset += static_cast<uint64_t>(__n__);
+      bytes -= static_cast<size_t>(__n__);
+    }
+    return true;
+  }
+
+  MGLORIA_INLINE_NORMAL bool Fail(const char* why) {
+    LOG_WARN << "The checkpoint " << m_path << " " << why << "." << std::endl;
+    Close();
+    return false;
+  }
+
+  MGLORIA_INLINE_NORMAL bool Warn(const std::string& name, const char* why) {
+    LOG_WARN << "The tensor " << name << " " << why << " the checkpoint " << m_path << "."
+             << std::endl;
+    return false;
+  }
+
+  std::string m_path;
+  int m_fd;
+  size_t m_chunk_bytes;
+  char* m_buffer;  ///! A chunk and its checksum.
+  std::map<std::string, Entry> m_index;
+  std::vector<std::string> m_names;
+};
+
+}  // namespace mgloria
+
+#endif  // _MGLORIA_CHECKPOINT_HPP_
@@ -1,7 +1,7 @@
 /*!
  *@author chenghua.wang
  *@file   complex_eval.hpp
- *@brief  The ComplexExpr dispatcher and dotExpr dispatcher.
+ *@brief  The ComplexExpr dispatcher, dotExpr and reduceExpr dispatcher.
  */
 
 #ifndef _MGLORIA_COMPLEX_EVAL_HPP_
@@ -47,4 +47,11 @@ struct DotEngine {
 }  // namespace expr
 }  // namespace mgloria
 
+///! After the ExpressionComplexDispatcher and DotEngine, they are specialized there.
+#include "op/__op_reduce_cpu.hpp"
+#include "op/__op_dot_cpu.hpp"
+#include "op/__op_batch_dot_cpu.hpp"
+#include "op/__op_qdot_cpu.hpp"
+#include "op/__op_conv_cpu.hpp"
+
 #endif
\ No newline at end of file
@@ -8,4 +8,7 @@
 #endif
 #endif
 #include "expr_eval.hpp"
+#include "tensor_fixed.hpp"
+#include "tensor_file.hpp"
+#include "checkpoint.hpp"
 #endif
\ No newline at end of file
@@ -76,5 +76,28 @@ struct LayoutType<LayoutTypeType::CDHWB> {
   static const int32_t Dims = 5;
 };
 
+/*!
+ *@brief The stride, padding, dilation and groups of a 2D convolution, see conv2d. The constructor
+ * gives the height and the width the same, they can be set apart after.
+ */
+struct Conv2dParam {
+  explicit Conv2dParam(index_t stride = 1, index_t pad = 0, index_t dilation = 1,
+                       index_t groups = 1)
+      : m_stride_h(stride),
+        m_stride_w(stride),
+        m_pad_h(pad),
+        m_pad_w(pad),
+        m_dilation_h(dilation),
+        m_dilation_w(dilation),
+        m_groups(groups) {}
+  index_t m_stride_h;
+  index_t m_stride_w;
+  index_t m_pad_h;
+  index_t m_pad_w;
+  index_t m_dilation_h;
+  index_t m_dilation_w;
+  index_t m_groups;
+};
+
 }  // namespace mgloria
 #endif
\ No newline at end of file
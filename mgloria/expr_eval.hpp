@@ -21,6 +21,42 @@ template<typename ExpressionType, typename DataType>
 struct Job {
   MGLORIA_INLINE_NORMAL DataType Eval(index_t y, index_t x) const;
 };
+
+/*!
+ *@brief    Does the Job of the expression have EvalTile(y0, x0, rows, cols, out), that computes a
+ * block of rows x cols (at most MGLORIA_JOB_TILE_ROWS x MGLORIA_JOB_TILE_COLS) at once. out is
+ * row major with a row every MGLORIA_JOB_TILE_COLS. Only the expressions that reuse data across a
+ * block, as ImplicitGemmExpr, and the element-wise ones holding them have it.
+ */
+template<typename ExpressionType>
+struct JobTileCheck {
+  static const bool m_Enable = false;
+};
+
+/*!
+ *@brief    Evaluates a block of any Job: by its EvalTile if Tiled, else element by element.
+ */
+template<bool Tiled>
+struct JobTile {
+  template<typename JobType, typename DataType>
+  MGLORIA_INLINE_NORMAL static void Eval(const JobType& job, index_t y0, index_t x0, index_t rows,
+                                         index_t cols, DataType* out) {
+    for (index_t r = 0; r < rows; ++r) {
+      for (index_t c = 0; c < cols; ++c) {
+        out[r * MGLORIA_JOB_TILE_COLS + c] = job.Eval(y0 + r, x0 + c);
+      }
+    }
+  }
+};
+
+template<>
+struct JobTile<true> {
+  template<typename JobType, typename DataType>
+  MGLORIA_INLINE_NORMAL static void Eval(const JobType& job, index_t y0, index_t x0, index_t rows,
+                                         index_t cols, DataType* out) {
+    job.EvalTile(y0, x0, rows, cols, out);
+  }
+};
 }  // namespace expr
 }  // namespace mgloria
 
@@ -53,11 +89,11 @@ struct Job<Tensor<Device, Dims, DataType>, DataType> {
   explicit Job(const Tensor<Device, Dims, DataType>& T)
       : __data_ptr(T.__data_ptr), m_Stride(T.m_Stride_) {}
 
-  MGLORIA_INLINE_NORMAL const DataType& Eval(index_t x, index_t y) const {
+  MGLORIA_INLINE_NORMAL const DataType& Eval(index_t y, index_t x) const {
     return __data_ptr[y * m_Stride + x];
   }
 
-  MGLORIA_INLINE_NORMAL DataType& REval(index_t x, index_t y) const {
+  MGLORIA_INLINE_NORMAL DataType& REval(index_t y, index_t x) const {
     return __data_ptr[y * m_Stride + x];
   }
 
@@ -79,6 +115,21 @@ struct Job<TransposeExpr<E, DataType>, DataType> {
     return m_job.Eval(x, y);
   }
 
+  MGLORIA_INLINE_NORMAL void EvalTile(index_t y0, index_t x0, index_t rows, index_t cols,
+                                      DataType* out) const {
+    alignas(64) DataType __tmp__[MGLORIA_JOB_TILE_ROWS * MGLORIA_JOB_TILE_COLS];
+    // The columns of this block are the rows of the inner one, MGLORIA_JOB_TILE_ROWS at a time.
+    for (index_t c0 = 0; c0 < cols; c0 += MGLORIA_JOB_TILE_ROWS) {
+      const index_t cn = cols - c0 < MGLORIA_JOB_TILE_ROWS ? cols - c0 : MGLORIA_JOB_TILE_ROWS;
+      JobTile<JobTileCheck<E>::m_Enable>::Eval(m_job, x0 + c0, y0, cn, rows, __tmp__);
+      for (index_t r = 0; r < rows; ++r) {
+        for (index_t c = 0; c < cn; ++c) {
+          out[r * MGLORIA_JOB_TILE_COLS + c0 + c] = __tmp__[c * MGLORIA_JOB_TILE_COLS + r];
+        }
+      }
+    }
+  }
+
   Job<E, DataType> m_job;
 };
 
@@ -102,7 +153,18 @@ template<typename OriDataType, typename DisDataType, typename A_T, exprType ETyp
 struct Job<TypeCastExpr<OriDataType, DisDataType, A_T, EType>, DisDataType> {
   explicit Job(const Job<A_T, OriDataType>& _job) : m_job(_job) {}
   MGLORIA_INLINE_NORMAL DisDataType Eval(index_t y, index_t x) const {
-    return DstDType(m_job.Eval(y, x));
+    return DisDataType(m_job.Eval(y, x));
+  }
+
+  MGLORIA_INLINE_NORMAL void EvalTile(index_t y0, index_t x0, index_t rows, index_t cols,
+                                      DisDataType* out) const {
+    alignas(64) OriDataType __tmp__[MGLORIA_JOB_TILE_ROWS * MGLORIA_JOB_TILE_COLS];
+    JobTile<JobTileCheck<A_T>::m_Enable>::Eval(m_job, y0, x0, rows, cols, __tmp__);
+    for (index_t r = 0; r < rows; ++r) {
+      for (index_t c = 0; c < cols; ++c) {
+        out[r * MGLORIA_JOB_TILE_COLS + c] = DisDataType(__tmp__[r * MGLORIA_JOB_TILE_COLS + c]);
+      }
+    }
   }
 
   Job<A_T, OriDataType> m_job;
@@ -119,6 +181,15 @@ struct Job<UnaryExpr<OP, A_T, DataType, EType>, DataType> {
     return OP::Do(m_job.Eval(y, x));
   }
 
+  MGLORIA_INLINE_NORMAL void EvalTile(index_t y0, index_t x0, index_t rows, index_t cols,
+                                      DataType* out) const {
+    JobTile<JobTileCheck<A_T>::m_Enable>::Eval(m_job, y0, x0, rows, cols, out);
+    for (index_t r = 0; r < rows; ++r) {
+      DataType* __row__ = out + r * MGLORIA_JOB_TILE_COLS;
+      for (index_t c = 0; c < cols; ++c) { __row__[c] = OP::Do(__row__[c]); }
+    }
+  }
+
   Job<A_T, DataType> m_job;
 };
 
@@ -134,6 +205,18 @@ struct Job<BinaryExpr<OP, A_T, B_T, DataType, EType>, DataType> {
     return OP::Do(m_lhs.Eval(y, x), m_rhs.Eval(y, x));
   }
 
+  MGLORIA_INLINE_NORMAL void EvalTile(index_t y0, index_t x0, index_t rows, index_t cols,
+                                      DataType* out) const {
+    alignas(64) DataType __rhs__[MGLORIA_JOB_TILE_ROWS * MGLORIA_JOB_TILE_COLS];
+    JobTile<JobTileCheck<A_T>::m_Enable>::Eval(m_lhs, y0, x0, rows, cols, out);
+    JobTile<JobTileCheck<B_T>::m_Enable>::Eval(m_rhs, y0, x0, rows, cols, __rhs__);
+    for (index_t r = 0; r < rows; ++r) {
+      DataType* __row__ = out + r * MGLORIA_JOB_TILE_COLS;
+      const DataType* __b__ = __rhs__ + r * MGLORIA_JOB_TILE_COLS;
+      for (index_t c = 0; c < cols; ++c) { __row__[c] = OP::Do(__row__[c], __b__[c]); }
+    }
+  }
+
   Job<A_T, DataType> m_lhs;
   Job<B_T, DataType> m_rhs;
 };
@@ -147,15 +230,58 @@ struct Job<TernaryExpr<OP, A_T, B_T, C_T, DataType, EType>, DataType> {
   explicit Job(const Job<A_T, DataType>& _1, const Job<B_T, DataType>& _2,
                const Job<C_T, DataType>& _3)
       : m_1(_1), m_2(_2), m_3(_3) {}
-  MGLORIA_INLINE_NORMAL DataType Eval(index_t y, index_t x) {
+  MGLORIA_INLINE_NORMAL DataType Eval(index_t y, index_t x) const {
     return OP::Do(m_1.Eval(y, x), m_2.Eval(y, x), m_3.Eval(y, x));
   }
 
+  MGLORIA_INLINE_NORMAL void EvalTile(index_t y0, index_t x0, index_t rows, index_t cols,
+                                      DataType* out) const {
+    alignas(64) DataType __2__[MGLORIA_JOB_TILE_ROWS * MGLORIA_JOB_TILE_COLS];
+    alignas(64) DataType __3__[MGLORIA_JOB_TILE_ROWS * MGLORIA_JOB_TILE_COLS];
+    JobTile<JobTileCheck<A_T>::m_Enable>::Eval(m_1, y0, x0, rows, cols, out);
+    JobTile<JobTileCheck<B_T>::m_Enable>::Eval(m_2, y0, x0, rows, cols, __2__);
+    JobTile<JobTileCheck<C_T>::m_Enable>::Eval(m_3, y0, x0, rows, cols, __3__);
+    for (index_t r = 0; r < rows; ++r) {
+      DataType* __row__ = out + r * MGLORIA_JOB_TILE_COLS;
+      const index_t o = r * MGLORIA_JOB_TILE_COLS;
+      for (index_t c = 0; c < cols; ++c) {
+        __row__[c] = OP::Do(__row__[c], __2__[o + c], __3__[o + c]);
+      }
+    }
+  }
+
   Job<A_T, DataType> m_1;
   Job<B_T, DataType> m_2;
   Job<C_T, DataType> m_3;
 };
 
+// Below is the checks of EvalTile. An element-wise Job has it if one of its operands has.
+template<typename E, typename DataType>
+struct JobTileCheck<TransposeExpr<E, DataType>> {
+  static const bool m_Enable = JobTileCheck<E>::m_Enable;
+};
+
+template<typename OriDataType, typename DisDataType, typename A_T, exprType EType>
+struct JobTileCheck<TypeCastExpr<OriDataType, DisDataType, A_T, EType>> {
+  static const bool m_Enable = JobTileCheck<A_T>::m_Enable;
+};
+
+template<typename OP, typename A_T, typename DataType, exprType EType>
+struct JobTileCheck<UnaryExpr<OP, A_T, DataType, EType>> {
+  static const bool m_Enable = JobTileCheck<A_T>::m_Enable;
+};
+
+template<typename OP, typename A_T, typename B_T, typename DataType, exprType EType>
+struct JobTileCheck<BinaryExpr<OP, A_T, B_T, DataType, EType>> {
+  static const bool m_Enable = JobTileCheck<A_T>::m_Enable || JobTileCheck<B_T>::m_Enable;
+};
+
+template<typename OP, typename A_T, typename B_T, typename C_T, typename DataType, exprType EType>
+struct JobTileCheck<TernaryExpr<OP, A_T, B_T, C_T, DataType, EType>> {
+  static const bool m_Enable =
+      JobTileCheck<A_T>::m_Enable || JobTileCheck<B_T>::m_Enable || JobTileCheck<C_T>::m_Enable;
+};
+
 // Below is the functions for easily use.
 /*!
  *@brief
@@ -184,7 +310,7 @@ MGLORIA_INLINE_NORMAL Job<ScalarExpr<DataType>, DataType> NewJob(const ScalarExp
  */
 template<typename OriDataType, typename DisDataType, typename A_T, exprType EType>
 MGLORIA_INLINE_NORMAL Job<TypeCastExpr<OriDataType, DisDataType, A_T, EType>, DisDataType> NewJob(
-    const TypeCastExpr<OriDataType, DisDataType, A_T, EType>, DisDataType& e) {
+    const TypeCastExpr<OriDataType, DisDataType, A_T, EType>& e) {
   return Job<TypeCastExpr<OriDataType, DisDataType, A_T, EType>, DisDataType>(NewJob(e.m_expr));
 }
 
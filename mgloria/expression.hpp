@@ -20,6 +20,10 @@
 #include "prepare_op.hpp"
 
 namespace mgloria {
+///! For the bias of a dot, see add_bias. Defined in tensor.hpp.
+template<typename Device, int Dims, typename DataType>
+class Tensor;
+
 /*!
  *@brief Below contain the expression template for tensor to use.
  *If you want to add new OPs. You should follow the CRTP.
@@ -179,6 +183,34 @@ struct RValueExpr : public Expression<Container, DataType, RValue_t> {
     return *(this->SelfPtr());
   }
 
+  /*!*/
+  template<typename A_T, exprType EType>
+  MGLORIA_INLINE_NORMAL Container& operator+=(const Expression<A_T, DataType, EType>& exp) {
+    ExpressionDispatcher<op::_plusto, Container, DataType>::Eval(this->SelfPtr(), exp.Self());
+    return *(this->SelfPtr());
+  }
+
+  /*!*/
+  template<typename A_T, exprType EType>
+  MGLORIA_INLINE_NORMAL Container& operator-=(const Expression<A_T, DataType, EType>& exp) {
+    ExpressionDispatcher<op::_minusto, Container, DataType>::Eval(this->SelfPtr(), exp.Self());
+    return *(this->SelfPtr());
+  }
+
+  /*!*/
+  template<typename A_T, exprType EType>
+  MGLORIA_INLINE_NORMAL Container& operator*=(const Expression<A_T, DataType, EType>& exp) {
+    ExpressionDispatcher<op::_multo, Container, DataType>::Eval(this->SelfPtr(), exp.Self());
+    return *(this->SelfPtr());
+  }
+
+  /*!*/
+  template<typename A_T, exprType EType>
+  MGLORIA_INLINE_NORMAL Container& operator/=(const Expression<A_T, DataType, EType>& exp) {
+    ExpressionDispatcher<op::_divto, Container, DataType>::Eval(this->SelfPtr(), exp.Self());
+    return *(this->SelfPtr());
+  }
+
   /*!*/
   MGLORIA_INLINE_NORMAL Container& __dispatch(DataType s) {
     ExpressionDispatcher<op::_saveto, Container, DataType>::Eval(this->SelfPtr(),
@@ -193,13 +225,19 @@ struct RValueExpr : public Expression<Container, DataType, RValue_t> {
     return *(this->SelfPtr());
   }
 
-  /*!*/
-  MGLORIA_INLINE_NORMAL Container& __dispatch(const Expression<Container, DataType, RValue_t>& exp);
+  /*!
+   *@brief    Copies the elements of a container of the same type, e.g. for TensorT::Clone.
+   */
+  MGLORIA_INLINE_NORMAL Container& __dispatch(
+      const Expression<Container, DataType, RValue_t>& exp) {
+    ExpressionDispatcher<op::_saveto, Container, DataType>::Eval(this->SelfPtr(), exp.Self());
+    return *(this->SelfPtr());
+  }
 
   // utils functions
   /*!*/
   MGLORIA_INLINE_NORMAL const TransposeExpr<Container, DataType> T() const {
-    return TransposeExpr<Container, DataType>(this->self());
+    return TransposeExpr<Container, DataType>(this->Self());
   }
 };
 
@@ -317,19 +355,57 @@ MGLORIA_INLINE_NORMAL
          const Expression<C_T, DataType, C_EType>& _c) {
   return GenExpr<OP>(_a, _b, _c);
 }
+
+/*!
+ *@brief      a where cond is not 0, else b, for each element. The cond is usually a compare, e.g.
+ * where(Func<op::_gt>(A, B), A, B). It is a blend by the compare mask when vectorized, no branch.
+ */
+template<typename C_T, typename A_T, typename B_T, typename DataType, exprType C_EType,
+         exprType A_EType, exprType B_EType>
+MGLORIA_INLINE_NORMAL
+    TernaryExpr<op::_where, C_T, A_T, B_T, DataType, C_EType | A_EType | B_EType | Mapped_t>
+    where(const Expression<C_T, DataType, C_EType>& cond,
+          const Expression<A_T, DataType, A_EType>& a,
+          const Expression<B_T, DataType, B_EType>& b) {
+  return GenExpr<op::_where>(cond, a, b);
+}
+
 // ########################## Matrix dot Expression define. #########################
-/*!*/
-template<typename A_T, typename B_T, bool lhs_transposed, bool rhs_transposed, typename DataType>
-struct DotExpr : public Expression<DotExpr<A_T, B_T, lhs_transposed, rhs_transposed, DataType>,
-                                   DataType, Complex_t> {
-  explicit DotExpr(const A_T& a, const B_T& b, DataType scale) : m_a(a), m_b(b), m_scale(scale) {}
+/*!
+ *@brief      dst Saver EpilogueOP(scale * op(a) * op(b) + bias). The bias and EpilogueOP are the
+ * epilogue, applied to each tile of dst by the DotEngine while it is still in registers, so
+ * Func<op::_relu>(dot(X, W) + b) is one pass over dst.
+ *@details    The bias is a vector broadcast over dst: one per column (m_bias_axis 1, e.g. dot + b)
+ * or one per row (m_bias_axis 0). m_bias is nullptr when there is no bias.
+ */
+template<typename A_T, typename B_T, bool lhs_transposed, bool rhs_transposed, typename DataType,
+         typename EpilogueOP = op::_identity>
+struct DotExpr
+    : public Expression<DotExpr<A_T, B_T, lhs_transposed, rhs_transposed, DataType, EpilogueOP>,
+                        DataType, Complex_t> {
+  explicit DotExpr(const A_T& a, const B_T& b, DataType scale, const DataType* bias = nullptr,
+                   index_t bias_size = 0, int bias_axis = 1)
+      : m_a(a),
+        m_b(b),
+        m_scale(scale),
+        m_bias(bias),
+        m_bias_size(bias_size),
+        m_bias_axis(bias_axis) {}
   const A_T& m_a;
   const B_T& m_b;
   DataType m_scale;
+  const DataType* m_bias;
+  index_t m_bias_size;
+  int m_bias_axis;
 };
 
-/*!*/
-template<typename A_T, typename B_T, bool lhs_transposed, bool rhs_transposed, typename DataType>
+/*!
+ *@brief      dst[b] = op(lhs[b]) * op(rhs[b]) over the batch, the first dim of 3D tensors. rhs may
+ * be a 2D tensor, the same for the whole batch, e.g. batch_dot<false, true>(Q, K) for the scores of
+ * attention. See op/__op_batch_dot_cpu.hpp.
+ */
+template<bool lhs_transposed = false, bool rhs_transposed = false, typename A_T, typename B_T,
+         typename DataType>
 MGLORIA_INLINE_NORMAL DotExpr<A_T, B_T, lhs_transposed, rhs_transposed, DataType> batch_dot(
     const RValueExpr<A_T, DataType>& lhs, const RValueExpr<B_T, DataType>& rhs) {
   return DotExpr<A_T, B_T, lhs_transposed, rhs_transposed, DataType>(lhs.Self(), rhs.Self(),
@@ -347,21 +423,242 @@ MGLORIA_INLINE_NORMAL DotExpr<A_T, B_T, false, false, DataType> dot(
 template<typename A_T, typename B_T, typename DataType>
 MGLORIA_INLINE_NORMAL DotExpr<A_T, B_T, true, false, DataType> dot(
     const TransposeExpr<A_T, DataType>& lhs, const RValueExpr<B_T, DataType>& rhs) {
-  return DotExpr<A_T, B_T, true, false, DataType>(lhs.Self(), rhs.Self(), DataType(1.f));
+  return DotExpr<A_T, B_T, true, false, DataType>(lhs.m_expr, rhs.Self(), DataType(1.f));
 }
 
 /*!*/
 template<typename A_T, typename B_T, typename DataType>
 MGLORIA_INLINE_NORMAL DotExpr<A_T, B_T, false, true, DataType> dot(
     const RValueExpr<A_T, DataType>& lhs, const TransposeExpr<B_T, DataType>& rhs) {
-  return DotExpr<A_T, B_T, false, true, DataType>(lhs.Self(), rhs.Self(), DataType(1.f));
+  return DotExpr<A_T, B_T, false, true, DataType>(lhs.Self(), rhs.m_expr, DataType(1.f));
 }
 
 /*!*/
 template<typename A_T, typename B_T, typename DataType>
 MGLORIA_INLINE_NORMAL DotExpr<A_T, B_T, true, true, DataType> dot(
     const TransposeExpr<A_T, DataType>& lhs, const TransposeExpr<B_T, DataType>& rhs) {
-  return DotExpr<A_T, B_T, true, true, DataType>(lhs.Self(), rhs.Self(), DataType(1.f));
+  return DotExpr<A_T, B_T, true, true, DataType>(lhs.m_expr, rhs.m_expr, DataType(1.f));
+}
+
+/*!
+ *@brief      Scale a dot, dot(A, B) * s. It is done by the DotEngine, no extra pass. The scale is
+ * of the product only, so it is done before a bias is added: dot(A, B) * s + b.
+ */
+template<typename A_T, typename B_T, bool lhs_transposed, bool rhs_transposed, typename DataType>
+MGLORIA_INLINE_NORMAL DotExpr<A_T, B_T, lhs_transposed, rhs_transposed, DataType> operator*(
+    const DotExpr<A_T, B_T, lhs_transposed, rhs_transposed, DataType>& lhs, DataType s) {
+  LOG_CHECK(lhs.m_bias == nullptr, " dot: scale the dot before adding the bias.");
+  return DotExpr<A_T, B_T, lhs_transposed, rhs_transposed, DataType>(lhs.m_a, lhs.m_b,
+                                                                     lhs.m_scale * s);
+}
+
+/*!*/
+template<typename A_T, typename B_T, bool lhs_transposed, bool rhs_transposed, typename DataType>
+MGLORIA_INLINE_NORMAL DotExpr<A_T, B_T, lhs_transposed, rhs_transposed, DataType> operator*(
+    DataType s, const DotExpr<A_T, B_T, lhs_transposed, rhs_transposed, DataType>& rhs) {
+  return rhs * s;
+}
+
+/*!
+ *@brief      Add a bias vector to a dot in its epilogue. axis 1: bias[j] is added to the column j
+ * of dst, it has as many elements as dst has columns. axis 0: bias[i] to the row i.
+ */
+template<typename A_T, typename B_T, bool lhs_transposed, bool rhs_transposed, typename DataType,
+         typename Device>
+MGLORIA_INLINE_NORMAL DotExpr<A_T, B_T, lhs_transposed, rhs_transposed, DataType> add_bias(
+    const DotExpr<A_T, B_T, lhs_transposed, rhs_transposed, DataType>& d,
+    const Tensor<Device, 1, DataType>& bias, int axis) {
+  LOG_CHECK(d.m_bias == nullptr, " dot: the bias is added already.");
+  LOG_CHECK(axis == 0 || axis == 1, " dot: the axis of the bias is ", axis);
+  return DotExpr<A_T, B_T, lhs_transposed, rhs_transposed, DataType>(
+      d.m_a, d.m_b, d.m_scale, bias.__data_ptr, bias.m_Shape[0], axis);
+}
+
+/*!
+ *@brief      dot(A, B) + b, b broadcast over the rows of dst as add_bias(dot(A, B), b, 1).
+ */
+template<typename A_T, typename B_T, bool lhs_transposed, bool rhs_transposed, typename DataType,
+         typename Device>
+MGLORIA_INLINE_NORMAL DotExpr<A_T, B_T, lhs_transposed, rhs_transposed, DataType> operator+(
+    const DotExpr<A_T, B_T, lhs_transposed, rhs_transposed, DataType>& d,
+    const Tensor<Device, 1, DataType>& bias) {
+  return add_bias(d, bias, 1);
+}
+
+/*!
+ *@brief      Func<OP>(dot(A, B) + b), the OP is applied in the epilogue of the dot. Only one OP,
+ * it must be element-wise and unary, e.g. op::_relu.
+ */
+template<typename OP, typename A_T, typename B_T, bool lhs_transposed, bool rhs_transposed,
+         typename DataType>
+MGLORIA_INLINE_NORMAL DotExpr<A_T, B_T, lhs_transposed, rhs_transposed, DataType, OP> Func(
+    const DotExpr<A_T, B_T, lhs_transposed, rhs_transposed, DataType>& d) {
+  return DotExpr<A_T, B_T, lhs_transposed, rhs_transposed, DataType, OP>(
+      d.m_a, d.m_b, d.m_scale, d.m_bias, d.m_bias_size, d.m_bias_axis);
+}
+
+// ###################### Quantized Matrix dot Expression define. ######################
+/*!
+ *@brief      The dot of uint8_t activations a [M, K] and int8_t weights op(b) [K, N], summed in
+ * int32_t: acc = sum_k (a[i][k] - a_zero) * b[k][j]. The epilogue requantizes acc to dst.
+ *@details    DisDataType int32_t: dst Saver acc.
+ *            DisDataType float:   dst Saver scale * acc.
+ *            DisDataType int8_t:  dst Saver saturate(round(scale * acc) + out_zero).
+ * scale is one for all (m_scale nullptr, m_scale_value) or one per column of dst, as the per
+ * channel scales of the weights times the scale of a.
+ *@note       It is evaluated by the ExpressionComplexDispatcher in op/__op_qdot_cpu.hpp.
+ */
+template<typename A_T, typename B_T, bool rhs_transposed, typename DisDataType>
+struct QuantDotExpr
+    : public Expression<QuantDotExpr<A_T, B_T, rhs_transposed, DisDataType>, DisDataType,
+                        Complex_t> {
+  explicit QuantDotExpr(const A_T& a, const B_T& b, int32_t a_zero, const float* scale = nullptr,
+                        index_t scale_size = 0, float scale_value = 1.f, int32_t out_zero = 0)
+      : m_a(a),
+        m_b(b),
+        m_a_zero(a_zero),
+        m_scale(scale),
+        m_scale_size(scale_size),
+        m_scale_value(scale_value),
+        m_out_zero(out_zero) {}
+  const A_T& m_a;
+  const B_T& m_b;
+  int32_t m_a_zero;
+  const float* m_scale;
+  index_t m_scale_size;
+  float m_scale_value;
+  int32_t m_out_zero;
+};
+
+/*!
+ *@brief      dot(A, W) of uint8_t A and int8_t W to int32_t. a_zero is the zero point of A.
+ */
+template<typename A_T, typename B_T>
+MGLORIA_INLINE_NORMAL QuantDotExpr<A_T, B_T, false, int32_t> dot(
+    const RValueExpr<A_T, uint8_t>& lhs, const RValueExpr<B_T, int8_t>& rhs, int32_t a_zero = 0) {
+  return QuantDotExpr<A_T, B_T, false, int32_t>(lhs.Self(), rhs.Self(), a_zero);
+}
+
+/*!
+ *@brief      dot(A, W.T()), W stored as [N, K] as the weights of a linear layer usually are.
+ */
+template<typename A_T, typename B_T>
+MGLORIA_INLINE_NORMAL QuantDotExpr<A_T, B_T, true, int32_t> dot(
+    const RValueExpr<A_T, uint8_t>& lhs, const TransposeExpr<B_T, int8_t>& rhs,
+    int32_t a_zero = 0) {
+  return QuantDotExpr<A_T, B_T, true, int32_t>(lhs.Self(), rhs.m_expr, a_zero);
+}
+
+/*!
+ *@brief      Requantize a quantized dot to float or int8_t with one scale, e.g.
+ * Y = requantize<int8_t>(dot(X, W.T(), x_zero), x_scale * w_scale / y_scale, y_zero);
+ */
+template<typename DisDataType, typename A_T, typename B_T, bool rhs_transposed>
+MGLORIA_INLINE_NORMAL QuantDotExpr<A_T, B_T, rhs_transposed, DisDataType> requantize(
+    const QuantDotExpr<A_T, B_T, rhs_transposed, int32_t>& d, float scale, int32_t out_zero = 0) {
+  static_assert(std::is_same<DisDataType, float>::value || std::is_same<DisDataType, int8_t>::value,
+                "requantize: to float or int8_t only.");
+  return QuantDotExpr<A_T, B_T, rhs_transposed, DisDataType>(d.m_a, d.m_b, d.m_a_zero, nullptr, 0,
+                                                             scale, out_zero);
+}
+
+/*!
+ *@brief      Requantize with one scale per column of dst, scales has as many elements as dst has
+ * columns.
+ */
+template<typename DisDataType, typename A_T, typename B_T, bool rhs_transposed, typename Device>
+MGLORIA_INLINE_NORMAL QuantDotExpr<A_T, B_T, rhs_transposed, DisDataType> requantize(
+    const QuantDotExpr<A_T, B_T, rhs_transposed, int32_t>& d,
+    const Tensor<Device, 1, float>& scales, int32_t out_zero = 0) {
+  static_assert(std::is_same<DisDataType, float>::value || std::is_same<DisDataType, int8_t>::value,
+                "requantize: to float or int8_t only.");
+  return QuantDotExpr<A_T, B_T, rhs_transposed, DisDataType>(
+      d.m_a, d.m_b, d.m_a_zero, scales.__data_ptr, scales.m_Shape[0], 1.f, out_zero);
+}
+
+// ######################### Convolution Expression define. ##########################
+/*!
+ *@brief      dst Saver conv2d(input, weight) of a 4D input in Layout, BCHW or BHWC, the dst is in
+ * the same layout. The weight is [Cout, Cin / groups, KH, KW] for BCHW and [Cout, KH, KW,
+ * Cin / groups] for BHWC: a row of it is in the order a window of the input is read in.
+ *@details    Conv2dShape gives the shape of the dst. There is no bias, add it after.
+ *@note       It is evaluated by the ExpressionComplexDispatcher in op/__op_conv_cpu.hpp.
+ */
+template<typename A_T, typename B_T, LayoutTypeType Layout, typename DataType>
+struct Conv2dExpr
+    : public Expression<Conv2dExpr<A_T, B_T, Layout, DataType>, DataType, Complex_t> {
+  static_assert(Layout == LayoutTypeType::BCHW || Layout == LayoutTypeType::BHWC,
+                "conv2d: the layout is BCHW or BHWC.");
+  explicit Conv2dExpr(const A_T& input, const B_T& weight, const Conv2dParam& param)
+      : m_input(input), m_weight(weight), m_param(param) {}
+  const A_T& m_input;
+  const B_T& m_weight;
+  Conv2dParam m_param;
+};
+
+/*!
+ *@brief      e.g. Y = conv2d<LayoutTypeType::BHWC>(X, W, Conv2dParam(1, 1));
+ */
+template<LayoutTypeType Layout = defualt_layout_t, typename A_T, typename B_T, typename DataType>
+MGLORIA_INLINE_NORMAL Conv2dExpr<A_T, B_T, Layout, DataType> conv2d(
+    const RValueExpr<A_T, DataType>& input, const RValueExpr<B_T, DataType>& weight,
+    const Conv2dParam& param = Conv2dParam()) {
+  return Conv2dExpr<A_T, B_T, Layout, DataType>(input.Self(), weight.Self(), param);
+}
+
+// ########################## Reduce Expression define. #############################
+/*!
+ *@brief      Reduce one axis of a tensor. The dst has the shape of the tensor without that axis,
+ * a 1D tensor is reduced to the shape [1].
+ *@tparam     Reducer one of op::_red_xxx.
+ *@tparam     OriDataType the element datatype of the tensor reduced.
+ *@tparam     DisDataType the result datatype, the index type for argmax.
+ *@note       It is evaluated by the ExpressionComplexDispatcher in op/__op_reduce_cpu.hpp.
+ */
+template<typename Reducer, typename A_T, typename OriDataType, typename DisDataType>
+struct ReduceExpr : public Expression<ReduceExpr<Reducer, A_T, OriDataType, DisDataType>,
+                                      DisDataType, Complex_t> {
+  explicit ReduceExpr(const A_T& a, index_t axis) : m_a(a), m_axis(axis) {}
+  const A_T& m_a;
+  index_t m_axis;
+};
+
+/*!*/
+template<typename A_T, typename DataType>
+MGLORIA_INLINE_NORMAL ReduceExpr<op::_red_sum, A_T, DataType, DataType> reduce_sum(
+    const RValueExpr<A_T, DataType>& src, index_t axis) {
+  return ReduceExpr<op::_red_sum, A_T, DataType, DataType>(src.Self(), axis);
+}
+
+/*!*/
+template<typename A_T, typename DataType>
+MGLORIA_INLINE_NORMAL ReduceExpr<op::_red_mean, A_T, DataType, DataType> reduce_mean(
+    const RValueExpr<A_T, DataType>& src, index_t axis) {
+  return ReduceExpr<op::_red_mean, A_T, DataType, DataType>(src.Self(), axis);
+}
+
+/*!*/
+template<typename A_T, typename DataType>
+MGLORIA_INLINE_NORMAL ReduceExpr<op::_red_max, A_T, DataType, DataType> reduce_max(
+    const RValueExpr<A_T, DataType>& src, index_t axis) {
+  return ReduceExpr<op::_red_max, A_T, DataType, DataType>(src.Self(), axis);
+}
+
+/*!*/
+template<typename A_T, typename DataType>
+MGLORIA_INLINE_NORMAL ReduceExpr<op::_red_min, A_T, DataType, DataType> reduce_min(
+    const RValueExpr<A_T, DataType>& src, index_t axis) {
+  return ReduceExpr<op::_red_min, A_T, DataType, DataType>(src.Self(), axis);
+}
+
+/*!
+ *@brief      The index of the max along the axis, the first one on ties. e.g.
+ * Tensor<CPU, 1, int32_t> label; label = argmax(logits, 1);
+ */
+template<typename IndexType = int32_t, typename A_T, typename DataType>
+MGLORIA_INLINE_NORMAL ReduceExpr<op::_red_argmax, A_T, DataType, IndexType> argmax(
+    const RValueExpr<A_T, DataType>& src, index_t axis) {
+  return ReduceExpr<op::_red_argmax, A_T, DataType, IndexType>(src.Self(), axis);
 }
 }  // namespace expr
 
@@ -0,0 +1,333 @@
+/*!
+ *@author   chenghua.wang
+ *@file     memory_pool.hpp
+ *@brief    The caching allocator of the host memory of CPU tensors, behind HostMallocTensorMem and
+ * __HostMalloc__<CPU>.
+ *@details  A freed block is kept for the next allocation of its size class instead of going back
+ * to the system, so the temporaries of a loop reuse the same pages: no posix_memalign, free or page
+ * faults once the loop is warm. The classes are 4 per power of 2 from 64 bytes, a block wastes
+ * under 25% of what it holds. Blocks over 2^MGLORIA_HOST_POOL_MAX_LOG bytes are not cached.
+ *
+ * Each thread keeps the blocks it frees, up to MGLORIA_HOST_POOL_THREAD_BYTES, and takes them back
+ * without a lock. The rest goes to a cache shared by all the threads, of at most
+ * MGLORIA_HOST_POOL_CACHE_BYTES, which a thread looks in when its own has no block of the class.
+ *
+ * A block is aligned as MallocAlignedPitch aligns, to at least 64 bytes. The header in front of it
+ * holds its class, so it is freed by the pointer alone, and to the system if the pool is off. A
+ * block of MGLORIA_HUGE_PAGE_MIN bytes or more starts on a huge page, advised MADV_HUGEPAGE.
+ *@note     The env MGLORIA_HOST_POOL=0, or SetEnabled(false), turns caching off: every block is
+ * taken from and given back to the system, e.g. to find leaks. Built with MGLORIA_HOST_POOL 0 the
+ * pool is not used at all.
+ */
+
+#ifndef _MGLORIA_MEMORY_POOL_HPP_
+#define _MGLORIA_MEMORY_POOL_HPP_
+
+#pragma once
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <vector>
+#include "./vectorization/__vec_mm.hpp"
+
+namespace mgloria {
+
+/*!
+ *@brief    The counters of the pool. The bytes are the ones of the size classes.
+ */
+struct HostPoolStats {
+  size_t m_allocs;          ///! Allocations.
+  size_t m_hits;            ///! Allocations served from a cache.
+  size_t m_frees;           ///! Frees.
+  size_t m_bytes_in_use;    ///! Held by the blocks not freed yet.
+  size_t m_peak_bytes;      ///! The most m_bytes_in_use has been.
+  size_t m_bytes_cached;    ///! Held by the caches of all the threads.
+  size_t m_bytes_reserved;  ///! Taken from the system and not given back.
+};
+
+class HostMemoryPool {
+ public:
+  static const int ms_MinLog = 6;
+  static const int ms_Classes = 1 + (MGLORIA_HOST_POOL_MAX_LOG - ms_MinLog) * 4;
+  static const size_t ms_Align = 64;
+
+  MGLORIA_INLINE_NORMAL static HostMemoryPool& Get() {
+    static HostMemoryPool __pool__;
+    return __pool__;
+  }
+
+  ///! The class of a block of bytes and the size of the class, -1 if it is not cached.
+  MGLORIA_INLINE_NORMAL static int ClassOf(size_t bytes, size_t* size) {
+    if (bytes <= (size_t(1) << ms_MinLog)) {
+      *size = size_t(1) << ms_MinLog;
+      return 0;
+    }
+    int p = ms_MinLog;
+    while ((size_t(1) << (p + 1)) < bytes) { ++p; }
+    if (p >= MGLORIA_HOST_POOL_MAX_LOG) {
+      *size = (bytes + ms_Align - 1) / ms_Align * ms_Align;
+      return -1;
+    }
+    const size_t step = size_t(1) << (p - 2);
+    const size_t q = (bytes + step - 1) / step;
+    *size = q * step;
+    return 1 + (p - ms_MinLog) * 4 + static_cast<int>(q - 5);
+  }
+
+  ///! fresh, if not null, tells whether the block is new from the system, never touched.
+  MGLORIA_INLINE_NORMAL void* Malloc(size_t bytes, bool* fresh = nullptr) {
+    size_t __size__;
+    const int __cls__ = ClassOf(bytes, &__size__);
+    m_allocs.fetch_add(1, std::memory_order_relaxed);
+    void* __ptr__ = nullptr;
+    if (__cls__ >= 0 && m_enabled.load(std::memory_order_relaxed)) {
+      ThreadCache& __tc__ = Local();
+      if (!__tc__.m_free[__cls__].empty()) {
+        __ptr__ = __tc__.m_free[__cls__].back();
+        __tc__.m_free[__cls__].pop_back();
+        __tc__.m_bytes -= __size__;
+      } else {
+        std::lock_guard<std::mutex> __lock__(m_mutex);
+        if (!m_free[__cls__].empty()) {
+          __ptr__ = m_free[__cls__].back();
+          m_free[__cls__].pop_back();
+        }
+      }
+    }
+    if (fresh != nullptr) { *fresh = __ptr__ == nullptr; }
+    if (__ptr__ != nullptr) {
+      m_hits.fetch_add(1, std::memory_order_relaxed);
+      m_cached.fetch_sub(__size__, std::memory_order_relaxed);
+    } else {
+      __ptr__ = System(__size__, __cls__);
+    }
+    const size_t __use__ = m_in_use.fetch_add(__size__, std::memory_order_relaxed) + __size__;
+    size_t __peak__ = m_peak.load(std::memory_order_relaxed);
+    while (__use__ > __peak__
+           && !m_peak.compare_exchange_weak(__peak__, __use__, std::memory_order_relaxed)) {}
+    return __ptr__;
+  }
+
+  MGLORIA_INLINE_NORMAL void Free(void* ptr) {
+    if (ptr == nullptr) { return; }
+    Header* __h__ = HeaderOf(ptr);
+    CHECK_EQUAL(__h__->m_magic, ms_Magic, " HostMemoryPool: freeing a block it did not allocate.");
+    const int __cls__ = __h__->m_class;
+    const size_t __size__ = __h__->m_size;
+    m_frees.fetch_add(1, std::memory_order_relaxed);
+    m_in_use.fetch_sub(__size__, std::memory_order_relaxed);
+    if (__cls__ >= 0 && m_enabled.load(std::memory_order_relaxed)) {
+      ThreadCache& __tc__ = Local();
+      if (__size__ <= MGLORIA_HOST_POOL_THREAD_BYTES / 16
+          && __tc__.m_bytes + __size__ <= MGLORIA_HOST_POOL_THREAD_BYTES) {
+        __tc__.m_free[__cls__].push_back(ptr);
+        __tc__.m_bytes += __size__;
+        m_cached.fetch_add(__size__, std::memory_order_relaxed);
+        return;
+      }
+      std::lock_guard<std::mutex> __lock__(m_mutex);
+      if (m_cached.load(std::memory_order_relaxed) + __size__ <= MGLORIA_HOST_POOL_CACHE_BYTES) {
+        m_free[__cls__].push_back(ptr);
+        m_cached.fetch_add(__size__, std::memory_order_relaxed);
+        return;
+      }
+    }
+    Release(ptr);
+  }
+
+  ///! Give the blocks cached by this thread and the shared ones back to the system. The caches of
+  ///! the other threads are given back when they exit.
+  MGLORIA_INLINE_NORMAL void Trim() {
+    Local().Flush(this);
+    std::lock_guard<std::mutex> __lock__(m_mutex);
+    for (int c = 0; c < ms_Classes; ++c) {
+      for (void* p : m_free[c]) {
+        m_cached.fetch_sub(HeaderOf(p)->m_size, std::memory_order_relaxed);
+        Release(p);
+      }
+      m_free[c].clear();
+    }
+  }
+
+  MGLORIA_INLINE_NORMAL bool Enabled() const { return m_enabled.load(); }
+
+  ///! Off gives the blocks cached back first. The blocks taken before are freed all the same.
+  MGLORIA_INLINE_NORMAL void SetEnabled(bool enabled) {
+    m_enabled.store(enabled);
+    if (!enabled) { Trim(); }
+  }
+
+  MGLORIA_INLINE_NORMAL HostPoolStats Stats() const {
+    HostPoolStats __s__;
+    __s__.m_allocs = m_allocs.load();
+    __s__.m_hits = m_hits.load();
+    __s__.m_frees = m_frees.load();
+    __s__.m_bytes_in_use = m_in_use.load();
+    __s__.m_peak_bytes = m_peak.load();
+    __s__.m_bytes_cached = m_cached.load();
+    __s__.m_bytes_reserved = m_reserved.load();
+    return __s__;
+  }
+
+  ///! Reset the counts and the peak, the bytes held are kept.
+  MGLORIA_INLINE_NORMAL void ResetStats() {
+    m_allocs.store(0);
+    m_hits.store(0);
+    m_frees.store(0);
+    m_peak.store(m_in_use.load());
+  }
+
+ private:
+  static const uint32_t ms_Magic = 0x6d67706cu;
+
+  struct Header {
+    uint32_t m_magic;
+    int32_t m_class;
+    size_t m_size;
+  };
+
+  struct ThreadCache {
+    ThreadCache() : m_bytes(0) {}
+    ~ThreadCache() { Flush(&HostMemoryPool::Get()); }
+
+    ///! All to the shared cache, and to the system over its limit.
+    MGLORIA_INLINE_NORMAL void Flush(HostMemoryPool* pool) {
+      std::lock_guard<std::mutex> __lock__(pool->m_mutex);
+      for (int c = 0; c < ms_Classes; ++c) {
+        for (void* p : m_free[c]) {
+          if (pool->m_cached.load(std::memory_order_relaxed) > MGLORIA_HOST_POOL_CACHE_BYTES) {
+            pool->m_cached.fetch_sub(HeaderOf(p)->m_size, std::memory_order_relaxed);
+            pool->Release(p);
+          } else {
+            pool->m_free[c].push_back(p);
+          }
+        }
+        m_free[c].clear();
+      }
+      m_bytes = 0;
+    }
+
+    std::vector<void*> m_free[ms_Classes];
+    size_t m_bytes;
+  };
+
+  HostMemoryPool()
+      : m_enabled(true),
+        m_allocs(0),
+        m_hits(0),
+        m_frees(0),
+        m_in_use(0),
+        m_peak(0),
+        m_cached(0),
+        m_reserved(0) {
+    const char* __env__ = std::getenv("MGLORIA_HOST_POOL");
+    if (__env__ != nullptr && std::strcmp(__env__, "0") == 0) { m_enabled.store(false); }
+  }
+
+  ~HostMemoryPool() {
+    for (int c = 0; c < ms_Classes; ++c) {
+      for (void* p : m_free[c]) { std::free(BaseOf(p)); }
+    }
+  }
+
+  MGLORIA_INLINE_NORMAL static Header* HeaderOf(void* ptr) {
+    return reinterpret_cast<Header*>(static_cast<char*>(ptr) - sizeof(Header));
+  }
+
+  ///! The header takes a whole alignment in front of the block, so the block stays aligned.
+  MGLORIA_INLINE_NORMAL static size_t Align() {
+    const size_t __vec__ =
+        size_t(1) << vectorization::AlignBytes<MGLORIA_VECTORIZATION_ALIGN_ARCH>::Default;
+    return __vec__ > size_t(ms_Align) ? __vec__ : size_t(ms_Align);
+  }
+
+  ///! What posix_memalign gave for a block.
+  MGLORIA_INLINE_NORMAL static void* BaseOf(void* ptr) { return static_cast<char*>(ptr) - Align(); }
+
+  MGLORIA_INLINE_NORMAL static ThreadCache& Local() {
+    static thread_local ThreadCache __cache__;
+    return __cache__;
+  }
+
+  MGLORIA_INLINE_NORMAL void* System(size_t size, int cls) {
+    // A large block starts on a huge page, its header takes the first Align() bytes of it.
+    const size_t __align__ = vectorization::BlockAlign(Align() + size, Align());
+    void* __base__ = nullptr;
+    const int __ret__ = posix_memalign(&__base__, __align__, Align() + size);
+    if (__ret__ != 0 || __base__ == nullptr) {
+      // The cached blocks may be what the system is short of.
+      Trim();
+      CHECK_EQUAL(posix_memalign(&__base__, __align__, Align() + size), 0,
+                  " HostMemoryPool: posix_memalign of ", size, " bytes failed.");
+    }
+    vectorization::AdviseHugePages(__base__, Align() + size);
+    void* __ptr__ = static_cast<char*>(__base__) + Align();
+    Header* __h__ = HeaderOf(__ptr__);
+    __h__->m_magic = ms_Magic;
+    __h__->m_class = cls;
+    __h__->m_size = size;
+    m_reserved.fetch_add(size, std::memory_order_relaxed);
+    return __ptr__;
+  }
+
+  MGLORIA_INLINE_NORMAL void Release(void* ptr) {
+    m_reserved.fetch_sub(HeaderOf(ptr)->m_size, std::memory_order_relaxed);
+    std::free(BaseOf(ptr));
+  }
+
+  std::mutex m_mutex;
+  std::vector<void*> m_free[ms_Classes];
+  std::atomic<bool> m_enabled;
+  std::atomic<size_t> m_allocs;
+  std::atomic<size_t> m_hits;
+  std::atomic<size_t> m_frees;
+  std::atomic<size_t> m_in_use;
+  std::atomic<size_t> m_peak;
+  std::atomic<size_t> m_cached;
+  std::atomic<size_t> m_reserved;
+};
+
+/*!
+ *@brief    As MallocAlignedPitch, from the pool when it is built in. Free with HostPoolFree.
+ */
+MGLORIA_INLINE_NORMAL void* HostPoolMallocPitch(size_t* actual_mem, size_t line_cells,
+                                                size_t lines, bool* fresh = nullptr) {
+#if MGLORIA_HOST_POOL == 1
+  const index_t aligned_bits = vectorization::AlignBytes<MGLORIA_VECTORIZATION_ALIGN_ARCH>::Default;
+  const size_t masked = (size_t(1) << aligned_bits) - 1;
+  *actual_mem = (line_cells + masked) & ~masked;
+  return HostMemoryPool::Get().Malloc(*actual_mem * lines, fresh);
+#else
+  if (fresh != nullptr) { *fresh = true; }
+  return vectorization::MallocAlignedPitch(actual_mem, line_cells, lines);
+#endif  // MGLORIA_HOST_POOL == 1
+}
+
+/*!
+ *@brief    Touch the lines of a new block first from the threads of the OpenMP static partition of
+ * the lines, as MapJob2Tensor runs over the rows: the pages are placed on the NUMA nodes of the
+ * threads that compute on them.
+ */
+MGLORIA_INLINE_NORMAL void HostFirstTouch(void* ptr, size_t pitch, size_t lines) {
+  char* __data__ = static_cast<char*>(ptr);
+#ifndef __CUDACC__
+#pragma omp parallel for schedule(static)
+#endif
+  for (openmp_index_t y = 0; y < static_cast<openmp_index_t>(lines); ++y) {
+    std::memset(__data__ + y * pitch, 0, pitch);
+  }
+}
+
+MGLORIA_INLINE_NORMAL void HostPoolFree(void* ptr) {
+#if MGLORIA_HOST_POOL == 1
+  HostMemoryPool::Get().Free(ptr);
+#else
+  vectorization::FreeAlignedPitch(ptr);
+#endif  // MGLORIA_HOST_POOL == 1
+}
+
+}  // namespace mgloria
+
+#endif  // _MGLORIA_MEMORY_POOL_HPP_
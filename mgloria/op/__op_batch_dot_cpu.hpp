@@ -0,0 +1,320 @@
+/*!
+ *@author chenghua.wang
+ *@file   op/__op_batch_dot_cpu.hpp
+ *@brief  The strided-batch gemm of batch_dot on 3D CPU tensors.
+ *@details dst[b] = scale * op(lhs[b]) * op(rhs[b]) for each b of the batch. The slice b of a
+ * [batch, rows, cols] tensor is the rows x cols matrix at b * rows * m_Stride_, with the m_Stride_
+ * of the tensor as the stride of its rows, so a padded tensor or a Slice of one is used as it is.
+ * rhs may be a 2D tensor or a 3D one of batch 1, it is then the same for all of lhs and packed
+ * only once.
+ *
+ * The gemms are the ones of op/__op_dot_cpu.hpp. With at least as many gemms as threads, or small
+ * ones, a thread runs whole gemms, packing into buffers of its own. Else the gemms run one after
+ * the other, each over all the threads as a dot does.
+ */
+
+#ifndef _MGLORIA___OP_BATCH_DOT_CPU_HPP_
+#define _MGLORIA___OP_BATCH_DOT_CPU_HPP_
+
+#pragma once
+
+#include "__op_dot_cpu.hpp"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace mgloria {
+namespace expr {
+
+/*!
+ *@brief    One side of a batch_dot: m_batch matrices of m_rows x m_cols, the one of b at
+ * m_data + b * m_step. m_step is 0 when the matrix is the same for the whole batch.
+ */
+template<typename DataType>
+struct BatchOperand {
+  MGLORIA_INLINE_NORMAL Tensor<CPU, 2, DataType> Slice(index_t b) const {
+    return Tensor<CPU, 2, DataType>(m_data + size_t(b) * m_step, makeShape2d(m_rows, m_cols),
+                                    m_ld, m_stream);
+  }
+
+  DataType* m_data;
+  index_t m_batch;
+  index_t m_rows;
+  index_t m_cols;
+  index_t m_ld;
+  size_t m_step;
+  Stream<CPU>* m_stream;
+};
+
+template<typename DataType>
+MGLORIA_INLINE_NORMAL BatchOperand<DataType> MakeBatchOperand(const Tensor<CPU, 3, DataType>& t) {
+  return BatchOperand<DataType>{t.__data_ptr, t.size(0), t.size(1), t.size(2), t.m_Stride_,
+                                t.size(0) == 1 ? 0 : size_t(t.size(1)) * t.m_Stride_,
+                                t.m_Stream};
+}
+
+template<typename DataType>
+MGLORIA_INLINE_NORMAL BatchOperand<DataType> MakeBatchOperand(const Tensor<CPU, 2, DataType>& t) {
+  return BatchOperand<DataType>{t.__data_ptr, 1, t.size(0), t.size(1), t.m_Stride_, 0,
+                                t.m_Stream};
+}
+
+/*!
+ *@brief    All the MC x NC blocks of one gemm, run by the calling thread.
+ */
+template<typename Kern, typename First, typename Rest, vectorization::VecArch Arch, typename OP,
+         typename DataType>
+MGLORIA_INLINE_NORMAL void BatchGemm(DataType* c, index_t ldc, const DataType* pa,
+                                     const DataType* pb, index_t M, index_t N, index_t K,
+                                     const GemmBlocking& blk,
+                                     const GemmEpilogue<OP, DataType>& epi) {
+  const index_t mpad = (M + Kern::m_MR - 1) / Kern::m_MR * Kern::m_MR;
+  const index_t npad = (N + Kern::m_NR - 1) / Kern::m_NR * Kern::m_NR;
+  for (index_t i0 = 0; i0 < M; i0 += blk.m_MC) {
+    const index_t mc = M - i0 < blk.m_MC ? M - i0 : blk.m_MC;
+    for (index_t j0 = 0; j0 < N; j0 += blk.m_NC) {
+      const index_t nc = N - j0 < blk.m_NC ? N - j0 : blk.m_NC;
+      GemmArchKernel<Arch>::template Block<Kern, First, Rest>(c, ldc, pa, pb, mpad, npad, i0, mc,
+                                                              j0, nc, K, blk.m_KC, epi);
+    }
+  }
+}
+
+/*!
+ *@brief    Check the shapes, pack and run the gemms of the batch with Arch.
+ */
+template<typename Saver, vectorization::VecArch Arch, bool LeftTransposed, bool RightTransposed,
+         typename OP, typename DataType>
+MGLORIA_INLINE_NORMAL void ExecuteBatchDot(Tensor<CPU, 3, DataType> dst,
+                                           const BatchOperand<DataType>& lhs,
+                                           const BatchOperand<DataType>& rhs, DataType scale,
+                                           const GemmEpilogue<OP, DataType>& epi) {
+  typedef GemmKernel<DataType, Arch, GemmVecCheck<DataType, Arch>::m_Enable> Kern;
+  typedef typename GemmSaver<Saver>::First First;
+  typedef typename GemmSaver<Saver>::Rest Rest;
+  const index_t Bt = dst.size(0);
+  const index_t M = LeftTransposed ? lhs.m_cols : lhs.m_rows;
+  const index_t K = LeftTransposed ? lhs.m_rows : lhs.m_cols;
+  const index_t N = RightTransposed ? rhs.m_rows : rhs.m_cols;
+  const index_t KR = RightTransposed ? rhs.m_cols : rhs.m_rows;
+  LOG_CHECK(K == KR && lhs.m_batch == Bt && (rhs.m_batch == Bt || rhs.m_step == 0),
+            " batch_dot: lhs=[", lhs.m_batch, ", ", lhs.m_rows, ", ", lhs.m_cols, "] rhs=[",
+            rhs.m_batch, ", ", rhs.m_rows, ", ", rhs.m_cols, "] lhs_transposed=", LeftTransposed,
+            " rhs_transposed=", RightTransposed);
+  LOG_CHECK(dst.size(1) == M && dst.size(2) == N, " batch_dot: Shape_Dst=", dst.m_Shape.str(),
+            " M=", M, " N=", N);
+  if (Bt == 0 || M == 0 || N == 0) { return; }
+  const index_t ldc = dst.m_Stride_;
+  const size_t __dstep__ = size_t(M) * ldc;
+
+  if (K == 0) {
+    for (index_t b = 0; b < Bt; ++b) {
+      ExecuteDot<Saver, Arch, LeftTransposed, RightTransposed>(
+          Tensor<CPU, 2, DataType>(dst.__data_ptr + b * __dstep__, makeShape2d(M, N), ldc,
+                                   dst.m_Stream),
+          lhs.Slice(b), rhs.Slice(b), scale, epi);
+    }
+    return;
+  }
+
+  GemmBlocking __blk__ = GemmDefaultBlocking<Kern, DataType>(M, N);
+  const bool __split__ = GemmSaver<Saver>::m_Split
+                         && (!epi.Enabled() || std::is_same<Saver, op::_saveto>::value);
+  if (!__split__ && K > __blk__.m_KC) {
+    // Saved to a buffer first, then applied once, see ExecuteDot.
+    WorkspaceScope __ws__(dst.m_Stream);
+    size_t __pitch__;
+    DataType* __buf__ =
+        static_cast<DataType*>(__ws__.AllocPitch(&__pitch__, sizeof(DataType) * N, Bt * M));
+    Tensor<CPU, 3, DataType> __tmp__(__buf__, dst.m_Shape, index_t(__pitch__ / sizeof(DataType)),
+                                     dst.m_Stream);
+    ExecuteBatchDot<op::_saveto, Arch, LeftTransposed, RightTransposed>(__tmp__, lhs, rhs, scale,
+                                                                        epi);
+#ifndef __CUDACC__
+#pragma omp parallel for
+#endif
+    for (openmp_index_t i = 0; i < Bt * M; ++i) {
+      for (index_t j = 0; j < N; ++j) {
+        Saver::template Do<DataType>(dst.__data_ptr[size_t(i) * ldc + j],
+                                     __tmp__.__data_ptr[size_t(i) * __tmp__.m_Stride_ + j]);
+      }
+    }
+    return;
+  }
+
+  index_t __threads__ = 1;
+#ifdef _OPENMP
+  __threads__ = omp_get_max_threads();
+#endif
+  const index_t MR = Kern::m_MR, NR = Kern::m_NR;
+  const index_t mpad = (M + MR - 1) / MR * MR, npad = (N + NR - 1) / NR * NR;
+  const bool __shared__ = rhs.m_step == 0;
+  // The sizes in 64 bits, M * N * K of a large gemm does not fit an index_t.
+  const size_t __apack__ = size_t(mpad) * K, __bpack__ = size_t(npad) * K;
+  const bool __across__ =
+      Bt >= __threads__ || size_t(M) * N * K <= size_t(MGLORIA_BATCH_DOT_SMALL);
+  WorkspaceScope __ws__(dst.m_Stream);
+  DataType* __pb__ = nullptr;
+  if (__shared__) {
+    __pb__ = __ws__.Alloc<DataType>(__bpack__);
+    GemmPack<RightTransposed>(__pb__, rhs.m_data, rhs.m_ld, N, NR, K, __blk__.m_KC, DataType(1));
+  }
+
+  if (__across__) {
+    // A thread owns whole gemms, so they are not cut for the threads.
+    __blk__.m_NC = (MGLORIA_GEMM_NC + NR - 1) / NR * NR;
+    const size_t __own__ = __apack__ + (__shared__ ? 0 : __bpack__);
+    DataType* __bufs__ = __ws__.Alloc<DataType>(__own__ * __threads__);
+#ifndef __CUDACC__
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for (openmp_index_t b = 0; b < Bt; ++b) {
+      index_t __id__ = 0;
+#ifdef _OPENMP
+      __id__ = omp_get_thread_num();
+#endif
+      DataType* __pa__ = __bufs__ + size_t(__id__) * __own__;
+      GemmPack<!LeftTransposed>(__pa__, lhs.m_data + size_t(b) * lhs.m_step, lhs.m_ld, M, MR, K,
+                                __blk__.m_KC, scale, false);
+      const DataType* __b__ = __pb__;
+      if (!__shared__) {
+        GemmPack<RightTransposed>(__pa__ + __apack__, rhs.m_data + size_t(b) * rhs.m_step,
+                                  rhs.m_ld, N, NR, K, __blk__.m_KC, DataType(1), false);
+        __b__ = __pa__ + __apack__;
+      }
+      BatchGemm<Kern, First, Rest, Arch>(dst.__data_ptr + b * __dstep__, ldc, __pa__, __b__, M, N,
+                                         K, __blk__, epi);
+    }
+  } else {
+    DataType* __pa__ = __ws__.Alloc<DataType>(__apack__ + (__shared__ ? 0 : __bpack__));
+    const index_t mblocks = (M + __blk__.m_MC - 1) / __blk__.m_MC;
+    const index_t nblocks = (N + __blk__.m_NC - 1) / __blk__.m_NC;
+    for (index_t b = 0; b < Bt; ++b) {
+      GemmPack<!LeftTransposed>(__pa__, lhs.m_data + size_t(b) * lhs.m_step, lhs.m_ld, M, MR, K,
+                                __blk__.m_KC, scale);
+      const DataType* __b__ = __pb__;
+      if (!__shared__) {
+        GemmPack<RightTransposed>(__pa__ + __apack__, rhs.m_data + size_t(b) * rhs.m_step,
+                                  rhs.m_ld, N, NR, K, __blk__.m_KC, DataType(1));
+        __b__ = __pa__ + __apack__;
+      }
+#ifndef __CUDACC__
+#pragma omp parallel for schedule(dynamic)
+#endif
+      for (openmp_index_t t = 0; t < mblocks * nblocks; ++t) {
+        const index_t i0 = (t / nblocks) * __blk__.m_MC, j0 = (t % nblocks) * __blk__.m_NC;
+        const index_t mc = M - i0 < __blk__.m_MC ? M - i0 : __blk__.m_MC;
+        const index_t nc = N - j0 < __blk__.m_NC ? N - j0 : __blk__.m_NC;
+        GemmArchKernel<Arch>::template Block<Kern, First, Rest>(dst.__data_ptr + b * __dstep__,
+                                                                ldc, __pa__, __b__, mpad, npad,
+                                                                i0, mc, j0, nc, K, __blk__.m_KC,
+                                                                epi);
+      }
+    }
+  }
+}
+
+/*!
+ *@brief    The batch gemm, on the arch of the build or the one picked by cpuid.
+ */
+template<typename Saver, bool LeftTransposed, bool RightTransposed, typename OP,
+         typename DataType>
+MGLORIA_INLINE_NORMAL void DispatchBatchDot(Tensor<CPU, 3, DataType> dst,
+                                            const BatchOperand<DataType>& lhs,
+                                            const BatchOperand<DataType>& rhs, DataType scale,
+                                            const GemmEpilogue<OP, DataType>& epi) {
+#if MGLORIA_RUNTIME_DISPATCH == 1
+  using vectorization::VecArch;
+  switch (vectorization::RuntimeVecArch()) {
+    case VecArch::AVX512_Arch: {
+      ExecuteBatchDot<Saver, VecArch::AVX512_Arch, LeftTransposed, RightTransposed>(dst, lhs, rhs,
+                                                                                    scale, epi);
+      break;
+    }
+    case VecArch::AVX2_Arch: {
+      ExecuteBatchDot<Saver, VecArch::AVX2_Arch, LeftTransposed, RightTransposed>(dst, lhs, rhs,
+                                                                                  scale, epi);
+      break;
+    }
+#if MGLORIA_USE_SSE == 1
+    case VecArch::SSE_Arch: {
+      ExecuteBatchDot<Saver, VecArch::SSE_Arch, LeftTransposed, RightTransposed>(dst, lhs, rhs,
+                                                                                 scale, epi);
+      break;
+    }
+#endif  // MGLORIA_USE_SSE == 1
+    default: {
+      ExecuteBatchDot<Saver, VecArch::NONE_Arch, LeftTransposed, RightTransposed>(dst, lhs, rhs,
+                                                                                  scale, epi);
+      break;
+    }
+  }
+#else
+  ExecuteBatchDot<Saver, MGLORIA_VECTORIZATION_ARCH, LeftTransposed, RightTransposed>(
+      dst, lhs, rhs, scale, epi);
+#endif  // MGLORIA_RUNTIME_DISPATCH == 1
+}
+
+/*!
+ *@brief    The DotEngine of batch_dot on CPU tensors, rhs of RightDims 3 or 2 (broadcast). It is
+ * always the native gemm.
+ */
+template<typename Saver, int RightDims, bool LeftTransposed, bool RightTransposed,
+         typename DataType>
+struct DotEngine<Saver, CPU, 3, 3, RightDims, LeftTransposed, RightTransposed, DataType> {
+  MGLORIA_INLINE_NORMAL static void Eval(Tensor<CPU, 3, DataType>* p_dst,
+                                         const Tensor<CPU, 3, DataType>& lhs,
+                                         const Tensor<CPU, RightDims, DataType>& rhs,
+                                         DataType scale) {
+    DispatchBatchDot<Saver, LeftTransposed, RightTransposed>(
+        *p_dst, MakeBatchOperand(lhs), MakeBatchOperand(rhs), scale,
+        GemmEpilogue<op::_identity, DataType>{nullptr, 1});
+  }
+
+  template<typename OP>
+  MGLORIA_INLINE_NORMAL static void Eval(Tensor<CPU, 3, DataType>* p_dst,
+                                         const Tensor<CPU, 3, DataType>& lhs,
+                                         const Tensor<CPU, RightDims, DataType>& rhs,
+                                         DataType scale, const GemmEpilogue<OP, DataType>& epi) {
+    DispatchBatchDot<Saver, LeftTransposed, RightTransposed>(
+        *p_dst, MakeBatchOperand(lhs), MakeBatchOperand(rhs), scale, epi);
+  }
+};
+
+/*!
+ *@brief    The dispatcher of batch_dot on CPU tensors. A bias is the one of each gemm, the same
+ * for the whole batch.
+ */
+template<typename Saver, int RightDims, bool LeftTransposed, bool RightTransposed,
+         typename DataType, typename EpilogueOP>
+struct ExpressionComplexDispatcher<
+    Saver, Tensor<CPU, 3, DataType>,
+    DotExpr<Tensor<CPU, 3, DataType>, Tensor<CPU, RightDims, DataType>, LeftTransposed,
+            RightTransposed, DataType, EpilogueOP>,
+    DataType> {
+  typedef DotExpr<Tensor<CPU, 3, DataType>, Tensor<CPU, RightDims, DataType>, LeftTransposed,
+                  RightTransposed, DataType, EpilogueOP>
+      E;
+  typedef DotEngine<Saver, CPU, 3, 3, RightDims, LeftTransposed, RightTransposed, DataType>
+      Engine;
+
+  MGLORIA_INLINE_NORMAL static void Eval(Tensor<CPU, 3, DataType>* dst,
+                                         const Expression<E, DataType, Complex_t>& exp) {
+    const E& e = exp.Self();
+    const GemmEpilogue<EpilogueOP, DataType> __epi__ = {e.m_bias, e.m_bias_axis};
+    if (!__epi__.Enabled()) {
+      Engine::Eval(dst, e.m_a, e.m_b, e.m_scale);
+      return;
+    }
+    if (e.m_bias != nullptr) {
+      CHECK_EQUAL(e.m_bias_size, dst->size(e.m_bias_axis + 1), " batch_dot: the bias of axis ",
+                  e.m_bias_axis, " Shape_Dst=", dst->m_Shape.str());
+    }
+    Engine::Eval(dst, e.m_a, e.m_b, e.m_scale, __epi__);
+  }
+};
+
+}  // namespace expr
+}  // namespace mgloria
+
+#endif  // _MGLORIA___OP_BATCH_DOT_CPU_HPP_
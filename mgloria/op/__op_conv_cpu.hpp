@@ -0,0 +1,476 @@
+/*!
+ *@author chenghua.wang
+ *@file   op/__op_conv_cpu.hpp
+ *@brief  The conv2d of CPU tensors, as an implicit gemm. See Conv2dExpr.
+ *@details For an image b and a group g the convolution is a gemm over K = Cin / groups x KH x KW,
+ * the window of the input one output pixel reads. The matrix of all the windows, the im2col, is
+ * never made: its panels are gathered from the input right before the micro kernel uses them,
+ * into a buffer of the task, with the padding read as 0. The weight is packed once, as an operand
+ * of op/__op_dot_cpu.hpp, and the micro kernel and the blocking are the ones of the dot.
+ *
+ *  BHWC: dst[b] [OH x OW, Cout / g] = windows [OH x OW, K] x weight[g]^T. The task packs the
+ *        MC x KC block of the windows as A panels, a window is read along the channels.
+ *  BCHW: dst[b] [Cout / g, OH x OW] = weight[g] [Cout / g, K] x windows^T. The task packs the
+ *        KC x NR panel of the windows as the B panel, its rows are read along the width.
+ *
+ * The tasks are the MC x NC blocks of the gemms of all the images and groups, they run in
+ * parallel with OpenMP.
+ */
+
+#ifndef _MGLORIA___OP_CONV_CPU_HPP_
+#define _MGLORIA___OP_CONV_CPU_HPP_
+
+#pragma once
+
+#include "__op_dot_cpu.hpp"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace mgloria {
+namespace expr {
+
+/*!
+ *@brief    The sizes of a conv2d, see Conv2dShape. G groups of Cg input and Cog output channels.
+ */
+struct ConvGeometry {
+  index_t m_B, m_C, m_H, m_W;
+  index_t m_Cout, m_KH, m_KW, m_OH, m_OW;
+  index_t m_G, m_Cg, m_Cog, m_K;
+  index_t m_SH, m_SW, m_PH, m_PW, m_DH, m_DW;
+};
+
+template<LayoutTypeType Layout>
+MGLORIA_INLINE_NORMAL ConvGeometry ConvMakeGeometry(const Shape<4>& input, const Shape<4>& weight,
+                                                    const Conv2dParam& param) {
+  const bool __hwc__ = Layout == LayoutTypeType::BHWC;
+  const Shape<4> __out__ = Conv2dShape(input, weight, param, Layout);
+  ConvGeometry g;
+  g.m_B = input[0];
+  g.m_C = __hwc__ ? input[3] : input[1];
+  g.m_H = __hwc__ ? input[1] : input[2];
+  g.m_W = __hwc__ ? input[2] : input[3];
+  g.m_Cout = weight[0];
+  g.m_KH = __hwc__ ? weight[1] : weight[2];
+  g.m_KW = __hwc__ ? weight[2] : weight[3];
+  g.m_OH = __hwc__ ? __out__[1] : __out__[2];
+  g.m_OW = __hwc__ ? __out__[2] : __out__[3];
+  g.m_G = param.m_groups;
+  g.m_Cg = __hwc__ ? weight[3] : weight[1];
+  g.m_Cog = g.m_G > 0 ? g.m_Cout / g.m_G : 0;
+  g.m_K = g.m_Cg * g.m_KH * g.m_KW;
+  g.m_SH = param.m_stride_h;
+  g.m_SW = param.m_stride_w;
+  g.m_PH = param.m_pad_h;
+  g.m_PW = param.m_pad_w;
+  g.m_DH = param.m_dilation_h;
+  g.m_DW = param.m_dilation_w;
+  return g;
+}
+
+/*!
+ *@brief    The windows of one image and group as a [OH x OW, K] matrix. Pack gathers its rows
+ * [p0, p0 + pn) of K [k0, k0 + kc) as GemmPackPanel does: (p, k) to dst[k * R + p - p0], the rows
+ * from pn to R are 0. m_src is the first channel of the group in the image, m_ld the stride of
+ * the last dim of the input.
+ */
+template<LayoutTypeType Layout, typename DataType>
+struct ConvWindows;
+
+///! k is (kh, kw, c). The c of a window are next to each other in the input.
+template<typename DataType>
+struct ConvWindows<LayoutTypeType::BHWC, DataType> {
+  MGLORIA_INLINE_CPU void Pack(DataType* dst, index_t p0, index_t pn, index_t R, index_t k0,
+                               index_t kc) const {
+    const ConvGeometry& g = m_geo;
+    for (index_t r = 0; r < pn; ++r) {
+      const index_t oh = (p0 + r) / g.m_OW, ow = (p0 + r) % g.m_OW;
+      index_t kh = k0 / (g.m_KW * g.m_Cg), kw = k0 / g.m_Cg % g.m_KW, c = k0 % g.m_Cg;
+      for (index_t t = 0; t < kc;) {
+        const index_t run = g.m_Cg - c < kc - t ? g.m_Cg - c : kc - t;
+        const index_t ih = oh * g.m_SH - g.m_PH + kh * g.m_DH;
+        const index_t iw = ow * g.m_SW - g.m_PW + kw * g.m_DW;
+        DataType* __d__ = dst + t * R + r;
+        if (ih >= 0 && ih < g.m_H && iw >= 0 && iw < g.m_W) {
+          const DataType* __s__ = m_src + (ih * g.m_W + iw) * m_ld + c;
+          for (index_t q = 0; q < run; ++q) { __d__[q * R] = __s__[q]; }
+        } else {
+          for (index_t q = 0; q < run; ++q) { __d__[q * R] = DataType(0); }
+        }
+        t += run;
+        c = 0;
+        if (++kw == g.m_KW) {
+          kw = 0;
+          ++kh;
+        }
+      }
+    }
+    for (index_t r = pn; r < R; ++r) {
+      for (index_t t = 0; t < kc; ++t) { dst[t * R + r] = DataType(0); }
+    }
+  }
+
+  const DataType* m_src;
+  index_t m_ld;
+  ConvGeometry m_geo;
+};
+
+///! k is (c, kh, kw). The pixels of a row of the panel are cut in runs of one output row, a run
+///! reads one row of the input, every m_SW-th element from where it starts.
+template<typename DataType>
+struct ConvWindows<LayoutTypeType::BCHW, DataType> {
+  static const index_t ms_MaxR = 64;
+
+  MGLORIA_INLINE_CPU void Pack(DataType* dst, index_t p0, index_t pn, index_t R, index_t k0,
+                               index_t kc) const {
+    const ConvGeometry& g = m_geo;
+    // The first pixel of each run, its output row and column, the last is pn.
+    index_t __r__[ms_MaxR + 1], __oh__[ms_MaxR], __ow__[ms_MaxR];
+    index_t runs = 0;
+    for (index_t r = 0; r < pn; ++runs) {
+      __r__[runs] = r;
+      __oh__[runs] = (p0 + r) / g.m_OW;
+      __ow__[runs] = (p0 + r) % g.m_OW;
+      r += g.m_OW - __ow__[runs] < pn - r ? g.m_OW - __ow__[runs] : pn - r;
+    }
+    __r__[runs] = pn;
+    index_t c = k0 / (g.m_KH * g.m_KW), kh = k0 / g.m_KW % g.m_KH, kw = k0 % g.m_KW;
+    for (index_t t = 0; t < kc; ++t) {
+      const DataType* __plane__ = m_src + c * g.m_H * m_ld;
+      DataType* __d__ = dst + t * R;
+      for (index_t u = 0; u < runs; ++u) {
+        DataType* __run__ = __d__ + __r__[u];
+        const index_t n = __r__[u + 1] - __r__[u];
+        const index_t ih = __oh__[u] * g.m_SH - g.m_PH + kh * g.m_DH;
+        const index_t iw = __ow__[u] * g.m_SW - g.m_PW + kw * g.m_DW;
+        if (ih < 0 || ih >= g.m_H) {
+          for (index_t q = 0; q < n; ++q) { __run__[q] = DataType(0); }
+          continue;
+        }
+        // [lo, hi) of the run is in the input, the rest is the pad.
+        const DataType* __s__ = __plane__ + ih * m_ld + iw;
+        index_t lo, hi;
+        if (g.m_SW == 1) {
+          lo = iw < 0 ? -iw : 0;
+          hi = g.m_W - iw;
+        } else {
+          lo = iw < 0 ? (-iw + g.m_SW - 1) / g.m_SW : 0;
+          hi = iw < g.m_W ? (g.m_W - iw + g.m_SW - 1) / g.m_SW : 0;
+        }
+        lo = lo < n ? lo : n;
+        hi = hi < n ? (hi < lo ? lo : hi) : n;
+        for (index_t q = 0; q < lo; ++q) { __run__[q] = DataType(0); }
+        if (g.m_SW == 1) {
+          for (index_t q = lo; q < hi; ++q) { __run__[q] = __s__[q]; }
+        } else {
+          for (index_t q = lo; q < hi; ++q) { __run__[q] = __s__[q * g.m_SW]; }
+        }
+        for (index_t q = hi; q < n; ++q) { __run__[q] = DataType(0); }
+      }
+      for (index_t r = pn; r < R; ++r) { __d__[r] = DataType(0); }
+      if (++kw == g.m_KW) {
+        kw = 0;
+        if (++kh == g.m_KH) {
+          kh = 0;
+          ++c;
+        }
+      }
+    }
+  }
+
+  const DataType* m_src;
+  index_t m_ld;
+  ConvGeometry m_geo;
+};
+
+/*!
+ *@brief    Pack the weight of all the groups as GemmPack packs one operand, the Cog rows of group
+ * g at dst + g * padded * K. A row of the weight is K long, in rows of L, its last dim, and ld
+ * is the stride of them.
+ */
+template<typename DataType>
+MGLORIA_INLINE_NORMAL void ConvPackWeight(DataType* dst, const DataType* w, index_t ld, index_t L,
+                                          index_t G, index_t Cog, index_t R, index_t K,
+                                          index_t KC) {
+  const index_t npanel = (Cog + R - 1) / R, nkb = (K + KC - 1) / KC;
+  const index_t padded = npanel * R;
+#ifndef __CUDACC__
+#pragma omp parallel for
+#endif
+  for (openmp_index_t t = 0; t < G * npanel * nkb; ++t) {
+    const index_t g = t / (npanel * nkb), r0 = (t % npanel) * R, k0 = (t / npanel % nkb) * KC;
+    const index_t rn = Cog - r0 < R ? Cog - r0 : R, kc = K - k0 < KC ? K - k0 : KC;
+    if (ld == L) {
+      GemmPackPanel<true>(dst + g * padded * K + k0 * padded + r0 * kc, w + g * Cog * K, K, r0,
+                          rn, R, k0, kc, DataType(1));
+      continue;
+    }
+    DataType* __d__ = dst + g * padded * K + k0 * padded + r0 * kc;
+    for (index_t r = 0; r < rn; ++r) {
+      const index_t o = g * Cog + r0 + r;
+      for (index_t k = 0; k < kc; ++k) {
+        __d__[k * R + r] = w[(o * (K / L) + (k0 + k) / L) * ld + (k0 + k) % L];
+      }
+    }
+    for (index_t r = rn; r < R; ++r) {
+      for (index_t k = 0; k < kc; ++k) { __d__[k * R + r] = DataType(0); }
+    }
+  }
+}
+
+/*!
+ *@brief    The MC x NC block at (i0, j0) of the gemm of one image and group, over all of K. pw is
+ * the packed weight of the group, with wpad rows. buf is the buffer of the task for the windows,
+ * MC x KC if they are the lhs (WindowsLeft, BHWC), else KC x NR.
+ */
+template<typename Kern, typename First, typename Rest, bool WindowsLeft, typename Windows,
+         typename DataType>
+MGLORIA_INLINE_CPU void ConvGemmBlock(DataType* c, index_t ldc, const DataType* pw, index_t wpad,
+                                      const Windows& win, DataType* buf, index_t i0, index_t mc,
+                                      index_t j0, index_t nc, index_t K, index_t KC) {
+  const index_t MR = Kern::m_MR, NR = Kern::m_NR;
+  for (index_t k0 = 0; k0 < K; k0 += KC) {
+    const index_t kc = K - k0 < KC ? K - k0 : KC;
+    if (WindowsLeft) {
+      for (index_t ir = 0; ir < mc; ir += MR) {
+        win.Pack(buf + ir * kc, i0 + ir, mc - ir < MR ? mc - ir : MR, MR, k0, kc);
+      }
+    }
+    const DataType* __w__ = pw + k0 * wpad + (WindowsLeft ? j0 : i0) * kc;
+    for (index_t jr = 0; jr < nc; jr += NR) {
+      const index_t nr = nc - jr < NR ? nc - jr : NR;
+      if (!WindowsLeft) { win.Pack(buf, j0 + jr, nr, NR, k0, kc); }
+      const DataType* __b__ = WindowsLeft ? __w__ + jr * kc : buf;
+      for (index_t ir = 0; ir < mc; ir += MR) {
+        const index_t mr = mc - ir < MR ? mc - ir : MR;
+        const DataType* __a__ = WindowsLeft ? buf + ir * kc : __w__ + ir * kc;
+        DataType* __c__ = c + (i0 + ir) * ldc + j0 + jr;
+        if (k0 == 0) {
+          Kern::template Tile<First>(kc, __a__, __b__, __c__, ldc, mr, nr);
+        } else {
+          Kern::template Tile<Rest>(kc, __a__, __b__, __c__, ldc, mr, nr);
+        }
+      }
+    }
+  }
+}
+
+/*!
+ *@brief    The roots of the conv2d kernel, compiled for Arch. See GemmArchKernel.
+ */
+template<vectorization::VecArch Arch>
+struct ConvArchKernel {
+  template<typename Kern, typename First, typename Rest, bool WindowsLeft, typename Windows,
+           typename DataType>
+  MGLORIA_INLINE_CPU static void Block(DataType* c, index_t ldc, const DataType* pw, index_t wpad,
+                                       const Windows& win, DataType* buf, index_t i0, index_t mc,
+                                       index_t j0, index_t nc, index_t K, index_t KC) {
+    ConvGemmBlock<Kern, First, Rest, WindowsLeft>(c, ldc, pw, wpad, win, buf, i0, mc, j0, nc, K,
+                                                  KC);
+  }
+};
+
+template<>
+struct ConvArchKernel<vectorization::VecArch::AVX2_Arch> {
+  template<typename Kern, typename First, typename Rest, bool WindowsLeft, typename Windows,
+           typename DataType>
+  MGLORIA_KERNEL_AVX2 static void Block(DataType* c, index_t ldc, const DataType* pw, index_t wpad,
+                                        const Windows& win, DataType* buf, index_t i0, index_t mc,
+                                        index_t j0, index_t nc, index_t K, index_t KC) {
+    ConvGemmBlock<Kern, First, Rest, WindowsLeft>(c, ldc, pw, wpad, win, buf, i0, mc, j0, nc, K,
+                                                  KC);
+  }
+};
+
+template<>
+struct ConvArchKernel<vectorization::VecArch::AVX512_Arch> {
+  template<typename Kern, typename First, typename Rest, bool WindowsLeft, typename Windows,
+           typename DataType>
+  MGLORIA_KERNEL_AVX512 static void Block(DataType* c, index_t ldc, const DataType* pw,
+                                          index_t wpad, const Windows& win, DataType* buf,
+                                          index_t i0, index_t mc, index_t j0, index_t nc,
+                                          index_t K, index_t KC) {
+    ConvGemmBlock<Kern, First, Rest, WindowsLeft>(c, ldc, pw, wpad, win, buf, i0, mc, j0, nc, K,
+                                                  KC);
+  }
+};
+
+/*!
+ *@brief    dst Saver src element by element, or Saver 0 if src is nullptr. Both have the shape of
+ * dst, src has no pad.
+ */
+template<typename Saver, typename DataType>
+MGLORIA_INLINE_NORMAL void ConvApply(Tensor<CPU, 4, DataType> dst, const DataType* src) {
+  const index_t rows = dst.size(0) * dst.size(1) * dst.size(2), cols = dst.size(3);
+#ifndef __CUDACC__
+#pragma omp parallel for
+#endif
+  for (openmp_index_t i = 0; i < rows; ++i) {
+    for (index_t j = 0; j < cols; ++j) {
+      Saver::template Do<DataType>(dst.__data_ptr[i * dst.m_Stride_ + j],
+                                   src != nullptr ? src[i * cols + j] : DataType(0));
+    }
+  }
+}
+
+/*!
+ *@brief    The Winograd path of the 3x3 stride 1 conv2d, in op/__op_winograd_cpu.hpp. Returns
+ * false if it does not take this one.
+ */
+template<typename Saver, vectorization::VecArch Arch, LayoutTypeType Layout, typename DataType>
+MGLORIA_INLINE_NORMAL bool ExecuteWinogradConv2d(Tensor<CPU, 4, DataType> dst,
+                                                 const Tensor<CPU, 4, DataType>& input,
+                                                 const Tensor<CPU, 4, DataType>& weight,
+                                                 const ConvGeometry& g);
+
+/*!
+ *@brief    Check the shapes, then take the Winograd path or pack the weight and run the blocks
+ * with Arch.
+ */
+template<typename Saver, vectorization::VecArch Arch, LayoutTypeType Layout, typename DataType>
+MGLORIA_INLINE_NORMAL void ExecuteConv2d(Tensor<CPU, 4, DataType> dst,
+                                         const Tensor<CPU, 4, DataType>& input,
+                                         const Tensor<CPU, 4, DataType>& weight,
+                                         const Conv2dParam& param) {
+  typedef GemmKernel<DataType, Arch, GemmVecCheck<DataType, Arch>::m_Enable> Kern;
+  static const bool WindowsLeft = Layout == LayoutTypeType::BHWC;
+  static_assert(Kern::m_NR <= ConvWindows<LayoutTypeType::BCHW, DataType>::ms_MaxR,
+                "conv2d: the panel is wider than the windows can be packed for.");
+  LOG_CHECK(param.m_stride_h > 0 && param.m_stride_w > 0 && param.m_dilation_h > 0
+                && param.m_dilation_w > 0 && param.m_pad_h >= 0 && param.m_pad_w >= 0,
+            " conv2d: stride=(", param.m_stride_h, ", ", param.m_stride_w, ") pad=(",
+            param.m_pad_h, ", ", param.m_pad_w, ") dilation=(", param.m_dilation_h, ", ",
+            param.m_dilation_w, ")");
+  const ConvGeometry geo = ConvMakeGeometry<Layout>(input.m_Shape, weight.m_Shape, param);
+  LOG_CHECK(geo.m_G > 0 && geo.m_C % geo.m_G == 0 && geo.m_Cout % geo.m_G == 0
+                && geo.m_Cg * geo.m_G == geo.m_C,
+            " conv2d: Shape_Input=", input.m_Shape.str(), " Shape_Weight=", weight.m_Shape.str(),
+            " groups=", geo.m_G);
+  LOG_CHECK(dst.m_Shape == Conv2dShape(input.m_Shape, weight.m_Shape, param, Layout),
+            " conv2d: Shape_Dst=", dst.m_Shape.str(), " Shape_Input=", input.m_Shape.str(),
+            " Shape_Weight=", weight.m_Shape.str());
+  const index_t P = geo.m_OH * geo.m_OW, K = geo.m_K;
+  if (dst.m_Shape.Size() == 0) { return; }
+  if (K == 0) {
+    ConvApply<Saver>(dst, static_cast<const DataType*>(nullptr));
+    return;
+  }
+  if (ExecuteWinogradConv2d<Saver, Arch, Layout>(dst, input, weight, geo)) { return; }
+
+  const index_t M = WindowsLeft ? P : geo.m_Cog, N = WindowsLeft ? geo.m_Cog : P;
+  GemmBlocking __blk__ = GemmDefaultBlocking<Kern, DataType>(M, N);
+  const index_t __mall__ = (M + Kern::m_MR - 1) / Kern::m_MR * Kern::m_MR;
+  if (!WindowsLeft && __mall__ * __blk__.m_KC * sizeof(DataType) <= MGLORIA_GEMM_L2_BYTES) {
+    // A B panel of the windows costs more than one of a dot, it is gathered once for all the
+    // rows of the weight when they fit in L2. The columns are then cut for the threads.
+    __blk__.m_MC = __mall__;
+#ifdef _OPENMP
+    const index_t want = 2 * omp_get_max_threads(), imgs = geo.m_B * geo.m_G;
+    if (imgs * ((N + __blk__.m_NC - 1) / __blk__.m_NC) < want) {
+      const index_t nblocks = (want + imgs - 1) / imgs, NR = Kern::m_NR;
+      const index_t nc = ((N + nblocks - 1) / nblocks + NR - 1) / NR * NR;
+      __blk__.m_NC = nc < __blk__.m_NC ? (nc < NR ? NR : nc) : __blk__.m_NC;
+    }
+#endif
+  }
+  WorkspaceScope __ws__(dst.m_Stream);
+  // The gemm writes the pixels of a channel as one row of dst in BCHW, so that has no pad.
+  if ((!GemmSaver<Saver>::m_Split && K > __blk__.m_KC)
+      || (!WindowsLeft && dst.m_Stride_ != geo.m_OW)) {
+    DataType* __buf__ = __ws__.Alloc<DataType>(dst.m_Shape.Size());
+    Tensor<CPU, 4, DataType> __tmp__(__buf__, dst.m_Shape, dst.size(3), dst.m_Stream);
+    ExecuteConv2d<op::_saveto, Arch, Layout>(__tmp__, input, weight, param);
+    ConvApply<Saver>(dst, static_cast<const DataType*>(__buf__));
+    return;
+  }
+
+  const index_t MR = Kern::m_MR, NR = Kern::m_NR, R = WindowsLeft ? NR : MR;
+  const index_t wpad = (geo.m_Cog + R - 1) / R * R;
+  DataType* __pw__ = __ws__.Alloc<DataType>(geo.m_G * wpad * K);
+  ConvPackWeight(__pw__, weight.__data_ptr, weight.m_Stride_, weight.size(3), geo.m_G, geo.m_Cog,
+                 R, K, __blk__.m_KC);
+
+  index_t __threads__ = 1;
+#ifdef _OPENMP
+  __threads__ = omp_get_max_threads();
+#endif
+  const index_t __bufsize__ = (WindowsLeft ? __blk__.m_MC : NR) * __blk__.m_KC;
+  DataType* __bufs__ = __ws__.Alloc<DataType>(__bufsize__ * __threads__);
+
+  const index_t mblocks = (M + __blk__.m_MC - 1) / __blk__.m_MC;
+  const index_t nblocks = (N + __blk__.m_NC - 1) / __blk__.m_NC;
+  const index_t ldc = WindowsLeft ? dst.m_Stride_ : P;
+#ifndef __CUDACC__
+#pragma omp parallel for schedule(dynamic)
+#endif
+  for (openmp_index_t t = 0; t < geo.m_B * geo.m_G * mblocks * nblocks; ++t) {
+    const index_t img = t / (mblocks * nblocks), blk = t % (mblocks * nblocks);
+    const index_t b = img / geo.m_G, g = img % geo.m_G;
+    const index_t i0 = (blk / nblocks) * __blk__.m_MC, j0 = (blk % nblocks) * __blk__.m_NC;
+    const index_t mc = M - i0 < __blk__.m_MC ? M - i0 : __blk__.m_MC;
+    const index_t nc = N - j0 < __blk__.m_NC ? N - j0 : __blk__.m_NC;
+    index_t __id__ = 0;
+#ifdef _OPENMP
+    __id__ = omp_get_thread_num();
+#endif
+    const DataType* __src__ =
+        WindowsLeft ? input.__data_ptr + b * geo.m_H * geo.m_W * input.m_Stride_ + g * geo.m_Cg
+                    : input.__data_ptr + (b * geo.m_C + g * geo.m_Cg) * geo.m_H * input.m_Stride_;
+    DataType* __c__ = WindowsLeft ? dst.__data_ptr + b * P * ldc + g * geo.m_Cog
+                                  : dst.__data_ptr + (b * geo.m_Cout + g * geo.m_Cog) * P;
+    const ConvWindows<Layout, DataType> __win__ = {__src__, input.m_Stride_, geo};
+    ConvArchKernel<Arch>::template Block<Kern, typename GemmSaver<Saver>::First,
+                                         typename GemmSaver<Saver>::Rest, WindowsLeft>(
+        __c__, ldc, __pw__ + g * wpad * K, wpad, __win__, __bufs__ + __id__ * __bufsize__, i0,
+        mc, j0, nc, K, __blk__.m_KC);
+  }
+}
+
+/*!
+ *@brief    The dispatcher of Conv2dExpr on CPU tensors.
+ */
+template<typename Saver, LayoutTypeType Layout, typename DataType>
+struct ExpressionComplexDispatcher<
+    Saver, Tensor<CPU, 4, DataType>,
+    Conv2dExpr<Tensor<CPU, 4, DataType>, Tensor<CPU, 4, DataType>, Layout, DataType>, DataType> {
+  typedef Conv2dExpr<Tensor<CPU, 4, DataType>, Tensor<CPU, 4, DataType>, Layout, DataType> E;
+
+  MGLORIA_INLINE_NORMAL static void Eval(Tensor<CPU, 4, DataType>* dst,
+                                         const Expression<E, DataType, Complex_t>& exp) {
+    const E& e = exp.Self();
+#if MGLORIA_RUNTIME_DISPATCH == 1
+    using vectorization::VecArch;
+    switch (vectorization::RuntimeVecArch()) {
+      case VecArch::AVX512_Arch: {
+        ExecuteConv2d<Saver, VecArch::AVX512_Arch, Layout>(*dst, e.m_input, e.m_weight,
+                                                           e.m_param);
+        break;
+      }
+      case VecArch::AVX2_Arch: {
+        ExecuteConv2d<Saver, VecArch::AVX2_Arch, Layout>(*dst, e.m_input, e.m_weight, e.m_param);
+        break;
+      }
+#if MGLORIA_USE_SSE == 1
+      case VecArch::SSE_Arch: {
+        ExecuteConv2d<Saver, VecArch::SSE_Arch, Layout>(*dst, e.m_input, e.m_weight, e.m_param);
+        break;
+      }
+#endif  // MGLORIA_USE_SSE == 1
+      default: {
+        ExecuteConv2d<Saver, VecArch::NONE_Arch, Layout>(*dst, e.m_input, e.m_weight, e.m_param);
+        break;
+      }
+    }
+#else
+    ExecuteConv2d<Saver, MGLORIA_VECTORIZATION_ARCH, Layout>(*dst, e.m_input, e.m_weight,
+                                                             e.m_param);
+#endif  // MGLORIA_RUNTIME_DISPATCH == 1
+  }
+};
+
+}  // namespace expr
+}  // namespace mgloria
+
+#include "__op_winograd_cpu.hpp"
+
+#endif  // _MGLORIA___OP_CONV_CPU_HPP_
@@ -0,0 +1,136 @@
+/*!
+ *@author chenghua.wang
+ *@file   op/__op_dot_blas.hpp
+ *@brief  The DotEngine of CPU tensors on cblas_sgemm and cblas_dgemm.
+ *@details Used instead of the native gemm when MGLORIA_DOT_USE_BLAS is 1. The tensors are passed
+ * to the blas as they are: the transposes become CblasTrans, the pitched m_Stride_ is the leading
+ * dimension, so a padded tensor or a slice is not copied. scale is alpha, and the Saver is beta:
+ *
+ *     _saveto   dst =  scale * op(lhs) * op(rhs)          alpha =  scale, beta = 0
+ *     _plusto   dst += scale * op(lhs) * op(rhs)          alpha =  scale, beta = 1
+ *     _minusto  dst -= scale * op(lhs) * op(rhs)          alpha = -scale, beta = 1
+ *
+ * The other Savers and the types other than float and double are left to the native gemm.
+ */
+
+#ifndef _MGLORIA___OP_DOT_BLAS_HPP_
+#define _MGLORIA___OP_DOT_BLAS_HPP_
+
+#pragma once
+
+#include "../complex_eval.hpp"
+#include <climits>
+
+namespace mgloria {
+namespace expr {
+
+/*!
+ *@brief    The gemm of the blas for DataType, row major.
+ */
+template<typename DataType>
+struct BlasGemm {
+  static const bool m_Enable = false;
+};
+
+template<>
+struct BlasGemm<float> {
+  static const bool m_Enable = true;
+  MGLORIA_INLINE_NORMAL static void Gemm(bool trans_a, bool trans_b, int m, int n, int k,
+                                         float alpha, const float* a, int lda, const float* b,
+                                         int ldb, float beta, float* c, int ldc) {
+    cblas_sgemm(CblasRowMajor, trans_a ? CblasTrans : CblasNoTrans,
+                trans_b ? CblasTrans : CblasNoTrans, m, n, k, alpha, a, lda, b, ldb, beta, c, ldc);
+  }
+};
+
+template<>
+struct BlasGemm<double> {
+  static const bool m_Enable = true;
+  MGLORIA_INLINE_NORMAL static void Gemm(bool trans_a, bool trans_b, int m, int n, int k,
+                                         double alpha, const double* a, int lda, const double* b,
+                                         int ldb, double beta, double* c, int ldc) {
+    cblas_dgemm(CblasRowMajor, trans_a ? CblasTrans : CblasNoTrans,
+                trans_b ? CblasTrans : CblasNoTrans, m, n, k, alpha, a, lda, b, ldb, beta, c, ldc);
+  }
+};
+
+/*!
+ *@brief    The sign of alpha and the beta a Saver maps to.
+ */
+template<typename Saver>
+struct BlasSaver {
+  static const bool m_Enable = false;
+};
+
+template<>
+struct BlasSaver<op::_saveto> {
+  static const bool m_Enable = true;
+  static const int m_Sign = 1;
+  static const int m_Beta = 0;
+};
+
+template<>
+struct BlasSaver<op::_plusto> {
+  static const bool m_Enable = true;
+  static const int m_Sign = 1;
+  static const int m_Beta = 1;
+};
+
+template<>
+struct BlasSaver<op::_minusto> {
+  static const bool m_Enable = true;
+  static const int m_Sign = -1;
+  static const int m_Beta = 1;
+};
+
+/*!
+ *@brief    Can dst Saver lhs x rhs of DataType run on the blas.
+ */
+template<typename Saver, typename DataType>
+struct BlasDotCheck {
+  static const bool m_Enable = BlasGemm<DataType>::m_Enable && BlasSaver<Saver>::m_Enable;
+};
+
+/*!
+ *@brief    The sizes and strides fit in the int of the cblas interface.
+ */
+template<typename DataType>
+MGLORIA_INLINE_NORMAL bool BlasDotFits(const Tensor<CPU, 2, DataType>& dst,
+                                       const Tensor<CPU, 2, DataType>& lhs,
+                                       const Tensor<CPU, 2, DataType>& rhs) {
+  const index_t __lim__ = static_cast<index_t>(INT_MAX);
+  return dst.size(0) <= __lim__ && dst.size(1) <= __lim__ && lhs.size(0) <= __lim__
+         && lhs.size(1) <= __lim__ && rhs.size(0) <= __lim__ && rhs.size(1) <= __lim__
+         && dst.m_Stride_ <= __lim__ && lhs.m_Stride_ <= __lim__ && rhs.m_Stride_ <= __lim__;
+}
+
+/*!
+ *@brief    dst Saver scale * op(lhs) * op(rhs) on the blas. Only for BlasDotCheck.
+ */
+template<typename Saver, bool LeftTransposed, bool RightTransposed, typename DataType>
+MGLORIA_INLINE_NORMAL void ExecuteBlasDot(Tensor<CPU, 2, DataType> dst,
+                                          const Tensor<CPU, 2, DataType>& lhs,
+                                          const Tensor<CPU, 2, DataType>& rhs, DataType scale) {
+  const index_t M = LeftTransposed ? lhs.size(1) : lhs.size(0);
+  const index_t K = LeftTransposed ? lhs.size(0) : lhs.size(1);
+  const index_t N = RightTransposed ? rhs.size(0) : rhs.size(1);
+  const index_t KR = RightTransposed ? rhs.size(1) : rhs.size(0);
+  LOG_CHECK(K == KR, " dot: Shape_Left=", lhs.m_Shape.str(), " Shape_Right=", rhs.m_Shape.str(),
+            " lhs_transposed=", LeftTransposed, " rhs_transposed=", RightTransposed);
+  LOG_CHECK(dst.size(0) == M && dst.size(1) == N, " dot: Shape_Dst=", dst.m_Shape.str(),
+            " M=", M, " N=", N);
+  if (M == 0 || N == 0) { return; }
+  // The blas asks lda >= 1 even if the side is empty.
+  const index_t __one__ = 1;
+  BlasGemm<DataType>::Gemm(
+      LeftTransposed, RightTransposed, static_cast<int>(M), static_cast<int>(N),
+      static_cast<int>(K), DataType(BlasSaver<Saver>::m_Sign) * scale, lhs.__data_ptr,
+      static_cast<int>(lhs.m_Stride_ > __one__ ? lhs.m_Stride_ : __one__), rhs.__data_ptr,
+      static_cast<int>(rhs.m_Stride_ > __one__ ? rhs.m_Stride_ : __one__),
+      DataType(BlasSaver<Saver>::m_Beta), dst.__data_ptr, static_cast<int>(dst.m_Stride_));
+}
+
+}  // namespace expr
+}  // namespace mgloria
+
+#endif  // _MGLORIA___OP_DOT_BLAS_HPP_
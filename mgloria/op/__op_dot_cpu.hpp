@@ -0,0 +1,700 @@
+/*!
+ *@author chenghua.wang
+ *@file   op/__op_dot_cpu.hpp
+ *@brief  The DotEngine of CPU tensors. A packed, cache blocked gemm.
+ *@details dst = scale * op(lhs) * op(rhs), op is the transpose or not. As [M, K] x [K, N].
+ *
+ * Both sides are packed first. op(lhs) into panels of MR rows, op(rhs) into panels of NR columns,
+ * each panel holds KC of K and is contiguous, the pad of the last panel is 0. Whatever the
+ * transposes and the strides are, the micro kernel only reads the packed panels in order.
+ *
+ * A task owns an MC x NC block of dst. For each KC of K it runs the micro kernel on every
+ * MR x NR tile of the block: the B panel (KC x NR) stays in L1 while the A panels of the block
+ * (MC x KC) are read from L2. The micro kernel keeps the MR x NR tile in vector registers, and
+ * applies it to dst through the Saver once per KC.
+ *
+ * The tasks run in parallel with OpenMP. Each element of dst is computed by one task, in the same
+ * order for any number of threads.
+ *
+ * MC, KC and NC are the tuned ones of the shape when there are, see op/__op_dot_tune_cpu.hpp.
+ *
+ * With MGLORIA_DOT_USE_BLAS the float and double dots run on the cblas instead, see
+ * op/__op_dot_blas.hpp.
+ */
+
+#ifndef _MGLORIA___OP_DOT_CPU_HPP_
+#define _MGLORIA___OP_DOT_CPU_HPP_
+
+#pragma once
+
+#include "../complex_eval.hpp"
+#include "../vectorization/veced_op.hpp"
+#include "__op_dot_tune_cpu.hpp"
+#if MGLORIA_DOT_USE_BLAS == 1
+#include "__op_dot_blas.hpp"
+#endif
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace mgloria {
+namespace expr {
+
+/*!
+ *@brief    Can the gemm of DataType use the vector micro kernel of Arch.
+ */
+template<typename DataType, vectorization::VecArch Arch>
+struct GemmVecCheck {
+  static const bool m_Enable = Arch != vectorization::VecArch::NONE_Arch
+                               && vectorization::VectorizedOP<op::_fma, DataType, Arch>::m_Enable;
+};
+
+/*!
+ *@brief    How a Saver is applied once per KC. The first KC uses First, the others Rest. A Saver
+ * that can not be split, as _multo, is only used directly when K fits in one KC.
+ */
+template<typename Saver>
+struct GemmSaver {
+  typedef Saver First;
+  typedef Saver Rest;
+  static const bool m_Split = false;
+};
+
+template<>
+struct GemmSaver<op::_saveto> {
+  typedef op::_saveto First;
+  typedef op::_plusto Rest;
+  static const bool m_Split = true;
+};
+
+template<>
+struct GemmSaver<op::_plusto> {
+  typedef op::_plusto First;
+  typedef op::_plusto Rest;
+  static const bool m_Split = true;
+};
+
+template<>
+struct GemmSaver<op::_minusto> {
+  typedef op::_minusto First;
+  typedef op::_minusto Rest;
+  static const bool m_Split = true;
+};
+
+/*!
+ *@brief    The epilogue of a gemm, dst Saver OP(acc + bias) where acc has the scale already. See
+ * DotExpr. It is run by the tile of the last KC, the tiles before only sum up acc.
+ */
+template<typename OP, typename DataType>
+struct GemmEpilogue {
+  const DataType* m_bias;
+  int m_axis;
+
+  ///! Is there anything to do besides acc. Without, the tiles are exactly the ones of a dot.
+  MGLORIA_INLINE_CPU bool Enabled() const {
+    return m_bias != nullptr || !std::is_same<OP, op::_identity>::value;
+  }
+};
+
+/*!
+ *@brief    Applies the epilogue to the mr x nr corner of a tile in memory, element by element.
+ */
+template<typename Saver, typename OP, bool Partial, typename DataType>
+MGLORIA_INLINE_CPU void GemmEpilogueSave(const DataType* tile, index_t ldt, DataType* c,
+                                         index_t ldc, index_t mr, index_t nr,
+                                         const DataType* brow, const DataType* bcol) {
+  for (index_t i = 0; i < mr; ++i) {
+    for (index_t j = 0; j < nr; ++j) {
+      DataType __v__ = tile[i * ldt + j];
+      if (bcol != nullptr) { __v__ += bcol[j]; }
+      if (brow != nullptr) { __v__ += brow[i]; }
+      if (Partial) { __v__ += c[i * ldc + j]; }
+      Saver::template Do<DataType>(c[i * ldc + j], OP::Do(__v__));
+    }
+  }
+}
+
+/*!
+ *@brief    The micro kernel. Tile computes the MR x NR tile of a (KC x MR) and b (KC x NR), and
+ * applies it to the mr x nr corner of c through Saver. The scale is in a, see GemmPack.
+ */
+template<typename DataType, vectorization::VecArch Arch, bool Vec>
+struct GemmKernel {
+  static const index_t m_MR = 4;
+  static const index_t m_NR = 4;
+
+  template<typename Saver>
+  MGLORIA_INLINE_CPU static void Tile(index_t kc, const DataType* a, const DataType* b,
+                                      DataType* c, index_t ldc, index_t mr, index_t nr) {
+    DataType __acc__[m_MR * m_NR] = {};
+    for (index_t k = 0; k < kc; ++k, a += m_MR, b += m_NR) {
+      for (index_t i = 0; i < m_MR; ++i) {
+        for (index_t j = 0; j < m_NR; ++j) { __acc__[i * m_NR + j] += a[i] * b[j]; }
+      }
+    }
+    for (index_t i = 0; i < mr; ++i) {
+      for (index_t j = 0; j < nr; ++j) {
+        Saver::template Do<DataType>(c[i * ldc + j], __acc__[i * m_NR + j]);
+      }
+    }
+  }
+
+  ///! The tile with the epilogue. brow is the bias of its first row, bcol of its first column,
+  ///! nullptr if none. If Partial, c holds the sum of the KC before, Saver is _saveto.
+  template<typename Saver, typename OP, bool Partial>
+  MGLORIA_INLINE_CPU static void TileEpilogue(index_t kc, const DataType* a, const DataType* b,
+                                              DataType* c, index_t ldc, index_t mr, index_t nr,
+                                              const DataType* brow, const DataType* bcol) {
+    DataType __acc__[m_MR * m_NR] = {};
+    for (index_t k = 0; k < kc; ++k, a += m_MR, b += m_NR) {
+      for (index_t i = 0; i < m_MR; ++i) {
+        for (index_t j = 0; j < m_NR; ++j) { __acc__[i * m_NR + j] += a[i] * b[j]; }
+      }
+    }
+    GemmEpilogueSave<Saver, OP, Partial>(__acc__, m_NR, c, ldc, mr, nr, brow, bcol);
+  }
+};
+
+/*!
+ *@brief    Rows of the MR x NR tile, two vectors each. One member per row, not an array, so that
+ * they are kept in registers after inlining without relying on the loops being unrolled.
+ */
+template<typename Vec, typename DataType, int Rows>
+struct GemmTileRows {
+  MGLORIA_INLINE_CPU void Zero() {
+    m_c0 = m_c1 = Vec::Fill(DataType(0));
+    m_next.Zero();
+  }
+  MGLORIA_INLINE_CPU void MulAdd(const DataType* a, Vec b0, Vec b1) {
+    const Vec __a__ = Vec::Fill(*a);
+    m_c0 = Vec::MulAdd(__a__, b0, m_c0);
+    m_c1 = Vec::MulAdd(__a__, b1, m_c1);
+    m_next.MulAdd(a + 1, b0, b1);
+  }
+  template<typename SaveOP>
+  MGLORIA_INLINE_CPU void Save(DataType* c, index_t ldc) const {
+    SaveOP::Do(Vec::LoadUnAligned(c), m_c0).StoreUnAligned(c);
+    SaveOP::Do(Vec::LoadUnAligned(c + Vec::num), m_c1).StoreUnAligned(c + Vec::num);
+    m_next.template Save<SaveOP>(c + ldc, ldc);
+  }
+  MGLORIA_INLINE_CPU void Store(DataType* tile) const {
+    m_c0.Store(tile);
+    m_c1.Store(tile + Vec::num);
+    m_next.Store(tile + 2 * Vec::num);
+  }
+  ///! See GemmEpilogueSave, the same order of the adds. bc0 and bc1 are the column bias or 0.
+  template<typename SaveOP, typename EpiOP, typename PlusOP, bool Partial>
+  MGLORIA_INLINE_CPU void SaveEpilogue(DataType* c, index_t ldc, const DataType* brow, Vec bc0,
+                                       Vec bc1) const {
+    Vec __v0__ = PlusOP::Do(m_c0, bc0), __v1__ = PlusOP::Do(m_c1, bc1);
+    if (brow != nullptr) {
+      const Vec __r__ = Vec::Fill(*brow);
+      __v0__ = PlusOP::Do(__v0__, __r__);
+      __v1__ = PlusOP::Do(__v1__, __r__);
+    }
+    const Vec __c0__ = Vec::LoadUnAligned(c), __c1__ = Vec::LoadUnAligned(c + Vec::num);
+    if (Partial) {
+      __v0__ = PlusOP::Do(__v0__, __c0__);
+      __v1__ = PlusOP::Do(__v1__, __c1__);
+    }
+    SaveOP::Do(__c0__, EpiOP::Do(__v0__)).StoreUnAligned(c);
+    SaveOP::Do(__c1__, EpiOP::Do(__v1__)).StoreUnAligned(c + Vec::num);
+    m_next.template SaveEpilogue<SaveOP, EpiOP, PlusOP, Partial>(
+        c + ldc, ldc, brow != nullptr ? brow + 1 : nullptr, bc0, bc1);
+  }
+
+  Vec m_c0, m_c1;
+  GemmTileRows<Vec, DataType, Rows - 1> m_next;
+};
+
+template<typename Vec, typename DataType>
+struct GemmTileRows<Vec, DataType, 0> {
+  MGLORIA_INLINE_CPU void Zero() {}
+  MGLORIA_INLINE_CPU void MulAdd(const DataType*, Vec, Vec) {}
+  template<typename SaveOP>
+  MGLORIA_INLINE_CPU void Save(DataType*, index_t) const {}
+  MGLORIA_INLINE_CPU void Store(DataType*) const {}
+  template<typename SaveOP, typename EpiOP, typename PlusOP, bool Partial>
+  MGLORIA_INLINE_CPU void SaveEpilogue(DataType*, index_t, const DataType*, Vec, Vec) const {}
+};
+
+/*!
+ *@brief    Applies the epilogue to a full tile from the registers, if Enable: the OP of the
+ * epilogue and the Saver are both vectorized for Arch. Returns false if it could not.
+ */
+template<bool Enable>
+struct GemmVecEpilogue {
+  template<typename Saver, typename OP, bool Partial, vectorization::VecArch Arch, typename Acc,
+           typename DataType>
+  MGLORIA_INLINE_CPU static bool Save(const Acc&, DataType*, index_t, const DataType*,
+                                      const DataType*) {
+    return false;
+  }
+};
+
+template<>
+struct GemmVecEpilogue<true> {
+  template<typename Saver, typename OP, bool Partial, vectorization::VecArch Arch, typename Acc,
+           typename DataType>
+  MGLORIA_INLINE_CPU static bool Save(const Acc& acc, DataType* c, index_t ldc,
+                                      const DataType* brow, const DataType* bcol) {
+    typedef vectorization::Vectorized<DataType, Arch> Vec;
+    const Vec __bc0__ = bcol != nullptr ? Vec::LoadUnAligned(bcol) : Vec::Fill(DataType(0));
+    const Vec __bc1__ =
+        bcol != nullptr ? Vec::LoadUnAligned(bcol + Vec::num) : Vec::Fill(DataType(0));
+    acc.template SaveEpilogue<vectorization::VectorizedOP<typename Saver::OPType, DataType, Arch>,
+                              vectorization::VectorizedOP<OP, DataType, Arch>,
+                              vectorization::VectorizedOP<op::_plus, DataType, Arch>, Partial>(
+        c, ldc, brow, __bc0__, __bc1__);
+    return true;
+  }
+};
+
+/*!
+ *@brief    Two vectors of columns by MR rows of accumulators. MR x 2 + 3 registers: 15 of the
+ * 16 on SSE and AVX2, 27 of the 32 on AVX-512.
+ */
+template<typename DataType, vectorization::VecArch Arch>
+struct GemmKernel<DataType, Arch, true> {
+  typedef vectorization::Vectorized<DataType, Arch> Vec;
+  static const index_t m_MR = Arch == vectorization::VecArch::AVX512_Arch ? 12 : 6;
+  static const index_t m_NR = 2 * Vec::num;
+
+  template<typename Saver>
+  MGLORIA_INLINE_CPU static void Tile(index_t kc, const DataType* a, const DataType* b,
+                                      DataType* c, index_t ldc, index_t mr, index_t nr) {
+    GemmTileRows<Vec, DataType, m_MR> __acc__;
+    __acc__.Zero();
+    for (index_t k = 0; k < kc; ++k, a += m_MR, b += m_NR) {
+      __acc__.MulAdd(a, Vec::LoadUnAligned(b), Vec::LoadUnAligned(b + Vec::num));
+    }
+
+    if (mr == m_MR && nr == m_NR) {
+      __acc__.template Save<vectorization::VectorizedOP<typename Saver::OPType, DataType, Arch>>(
+          c, ldc);
+      return;
+    }
+    // The edge of dst, through a buffer.
+    DataType __tile__[m_MR * m_NR] MGLORIA_ALIGNED(64);
+    __acc__.Store(__tile__);
+    for (index_t i = 0; i < mr; ++i) {
+      for (index_t j = 0; j < nr; ++j) {
+        Saver::template Do<DataType>(c[i * ldc + j], __tile__[i * m_NR + j]);
+      }
+    }
+  }
+
+  template<typename Saver, typename OP, bool Partial>
+  MGLORIA_INLINE_CPU static void TileEpilogue(index_t kc, const DataType* a, const DataType* b,
+                                              DataType* c, index_t ldc, index_t mr, index_t nr,
+                                              const DataType* brow, const DataType* bcol) {
+    GemmTileRows<Vec, DataType, m_MR> __acc__;
+    __acc__.Zero();
+    for (index_t k = 0; k < kc; ++k, a += m_MR, b += m_NR) {
+      __acc__.MulAdd(a, Vec::LoadUnAligned(b), Vec::LoadUnAligned(b + Vec::num));
+    }
+
+    if (mr == m_MR && nr == m_NR
+        && GemmVecEpilogue<
+            vectorization::VectorizedOP<OP, DataType, Arch>::m_Enable
+            && vectorization::VectorizedOP<typename Saver::OPType, DataType, Arch>::m_Enable>::
+            template Save<Saver, OP, Partial, Arch>(__acc__, c, ldc, brow, bcol)) {
+      return;
+    }
+    DataType __tile__[m_MR * m_NR] MGLORIA_ALIGNED(64);
+    __acc__.Store(__tile__);
+    GemmEpilogueSave<Saver, OP, Partial>(__tile__, m_NR, c, ldc, mr, nr, brow, bcol);
+  }
+};
+
+/*!
+ *@brief    Pack rows [r0, r0 + rn) of K [k0, k0 + kc) into a panel of R rows, the element (r, k)
+ * times scale is at dst[k * R + r]. The rows from rn to R are 0.
+ *@tparam   RowMajor the element (r, k) is src[r * ld + k], else src[k * ld + r].
+ */
+template<bool RowMajor, typename DataType>
+MGLORIA_INLINE_CPU void GemmPackPanel(DataType* dst, const DataType* src, index_t ld, index_t r0,
+                                      index_t rn, index_t R, index_t k0, index_t kc,
+                                      DataType scale) {
+  if (RowMajor) {
+    for (index_t r = 0; r < rn; ++r) {
+      const DataType* __row__ = src + (r0 + r) * ld + k0;
+      for (index_t k = 0; k < kc; ++k) { dst[k * R + r] = scale * __row__[k]; }
+    }
+    for (index_t r = rn; r < R; ++r) {
+      for (index_t k = 0; k < kc; ++k) { dst[k * R + r] = DataType(0); }
+    }
+  } else {
+    for (index_t k = 0; k < kc; ++k) {
+      const DataType* __row__ = src + (k0 + k) * ld + r0;
+      for (index_t r = 0; r < rn; ++r) { dst[k * R + r] = scale * __row__[r]; }
+      for (index_t r = rn; r < R; ++r) { dst[k * R + r] = DataType(0); }
+    }
+  }
+}
+
+/*!
+ *@brief    Pack all of a [rows, K] operand. The panels of the KC at k0 start at dst + k0 * padded,
+ * padded being rows rounded up to R, and the panel of row r0 is r0 * kc after that. The scale of
+ * the dot is packed into lhs, it is one multiply per element of lhs, not of dst. Packed by the
+ * calling thread alone unless parallel.
+ */
+template<bool RowMajor, typename DataType>
+MGLORIA_INLINE_NORMAL void GemmPack(DataType* dst, const DataType* src, index_t ld, index_t rows,
+                                    index_t R, index_t K, index_t KC, DataType scale,
+                                    bool parallel = true) {
+  const index_t npanel = (rows + R - 1) / R, nkb = (K + KC - 1) / KC;
+  const index_t padded = npanel * R;
+#ifndef __CUDACC__
+#pragma omp parallel for if (parallel)
+#endif
+  for (openmp_index_t t = 0; t < npanel * nkb; ++t) {
+    const index_t r0 = (t % npanel) * R, k0 = (t / npanel) * KC;
+    const index_t rn = rows - r0 < R ? rows - r0 : R, kc = K - k0 < KC ? K - k0 : KC;
+    GemmPackPanel<RowMajor>(dst + k0 * padded + r0 * kc, src, ld, r0, rn, R, k0, kc, scale);
+  }
+}
+
+/*!
+ *@brief    The MC x NC block of dst at (i0, j0), over all of K.
+ */
+template<typename Kern, typename First, typename Rest, typename OP, typename DataType>
+MGLORIA_INLINE_CPU void GemmBlock(DataType* c, index_t ldc, const DataType* pa, const DataType* pb,
+                                  index_t mpad, index_t npad, index_t i0, index_t mc, index_t j0,
+                                  index_t nc, index_t K, index_t KC,
+                                  const GemmEpilogue<OP, DataType>& epi) {
+  const index_t MR = Kern::m_MR, NR = Kern::m_NR;
+  const bool __epi__ = epi.Enabled();
+  for (index_t k0 = 0; k0 < K; k0 += KC) {
+    const index_t kc = K - k0 < KC ? K - k0 : KC;
+    const DataType* __a__ = pa + k0 * mpad + i0 * kc;
+    const DataType* __b__ = pb + k0 * npad + j0 * kc;
+    for (index_t jr = 0; jr < nc; jr += NR) {
+      const index_t nr = nc - jr < NR ? nc - jr : NR;
+      for (index_t ir = 0; ir < mc; ir += MR) {
+        const index_t mr = mc - ir < MR ? mc - ir : MR;
+        DataType* __c__ = c + (i0 + ir) * ldc + j0 + jr;
+        if (__epi__ && k0 + kc == K) {
+          const DataType* brow =
+              epi.m_bias != nullptr && epi.m_axis == 0 ? epi.m_bias + i0 + ir : nullptr;
+          const DataType* bcol =
+              epi.m_bias != nullptr && epi.m_axis == 1 ? epi.m_bias + j0 + jr : nullptr;
+          if (k0 == 0) {
+            Kern::template TileEpilogue<First, OP, false>(kc, __a__ + ir * kc, __b__ + jr * kc,
+                                                          __c__, ldc, mr, nr, brow, bcol);
+          } else {
+            // Only a _saveto is split with an epilogue, c holds the sum of the KC before.
+            Kern::template TileEpilogue<op::_saveto, OP, true>(
+                kc, __a__ + ir * kc, __b__ + jr * kc, __c__, ldc, mr, nr, brow, bcol);
+          }
+        } else if (k0 == 0) {
+          Kern::template Tile<First>(kc, __a__ + ir * kc, __b__ + jr * kc, __c__, ldc, mr, nr);
+        } else {
+          Kern::template Tile<Rest>(kc, __a__ + ir * kc, __b__ + jr * kc, __c__, ldc, mr, nr);
+        }
+      }
+    }
+  }
+}
+
+/*!
+ *@brief    The roots of the gemm kernel, compiled for Arch. See VectorizedRowKernel.
+ */
+template<vectorization::VecArch Arch>
+struct GemmArchKernel {
+  template<typename Kern, typename First, typename Rest, typename OP, typename DataType>
+  MGLORIA_INLINE_CPU static void Block(DataType* c, index_t ldc, const DataType* pa,
+                                       const DataType* pb, index_t mpad, index_t npad, index_t i0,
+                                       index_t mc, index_t j0, index_t nc, index_t K, index_t KC,
+                                       const GemmEpilogue<OP, DataType>& epi) {
+    GemmBlock<Kern, First, Rest>(c, ldc, pa, pb, mpad, npad, i0, mc, j0, nc, K, KC, epi);
+  }
+};
+
+template<>
+struct GemmArchKernel<vectorization::VecArch::AVX2_Arch> {
+  template<typename Kern, typename First, typename Rest, typename OP, typename DataType>
+  MGLORIA_KERNEL_AVX2 static void Block(DataType* c, index_t ldc, const DataType* pa,
+                                        const DataType* pb, index_t mpad, index_t npad, index_t i0,
+                                        index_t mc, index_t j0, index_t nc, index_t K, index_t KC,
+                                        const GemmEpilogue<OP, DataType>& epi) {
+    GemmBlock<Kern, First, Rest>(c, ldc, pa, pb, mpad, npad, i0, mc, j0, nc, K, KC, epi);
+  }
+};
+
+template<>
+struct GemmArchKernel<vectorization::VecArch::AVX512_Arch> {
+  template<typename Kern, typename First, typename Rest, typename OP, typename DataType>
+  MGLORIA_KERNEL_AVX512 static void Block(DataType* c, index_t ldc, const DataType* pa,
+                                          const DataType* pb, index_t mpad, index_t npad,
+                                          index_t i0, index_t mc, index_t j0, index_t nc,
+                                          index_t K, index_t KC,
+                                          const GemmEpilogue<OP, DataType>& epi) {
+    GemmBlock<Kern, First, Rest>(c, ldc, pa, pb, mpad, npad, i0, mc, j0, nc, K, KC, epi);
+  }
+};
+
+/*!
+ *@brief    The block sizes for the cache sizes in prepare.hpp. The B panel takes half of L1, the
+ * A block half of L2. NC is lowered when there are too few blocks for the threads.
+ */
+template<typename Kern, typename DataType>
+MGLORIA_INLINE_NORMAL GemmBlocking GemmDefaultBlocking(index_t M, index_t N) {
+  const index_t MR = Kern::m_MR, NR = Kern::m_NR;
+  GemmBlocking __blk__;
+  index_t kc = index_t(MGLORIA_GEMM_L1_BYTES / 2 / (NR * sizeof(DataType)));
+  __blk__.m_KC = kc < 64 ? 64 : (kc > 512 ? 512 : kc);
+  index_t mc = index_t(MGLORIA_GEMM_L2_BYTES / 2 / (__blk__.m_KC * sizeof(DataType))) / MR * MR;
+  __blk__.m_MC = mc < MR ? MR : mc;
+  __blk__.m_NC = (MGLORIA_GEMM_NC + NR - 1) / NR * NR;
+#ifdef _OPENMP
+  const index_t mblocks = (M + __blk__.m_MC - 1) / __blk__.m_MC;
+  const index_t want = 2 * omp_get_max_threads();
+  if (mblocks * ((N + __blk__.m_NC - 1) / __blk__.m_NC) < want) {
+    const index_t nblocks = (want + mblocks - 1) / mblocks;
+    const index_t nc = ((N + nblocks - 1) / nblocks + NR - 1) / NR * NR;
+    __blk__.m_NC = nc < __blk__.m_NC ? (nc < NR ? NR : nc) : __blk__.m_NC;
+  }
+#endif
+  return __blk__;
+}
+
+/*!
+ *@brief    Check the shapes, pack and run the blocks with Arch, in blk if given.
+ */
+template<typename Saver, vectorization::VecArch Arch, bool LeftTransposed, bool RightTransposed,
+         typename OP, typename DataType>
+MGLORIA_INLINE_NORMAL void ExecuteDot(Tensor<CPU, 2, DataType> dst,
+                                      const Tensor<CPU, 2, DataType>& lhs,
+                                      const Tensor<CPU, 2, DataType>& rhs, DataType scale,
+                                      const GemmEpilogue<OP, DataType>& epi,
+                                      const GemmBlocking* blk = nullptr) {
+  typedef GemmKernel<DataType, Arch, GemmVecCheck<DataType, Arch>::m_Enable> Kern;
+  const index_t M = LeftTransposed ? lhs.size(1) : lhs.size(0);
+  const index_t K = LeftTransposed ? lhs.size(0) : lhs.size(1);
+  const index_t N = RightTransposed ? rhs.size(0) : rhs.size(1);
+  const index_t KR = RightTransposed ? rhs.size(1) : rhs.size(0);
+  LOG_CHECK(K == KR, " dot: Shape_Left=", lhs.m_Shape.str(), " Shape_Right=", rhs.m_Shape.str(),
+            " lhs_transposed=", LeftTransposed, " rhs_transposed=", RightTransposed);
+  LOG_CHECK(dst.size(0) == M && dst.size(1) == N, " dot: Shape_Dst=", dst.m_Shape.str(),
+            " M=", M, " N=", N);
+  if (M == 0 || N == 0) { return; }
+
+  if (K == 0) {
+    for (index_t i = 0; i < M; ++i) {
+      for (index_t j = 0; j < N; ++j) {
+        DataType __v__ = DataType(0);
+        if (epi.m_bias != nullptr) { __v__ = epi.m_bias[epi.m_axis == 0 ? i : j]; }
+        Saver::template Do<DataType>(dst.__data_ptr[i * dst.m_Stride_ + j], OP::Do(__v__));
+      }
+    }
+    return;
+  }
+
+  GemmBlocking __blk__ = GemmDefaultBlocking<Kern, DataType>(M, N);
+  if (blk != nullptr) {
+    __blk__ = *blk;
+  } else {
+    // A tuning run computes the same dot into a buffer of its own.
+    WorkspaceScope __ws__(dst.m_Stream);
+    size_t __spitch__ = 0;
+    DataType* __scratch__ = nullptr;
+    const std::function<void(const GemmBlocking&)> __run__ = [&](const GemmBlocking& b) {
+      if (__scratch__ == nullptr) {
+        __scratch__ =
+            static_cast<DataType*>(__ws__.AllocPitch(&__spitch__, sizeof(DataType) * N, M));
+      }
+      ExecuteDot<op::_saveto, Arch, LeftTransposed, RightTransposed>(
+          Tensor<CPU, 2, DataType>(__scratch__, dst.m_Shape,
+                                   index_t(__spitch__ / sizeof(DataType)), dst.m_Stream),
+          lhs, rhs, scale, GemmEpilogue<op::_identity, DataType>{nullptr, 1}, &b);
+    };
+    __blk__ = GemmTunedBlocking<DataType>(static_cast<int>(Arch), Kern::m_MR, Kern::m_NR, M, N, K,
+                                          __blk__, __run__);
+  }
+  // The epilogue is not linear, the sums of KC can only be kept in dst for a _saveto.
+  const bool __split__ = GemmSaver<Saver>::m_Split
+                         && (!epi.Enabled() || std::is_same<Saver, op::_saveto>::value);
+  if (!__split__ && K > __blk__.m_KC) {
+    // Saved to a buffer first, then applied once.
+    WorkspaceScope __ws__(dst.m_Stream);
+    size_t __pitch__;
+    DataType* __buf__ =
+        static_cast<DataType*>(__ws__.AllocPitch(&__pitch__, sizeof(DataType) * N, M));
+    Tensor<CPU, 2, DataType> __tmp__(__buf__, dst.m_Shape, index_t(__pitch__ / sizeof(DataType)),
+                                     dst.m_Stream);
+    ExecuteDot<op::_saveto, Arch, LeftTransposed, RightTransposed>(__tmp__, lhs, rhs, scale, epi,
+                                                                   &__blk__);
+#ifndef __CUDACC__
+#pragma omp parallel for
+#endif
+    for (openmp_index_t i = 0; i < M; ++i) {
+      for (index_t j = 0; j < N; ++j) {
+        Saver::template Do<DataType>(dst.__data_ptr[i * dst.m_Stride_ + j],
+                                     __tmp__.__data_ptr[i * __tmp__.m_Stride_ + j]);
+      }
+    }
+    return;
+  }
+
+  const index_t MR = Kern::m_MR, NR = Kern::m_NR;
+  const index_t mpad = (M + MR - 1) / MR * MR, npad = (N + NR - 1) / NR * NR;
+  WorkspaceScope __ws__(dst.m_Stream);
+  DataType* __pa__ = __ws__.Alloc<DataType>(size_t(mpad) * K);
+  DataType* __pb__ = __ws__.Alloc<DataType>(size_t(npad) * K);
+  GemmPack<!LeftTransposed>(__pa__, lhs.__data_ptr, lhs.m_Stride_, M, MR, K, __blk__.m_KC,
+                            scale);
+  GemmPack<RightTransposed>(__pb__, rhs.__data_ptr, rhs.m_Stride_, N, NR, K, __blk__.m_KC,
+                            DataType(1));
+
+  const index_t mblocks = (M + __blk__.m_MC - 1) / __blk__.m_MC;
+  const index_t nblocks = (N + __blk__.m_NC - 1) / __blk__.m_NC;
+#ifndef __CUDACC__
+#pragma omp parallel for schedule(dynamic)
+#endif
+  for (openmp_index_t t = 0; t < mblocks * nblocks; ++t) {
+    const index_t i0 = (t / nblocks) * __blk__.m_MC, j0 = (t % nblocks) * __blk__.m_NC;
+    const index_t mc = M - i0 < __blk__.m_MC ? M - i0 : __blk__.m_MC;
+    const index_t nc = N - j0 < __blk__.m_NC ? N - j0 : __blk__.m_NC;
+    GemmArchKernel<Arch>::template Block<Kern, typename GemmSaver<Saver>::First,
+                                         typename GemmSaver<Saver>::Rest>(
+        dst.__data_ptr, dst.m_Stride_, __pa__, __pb__, mpad, npad, i0, mc, j0, nc, K,
+        __blk__.m_KC, epi);
+  }
+}
+
+/*!
+ *@brief    The native gemm, on the arch of the build or the one picked by cpuid.
+ */
+template<typename Saver, bool LeftTransposed, bool RightTransposed, typename OP,
+         typename DataType>
+MGLORIA_INLINE_NORMAL void DispatchDot(Tensor<CPU, 2, DataType> dst,
+                                       const Tensor<CPU, 2, DataType>& lhs,
+                                       const Tensor<CPU, 2, DataType>& rhs, DataType scale,
+                                       const GemmEpilogue<OP, DataType>& epi) {
+#if MGLORIA_RUNTIME_DISPATCH == 1
+  using vectorization::VecArch;
+  switch (vectorization::RuntimeVecArch()) {
+    case VecArch::AVX512_Arch: {
+      ExecuteDot<Saver, VecArch::AVX512_Arch, LeftTransposed, RightTransposed>(dst, lhs, rhs,
+                                                                               scale, epi);
+      break;
+    }
+    case VecArch::AVX2_Arch: {
+      ExecuteDot<Saver, VecArch::AVX2_Arch, LeftTransposed, RightTransposed>(dst, lhs, rhs, scale,
+                                                                             epi);
+      break;
+    }
+#if MGLORIA_USE_SSE == 1
+    case VecArch::SSE_Arch: {
+      ExecuteDot<Saver, VecArch::SSE_Arch, LeftTransposed, RightTransposed>(dst, lhs, rhs, scale,
+                                                                            epi);
+      break;
+    }
+#endif  // MGLORIA_USE_SSE == 1
+    default: {
+      ExecuteDot<Saver, VecArch::NONE_Arch, LeftTransposed, RightTransposed>(dst, lhs, rhs, scale,
+                                                                             epi);
+      break;
+    }
+  }
+#else
+  ExecuteDot<Saver, MGLORIA_VECTORIZATION_ARCH, LeftTransposed, RightTransposed>(dst, lhs, rhs,
+                                                                                 scale, epi);
+#endif  // MGLORIA_RUNTIME_DISPATCH == 1
+}
+
+#if MGLORIA_DOT_USE_BLAS == 1
+/*!
+ *@brief    Runs a dot on the blas when it can, see op/__op_dot_blas.hpp. Otherwise the native.
+ */
+template<bool UseBlas>
+struct DotBackend {
+  template<typename Saver, bool LeftTransposed, bool RightTransposed, typename DataType>
+  MGLORIA_INLINE_NORMAL static void Eval(Tensor<CPU, 2, DataType> dst,
+                                         const Tensor<CPU, 2, DataType>& lhs,
+                                         const Tensor<CPU, 2, DataType>& rhs, DataType scale) {
+    DispatchDot<Saver, LeftTransposed, RightTransposed>(
+        dst, lhs, rhs, scale, GemmEpilogue<op::_identity, DataType>{nullptr, 1});
+  }
+};
+
+template<>
+struct DotBackend<true> {
+  template<typename Saver, bool LeftTransposed, bool RightTransposed, typename DataType>
+  MGLORIA_INLINE_NORMAL static void Eval(Tensor<CPU, 2, DataType> dst,
+                                         const Tensor<CPU, 2, DataType>& lhs,
+                                         const Tensor<CPU, 2, DataType>& rhs, DataType scale) {
+    if (BlasDotFits(dst, lhs, rhs)) {
+      ExecuteBlasDot<Saver, LeftTransposed, RightTransposed>(dst, lhs, rhs, scale);
+    } else {
+      DotBackend<false>::template Eval<Saver, LeftTransposed, RightTransposed>(dst, lhs, rhs,
+                                                                               scale);
+    }
+  }
+};
+#endif  // MGLORIA_DOT_USE_BLAS == 1
+
+/*!
+ *@brief    The DotEngine of 2D CPU tensors. The blas one if MGLORIA_DOT_USE_BLAS, else native.
+ * A dot with an epilogue always runs on the native one, the blas can not fuse it.
+ */
+template<typename Saver, bool LeftTransposed, bool RightTransposed, typename DataType>
+struct DotEngine<Saver, CPU, 2, 2, 2, LeftTransposed, RightTransposed, DataType> {
+  MGLORIA_INLINE_NORMAL static void Eval(Tensor<CPU, 2, DataType>* p_dst,
+                                         const Tensor<CPU, 2, DataType>& lhs,
+                                         const Tensor<CPU, 2, DataType>& rhs, DataType scale) {
+#if MGLORIA_DOT_USE_BLAS == 1
+    DotBackend<BlasDotCheck<Saver, DataType>::m_Enable>::template Eval<Saver, LeftTransposed,
+                                                                       RightTransposed>(
+        *p_dst, lhs, rhs, scale);
+#else
+    DispatchDot<Saver, LeftTransposed, RightTransposed>(
+        *p_dst, lhs, rhs, scale, GemmEpilogue<op::_identity, DataType>{nullptr, 1});
+#endif  // MGLORIA_DOT_USE_BLAS == 1
+  }
+
+  template<typename OP>
+  MGLORIA_INLINE_NORMAL static void Eval(Tensor<CPU, 2, DataType>* p_dst,
+                                         const Tensor<CPU, 2, DataType>& lhs,
+                                         const Tensor<CPU, 2, DataType>& rhs, DataType scale,
+                                         const GemmEpilogue<OP, DataType>& epi) {
+    DispatchDot<Saver, LeftTransposed, RightTransposed>(*p_dst, lhs, rhs, scale, epi);
+  }
+};
+
+/*!
+ *@brief    The dispatcher of DotExpr on CPU tensors.
+ */
+template<typename Saver, bool LeftTransposed, bool RightTransposed, typename DataType,
+         typename EpilogueOP>
+struct ExpressionComplexDispatcher<
+    Saver, Tensor<CPU, 2, DataType>,
+    DotExpr<Tensor<CPU, 2, DataType>, Tensor<CPU, 2, DataType>, LeftTransposed, RightTransposed,
+            DataType, EpilogueOP>,
+    DataType> {
+  typedef DotExpr<Tensor<CPU, 2, DataType>, Tensor<CPU, 2, DataType>, LeftTransposed,
+                  RightTransposed, DataType, EpilogueOP>
+      E;
+  typedef DotEngine<Saver, CPU, 2, 2, 2, LeftTransposed, RightTransposed, DataType> Engine;
+
+  MGLORIA_INLINE_NORMAL static void Eval(Tensor<CPU, 2, DataType>* dst,
+                                         const Expression<E, DataType, Complex_t>& exp) {
+    const E& e = exp.Self();
+    const GemmEpilogue<EpilogueOP, DataType> __epi__ = {e.m_bias, e.m_bias_axis};
+    if (!__epi__.Enabled()) {
+      Engine::Eval(dst, e.m_a, e.m_b, e.m_scale);
+      return;
+    }
+    if (e.m_bias != nullptr) {
+      CHECK_EQUAL(e.m_bias_size, dst->size(e.m_bias_axis), " dot: the bias of axis ",
+                  e.m_bias_axis, " Shape_Dst=", dst->m_Shape.str());
+    }
+    Engine::Eval(dst, e.m_a, e.m_b, e.m_scale, __epi__);
+  }
+};
+
+}  // namespace expr
+}  // namespace mgloria
+
+#endif  // _MGLORIA___OP_DOT_CPU_HPP_
@@ -0,0 +1,344 @@
+/*!
+ *@author chenghua.wang
+ *@file   op/__op_dot_tune_cpu.hpp
+ *@brief  The block sizes of the CPU gemm, and the tuner that picks them per CPU model.
+ *@details The default blocking of op/__op_dot_cpu.hpp comes from the cache sizes of prepare.hpp,
+ * which are not the ones of every host. With tuning on, the first dot of a shape class times a few
+ * blockings and keeps the fastest: KC first, then MC with that KC, then NC, which is also how the
+ * blocks are split over the threads. The micro tile MR x NR is fixed by the arch.
+ *
+ * A shape class is the type, the arch, the number of threads and M, N and K rounded up to a power
+ * of 2. The winners are written to a tuning file, one line per class of a CPU model (the cpuid
+ * brand string), and read back the first time a dot looks for one. The lines of other models are
+ * kept, so one file serves every host it is shared by. A write holds the lock of path.lock, merges
+ * the lines other processes wrote since the file was read, and renames path.tmp.pid over path.
+ *@note     The env MGLORIA_GEMM_TUNE=1 turns tuning on, MGLORIA_GEMM_TUNE_FILE is the tuning file,
+ * MGLORIA_GEMM_TUNE_FILE of prepare.hpp by default, which is under $XDG_CACHE_HOME, else
+ * $HOME/.cache, when it is a relative path (the working directory only without either). Without
+ * tuning on, the classes of the file are still used, and the others get the default blocking.
+ */
+
+#ifndef _MGLORIA___OP_DOT_TUNE_CPU_HPP_
+#define _MGLORIA___OP_DOT_TUNE_CPU_HPP_
+
+#pragma once
+
+#include "../prepare.hpp"
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+namespace mgloria {
+namespace expr {
+
+/*!
+ *@brief    The block sizes of one gemm, in elements. MC is a multiple of MR, NC of NR.
+ */
+struct GemmBlocking {
+  index_t m_MC;
+  index_t m_KC;
+  index_t m_NC;
+};
+
+/*!
+ *@brief    The cpuid brand string of this CPU, "unknown" if there is none.
+ */
+MGLORIA_INLINE_NORMAL std::string GemmCpuModel() {
+  std::string __model__;
+#if defined(__x86_64__) || defined(__i386__)
+  unsigned int __r__[4];
+  if (__get_cpuid(0x80000000u, &__r__[0], &__r__[1], &__r__[2], &__r__[3])
+      && __r__[0] >= 0x80000004u) {
+    char __brand__[49] = {};
+    for (unsigned int i = 0; i < 3; ++i) {
+      __get_cpuid(0x80000002u + i, &__r__[0], &__r__[1], &__r__[2], &__r__[3]);
+      std::memcpy(__brand__ + i * 16, __r__, 16);
+    }
+    // Trimmed, and a tab would break the line of the tuning file.
+    for (const char* c = __brand__; *c != '\0'; ++c) {
+      if (*c == ' ' || *c == '\t') {
+        if (!__model__.empty() && __model__.back() != ' ') { __model__ += ' '; }
+      } else {
+        __model__ += *c;
+      }
+    }
+    while (!__model__.empty() && __model__.back() == ' ') { __model__.pop_back(); }
+  }
+#endif
+  return __model__.empty() ? std::string("unknown") : __model__;
+}
+
+/*!
+ *@brief    The default tuning file: MGLORIA_GEMM_TUNE_FILE, under $XDG_CACHE_HOME or else
+ * $HOME/.cache when it is a relative path, so every working directory shares it.
+ */
+MGLORIA_INLINE_NORMAL std::string GemmTuneDefaultPath() {
+  const std::string __file__ = MGLORIA_GEMM_TUNE_FILE;
+  if (__file__.empty() || __file__[0] == '/') { return __file__; }
+  const char* __cache__ = std::getenv("XDG_CACHE_HOME");
+  const char* __home__ = std::getenv("HOME");
+  std::string __dir__;
+  if (__cache__ != nullptr && __cache__[0] == '/') {
+    __dir__ = __cache__;
+  } else if (__home__ != nullptr && __home__[0] == '/') {
+    __dir__ = std::string(__home__) + "/.cache";
+  } else {
+    return __file__;
+  }
+  // Fails if it is there already, which is fine; the write warns if it is not.
+  ::mkdir(__dir__.c_str(), 0755);
+  return __dir__ + "/" + __file__;
+}
+
+/*!
+ *@brief    The tuned blockings of this CPU model, shared by all the threads.
+ */
+class GemmTuner {
+ public:
+  MGLORIA_INLINE_NORMAL static GemmTuner& Get() {
+    static GemmTuner __tuner__;
+    return __tuner__;
+  }
+
+  MGLORIA_INLINE_NORMAL bool Enabled() {
+    std::lock_guard<std::mutex> __lock__(m_mutex);
+    return m_enabled;
+  }
+
+  ///! Tune the classes not known yet, or only use the known ones.
+  MGLORIA_INLINE_NORMAL void SetEnabled(bool enabled) {
+    std::lock_guard<std::mutex> __lock__(m_mutex);
+    m_enabled = enabled;
+  }
+
+  ///! The tuning file. The classes known are kept, the file is read again on the next Find.
+  MGLORIA_INLINE_NORMAL void SetPath(const std::string& path) {
+    std::lock_guard<std::mutex> __lock__(m_mutex);
+    m_path = path;
+    m_loaded = false;
+  }
+
+  MGLORIA_INLINE_NORMAL std::string Path() {
+    std::lock_guard<std::mutex> __lock__(m_mutex);
+    return m_path;
+  }
+
+  ///! The number of classes known for this CPU model.
+  MGLORIA_INLINE_NORMAL size_t Size() {
+    std::lock_guard<std::mutex> __lock__(m_mutex);
+    return m_table.size();
+  }
+
+  ///! Forget all the classes, the tuning file is read again on the next Find.
+  MGLORIA_INLINE_NORMAL void Clear() {
+    std::lock_guard<std::mutex> __lock__(m_mutex);
+    m_table.clear();
+    m_others.clear();
+    m_loaded = false;
+  }
+
+  MGLORIA_INLINE_NORMAL bool Find(const std::string& key, GemmBlocking* blk) {
+    std::lock_guard<std::mutex> __lock__(m_mutex);
+    if (!m_loaded) {
+      Load();
+      m_loaded = true;
+    }
+    auto it = m_table.find(key);
+    if (it == m_table.end()) { return false; }
+    *blk = it->second;
+    return true;
+  }
+
+  ///! Keep the winner of key, and write the tuning file again, merged with the lines the other
+  ///! processes wrote since it was read. The classes known here win over the ones of the file.
+  MGLORIA_INLINE_NORMAL void Put(const std::string& key, const GemmBlocking& blk) {
+    std::lock_guard<std::mutex> __lock__(m_mutex);
+    m_table[key] = blk;
+    const int __lock_fd__ = ::open((m_path + ".lock").c_str(), O_RDWR | O_CREAT, 0644);
+    if (__lock_fd__ < 0 || ::flock(__lock_fd__, LOCK_EX) != 0) {
+      LOG_WARN << "The gemm tuning file " << m_path << " can not be locked." << std::endl;
+      if (__lock_fd__ >= 0) { ::close(__lock_fd__); }
+      return;
+    }
+    std::map<std::string, GemmBlocking> __known__;
+    __known__.swap(m_table);
+    Load();
+    for (const auto& e : __known__) { m_table[e.first] = e.second; }
+    std::ostringstream __out__;
+    __out__ << "# mgloria gemm tuning: cpu model, shape class, MC KC NC\n";
+    for (const std::string& line : m_others) { __out__ << line << '\n'; }
+    for (const auto& e : m_table) {
+      __out__ << m_model << '\t' << e.first << '\t' << e.second.m_MC << ' ' << e.second.m_KC << ' '
+              << e.second.m_NC << '\n';
+    }
+    // A reader sees the old file or the new one, never a part of it.
+    const std::string __tmp__ = m_path + ".tmp." + std::to_string(::getpid());
+    const std::string __text__ = __out__.str();
+    bool __ok__ = false;
+    std::FILE* f = std::fopen(__tmp__.c_str(), "wb");
+    if (f != nullptr) {
+      __ok__ = std::fwrite(__text__.data(), 1, __text__.size(), f) == __text__.size()
+               && std::fflush(f) == 0 && ::fdatasync(::fileno(f)) == 0;
+      __ok__ = std::fclose(f) == 0 && __ok__;
+    }
+    if (__ok__) { __ok__ = std::rename(__tmp__.c_str(), m_path.c_str()) == 0; }
+    if (!__ok__) {
+      std::remove(__tmp__.c_str());
+      LOG_WARN << "The gemm tuning file " << m_path << " can not be written." << std::endl;
+    }
+    ::flock(__lock_fd__, LOCK_UN);
+    ::close(__lock_fd__);
+  }
+
+ private:
+  GemmTuner() : m_enabled(false), m_loaded(false), m_model(GemmCpuModel()) {
+    const char* __tune__ = std::getenv("MGLORIA_GEMM_TUNE");
+    m_enabled = __tune__ != nullptr && std::strcmp(__tune__, "1") == 0;
+    const char* __file__ = std::getenv("MGLORIA_GEMM_TUNE_FILE");
+    m_path = __file__ != nullptr && __file__[0] != '\0' ? __file__ : GemmTuneDefaultPath();
+  }
+
+  ///! The lines of this model into m_table, the others into m_others. Locked by the caller.
+  MGLORIA_INLINE_NORMAL void Load() {
+    m_others.clear();
+    std::ifstream __in__(m_path.c_str());
+    std::string __line__;
+    while (std::getline(__in__, __line__)) {
+      if (__line__.empty() || __line__[0] == '#') { continue; }
+      const size_t t0 = __line__.find('\t'), t1 = __line__.find('\t', t0 + 1);
+      if (t0 == std::string::npos || t1 == std::string::npos) { continue; }
+      if (__line__.compare(0, t0, m_model) != 0) {
+        m_others.push_back(__line__);
+        continue;
+      }
+      GemmBlocking __blk__;
+      std::istringstream __sizes__(__line__.substr(t1 + 1));
+      if (__sizes__ >> __blk__.m_MC >> __blk__.m_KC >> __blk__.m_NC && __blk__.m_MC > 0
+          && __blk__.m_KC > 0 && __blk__.m_NC > 0) {
+        m_table[__line__.substr(t0 + 1, t1 - t0 - 1)] = __blk__;
+      }
+    }
+  }
+
+  std::mutex m_mutex;
+  bool m_enabled;
+  bool m_loaded;
+  std::string m_model;
+  std::string m_path;
+  std::map<std::string, GemmBlocking> m_table;
+  std::vector<std::string> m_others;
+};
+
+///! n rounded up to a power of 2.
+MGLORIA_INLINE_NORMAL index_t GemmTuneBucket(index_t n) {
+  index_t __b__ = 1;
+  while (__b__ < n) { __b__ *= 2; }
+  return __b__;
+}
+
+/*!
+ *@brief    The fastest of blks for run, the time being the best of two runs. blks is not empty.
+ */
+MGLORIA_INLINE_NORMAL GemmBlocking GemmTuneFastest(
+    const std::vector<GemmBlocking>& blks, const std::function<void(const GemmBlocking&)>& run) {
+  GemmBlocking __best__ = blks[0];
+  double __best_time__ = -1;
+  for (const GemmBlocking& blk : blks) {
+    double __time__ = -1;
+    for (int r = 0; r < 2; ++r) {
+      const auto t0 = std::chrono::steady_clock::now();
+      run(blk);
+      const double t = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+      __time__ = __time__ < 0 || t < __time__ ? t : __time__;
+    }
+    if (__best_time__ < 0 || __time__ < __best_time__) {
+      __best_time__ = __time__;
+      __best__ = blk;
+    }
+  }
+  return __best__;
+}
+
+/*!
+ *@brief    The blocking of an [M, K] x [K, N] gemm: the tuned one of its class, or found now by
+ * run if tuning is on, else def. run computes the gemm with a given blocking.
+ */
+template<typename DataType>
+MGLORIA_INLINE_NORMAL GemmBlocking GemmTunedBlocking(
+    int arch, index_t MR, index_t NR, index_t M, index_t N, index_t K, const GemmBlocking& def,
+    const std::function<void(const GemmBlocking&)>& run) {
+  if (size_t(M) * N * K < size_t(MGLORIA_GEMM_TUNE_MIN)) { return def; }
+  GemmTuner& __tuner__ = GemmTuner::Get();
+  int __threads__ = 1;
+#ifdef _OPENMP
+  __threads__ = omp_get_max_threads();
+#endif
+  std::ostringstream __key__;
+  __key__ << (std::is_floating_point<DataType>::value ? 'f' : 'i') << sizeof(DataType) * 8
+          << " arch" << arch << " t" << __threads__ << " m" << GemmTuneBucket(M) << " n"
+          << GemmTuneBucket(N) << " k" << GemmTuneBucket(K);
+  GemmBlocking __blk__ = def;
+  if (__tuner__.Find(__key__.str(), &__blk__)) {
+    // The file may be edited by hand.
+    __blk__.m_MC = __blk__.m_MC < MR ? MR : __blk__.m_MC / MR * MR;
+    __blk__.m_NC = __blk__.m_NC < NR ? NR : __blk__.m_NC / NR * NR;
+    return __blk__;
+  }
+  if (!__tuner__.Enabled()) { return def; }
+
+  const index_t mpad = (M + MR - 1) / MR * MR, npad = (N + NR - 1) / NR * NR;
+  std::vector<GemmBlocking> __cands__;
+  const index_t __kcs__[] = {64, 128, 256, 384, 512};
+  for (index_t kc : __kcs__) {
+    if (kc == def.m_KC || kc >= K + 64) { continue; }
+    __cands__.push_back(GemmBlocking{def.m_MC, kc, def.m_NC});
+  }
+  __cands__.push_back(def);
+  __blk__ = GemmTuneFastest(__cands__, run);
+
+  __cands__.clear();
+  for (index_t l2 = MGLORIA_GEMM_L2_BYTES / 8; l2 <= MGLORIA_GEMM_L2_BYTES * 2; l2 *= 2) {
+    index_t mc = index_t(l2 / (__blk__.m_KC * sizeof(DataType))) / MR * MR;
+    mc = mc < MR ? MR : (mc > mpad ? mpad : mc);
+    if (__cands__.empty() || __cands__.back().m_MC != mc) {
+      __cands__.push_back(GemmBlocking{mc, __blk__.m_KC, __blk__.m_NC});
+    }
+  }
+  __blk__ = GemmTuneFastest(__cands__, run);
+
+  __cands__.clear();
+  const index_t __ncs__[] = {def.m_NC, 16 * NR, 256, 512, 1024, 2048, 4096};
+  for (index_t n : __ncs__) {
+    index_t nc = (n + NR - 1) / NR * NR;
+    nc = nc > npad ? npad : nc;
+    bool __seen__ = false;
+    for (const GemmBlocking& c : __cands__) { __seen__ = __seen__ || c.m_NC == nc; }
+    if (!__seen__) { __cands__.push_back(GemmBlocking{__blk__.m_MC, __blk__.m_KC, nc}); }
+  }
+  __blk__ = GemmTuneFastest(__cands__, run);
+  __tuner__.Put(__key__.str(), __blk__);
+  return __blk__;
+}
+
+}  // namespace expr
+}  // namespace mgloria
+
+#endif  // _MGLORIA___OP_DOT_TUNE_CPU_HPP_
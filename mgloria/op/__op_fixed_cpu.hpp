@@ -0,0 +1,807 @@
+/*!
+ *@author chenghua.wang
+ *@file   op/__op_fixed_cpu.hpp
+ *@brief  The element-wise and the dot kernels of FixedTensor, see tensor_fixed.hpp.
+ *@details All the sizes are template arguments, so there is no shape check at runtime, no heap
+ * and no OpenMP, only one switch on the arch with MGLORIA_RUNTIME_DISPATCH.
+ *
+ * The element-wise expressions are run a vector at a time over each row, or over all the elements
+ * as one row when none of the operands is transposed: a 3x3 float is one vector and one element.
+ *
+ * The dot keeps a tile of up to 12 rows x 2 vectors of dst in registers, as the micro kernel of
+ * op/__op_dot_cpu.hpp but on the operands as they are, there is nothing to pack:
+ *
+ *     dot(A, B), dot(A.T(), B)    an element of op(A) broadcast, times the vectors of a row of B.
+ *     dot(A, B.T())               the rows of A and B are both along K, vectors along K, summed.
+ *     dot(A.T(), B.T())           scalar.
+ *
+ * The tiles are unrolled by templates (FixedUnroll, FixedVecs, FixedTileRows), the loops over the
+ * tiles and over K have constant bounds. The columns after the last full vector, and the types with
+ * no vector fma on the arch, are scalar.
+ */
+
+#ifndef _MGLORIA___OP_FIXED_CPU_HPP_
+#define _MGLORIA___OP_FIXED_CPU_HPP_
+
+#pragma once
+
+#include "../tensor_fixed.hpp"
+
+namespace mgloria {
+namespace expr {
+
+// ######################## Below for the Jobs of FixedTensor ###################
+/*!
+ *@brief
+ */
+template<index_t Rows, index_t Cols, typename DataType>
+struct Job<FixedTensor<Rows, Cols, DataType>, DataType> {
+  explicit Job(const FixedTensor<Rows, Cols, DataType>& t) : __data_ptr(t.m_Data) {}
+
+  MGLORIA_INLINE_NORMAL const DataType& Eval(index_t y, index_t x) const {
+    return __data_ptr[y * Cols + x];
+  }
+
+ private:
+  const DataType* __data_ptr;
+};
+
+/*!
+ *@brief      The rows of a FixedTensor are aligned only if Cols is a multiple of the vector, all
+ * the loads are unaligned.
+ */
+template<index_t Rows, index_t Cols, typename DataType, vectorization::VecArch Arch>
+struct VectorizedJob<FixedTensor<Rows, Cols, DataType>, DataType, Arch> {
+  explicit VectorizedJob(const FixedTensor<Rows, Cols, DataType>& t) : __data_ptr(t.m_Data) {}
+
+  MGLORIA_INLINE_CPU DataType Eval(index_t y, index_t x) const { return __data_ptr[y * Cols + x]; }
+  MGLORIA_INLINE_CPU vectorization::Vectorized<DataType, Arch> EvalVec(index_t y, index_t x) const {
+    return vectorization::Vectorized<DataType, Arch>::LoadUnAligned(&__data_ptr[y * Cols + x]);
+  }
+  MGLORIA_INLINE_CPU vectorization::Vectorized<DataType, Arch> EvalVecUnAligned(index_t y,
+                                                                              index_t x) const {
+    return EvalVec(y, x);
+  }
+  MGLORIA_INLINE_CPU vectorization::Vectorized<DataType, Arch> EvalVecMasked(index_t y, index_t x,
+                                                                           index_t n) const {
+    return vectorization::Vectorized<DataType, Arch>::LoadMasked(&__data_ptr[y * Cols + x], n);
+  }
+
+ private:
+  const DataType* __data_ptr;
+};
+
+///! So that a FixedTensor can also be an operand of an expression saved to a Tensor.
+template<index_t Rows, index_t Cols, typename DataType>
+struct __runtime_shape_check<2, FixedTensor<Rows, Cols, DataType>> {
+  MGLORIA_INLINE_NORMAL static Shape<2> _check(const FixedTensor<Rows, Cols, DataType>&) {
+    return makeShape2d(Rows, Cols);
+  }
+};
+
+// ######################## Below for the checks at compile time ################
+/*!
+ *@brief    Is E a Rows x Cols expression of only FixedTensor and scalars.
+ */
+template<typename E, index_t Rows, index_t Cols>
+struct FixedShapeCheck {
+  static const bool m_Enable = false;
+};
+
+template<typename DataType, index_t Rows, index_t Cols>
+struct FixedShapeCheck<ScalarExpr<DataType>, Rows, Cols> {
+  static const bool m_Enable = true;
+};
+
+template<index_t Rows, index_t Cols, typename DataType>
+struct FixedShapeCheck<FixedTensor<Rows, Cols, DataType>, Rows, Cols> {
+  static const bool m_Enable = true;
+};
+
+template<typename E, typename DataType, index_t Rows, index_t Cols>
+struct FixedShapeCheck<TransposeExpr<E, DataType>, Rows, Cols> {
+  static const bool m_Enable = FixedShapeCheck<E, Cols, Rows>::m_Enable;
+};
+
+template<typename OriDataType, typename DisDataType, typename A_T, exprType EType, index_t Rows,
+         index_t Cols>
+struct FixedShapeCheck<TypeCastExpr<OriDataType, DisDataType, A_T, EType>, Rows, Cols> {
+  static const bool m_Enable = FixedShapeCheck<A_T, Rows, Cols>::m_Enable;
+};
+
+template<typename OP, typename A_T, typename DataType, exprType EType, index_t Rows, index_t Cols>
+struct FixedShapeCheck<UnaryExpr<OP, A_T, DataType, EType>, Rows, Cols> {
+  static const bool m_Enable = FixedShapeCheck<A_T, Rows, Cols>::m_Enable;
+};
+
+template<typename OP, typename A_T, typename B_T, typename DataType, exprType EType, index_t Rows,
+         index_t Cols>
+struct FixedShapeCheck<BinaryExpr<OP, A_T, B_T, DataType, EType>, Rows, Cols> {
+  static const bool m_Enable =
+      FixedShapeCheck<A_T, Rows, Cols>::m_Enable && FixedShapeCheck<B_T, Rows, Cols>::m_Enable;
+};
+
+template<typename OP, typename A_T, typename B_T, typename C_T, typename DataType, exprType EType,
+         index_t Rows, index_t Cols>
+struct FixedShapeCheck<TernaryExpr<OP, A_T, B_T, C_T, DataType, EType>, Rows, Cols> {
+  static const bool m_Enable = FixedShapeCheck<A_T, Rows, Cols>::m_Enable
+                               && FixedShapeCheck<B_T, Rows, Cols>::m_Enable
+                               && FixedShapeCheck<C_T, Rows, Cols>::m_Enable;
+};
+
+/*!
+ *@brief    Can E be run as one row of Rows * Cols: none of its operands is transposed.
+ */
+template<typename E>
+struct FixedFlatCheck {
+  static const bool m_Enable = true;
+};
+
+template<typename E, typename DataType>
+struct FixedFlatCheck<TransposeExpr<E, DataType>> {
+  static const bool m_Enable = false;
+};
+
+template<typename OriDataType, typename DisDataType, typename A_T, exprType EType>
+struct FixedFlatCheck<TypeCastExpr<OriDataType, DisDataType, A_T, EType>> {
+  static const bool m_Enable = FixedFlatCheck<A_T>::m_Enable;
+};
+
+template<typename OP, typename A_T, typename DataType, exprType EType>
+struct FixedFlatCheck<UnaryExpr<OP, A_T, DataType, EType>> {
+  static const bool m_Enable = FixedFlatCheck<A_T>::m_Enable;
+};
+
+template<typename OP, typename A_T, typename B_T, typename DataType, exprType EType>
+struct FixedFlatCheck<BinaryExpr<OP, A_T, B_T, DataType, EType>> {
+  static const bool m_Enable = FixedFlatCheck<A_T>::m_Enable && FixedFlatCheck<B_T>::m_Enable;
+};
+
+template<typename OP, typename A_T, typename B_T, typename C_T, typename DataType, exprType EType>
+struct FixedFlatCheck<TernaryExpr<OP, A_T, B_T, C_T, DataType, EType>> {
+  static const bool m_Enable = FixedFlatCheck<A_T>::m_Enable && FixedFlatCheck<B_T>::m_Enable
+                               && FixedFlatCheck<C_T>::m_Enable;
+};
+
+// ######################## Below for the element-wise kernels ##################
+/*!
+ *@brief    Calls body(i) for i in [i0, i0 + N), all inlined. Split in halves, so the depth of the
+ * templates is log(N) and not N.
+ */
+template<index_t N>
+struct FixedUnroll {
+  template<typename Body>
+  MGLORIA_INLINE_CPU static void Do(const Body& body, index_t i0) {
+    FixedUnroll<N / 2>::Do(body, i0);
+    FixedUnroll<N - N / 2>::Do(body, i0 + N / 2);
+  }
+};
+
+template<>
+struct FixedUnroll<1> {
+  template<typename Body>
+  MGLORIA_INLINE_CPU static void Do(const Body& body, index_t i0) {
+    body(i0);
+  }
+};
+
+template<>
+struct FixedUnroll<0> {
+  template<typename Body>
+  MGLORIA_INLINE_CPU static void Do(const Body&, index_t) {}
+};
+
+/*!
+ *@brief    The vector v of the row y of dst.
+ */
+template<typename Saver, typename Plan, typename DataType, vectorization::VecArch Arch>
+struct FixedMapStep {
+  typedef vectorization::Vectorized<DataType, Arch> Vec;
+
+  MGLORIA_INLINE_CPU void operator()(index_t v) const {
+    DataType* __p__ = m_row + v * Vec::num;
+    vectorization::VectorizedOP<typename Saver::OPType, DataType, Arch>::Do(
+        Vec::LoadUnAligned(__p__), m_plan.EvalVecUnAligned(m_y, v * Vec::num))
+        .StoreUnAligned(__p__);
+  }
+
+  DataType* m_row;
+  const Plan& m_plan;
+  index_t m_y;
+};
+
+/*!
+ *@brief    dst Saver plan, with the vectors of Arch. If Flat, as one row of Rows * Cols.
+ */
+template<typename Saver, index_t Rows, index_t Cols, bool Flat, vectorization::VecArch Arch,
+         typename Plan, typename DataType>
+MGLORIA_INLINE_CPU void FixedMapVec(DataType* dst, const Plan& plan) {
+  static_assert(Arch != vectorization::VecArch::NONE_Arch, "NONE_Arch has no vectors.");
+  typedef vectorization::Vectorized<DataType, Arch> Vec;
+  static const index_t __rows__ = Flat ? 1 : Rows;
+  static const index_t __cols__ = Flat ? Rows * Cols : Cols;
+  for (index_t y = 0; y < __rows__; ++y) {
+    DataType* __row__ = dst + y * __cols__;
+    const FixedMapStep<Saver, Plan, DataType, Arch> __step__ = {__row__, plan, y};
+    FixedUnroll<__cols__ / Vec::num>::Do(__step__, 0);
+    for (index_t x = __cols__ / Vec::num * Vec::num; x < __cols__; ++x) {
+      Saver::template Do<DataType>(__row__[x], plan.Eval(y, x));
+    }
+  }
+}
+
+/*!
+ *@brief    dst Saver plan, element by element. For the expressions Arch can not vectorize.
+ */
+template<typename Saver, index_t Rows, index_t Cols, bool Flat, typename Plan, typename DataType>
+MGLORIA_INLINE_NORMAL void FixedMapScalar(DataType* dst, const Plan& plan) {
+  static const index_t __rows__ = Flat ? 1 : Rows;
+  static const index_t __cols__ = Flat ? Rows * Cols : Cols;
+  for (index_t y = 0; y < __rows__; ++y) {
+    for (index_t x = 0; x < __cols__; ++x) {
+      Saver::template Do<DataType>(dst[y * __cols__ + x], plan.Eval(y, x));
+    }
+  }
+}
+
+// ######################## Below for the dot kernels ###########################
+/*!
+ *@brief    The epilogue of a fixed dot, dst Saver OP(scale * acc + bias), see DotExpr. brow is the
+ * bias of the rows, bcol of the columns, nullptr if none.
+ */
+template<typename DataType>
+struct FixedDotArgs {
+  DataType m_scale;
+  const DataType* m_brow;
+  const DataType* m_bcol;
+};
+
+/*!
+ *@brief    Applies the epilogue to the element (i, j) of dst at c.
+ */
+template<typename Saver, typename OP, typename DataType>
+MGLORIA_INLINE_CPU void FixedDotSave(DataType* c, DataType acc, const FixedDotArgs<DataType>& args,
+                                     index_t i, index_t j) {
+  DataType __v__ = acc * args.m_scale;
+  if (args.m_bcol != nullptr) { __v__ += args.m_bcol[j]; }
+  if (args.m_brow != nullptr) { __v__ += args.m_brow[i]; }
+  Saver::template Do<DataType>(*c, OP::Do(__v__));
+}
+
+/*!
+ *@brief    The element (i, j) of op(A) x op(B) for [M, K] x [K, N], scalar. The element (i, k) of
+ * op(A) is a[i * SAI + k * SAK], the element (k, j) of op(B) is b[k * SBK + j * SBJ].
+ */
+template<index_t K, index_t SAI, index_t SAK, index_t SBK, index_t SBJ, typename DataType>
+MGLORIA_INLINE_CPU DataType FixedDotAt(const DataType* a, const DataType* b, index_t i, index_t j) {
+  DataType __acc__ = DataType(0);
+  for (index_t k = 0; k < K; ++k) { __acc__ += a[i * SAI + k * SAK] * b[k * SBK + j * SBJ]; }
+  return __acc__;
+}
+
+/*!
+ *@brief    NV vectors of a row, one member each. Like GemmTileRows, not an array, so that they stay
+ * in registers whether the loops are unrolled or not.
+ */
+template<typename Vec, typename DataType, index_t NV>
+struct FixedVecs {
+  MGLORIA_INLINE_CPU void Zero() {
+    m_v = Vec::Fill(DataType(0));
+    m_next.Zero();
+  }
+  MGLORIA_INLINE_CPU void Load(const DataType* p) {
+    m_v = Vec::LoadUnAligned(p);
+    m_next.Load(p + Vec::num);
+  }
+  MGLORIA_INLINE_CPU void MulAdd(const Vec& a, const FixedVecs& b) {
+    m_v = Vec::MulAdd(a, b.m_v, m_v);
+    m_next.MulAdd(a, b.m_next);
+  }
+  MGLORIA_INLINE_CPU void Store(DataType* p) const {
+    m_v.StoreUnAligned(p);
+    m_next.Store(p + Vec::num);
+  }
+  ///! See FixedDotSave, the same order of the ops. brow is the bias of the row or 0.
+  template<typename SaveOP, typename EpiOP, typename PlusOP, typename MulOP>
+  MGLORIA_INLINE_CPU void SaveEpilogue(DataType* c, const DataType* bcol, const Vec& scale,
+                                       const Vec& brow) const {
+    Vec __v__ = MulOP::Do(m_v, scale);
+    if (bcol != nullptr) { __v__ = PlusOP::Do(__v__, Vec::LoadUnAligned(bcol)); }
+    __v__ = PlusOP::Do(__v__, brow);
+    SaveOP::Do(Vec::LoadUnAligned(c), EpiOP::Do(__v__)).StoreUnAligned(c);
+    m_next.template SaveEpilogue<SaveOP, EpiOP, PlusOP, MulOP>(
+        c + Vec::num, bcol != nullptr ? bcol + Vec::num : nullptr, scale, brow);
+  }
+
+  Vec m_v;
+  FixedVecs<Vec, DataType, NV - 1> m_next;
+};
+
+template<typename Vec, typename DataType>
+struct FixedVecs<Vec, DataType, 0> {
+  MGLORIA_INLINE_CPU void Zero() {}
+  MGLORIA_INLINE_CPU void Load(const DataType*) {}
+  MGLORIA_INLINE_CPU void MulAdd(const Vec&, const FixedVecs&) {}
+  MGLORIA_INLINE_CPU void Store(DataType*) const {}
+  template<typename SaveOP, typename EpiOP, typename PlusOP, typename MulOP>
+  MGLORIA_INLINE_CPU void SaveEpilogue(DataType*, const DataType*, const Vec&, const Vec&) const {}
+};
+
+/*!
+ *@brief    Rows x NV vectors of accumulators. MulAdd takes the element of op(A) of each row from
+ * a, the next row's is SAI after.
+ */
+template<typename Vec, typename DataType, index_t NV, index_t Rows>
+struct FixedTileRows {
+  MGLORIA_INLINE_CPU void Zero() {
+    m_c.Zero();
+    m_next.Zero();
+  }
+  template<index_t SAI>
+  MGLORIA_INLINE_CPU void MulAdd(const DataType* a, const FixedVecs<Vec, DataType, NV>& b) {
+    m_c.MulAdd(Vec::Fill(*a), b);
+    m_next.template MulAdd<SAI>(a + SAI, b);
+  }
+  MGLORIA_INLINE_CPU void Store(DataType* tile) const {
+    m_c.Store(tile);
+    m_next.Store(tile + NV * Vec::num);
+  }
+  template<typename SaveOP, typename EpiOP, typename PlusOP, typename MulOP>
+  MGLORIA_INLINE_CPU void SaveEpilogue(DataType* c, index_t ldc, const DataType* brow,
+                                       const DataType* bcol, const Vec& scale) const {
+    m_c.template SaveEpilogue<SaveOP, EpiOP, PlusOP, MulOP>(
+        c, bcol, scale, Vec::Fill(brow != nullptr ? *brow : DataType(0)));
+    m_next.template SaveEpilogue<SaveOP, EpiOP, PlusOP, MulOP>(
+        c + ldc, ldc, brow != nullptr ? brow + 1 : nullptr, bcol, scale);
+  }
+
+  FixedVecs<Vec, DataType, NV> m_c;
+  FixedTileRows<Vec, DataType, NV, Rows - 1> m_next;
+};
+
+template<typename Vec, typename DataType, index_t NV>
+struct FixedTileRows<Vec, DataType, NV, 0> {
+  MGLORIA_INLINE_CPU void Zero() {}
+  template<index_t SAI>
+  MGLORIA_INLINE_CPU void MulAdd(const DataType*, const FixedVecs<Vec, DataType, NV>&) {}
+  MGLORIA_INLINE_CPU void Store(DataType*) const {}
+  template<typename SaveOP, typename EpiOP, typename PlusOP, typename MulOP>
+  MGLORIA_INLINE_CPU void SaveEpilogue(DataType*, index_t, const DataType*, const DataType*,
+                                       const Vec&) const {}
+};
+
+/*!
+ *@brief    Applies the epilogue to a tile from the registers if Enable: the OP and the Saver are
+ * vectorized for Arch. Else through a buffer, element by element.
+ */
+template<bool Enable>
+struct FixedDotTileSave {
+  template<typename Saver, typename OP, vectorization::VecArch Arch, index_t Rows, index_t NV,
+           typename Acc, typename DataType>
+  MGLORIA_INLINE_CPU static void Save(const Acc& acc, DataType* c, index_t ldc,
+                                      const FixedDotArgs<DataType>& args, index_t i0, index_t j0) {
+    static const index_t __ldt__ = NV * vectorization::Vectorized<DataType, Arch>::num;
+    DataType __tile__[Rows * __ldt__] MGLORIA_ALIGNED(64);
+    acc.Store(__tile__);
+    for (index_t r = 0; r < Rows; ++r) {
+      for (index_t j = 0; j < __ldt__; ++j) {
+        FixedDotSave<Saver, OP>(c + r * ldc + j, __tile__[r * __ldt__ + j], args, i0 + r, j0 + j);
+      }
+    }
+  }
+};
+
+template<>
+struct FixedDotTileSave<true> {
+  template<typename Saver, typename OP, vectorization::VecArch Arch, index_t Rows, index_t NV,
+           typename Acc, typename DataType>
+  MGLORIA_INLINE_CPU static void Save(const Acc& acc, DataType* c, index_t ldc,
+                                      const FixedDotArgs<DataType>& args, index_t i0, index_t j0) {
+    acc.template SaveEpilogue<vectorization::VectorizedOP<typename Saver::OPType, DataType, Arch>,
+                              vectorization::VectorizedOP<OP, DataType, Arch>,
+                              vectorization::VectorizedOP<op::_plus, DataType, Arch>,
+                              vectorization::VectorizedOP<op::_mul, DataType, Arch>>(
+        c, ldc, args.m_brow != nullptr ? args.m_brow + i0 : nullptr,
+        args.m_bcol != nullptr ? args.m_bcol + j0 : nullptr,
+        vectorization::Vectorized<DataType, Arch>::Fill(args.m_scale));
+  }
+};
+
+/*!
+ *@brief    dst [M, N] Saver op(A) x B, B [K, N] not transposed. Tiles of MR rows x NV vectors,
+ * MR x NV + NV + 1 registers at most, the columns after the last vector are scalar.
+ */
+template<typename Saver, typename OP, vectorization::VecArch Arch, index_t M, index_t K,
+         index_t N, bool LT, typename DataType>
+struct FixedDotRows {
+  typedef vectorization::Vectorized<DataType, Arch> Vec;
+  static const index_t m_SAI = LT ? 1 : K;
+  static const index_t m_SAK = LT ? M : 1;
+  static const index_t m_NVAll = N / Vec::num;
+  static const index_t m_NV = m_NVAll < 2 ? 1 : 2;
+  static const index_t m_Regs = Arch == vectorization::VecArch::AVX512_Arch ? 32 : 16;
+  static const index_t m_MRRegs = (m_Regs - m_NV - 1) / m_NV;
+  static const index_t m_MRMax = m_MRRegs < 12 ? m_MRRegs : 12;
+  static const index_t m_MR = M < m_MRMax ? M : m_MRMax;
+
+  ///! The tile of Rows x NV vectors at (i0, j0).
+  template<index_t Rows, index_t NV>
+  MGLORIA_INLINE_CPU static void Tile(DataType* c, const DataType* a, const DataType* b,
+                                      const FixedDotArgs<DataType>& args, index_t i0, index_t j0) {
+    FixedTileRows<Vec, DataType, NV, Rows> __acc__;
+    __acc__.Zero();
+    const DataType* __a__ = a + i0 * m_SAI;
+    for (index_t k = 0; k < K; ++k) {
+      FixedVecs<Vec, DataType, NV> __b__;
+      __b__.Load(b + k * N + j0);
+      __acc__.template MulAdd<m_SAI>(__a__ + k * m_SAK, __b__);
+    }
+    FixedDotTileSave<vectorization::VectorizedOP<OP, DataType, Arch>::m_Enable
+                     && vectorization::VectorizedOP<typename Saver::OPType, DataType,
+                                                    Arch>::m_Enable>::
+        template Save<Saver, OP, Arch, Rows, NV>(__acc__, c + i0 * N + j0, N, args, i0, j0);
+  }
+
+  ///! The rows [i0, i0 + Rows), all the vectors of columns.
+  template<index_t Rows>
+  MGLORIA_INLINE_CPU static void Block(DataType* c, const DataType* a, const DataType* b,
+                                       const FixedDotArgs<DataType>& args, index_t i0) {
+    for (index_t v = 0; v + m_NV <= m_NVAll; v += m_NV) {
+      Tile<Rows, m_NV>(c, a, b, args, i0, v * Vec::num);
+    }
+    if (m_NVAll % m_NV != 0) { Tile<Rows, 1>(c, a, b, args, i0, (m_NVAll - 1) * Vec::num); }
+  }
+
+  MGLORIA_INLINE_CPU static void Do(DataType* c, const DataType* a, const DataType* b,
+                                    const FixedDotArgs<DataType>& args) {
+    for (index_t i0 = 0; i0 + m_MR <= M; i0 += m_MR) { Block<m_MR>(c, a, b, args, i0); }
+    // Never 0 rows, the template is instantiated even if M is a multiple of MR.
+    if (M % m_MR != 0) { Block<(M % m_MR != 0 ? M % m_MR : 1)>(c, a, b, args, M - M % m_MR); }
+    for (index_t i = 0; i < M; ++i) {
+      for (index_t j = m_NVAll * Vec::num; j < N; ++j) {
+        FixedDotSave<Saver, OP>(c + i * N + j, FixedDotAt<K, m_SAI, m_SAK, N, 1>(a, b, i, j), args,
+                                i, j);
+      }
+    }
+  }
+};
+
+/*!
+ *@brief    Cols accumulators, of the dot of a row of A with Cols rows of B, ldb apart.
+ */
+template<typename Vec, typename DataType, index_t Cols>
+struct FixedInnerCols {
+  MGLORIA_INLINE_CPU void Zero() {
+    m_acc = Vec::Fill(DataType(0));
+    m_next.Zero();
+  }
+  MGLORIA_INLINE_CPU void MulAdd(const Vec& a, const DataType* b, index_t ldb) {
+    m_acc = Vec::MulAdd(a, Vec::LoadUnAligned(b), m_acc);
+    m_next.MulAdd(a, b + ldb, ldb);
+  }
+  MGLORIA_INLINE_CPU void Sum(DataType* out) const {
+    *out = m_acc.Sum();
+    m_next.Sum(out + 1);
+  }
+
+  Vec m_acc;
+  FixedInnerCols<Vec, DataType, Cols - 1> m_next;
+};
+
+template<typename Vec, typename DataType>
+struct FixedInnerCols<Vec, DataType, 0> {
+  MGLORIA_INLINE_CPU void Zero() {}
+  MGLORIA_INLINE_CPU void MulAdd(const Vec&, const DataType*, index_t) {}
+  MGLORIA_INLINE_CPU void Sum(DataType*) const {}
+};
+
+/*!
+ *@brief    dst [M, N] Saver A x B^T, A [M, K] and B [N, K]. For each row of A, 4 columns of dst at
+ * once, the vectors along K are summed at the end and the K after the last vector is scalar.
+ */
+template<typename Saver, typename OP, vectorization::VecArch Arch, index_t M, index_t K,
+         index_t N, typename DataType>
+struct FixedDotInner {
+  typedef vectorization::Vectorized<DataType, Arch> Vec;
+  static const index_t m_JR = 4;
+  static const index_t m_KV = K / Vec::num * Vec::num;
+
+  ///! The columns [j0, j0 + Cols) of the row i.
+  template<index_t Cols>
+  MGLORIA_INLINE_CPU static void Row(DataType* c, const DataType* a, const DataType* b,
+                                     const FixedDotArgs<DataType>& args, index_t i, index_t j0) {
+    FixedInnerCols<Vec, DataType, Cols> __acc__;
+    __acc__.Zero();
+    const DataType* __a__ = a + i * K;
+    const DataType* __b__ = b + j0 * K;
+    for (index_t k = 0; k < m_KV; k += Vec::num) {
+      __acc__.MulAdd(Vec::LoadUnAligned(__a__ + k), __b__ + k, K);
+    }
+    DataType __sum__[Cols];
+    __acc__.Sum(__sum__);
+    for (index_t j = 0; j < Cols; ++j) {
+      for (index_t k = m_KV; k < K; ++k) { __sum__[j] += __a__[k] * __b__[j * K + k]; }
+      FixedDotSave<Saver, OP>(c + i * N + j0 + j, __sum__[j], args, i, j0 + j);
+    }
+  }
+
+  MGLORIA_INLINE_CPU static void Do(DataType* c, const DataType* a, const DataType* b,
+                                    const FixedDotArgs<DataType>& args) {
+    for (index_t i = 0; i < M; ++i) {
+      for (index_t j0 = 0; j0 + m_JR <= N; j0 += m_JR) { Row<m_JR>(c, a, b, args, i, j0); }
+      for (index_t j = N / m_JR * m_JR; j < N; ++j) { Row<1>(c, a, b, args, i, j); }
+    }
+  }
+};
+
+/*!
+ *@brief    dst [M, N] Saver op(A) x op(B), scalar.
+ */
+template<typename Saver, typename OP, index_t M, index_t K, index_t N, bool LT, bool RT,
+         typename DataType>
+MGLORIA_INLINE_CPU void FixedDotScalar(DataType* c, const DataType* a, const DataType* b,
+                                       const FixedDotArgs<DataType>& args) {
+  for (index_t i = 0; i < M; ++i) {
+    for (index_t j = 0; j < N; ++j) {
+      FixedDotSave<Saver, OP>(
+          c + i * N + j,
+          FixedDotAt<K, LT ? 1 : K, LT ? M : 1, RT ? 1 : N, RT ? K : 1>(a, b, i, j), args, i, j);
+    }
+  }
+}
+
+/*!
+ *@brief    Picks the kernel of a fixed dot, see the head of the file. Vec: the gemm of DataType has
+ * the vector fma on Arch (GemmVecCheck).
+ */
+template<bool Vec, bool LT, bool RT>
+struct FixedDotKernel {
+  template<typename Saver, typename OP, vectorization::VecArch Arch, index_t M, index_t K,
+           index_t N, typename DataType>
+  MGLORIA_INLINE_CPU static void Do(DataType* c, const DataType* a, const DataType* b,
+                                    const FixedDotArgs<DataType>& args) {
+    FixedDotScalar<Saver, OP, M, K, N, LT, RT>(c, a, b, args);
+  }
+};
+
+template<bool LT>
+struct FixedDotKernel<true, LT, false> {
+  template<typename Saver, typename OP, vectorization::VecArch Arch, index_t M, index_t K,
+           index_t N, typename DataType>
+  MGLORIA_INLINE_CPU static void Do(DataType* c, const DataType* a, const DataType* b,
+                                    const FixedDotArgs<DataType>& args) {
+    FixedDotRows<Saver, OP, Arch, M, K, N, LT, DataType>::Do(c, a, b, args);
+  }
+};
+
+template<>
+struct FixedDotKernel<true, false, true> {
+  template<typename Saver, typename OP, vectorization::VecArch Arch, index_t M, index_t K,
+           index_t N, typename DataType>
+  MGLORIA_INLINE_CPU static void Do(DataType* c, const DataType* a, const DataType* b,
+                                    const FixedDotArgs<DataType>& args) {
+    FixedDotInner<Saver, OP, Arch, M, K, N, DataType>::Do(c, a, b, args);
+  }
+};
+
+// ######################## Below for the roots and the dispatchers #############
+/*!
+ *@brief    The roots of the FixedTensor kernels, compiled for Arch. See VectorizedRowKernel.
+ */
+template<vectorization::VecArch Arch>
+struct FixedArchKernel {
+  template<typename Saver, index_t Rows, index_t Cols, typename E, typename DataType>
+  MGLORIA_INLINE_CPU static void Map(DataType* dst, const E& e) {
+    FixedMapVec<Saver, Rows, Cols, FixedFlatCheck<E>::m_Enable, Arch>(
+        dst, NewVectorizedJob<Arch>(e));
+  }
+  template<typename Saver, typename OP, index_t M, index_t K, index_t N, bool LT, bool RT,
+           typename DataType>
+  MGLORIA_INLINE_CPU static void Dot(DataType* c, const DataType* a, const DataType* b,
+                                     const FixedDotArgs<DataType>& args) {
+    FixedDotKernel<GemmVecCheck<DataType, Arch>::m_Enable, LT, RT>::template Do<Saver, OP, Arch,
+                                                                                M, K, N>(
+        c, a, b, args);
+  }
+};
+
+template<>
+struct FixedArchKernel<vectorization::VecArch::AVX2_Arch> {
+  template<typename Saver, index_t Rows, index_t Cols, typename E, typename DataType>
+  MGLORIA_KERNEL_AVX2 static void Map(DataType* dst, const E& e) {
+    FixedMapVec<Saver, Rows, Cols, FixedFlatCheck<E>::m_Enable, vectorization::VecArch::AVX2_Arch>(
+        dst, NewVectorizedJob<vectorization::VecArch::AVX2_Arch>(e));
+  }
+  template<typename Saver, typename OP, index_t M, index_t K, index_t N, bool LT, bool RT,
+           typename DataType>
+  MGLORIA_KERNEL_AVX2 static void Dot(DataType* c, const DataType* a, const DataType* b,
+                                      const FixedDotArgs<DataType>& args) {
+    FixedDotKernel<GemmVecCheck<DataType, vectorization::VecArch::AVX2_Arch>::m_Enable, LT, RT>::
+        template Do<Saver, OP, vectorization::VecArch::AVX2_Arch, M, K, N>(c, a, b, args);
+  }
+};
+
+template<>
+struct FixedArchKernel<vectorization::VecArch::AVX512_Arch> {
+  template<typename Saver, index_t Rows, index_t Cols, typename E, typename DataType>
+  MGLORIA_KERNEL_AVX512 static void Map(DataType* dst, const E& e) {
+    FixedMapVec<Saver, Rows, Cols, FixedFlatCheck<E>::m_Enable,
+                vectorization::VecArch::AVX512_Arch>(
+        dst, NewVectorizedJob<vectorization::VecArch::AVX512_Arch>(e));
+  }
+  template<typename Saver, typename OP, index_t M, index_t K, index_t N, bool LT, bool RT,
+           typename DataType>
+  MGLORIA_KERNEL_AVX512 static void Dot(DataType* c, const DataType* a, const DataType* b,
+                                        const FixedDotArgs<DataType>& args) {
+    FixedDotKernel<GemmVecCheck<DataType, vectorization::VecArch::AVX512_Arch>::m_Enable, LT, RT>::
+        template Do<Saver, OP, vectorization::VecArch::AVX512_Arch, M, K, N>(c, a, b, args);
+  }
+};
+
+/*!
+ *@brief    The element-wise expression on Arch if Passed (VecSaveCheck), else the scalar one.
+ */
+template<bool Passed, vectorization::VecArch Arch>
+struct FixedMapArch {
+  template<typename Saver, index_t Rows, index_t Cols, typename E, typename DataType>
+  MGLORIA_INLINE_NORMAL static void Do(DataType* dst, const E& e) {
+    FixedMapScalar<Saver, Rows, Cols, FixedFlatCheck<E>::m_Enable>(dst, NewJob(e));
+  }
+};
+
+template<vectorization::VecArch Arch>
+struct FixedMapArch<true, Arch> {
+  template<typename Saver, index_t Rows, index_t Cols, typename E, typename DataType>
+  MGLORIA_INLINE_NORMAL static void Do(DataType* dst, const E& e) {
+    FixedArchKernel<Arch>::template Map<Saver, Rows, Cols>(dst, e);
+  }
+};
+
+/*!
+ *@brief    dst Saver e, dst is the data of a Rows x Cols FixedTensor.
+ */
+template<typename Saver, index_t Rows, index_t Cols, typename E, typename DataType>
+MGLORIA_INLINE_NORMAL void FixedMap(DataType* dst, const E& e) {
+  static_assert(FixedShapeCheck<E, Rows, Cols>::m_Enable,
+                "FixedTensor: the operands must be FixedTensor of the same shape or scalars.");
+#if MGLORIA_RUNTIME_DISPATCH == 1
+  using vectorization::VecArch;
+  switch (vectorization::RuntimeVecArch()) {
+    case VecArch::AVX512_Arch: {
+      FixedMapArch<VecSaveCheck<Saver, E, DataType, VecArch::AVX512_Arch>::m_Enable,
+                   VecArch::AVX512_Arch>::template Do<Saver, Rows, Cols>(dst, e);
+      break;
+    }
+    case VecArch::AVX2_Arch: {
+      FixedMapArch<VecSaveCheck<Saver, E, DataType, VecArch::AVX2_Arch>::m_Enable,
+                   VecArch::AVX2_Arch>::template Do<Saver, Rows, Cols>(dst, e);
+      break;
+    }
+#if MGLORIA_USE_SSE == 1
+    case VecArch::SSE_Arch: {
+      FixedMapArch<VecSaveCheck<Saver, E, DataType, VecArch::SSE_Arch>::m_Enable,
+                   VecArch::SSE_Arch>::template Do<Saver, Rows, Cols>(dst, e);
+      break;
+    }
+#endif  // MGLORIA_USE_SSE == 1
+    default: {
+      FixedMapArch<false, VecArch::NONE_Arch>::template Do<Saver, Rows, Cols>(dst, e);
+      break;
+    }
+  }
+#else
+  FixedMapArch<VecSaveCheck<Saver, E, DataType, MGLORIA_VECTORIZATION_ARCH>::m_Enable,
+               MGLORIA_VECTORIZATION_ARCH>::template Do<Saver, Rows, Cols>(dst, e);
+#endif  // MGLORIA_RUNTIME_DISPATCH == 1
+}
+
+/*!
+ *@brief    Saves the expressions to a FixedTensor. The element-wise ones by FixedMap, the complex
+ * ones by their ExpressionComplexDispatcher.
+ */
+template<typename Saver, index_t Rows, index_t Cols, typename DataType>
+struct ExpressionDispatcher<Saver, FixedTensor<Rows, Cols, DataType>, DataType> {
+  typedef FixedTensor<Rows, Cols, DataType> RValue;
+
+  template<typename E>
+  MGLORIA_INLINE_NORMAL static void Eval(RValue* dst,
+                                         const Expression<E, DataType, Mapped_t>& exp) {
+    FixedMap<Saver, Rows, Cols>(dst->m_Data, exp.Self());
+  }
+
+  template<typename E>
+  MGLORIA_INLINE_NORMAL static void Eval(RValue* dst,
+                                         const Expression<E, DataType, Chained_t>& exp) {
+    FixedMap<Saver, Rows, Cols>(dst->m_Data, exp.Self());
+  }
+
+  template<typename E>
+  MGLORIA_INLINE_NORMAL static void Eval(RValue* dst,
+                                         const Expression<E, DataType, RValue_t>& exp) {
+    FixedMap<Saver, Rows, Cols>(dst->m_Data, exp.Self());
+  }
+
+  template<typename E>
+  MGLORIA_INLINE_NORMAL static void Eval(RValue* dst,
+                                         const Expression<E, DataType, Complex_t>& exp) {
+    ExpressionComplexDispatcher<Saver, RValue, E, DataType>::Eval(dst, exp);
+  }
+};
+
+/*!
+ *@brief    The dispatcher of DotExpr on FixedTensor, [M, K] x [K, N]. The shapes are checked at
+ * compile time, only the size of a bias is checked at runtime.
+ */
+template<typename Saver, index_t M, index_t N, index_t AR, index_t AC, index_t BR, index_t BC,
+         bool LeftTransposed, bool RightTransposed, typename DataType, typename EpilogueOP>
+struct ExpressionComplexDispatcher<
+    Saver, FixedTensor<M, N, DataType>,
+    DotExpr<FixedTensor<AR, AC, DataType>, FixedTensor<BR, BC, DataType>, LeftTransposed,
+            RightTransposed, DataType, EpilogueOP>,
+    DataType> {
+  typedef DotExpr<FixedTensor<AR, AC, DataType>, FixedTensor<BR, BC, DataType>, LeftTransposed,
+                  RightTransposed, DataType, EpilogueOP>
+      E;
+  static const index_t m_K = LeftTransposed ? AR : AC;
+  static_assert((LeftTransposed ? AC : AR) == M && (RightTransposed ? BR : BC) == N
+                    && (RightTransposed ? BC : BR) == m_K,
+                "dot: the shapes of the FixedTensor do not match.");
+
+  MGLORIA_INLINE_NORMAL static void Eval(FixedTensor<M, N, DataType>* dst,
+                                         const Expression<E, DataType, Complex_t>& exp) {
+    const E& e = exp.Self();
+    if (e.m_bias != nullptr) {
+      CHECK_EQUAL(e.m_bias_size, e.m_bias_axis == 0 ? M : N, " dot: the bias of axis ",
+                  e.m_bias_axis, " Shape_Dst=", dst->GetShape().str());
+    }
+    const FixedDotArgs<DataType> __args__ = {e.m_scale,
+                                            e.m_bias_axis == 0 ? e.m_bias : nullptr,
+                                            e.m_bias_axis == 0 ? nullptr : e.m_bias};
+#if MGLORIA_RUNTIME_DISPATCH == 1
+    using vectorization::VecArch;
+    switch (vectorization::RuntimeVecArch()) {
+      case VecArch::AVX512_Arch: {
+        FixedArchKernel<VecArch::AVX512_Arch>::template Dot<Saver, EpilogueOP, M, m_K, N,
+                                                            LeftTransposed, RightTransposed>(
+            dst->m_Data, e.m_a.m_Data, e.m_b.m_Data, __args__);
+        break;
+      }
+      case VecArch::AVX2_Arch: {
+        FixedArchKernel<VecArch::AVX2_Arch>::template Dot<Saver, EpilogueOP, M, m_K, N,
+                                                          LeftTransposed, RightTransposed>(
+            dst->m_Data, e.m_a.m_Data, e.m_b.m_Data, __args__);
+        break;
+      }
+#if MGLORIA_USE_SSE == 1
+      case VecArch::SSE_Arch: {
+        FixedArchKernel<VecArch::SSE_Arch>::template Dot<Saver, EpilogueOP, M, m_K, N,
+                                                         LeftTransposed, RightTransposed>(
+            dst->m_Data, e.m_a.m_Data, e.m_b.m_Data, __args__);
+        break;
+      }
+#endif  // MGLORIA_USE_SSE == 1
+      default: {
+        FixedDotScalar<Saver, EpilogueOP, M, m_K, N, LeftTransposed, RightTransposed>(
+            dst->m_Data, e.m_a.m_Data, e.m_b.m_Data, __args__);
+        break;
+      }
+    }
+#else
+    FixedArchKernel<MGLORIA_VECTORIZATION_ARCH>::template Dot<Saver, EpilogueOP, M, m_K, N,
+                                                              LeftTransposed, RightTransposed>(
+        dst->m_Data, e.m_a.m_Data, e.m_b.m_Data, __args__);
+#endif  // MGLORIA_RUNTIME_DISPATCH == 1
+  }
+};
+
+}  // namespace expr
+
+// ############################### Below for Vectorization Enable check. #####################
+template<index_t Rows, index_t Cols, typename DataType, vectorization::VecArch Arch>
+struct VecCheck<FixedTensor<Rows, Cols, DataType>, Arch> {
+  static const bool m_Enable = VecCheck<DataType, Arch>::m_Enable;
+};
+
+}  // namespace mgloria
+
+#endif  // _MGLORIA___OP_FIXED_CPU_HPP_
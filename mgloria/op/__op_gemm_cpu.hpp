@@ -72,13 +72,92 @@ MGLORIA_INLINE_NORMAL ImplicitGemmExpr<LExpr, RExpr, DataType> implicit_dot(
 }
 
 /*!
- *@brief
+ *@brief    The kernel of a block of the implicit gemm, out[rows x cols] += a[rows x kc] x
+ * b[kc x cols]. All three have a row every MGLORIA_JOB_TILE_COLS. The vector one runs over the
+ * columns rounded up to the vector, the pad columns of b must be 0.
+ */
+template<bool Vec>
+struct ImplicitGemmTileKernel {
+  template<typename DataType>
+  MGLORIA_INLINE_NORMAL static index_t Padded(index_t cols) {
+    return cols;
+  }
+
+  template<typename DataType>
+  MGLORIA_INLINE_NORMAL static void Run(const DataType* a, const DataType* b, DataType* out,
+                                        index_t rows, index_t cols, index_t kc) {
+    for (index_t r = 0; r < rows; ++r) {
+      DataType* __row__ = out + r * MGLORIA_JOB_TILE_COLS;
+      for (index_t k = 0; k < kc; ++k) {
+        const DataType __a__ = a[r * MGLORIA_JOB_TILE_COLS + k];
+        const DataType* __b__ = b + k * MGLORIA_JOB_TILE_COLS;
+        for (index_t c = 0; c < cols; ++c) { __row__[c] += __a__ * __b__[c]; }
+      }
+    }
+  }
+};
+
+template<>
+struct ImplicitGemmTileKernel<true> {
+  template<typename DataType>
+  MGLORIA_INLINE_NORMAL static index_t Padded(index_t cols) {
+    const index_t n = vectorization::Vectorized<DataType>::num;
+    return (cols + n - 1) / n * n;
+  }
+
+  template<typename DataType>
+  MGLORIA_INLINE_NORMAL static void Run(const DataType* a, const DataType* b, DataType* out,
+                                        index_t rows, index_t cols, index_t kc) {
+    typedef vectorization::Vectorized<DataType> V;
+    const index_t n = V::num;
+    for (index_t r = 0; r < rows; ++r) {
+      DataType* __row__ = out + r * MGLORIA_JOB_TILE_COLS;
+      const DataType* __a__ = a + r * MGLORIA_JOB_TILE_COLS;
+      index_t c = 0;
+      // Four vectors of a row are kept in registers over all of kc.
+      for (; c + 4 * n <= cols; c += 4 * n) {
+        V c0 = V::Load(__row__ + c), c1 = V::Load(__row__ + c + n);
+        V c2 = V::Load(__row__ + c + 2 * n), c3 = V::Load(__row__ + c + 3 * n);
+        for (index_t k = 0; k < kc; ++k) {
+          const V __av__ = V::Fill(__a__[k]);
+          const DataType* __b__ = b + k * MGLORIA_JOB_TILE_COLS + c;
+          c0 = V::MulAdd(__av__, V::Load(__b__), c0);
+          c1 = V::MulAdd(__av__, V::Load(__b__ + n), c1);
+          c2 = V::MulAdd(__av__, V::Load(__b__ + 2 * n), c2);
+          c3 = V::MulAdd(__av__, V::Load(__b__ + 3 * n), c3);
+        }
+        c0.Store(__row__ + c);
+        c1.Store(__row__ + c + n);
+        c2.Store(__row__ + c + 2 * n);
+        c3.Store(__row__ + c + 3 * n);
+      }
+      for (; c < cols; c += n) {
+        V c0 = V::Load(__row__ + c);
+        for (index_t k = 0; k < kc; ++k) {
+          c0 = V::MulAdd(V::Fill(__a__[k]), V::Load(b + k * MGLORIA_JOB_TILE_COLS + c), c0);
+        }
+        c0.Store(__row__ + c);
+      }
+    }
+  }
+};
+
+template<typename LExpr, typename RExpr, typename DataType>
+struct JobTileCheck<ImplicitGemmExpr<LExpr, RExpr, DataType>> {
+  static const bool m_Enable = true;
+};
+
+/*!
+ *@brief    Eval computes one element, reading a row of lhs and a column of rhs. EvalTile computes
+ * a block: for each MGLORIA_JOB_TILE_COLS of K, the block of lhs and the rows of rhs are gathered
+ * once into L1 buffers, by their own EvalTile if they have one, and each is then reused for all
+ * the columns or rows of the block.
  */
 template<typename LExpr, typename RExpr, typename DataType>
 struct Job<ImplicitGemmExpr<LExpr, RExpr, DataType>, DataType> {
   explicit Job(const ImplicitGemmExpr<LExpr, RExpr, DataType>& e)
-      : m_lhs(e.m_lhs),
-        m_rhs(e.m_rhs),
+      : m_lhs(NewJob(e.m_lhs)),
+        m_rhs(NewJob(e.m_rhs)),
         m_internal_size(e.m_internal_size),
         m_internal_size_floor_aligned(
             vectorization::FloorAlign<MGLORIA_VECTORIZATION_ARCH, DataType>(e.m_internal_size)) {}
@@ -92,9 +171,8 @@ struct Job<ImplicitGemmExpr<LExpr, RExpr, DataType>, DataType> {
     for (index_t i = 0; i < m_internal_size_floor_aligned; i += __vec_size__) {
       for (index_t j = 0; j < __vec_size__; ++j) { __lhs__[j] = m_lhs.Eval(y, i + j); }
       for (index_t j = 0; j < __vec_size__; ++j) { __rhs__[j] = m_rhs.Eval(i + j, x); }
-      __vec__ = __vec__
-                + Vectorized<DataType>::LoadUnAligned(__lhs__)
-                      * Vectorized<DataType>::LoadUnAligned(__rhs__);
+      __vec__ = Vectorized<DataType>::MulAdd(Vectorized<DataType>::LoadUnAligned(__lhs__),
+                                             Vectorized<DataType>::LoadUnAligned(__rhs__), __vec__);
     }
 
     DataType res = __vec__.Sum();
@@ -105,6 +183,36 @@ struct Job<ImplicitGemmExpr<LExpr, RExpr, DataType>, DataType> {
     return res;
   }
 
+  MGLORIA_INLINE_NORMAL void EvalTile(index_t y0, index_t x0, index_t rows, index_t cols,
+                                      DataType* out) const {
+    typedef ImplicitGemmTileKernel<
+        MGLORIA_VECTORIZATION_ARCH != vectorization::VecArch::NONE_Arch
+        && vectorization::VectorizedOP<op::_fma, DataType, MGLORIA_VECTORIZATION_ARCH>::m_Enable>
+        Kern;
+    const index_t __padded__ = Kern::template Padded<DataType>(cols);
+    alignas(64) DataType __a__[MGLORIA_JOB_TILE_ROWS * MGLORIA_JOB_TILE_COLS];
+    alignas(64) DataType __b__[MGLORIA_JOB_TILE_COLS * MGLORIA_JOB_TILE_COLS];
+    for (index_t r = 0; r < rows; ++r) {
+      for (index_t c = 0; c < __padded__; ++c) { out[r * MGLORIA_JOB_TILE_COLS + c] = DataType(0); }
+    }
+    for (index_t k0 = 0; k0 < m_internal_size; k0 += MGLORIA_JOB_TILE_COLS) {
+      const index_t kc = m_internal_size - k0 < MGLORIA_JOB_TILE_COLS ? m_internal_size - k0
+                                                                       : MGLORIA_JOB_TILE_COLS;
+      JobTile<JobTileCheck<LExpr>::m_Enable>::Eval(m_lhs, y0, k0, rows, kc, __a__);
+      for (index_t k = 0; k < kc; k += MGLORIA_JOB_TILE_ROWS) {
+        const index_t kn = kc - k < MGLORIA_JOB_TILE_ROWS ? kc - k : MGLORIA_JOB_TILE_ROWS;
+        JobTile<JobTileCheck<RExpr>::m_Enable>::Eval(m_rhs, k0 + k, x0, kn, cols,
+                                                     __b__ + k * MGLORIA_JOB_TILE_COLS);
+      }
+      for (index_t k = 0; k < kc; ++k) {
+        for (index_t c = cols; c < __padded__; ++c) {
+          __b__[k * MGLORIA_JOB_TILE_COLS + c] = DataType(0);
+        }
+      }
+      Kern::Run(__a__, __b__, out, rows, __padded__, kc);
+    }
+  }
+
  private:
   Job<LExpr, DataType> m_lhs;
   Job<RExpr, DataType> m_rhs;
@@ -0,0 +1,507 @@
+/*!
+ *@author chenghua.wang
+ *@file   op/__op_qdot_cpu.hpp
+ *@brief  The quantized dot of CPU tensors, uint8_t x int8_t summed in int32_t. See QuantDotExpr.
+ *@details The two k of a pair are widened to int16 and held in one int32 word, a with its zero
+ * point taken off already. The micro kernel is the one of the float gemm on int32 lanes, with
+ * MulAddPairs (pmaddwd, vpdpwssd with AVX512-VNNI) as the multiply add, so one instruction does
+ * two k of a column. The products fit in int16 x int16 and the pair sums in int32, nothing
+ * saturates as with pmaddubsw on the full range of uint8_t and int8_t.
+ *
+ * lhs is packed once into panels of MR rows. A task owns an MC x NC block of dst and packs the
+ * NR columns of rhs it is on into its own panel right before using it, so the weights are read
+ * from memory as int8_t and the wider panel stays in cache. The tile is summed over all of K in
+ * registers and requantized to dst once.
+ *
+ * With fewer rows than MR and rhs as W.T(), the weights [N, K] of a linear layer, the panels are
+ * not worth packing: each row of W is widened in registers as it is read, see QuantGemvKernel.
+ */
+
+#ifndef _MGLORIA___OP_QDOT_CPU_HPP_
+#define _MGLORIA___OP_QDOT_CPU_HPP_
+
+#pragma once
+
+#include "__op_dot_cpu.hpp"
+#include <cmath>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace mgloria {
+namespace expr {
+
+///! Two int16 in one word, lo in the low half.
+MGLORIA_INLINE_CPU int32_t QuantPair(int32_t lo, int32_t hi) {
+  return static_cast<int32_t>((static_cast<uint32_t>(hi) << 16)
+                              | (static_cast<uint32_t>(lo) & 0xffffu));
+}
+
+MGLORIA_INLINE_CPU int32_t QuantPairLo(int32_t w) {
+  return static_cast<int16_t>(static_cast<uint32_t>(w) & 0xffffu);
+}
+
+MGLORIA_INLINE_CPU int32_t QuantPairHi(int32_t w) {
+  return static_cast<int16_t>(static_cast<uint32_t>(w) >> 16);
+}
+
+/*!
+ *@brief    The requantization of an int32_t sum to DisDataType, see QuantDotExpr.
+ */
+template<typename DisDataType>
+struct QuantRequant {
+  MGLORIA_INLINE_CPU static int32_t Do(int32_t v, float, int32_t) { return v; }
+};
+
+template<>
+struct QuantRequant<float> {
+  MGLORIA_INLINE_CPU static float Do(int32_t v, float scale, int32_t) {
+    return scale * static_cast<float>(v);
+  }
+};
+
+template<>
+struct QuantRequant<int8_t> {
+  MGLORIA_INLINE_CPU static int8_t Do(int32_t v, float scale, int32_t zero) {
+    // Round half to even, as the float to int of the vector units.
+    const long __q__ = std::lrint(scale * static_cast<float>(v)) + zero;
+    return static_cast<int8_t>(__q__ < -128 ? -128 : (__q__ > 127 ? 127 : __q__));
+  }
+};
+
+/*!
+ *@brief    The epilogue of a quantized dot. m_scale is one per column of dst, or nullptr and
+ * m_scale_value for all.
+ */
+template<typename DisDataType>
+struct QuantDotEpilogue {
+  const float* m_scale;
+  float m_scale_value;
+  int32_t m_zero;
+};
+
+/*!
+ *@brief    Requantizes the mr x nr corner of a tile and applies it to c. scol is the scale of the
+ * first column of the tile, or nullptr.
+ */
+template<typename Saver, typename DisDataType>
+MGLORIA_INLINE_CPU void QuantDotSave(const int32_t* tile, index_t ldt, DisDataType* c,
+                                     index_t ldc, index_t mr, index_t nr, const float* scol,
+                                     const QuantDotEpilogue<DisDataType>& epi) {
+  for (index_t i = 0; i < mr; ++i) {
+    for (index_t j = 0; j < nr; ++j) {
+      const float __s__ = scol != nullptr ? scol[j] : epi.m_scale_value;
+      Saver::template Do<DisDataType>(
+          c[i * ldc + j], QuantRequant<DisDataType>::Do(tile[i * ldt + j], __s__, epi.m_zero));
+    }
+  }
+}
+
+/*!
+ *@brief    The int32 lanes of Arch with MulAddPairs as MulAdd, for the GemmTileRows.
+ */
+template<vectorization::VecArch Arch>
+struct QuantPairVec : public vectorization::Vectorized<int32_t, Arch> {
+  typedef vectorization::Vectorized<int32_t, Arch> Base;
+  QuantPairVec() = default;
+  MGLORIA_INLINE_CPU QuantPairVec(const Base& v) : Base(v) {}
+
+  MGLORIA_INLINE_CPU static QuantPairVec Fill(int32_t s) { return Base::Fill(s); }
+  MGLORIA_INLINE_CPU static QuantPairVec LoadUnAligned(const int32_t* s) {
+    return Base::LoadUnAligned(s);
+  }
+  MGLORIA_INLINE_CPU static QuantPairVec MulAdd(const QuantPairVec& a, const QuantPairVec& b,
+                                                const QuantPairVec& c) {
+    return Base::MulAddPairs(a, b, c);
+  }
+};
+
+/*!
+ *@brief    The micro kernel. Tile<Rows> sums the first Rows rows of a (kp x MR pairs) times b
+ * (kp x NR pairs) into tile, Rows x NR with the row pitch NR.
+ */
+template<vectorization::VecArch Arch, bool Vec>
+struct QuantGemmKernel {
+  static const index_t m_MR = 4;
+  static const index_t m_NR = 4;
+
+  template<int Rows>
+  MGLORIA_INLINE_CPU static void Tile(index_t kp, const int32_t* a, const int32_t* b,
+                                      int32_t* tile) {
+    int32_t __acc__[Rows * m_NR] = {0};
+    for (index_t p = 0; p < kp; ++p, a += m_MR, b += m_NR) {
+      for (index_t i = 0; i < Rows; ++i) {
+        const int32_t __lo__ = QuantPairLo(a[i]), __hi__ = QuantPairHi(a[i]);
+        for (index_t j = 0; j < m_NR; ++j) {
+          __acc__[i * m_NR + j] += __lo__ * QuantPairLo(b[j]) + __hi__ * QuantPairHi(b[j]);
+        }
+      }
+    }
+    for (index_t i = 0; i < Rows * m_NR; ++i) { tile[i] = __acc__[i]; }
+  }
+};
+
+/*!
+ *@brief    Two vectors of columns by MR rows, as GemmKernel.
+ */
+template<vectorization::VecArch Arch>
+struct QuantGemmKernel<Arch, true> {
+  typedef QuantPairVec<Arch> Vec;
+  static const index_t m_MR = Arch == vectorization::VecArch::AVX512_Arch ? 12 : 6;
+  static const index_t m_NR = 2 * Vec::num;
+
+  template<int Rows>
+  MGLORIA_INLINE_CPU static void Tile(index_t kp, const int32_t* a, const int32_t* b,
+                                      int32_t* tile) {
+    GemmTileRows<Vec, int32_t, Rows> __acc__;
+    __acc__.Zero();
+    for (index_t p = 0; p < kp; ++p, a += m_MR, b += m_NR) {
+      __acc__.MulAdd(a, Vec::LoadUnAligned(b), Vec::LoadUnAligned(b + Vec::num));
+    }
+    __acc__.Store(tile);
+  }
+};
+
+/*!
+ *@brief    Adds the pairs from p0 on of a row of lhs times four rows of rhs to out, in scalar.
+ */
+MGLORIA_INLINE_CPU void QuantGemvTail(index_t p0, index_t K, const int32_t* a,
+                                      const int8_t* const* b, int32_t* out) {
+  for (index_t p = p0; 2 * p < K; ++p) {
+    const int32_t __lo__ = QuantPairLo(a[p]), __hi__ = QuantPairHi(a[p]);
+    for (int r = 0; r < 4; ++r) {
+      out[r] += __lo__ * b[r][2 * p] + (2 * p + 1 < K ? __hi__ * b[r][2 * p + 1] : 0);
+    }
+  }
+}
+
+/*!
+ *@brief    The dot of a row of lhs, packed as QuantPackPanel with R 1, with four rows b[r] of
+ * rhs [N, K]. rhs is read as int8_t where it is, for a few rows of lhs the panels of rhs would
+ * cost more to pack than they save.
+ */
+template<vectorization::VecArch Arch, bool Vec>
+struct QuantGemvKernel {
+  MGLORIA_INLINE_CPU static void Row4(index_t K, const int32_t* a, const int8_t* const* b,
+                                      int32_t* out) {
+    out[0] = out[1] = out[2] = out[3] = 0;
+    QuantGemvTail(0, K, a, b, out);
+  }
+};
+
+template<vectorization::VecArch Arch>
+struct QuantGemvKernel<Arch, true> {
+  typedef vectorization::Vectorized<int32_t, Arch> Vec;
+
+  MGLORIA_INLINE_CPU static void Row4(index_t K, const int32_t* a, const int8_t* const* b,
+                                      int32_t* out) {
+    // The pairs of whole vectors, the rest is in scalar.
+    const index_t kv = K / (2 * Vec::num) * Vec::num;
+    Vec __c0__ = Vec::Fill(0), __c1__ = Vec::Fill(0), __c2__ = Vec::Fill(0),
+        __c3__ = Vec::Fill(0);
+    for (index_t p = 0; p < kv; p += Vec::num) {
+      const Vec __a__ = Vec::LoadUnAligned(a + p);
+      __c0__ = Vec::MulAddPairs(__a__, Vec::LoadPairs(b[0] + 2 * p), __c0__);
+      __c1__ = Vec::MulAddPairs(__a__, Vec::LoadPairs(b[1] + 2 * p), __c1__);
+      __c2__ = Vec::MulAddPairs(__a__, Vec::LoadPairs(b[2] + 2 * p), __c2__);
+      __c3__ = Vec::MulAddPairs(__a__, Vec::LoadPairs(b[3] + 2 * p), __c3__);
+    }
+    out[0] = __c0__.Sum();
+    out[1] = __c1__.Sum();
+    out[2] = __c2__.Sum();
+    out[3] = __c3__.Sum();
+    QuantGemvTail(kv, K, a, b, out);
+  }
+};
+
+/*!
+ *@brief    Pack rows [r0, r0 + rn) of op(src) [rows, K] into a panel of R rows, the pair p of
+ * row r is at dst[p * R + r]. zero is taken off each element. The rows from rn to R and the odd
+ * k at the end are 0.
+ *@tparam   RowMajor the element (r, k) is src[r * ld + k], else src[k * ld + r].
+ */
+template<bool RowMajor, typename DataType>
+MGLORIA_INLINE_CPU void QuantPackPanel(int32_t* dst, const DataType* src, index_t ld, index_t r0,
+                                       index_t rn, index_t R, index_t K, int32_t zero) {
+  const index_t kp = (K + 1) / 2, k2 = K / 2;
+  if (RowMajor) {
+    for (index_t r = 0; r < rn; ++r) {
+      const DataType* __row__ = src + (r0 + r) * ld;
+      for (index_t p = 0; p < k2; ++p) {
+        dst[p * R + r] =
+            QuantPair(int32_t(__row__[2 * p]) - zero, int32_t(__row__[2 * p + 1]) - zero);
+      }
+      if (k2 < kp) { dst[k2 * R + r] = QuantPair(int32_t(__row__[K - 1]) - zero, 0); }
+    }
+  } else {
+    for (index_t p = 0; p < kp; ++p) {
+      const DataType* __lo__ = src + 2 * p * ld + r0;
+      if (p < k2) {
+        const DataType* __hi__ = __lo__ + ld;
+        for (index_t r = 0; r < rn; ++r) {
+          dst[p * R + r] = QuantPair(int32_t(__lo__[r]) - zero, int32_t(__hi__[r]) - zero);
+        }
+      } else {
+        for (index_t r = 0; r < rn; ++r) {
+          dst[p * R + r] = QuantPair(int32_t(__lo__[r]) - zero, 0);
+        }
+      }
+    }
+  }
+  for (index_t p = 0; p < kp; ++p) {
+    for (index_t r = rn; r < R; ++r) { dst[p * R + r] = 0; }
+  }
+}
+
+/*!
+ *@brief    The MC x NC block of dst at (i0, j0). pb is the panel of the task, NR x kp pairs.
+ */
+template<typename Kern, typename Saver, bool RightTransposed, typename DisDataType>
+MGLORIA_INLINE_CPU void QuantGemmBlock(DisDataType* c, index_t ldc, const int32_t* pa,
+                                       const int8_t* b, index_t ldb, int32_t* pb, index_t i0,
+                                       index_t mc, index_t j0, index_t nc, index_t K,
+                                       const QuantDotEpilogue<DisDataType>& epi) {
+  const index_t MR = Kern::m_MR, NR = Kern::m_NR, kp = (K + 1) / 2;
+  int32_t __tile__[Kern::m_MR * Kern::m_NR] MGLORIA_ALIGNED(64);
+  for (index_t jr = j0; jr < j0 + nc; jr += NR) {
+    const index_t nr = j0 + nc - jr < NR ? j0 + nc - jr : NR;
+    QuantPackPanel<RightTransposed>(pb, b, ldb, jr, nr, NR, K, 0);
+    const float* scol = epi.m_scale != nullptr ? epi.m_scale + jr : nullptr;
+    for (index_t ir = i0; ir < i0 + mc; ir += MR) {
+      const index_t mr = i0 + mc - ir < MR ? i0 + mc - ir : MR;
+      const int32_t* __a__ = pa + ir * kp;
+      if (mr == MR) {
+        Kern::template Tile<Kern::m_MR>(kp, __a__, pb, __tile__);
+      } else {
+        // Row by row, a single row as of batch 1 does not pay for MR.
+        for (index_t i = 0; i < mr; ++i) {
+          Kern::template Tile<1>(kp, __a__ + i, pb, __tile__ + i * NR);
+        }
+      }
+      QuantDotSave<Saver>(__tile__, NR, c + ir * ldc + jr, ldc, mr, nr, scol, epi);
+    }
+  }
+}
+
+/*!
+ *@brief    The columns [j0, j0 + nc) of all the M rows of dst, rhs [N, K]. pa holds the rows of
+ * lhs one after the other, kp pairs each.
+ */
+template<typename Kern, typename Saver, typename DisDataType>
+MGLORIA_INLINE_CPU void QuantGemvBlock(DisDataType* c, index_t ldc, const int32_t* pa, index_t M,
+                                       const int8_t* b, index_t ldb, index_t j0, index_t nc,
+                                       index_t K, const QuantDotEpilogue<DisDataType>& epi) {
+  const index_t kp = (K + 1) / 2;
+  int32_t __out__[4];
+  for (index_t j = j0; j < j0 + nc; j += 4) {
+    const index_t nr = j0 + nc - j < 4 ? j0 + nc - j : 4;
+    // The rows past N are the first one again, their sums are not saved.
+    const int8_t* __b__[4];
+    for (index_t r = 0; r < 4; ++r) { __b__[r] = b + (j + (r < nr ? r : 0)) * ldb; }
+    const float* scol = epi.m_scale != nullptr ? epi.m_scale + j : nullptr;
+    for (index_t i = 0; i < M; ++i) {
+      Kern::Row4(K, pa + i * kp, __b__, __out__);
+      QuantDotSave<Saver>(__out__, 4, c + i * ldc + j, ldc, 1, nr, scol, epi);
+    }
+  }
+}
+
+/*!
+ *@brief    The roots of the quantized gemm kernel, compiled for Arch. See GemmArchKernel.
+ */
+template<vectorization::VecArch Arch>
+struct QuantGemmArchKernel {
+  template<typename Kern, typename Saver, bool RightTransposed, typename DisDataType>
+  MGLORIA_INLINE_CPU static void Block(DisDataType* c, index_t ldc, const int32_t* pa,
+                                       const int8_t* b, index_t ldb, int32_t* pb, index_t i0,
+                                       index_t mc, index_t j0, index_t nc, index_t K,
+                                       const QuantDotEpilogue<DisDataType>& epi) {
+    QuantGemmBlock<Kern, Saver, RightTransposed>(c, ldc, pa, b, ldb, pb, i0, mc, j0, nc, K, epi);
+  }
+
+  template<typename Kern, typename Saver, typename DisDataType>
+  MGLORIA_INLINE_CPU static void Gemv(DisDataType* c, index_t ldc, const int32_t* pa, index_t M,
+                                      const int8_t* b, index_t ldb, index_t j0, index_t nc,
+                                      index_t K, const QuantDotEpilogue<DisDataType>& epi) {
+    QuantGemvBlock<Kern, Saver>(c, ldc, pa, M, b, ldb, j0, nc, K, epi);
+  }
+};
+
+template<>
+struct QuantGemmArchKernel<vectorization::VecArch::AVX2_Arch> {
+  template<typename Kern, typename Saver, bool RightTransposed, typename DisDataType>
+  MGLORIA_KERNEL_AVX2 static void Block(DisDataType* c, index_t ldc, const int32_t* pa,
+                                        const int8_t* b, index_t ldb, int32_t* pb, index_t i0,
+                                        index_t mc, index_t j0, index_t nc, index_t K,
+                                        const QuantDotEpilogue<DisDataType>& epi) {
+    QuantGemmBlock<Kern, Saver, RightTransposed>(c, ldc, pa, b, ldb, pb, i0, mc, j0, nc, K, epi);
+  }
+
+  template<typename Kern, typename Saver, typename DisDataType>
+  MGLORIA_KERNEL_AVX2 static void Gemv(DisDataType* c, index_t ldc, const int32_t* pa, index_t M,
+                                       const int8_t* b, index_t ldb, index_t j0, index_t nc,
+                                       index_t K, const QuantDotEpilogue<DisDataType>& epi) {
+    QuantGemvBlock<Kern, Saver>(c, ldc, pa, M, b, ldb, j0, nc, K, epi);
+  }
+};
+
+template<>
+struct QuantGemmArchKernel<vectorization::VecArch::AVX512_Arch> {
+  template<typename Kern, typename Saver, bool RightTransposed, typename DisDataType>
+  MGLORIA_KERNEL_AVX512 static void Block(DisDataType* c, index_t ldc, const int32_t* pa,
+                                          const int8_t* b, index_t ldb, int32_t* pb, index_t i0,
+                                          index_t mc, index_t j0, index_t nc, index_t K,
+                                          const QuantDotEpilogue<DisDataType>& epi) {
+    QuantGemmBlock<Kern, Saver, RightTransposed>(c, ldc, pa, b, ldb, pb, i0, mc, j0, nc, K, epi);
+  }
+
+  template<typename Kern, typename Saver, typename DisDataType>
+  MGLORIA_KERNEL_AVX512 static void Gemv(DisDataType* c, index_t ldc, const int32_t* pa, index_t M,
+                                         const int8_t* b, index_t ldb, index_t j0, index_t nc,
+                                         index_t K, const QuantDotEpilogue<DisDataType>& epi) {
+    QuantGemvBlock<Kern, Saver>(c, ldc, pa, M, b, ldb, j0, nc, K, epi);
+  }
+};
+
+/*!
+ *@brief    Check the shapes, pack lhs and run the blocks with Arch.
+ */
+template<typename Saver, vectorization::VecArch Arch, bool RightTransposed, typename DisDataType>
+MGLORIA_INLINE_NORMAL void ExecuteQuantDot(Tensor<CPU, 2, DisDataType> dst,
+                                           const Tensor<CPU, 2, uint8_t>& lhs,
+                                           const Tensor<CPU, 2, int8_t>& rhs, int32_t a_zero,
+                                           const QuantDotEpilogue<DisDataType>& epi) {
+  typedef QuantGemmKernel<Arch, Arch != vectorization::VecArch::NONE_Arch> Kern;
+  const index_t M = lhs.size(0), K = lhs.size(1);
+  const index_t N = RightTransposed ? rhs.size(0) : rhs.size(1);
+  const index_t KR = RightTransposed ? rhs.size(1) : rhs.size(0);
+  LOG_CHECK(K == KR, " dot: Shape_Left=", lhs.m_Shape.str(), " Shape_Right=", rhs.m_Shape.str(),
+            " rhs_transposed=", RightTransposed);
+  LOG_CHECK(dst.size(0) == M && dst.size(1) == N, " dot: Shape_Dst=", dst.m_Shape.str(),
+            " M=", M, " N=", N);
+  if (M == 0 || N == 0) { return; }
+
+  const index_t MR = Kern::m_MR, NR = Kern::m_NR, kp = (K + 1) / 2;
+  index_t __threads__ = 1;
+#ifdef _OPENMP
+  __threads__ = omp_get_max_threads();
+#endif
+  WorkspaceScope __ws__(dst.m_Stream);
+  if (RightTransposed && M < MR) {
+    // A few rows, as of a batch 1 inference, see QuantGemvKernel. The tasks split the columns.
+    typedef QuantGemvKernel<Arch, Arch != vectorization::VecArch::NONE_Arch> Gemv;
+    int32_t* __pa__ = __ws__.Alloc<int32_t>(size_t(M) * (kp + 1));
+    for (index_t i = 0; i < M; ++i) {
+      QuantPackPanel<true>(__pa__ + size_t(i) * kp, lhs.__data_ptr, lhs.m_Stride_, i, 1, 1, K,
+                           a_zero);
+    }
+    index_t nc = ((N + 4 * __threads__ - 1) / (4 * __threads__) + 3) / 4 * 4;
+    nc = nc < 64 ? 64 : nc;
+    const index_t nblocks = (N + nc - 1) / nc;
+#ifndef __CUDACC__
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for (openmp_index_t t = 0; t < nblocks; ++t) {
+      const index_t j0 = t * nc;
+      QuantGemmArchKernel<Arch>::template Gemv<Gemv, Saver>(
+          dst.__data_ptr, dst.m_Stride_, __pa__, M, rhs.__data_ptr, rhs.m_Stride_, j0,
+          N - j0 < nc ? N - j0 : nc, K, epi);
+    }
+    return;
+  }
+
+  // All of K is summed in the registers, MC is chosen for the lhs block of all of K in half L2.
+  GemmBlocking __blk__ = GemmDefaultBlocking<Kern, int32_t>(M, N);
+  const index_t mc = kp == 0 ? M : index_t(MGLORIA_GEMM_L2_BYTES / 2 / (kp * sizeof(int32_t)));
+  __blk__.m_MC = mc / MR * MR < MR ? MR : mc / MR * MR;
+  __blk__.m_KC = kp;
+
+  const index_t mpad = (M + MR - 1) / MR * MR;
+  // One more pair so that an empty K still has a buffer.
+  int32_t* __pa__ = __ws__.Alloc<int32_t>(size_t(mpad) * (kp + 1));
+  int32_t* __pb__ = __ws__.Alloc<int32_t>(size_t(NR) * (kp + 1) * __threads__);
+#ifndef __CUDACC__
+#pragma omp parallel for
+#endif
+  for (openmp_index_t t = 0; t < mpad / MR; ++t) {
+    const index_t r0 = t * MR, rn = M - r0 < MR ? M - r0 : MR;
+    QuantPackPanel<true>(__pa__ + size_t(r0) * kp, lhs.__data_ptr, lhs.m_Stride_, r0, rn, MR, K,
+                         a_zero);
+  }
+
+  const index_t mblocks = (M + __blk__.m_MC - 1) / __blk__.m_MC;
+  const index_t nblocks = (N + __blk__.m_NC - 1) / __blk__.m_NC;
+#ifndef __CUDACC__
+#pragma omp parallel for schedule(dynamic)
+#endif
+  for (openmp_index_t t = 0; t < mblocks * nblocks; ++t) {
+    const index_t i0 = (t / nblocks) * __blk__.m_MC, j0 = (t % nblocks) * __blk__.m_NC;
+    const index_t mc = M - i0 < __blk__.m_MC ? M - i0 : __blk__.m_MC;
+    const index_t nc = N - j0 < __blk__.m_NC ? N - j0 : __blk__.m_NC;
+    index_t __id__ = 0;
+#ifdef _OPENMP
+    __id__ = omp_get_thread_num();
+#endif
+    QuantGemmArchKernel<Arch>::template Block<Kern, Saver, RightTransposed>(
+        dst.__data_ptr, dst.m_Stride_, __pa__, rhs.__data_ptr, rhs.m_Stride_,
+        __pb__ + size_t(__id__) * NR * (kp + 1), i0, mc, j0, nc, K, epi);
+  }
+}
+
+/*!
+ *@brief    The dispatcher of QuantDotExpr on CPU tensors.
+ */
+template<typename Saver, bool RightTransposed, typename DisDataType>
+struct ExpressionComplexDispatcher<
+    Saver, Tensor<CPU, 2, DisDataType>,
+    QuantDotExpr<Tensor<CPU, 2, uint8_t>, Tensor<CPU, 2, int8_t>, RightTransposed, DisDataType>,
+    DisDataType> {
+  typedef QuantDotExpr<Tensor<CPU, 2, uint8_t>, Tensor<CPU, 2, int8_t>, RightTransposed,
+                       DisDataType>
+      E;
+
+  MGLORIA_INLINE_NORMAL static void Eval(Tensor<CPU, 2, DisDataType>* dst,
+                                         const Expression<E, DisDataType, Complex_t>& exp) {
+    const E& e = exp.Self();
+    if (e.m_scale != nullptr) {
+      CHECK_EQUAL(e.m_scale_size, dst->size(1), " dot: the scales of the columns, Shape_Dst=",
+                  dst->m_Shape.str());
+    }
+    const QuantDotEpilogue<DisDataType> __epi__ = {e.m_scale, e.m_scale_value, e.m_out_zero};
+#if MGLORIA_RUNTIME_DISPATCH == 1
+    using vectorization::VecArch;
+    switch (vectorization::RuntimeVecArch()) {
+      case VecArch::AVX512_Arch: {
+        ExecuteQuantDot<Saver, VecArch::AVX512_Arch, RightTransposed>(*dst, e.m_a, e.m_b,
+                                                                      e.m_a_zero, __epi__);
+        break;
+      }
+      case VecArch::AVX2_Arch: {
+        ExecuteQuantDot<Saver, VecArch::AVX2_Arch, RightTransposed>(*dst, e.m_a, e.m_b,
+                                                                    e.m_a_zero, __epi__);
+        break;
+      }
+#if MGLORIA_USE_SSE == 1
+      case VecArch::SSE_Arch: {
+        ExecuteQuantDot<Saver, VecArch::SSE_Arch, RightTransposed>(*dst, e.m_a, e.m_b,
+                                                                   e.m_a_zero, __epi__);
+        break;
+      }
+#endif  // MGLORIA_USE_SSE == 1
+      default: {
+        ExecuteQuantDot<Saver, VecArch::NONE_Arch, RightTransposed>(*dst, e.m_a, e.m_b,
+                                                                    e.m_a_zero, __epi__);
+        break;
+      }
+    }
+#else
+    ExecuteQuantDot<Saver, MGLORIA_VECTORIZATION_ARCH, RightTransposed>(*dst, e.m_a, e.m_b,
+                                                                        e.m_a_zero, __epi__);
+#endif  // MGLORIA_RUNTIME_DISPATCH == 1
+  }
+};
+
+}  // namespace expr
+}  // namespace mgloria
+
+#endif  // _MGLORIA___OP_QDOT_CPU_HPP_
@@ -0,0 +1,453 @@
+/*!
+ *@author chenghua.wang
+ *@file   op/__op_reduce_cpu.hpp
+ *@brief  Reduce one axis of a CPU tensor. sum, mean, max, min and argmax.
+ *@details The tensor is seen as [outer, n, inner], n is the axis reduced.
+ *
+ * The last axis: each row is cut into chunks of MGLORIA_REDUCE_CHUNK elements. A chunk is reduced
+ * with several vector accumulators and unaligned loads, so a long row streams at memory bandwidth.
+ *
+ * A leading axis: the rows of n are added to each other as whole rows, a vector of columns at a
+ * time. Nothing is loaded with a stride. Each task reduces MGLORIA_REDUCE_ROW_CHUNK rows of a
+ * MGLORIA_REDUCE_COL_TILE columns tile.
+ *
+ * The tasks run in parallel with OpenMP, and write their partial results to a buffer. The
+ * partials are then combined pairwise as a tree, in a fixed order. The chunks only depend on the
+ * shape, so the result is the same for any number of threads.
+ */
+
+#ifndef _MGLORIA___OP_REDUCE_CPU_HPP_
+#define _MGLORIA___OP_REDUCE_CPU_HPP_
+
+#pragma once
+
+#include "../complex_eval.hpp"
+#include "../vectorization/veced_op.hpp"
+
+namespace mgloria {
+namespace expr {
+
+/*!
+ *@brief    The partial of argmax. The value and where it is.
+ */
+template<typename DataType>
+struct ReduceArgPair {
+  DataType m_value;
+  index_t m_index;
+};
+
+/*!
+ *@brief    Can the Reducer be done with Vectorized<DataType, Arch>.
+ */
+template<typename Reducer, typename DataType, vectorization::VecArch Arch>
+struct ReduceVecCheck {
+  static const bool m_Enable =
+      Arch != vectorization::VecArch::NONE_Arch && VecCheck<DataType, Arch>::m_Enable
+      && vectorization::VectorizedOP<typename Reducer::OPType, DataType, Arch>::m_Enable;
+};
+
+template<typename DataType, vectorization::VecArch Arch>
+struct ReduceVecCheck<op::_red_argmax, DataType, Arch> {
+  static const bool m_Enable = MGLORIA_VECTORIZATION_FALSE;
+};
+
+/*!
+ *@brief    The work of one reduce task.
+ *@details  Row reduces n contiguous elements to one partial. Rows reduces nrows rows, step apart,
+ * to one row of ncols partials. Combine puts b into a, b being the partials after a. base is the
+ * index of the first element along the axis, only argmax uses it.
+ */
+template<typename Reducer, typename OriDataType, typename DisDataType, vectorization::VecArch Arch,
+         bool Vec>
+struct ReduceKernel {
+  typedef OriDataType PartialType;
+  typedef typename Reducer::OPType OPType;
+
+  MGLORIA_INLINE_CPU static void Row(PartialType* out, const OriDataType* src, index_t n,
+                                     index_t) {
+    OriDataType __acc__ = Reducer::template Init<OriDataType>();
+    for (index_t i = 0; i < n; ++i) { __acc__ = OPType::Do(__acc__, src[i]); }
+    *out = __acc__;
+  }
+
+  MGLORIA_INLINE_CPU static void Rows(PartialType* out, const OriDataType* src, index_t step,
+                                      index_t nrows, index_t ncols, index_t) {
+    for (index_t c = 0; c < ncols; ++c) { out[c] = src[c]; }
+    for (index_t k = 1; k < nrows; ++k) {
+      const OriDataType* __row__ = src + k * step;
+      for (index_t c = 0; c < ncols; ++c) { out[c] = OPType::Do(out[c], __row__[c]); }
+    }
+  }
+
+  MGLORIA_INLINE_CPU static void Combine(PartialType* a, const PartialType* b, index_t ncols) {
+    for (index_t c = 0; c < ncols; ++c) { a[c] = OPType::Do(a[c], b[c]); }
+  }
+
+  MGLORIA_INLINE_CPU static DisDataType Finish(const PartialType& p, index_t n) {
+    return Reducer::template Finish<OriDataType>(p, n);
+  }
+};
+
+/*!
+ *@brief    Vectorized with Arch. The outputs of Rows and the rows of Combine are aligned for Arch,
+ * they are in the partial buffer. The tensor reduced is not, it may be a slice.
+ */
+template<typename Reducer, typename OriDataType, typename DisDataType, vectorization::VecArch Arch>
+struct ReduceKernel<Reducer, OriDataType, DisDataType, Arch, true> {
+  typedef OriDataType PartialType;
+  typedef typename Reducer::OPType OPType;
+  typedef vectorization::Vectorized<OriDataType, Arch> Vec;
+  typedef vectorization::VectorizedOP<OPType, OriDataType, Arch> VecOP;
+
+  MGLORIA_INLINE_CPU static void Row(PartialType* out, const OriDataType* src, index_t n,
+                                     index_t) {
+    const index_t num = Vec::num;
+    const OriDataType __init__ = Reducer::template Init<OriDataType>();
+    ///! 4 accumulators hide the latency of the adds.
+    Vec __a0__ = Vec::Fill(__init__), __a1__ = __a0__, __a2__ = __a0__, __a3__ = __a0__;
+    index_t i = 0;
+    for (; i + 4 * num <= n; i += 4 * num) {
+      __a0__ = VecOP::Do(__a0__, Vec::LoadUnAligned(src + i));
+      __a1__ = VecOP::Do(__a1__, Vec::LoadUnAligned(src + i + num));
+      __a2__ = VecOP::Do(__a2__, Vec::LoadUnAligned(src + i + 2 * num));
+      __a3__ = VecOP::Do(__a3__, Vec::LoadUnAligned(src + i + 3 * num));
+    }
+    for (; i + num <= n; i += num) { __a0__ = VecOP::Do(__a0__, Vec::LoadUnAligned(src + i)); }
+    __a0__ = VecOP::Do(VecOP::Do(__a0__, __a1__), VecOP::Do(__a2__, __a3__));
+
+    OriDataType __lanes__[Vec::num] MGLORIA_ALIGNED(64);
+    __a0__.Store(__lanes__);
+    for (index_t s = num / 2; s > 0; s /= 2) {
+      for (index_t j = 0; j < s; ++j) { __lanes__[j] = OPType::Do(__lanes__[j], __lanes__[j + s]); }
+    }
+    OriDataType __acc__ = __lanes__[0];
+    for (; i < n; ++i) { __acc__ = OPType::Do(__acc__, src[i]); }
+    *out = __acc__;
+  }
+
+  MGLORIA_INLINE_CPU static void Rows(PartialType* out, const OriDataType* src, index_t step,
+                                      index_t nrows, index_t ncols, index_t) {
+    const index_t num = Vec::num;
+    const OriDataType __init__ = Reducer::template Init<OriDataType>();
+    index_t c = 0;
+    for (; c + 4 * num <= ncols; c += 4 * num) {
+      Vec __a0__ = Vec::Fill(__init__), __a1__ = __a0__, __a2__ = __a0__, __a3__ = __a0__;
+      const OriDataType* __row__ = src + c;
+      for (index_t k = 0; k < nrows; ++k, __row__ += step) {
+        __a0__ = VecOP::Do(__a0__, Vec::LoadUnAligned(__row__));
+        __a1__ = VecOP::Do(__a1__, Vec::LoadUnAligned(__row__ + num));
+        __a2__ = VecOP::Do(__a2__, Vec::LoadUnAligned(__row__ + 2 * num));
+        __a3__ = VecOP::Do(__a3__, Vec::LoadUnAligned(__row__ + 3 * num));
+      }
+      __a0__.Store(out + c);
+      __a1__.Store(out + c + num);
+      __a2__.Store(out + c + 2 * num);
+      __a3__.Store(out + c + 3 * num);
+    }
+    for (; c + num <= ncols; c += num) {
+      Vec __a0__ = Vec::Fill(__init__);
+      const OriDataType* __row__ = src + c;
+      for (index_t k = 0; k < nrows; ++k, __row__ += step) {
+        __a0__ = VecOP::Do(__a0__, Vec::LoadUnAligned(__row__));
+      }
+      __a0__.Store(out + c);
+    }
+    for (; c < ncols; ++c) {
+      OriDataType __acc__ = __init__;
+      for (index_t k = 0; k < nrows; ++k) { __acc__ = OPType::Do(__acc__, src[k * step + c]); }
+      out[c] = __acc__;
+    }
+  }
+
+  MGLORIA_INLINE_CPU static void Combine(PartialType* a, const PartialType* b, index_t ncols) {
+    const index_t num = Vec::num;
+    index_t c = 0;
+    for (; c + num <= ncols; c += num) {
+      VecOP::Do(Vec::Load(a + c), Vec::Load(b + c)).Store(a + c);
+    }
+    for (; c < ncols; ++c) { a[c] = OPType::Do(a[c], b[c]); }
+  }
+
+  MGLORIA_INLINE_CPU static DisDataType Finish(const PartialType& p, index_t n) {
+    return Reducer::template Finish<OriDataType>(p, n);
+  }
+};
+
+/*!
+ *@brief    argmax keeps (value, index). The later element only wins if it is greater, so the
+ * first max is found. A NaN never wins, unless it is the first element.
+ */
+template<typename OriDataType, typename DisDataType, vectorization::VecArch Arch>
+struct ReduceKernel<op::_red_argmax, OriDataType, DisDataType, Arch, false> {
+  typedef ReduceArgPair<OriDataType> PartialType;
+
+  MGLORIA_INLINE_CPU static void Row(PartialType* out, const OriDataType* src, index_t n,
+                                     index_t base) {
+    OriDataType __best__ = src[0];
+    index_t __idx__ = 0;
+    for (index_t i = 1; i < n; ++i) {
+      if (src[i] > __best__) {
+        __best__ = src[i];
+        __idx__ = i;
+      }
+    }
+    out->m_value = __best__;
+    out->m_index = base + __idx__;
+  }
+
+  MGLORIA_INLINE_CPU static void Rows(PartialType* out, const OriDataType* src, index_t step,
+                                      index_t nrows, index_t ncols, index_t base) {
+    for (index_t c = 0; c < ncols; ++c) {
+      out[c].m_value = src[c];
+      out[c].m_index = base;
+    }
+    for (index_t k = 1; k < nrows; ++k) {
+      const OriDataType* __row__ = src + k * step;
+      for (index_t c = 0; c < ncols; ++c) {
+        if (__row__[c] > out[c].m_value) {
+          out[c].m_value = __row__[c];
+          out[c].m_index = base + k;
+        }
+      }
+    }
+  }
+
+  MGLORIA_INLINE_CPU static void Combine(PartialType* a, const PartialType* b, index_t ncols) {
+    for (index_t c = 0; c < ncols; ++c) {
+      if (b[c].m_value > a[c].m_value) { a[c] = b[c]; }
+    }
+  }
+
+  MGLORIA_INLINE_CPU static DisDataType Finish(const PartialType& p, index_t) {
+    return static_cast<DisDataType>(p.m_index);
+  }
+};
+
+/*!
+ *@brief    The roots of one reduce kernel, compiled for Arch. See VectorizedRowKernel.
+ */
+template<vectorization::VecArch Arch>
+struct ReduceArchKernel {
+  template<typename K, typename P, typename DataType>
+  MGLORIA_INLINE_CPU static void Row(P* out, const DataType* src, index_t n, index_t base) {
+    K::Row(out, src, n, base);
+  }
+  template<typename K, typename P, typename DataType>
+  MGLORIA_INLINE_CPU static void Rows(P* out, const DataType* src, index_t step, index_t nrows,
+                                      index_t ncols, index_t base) {
+    K::Rows(out, src, step, nrows, ncols, base);
+  }
+  template<typename K, typename P>
+  MGLORIA_INLINE_CPU static void Combine(P* a, const P* b, index_t ncols) {
+    K::Combine(a, b, ncols);
+  }
+};
+
+template<>
+struct ReduceArchKernel<vectorization::VecArch::AVX2_Arch> {
+  template<typename K, typename P, typename DataType>
+  MGLORIA_KERNEL_AVX2 static void Row(P* out, const DataType* src, index_t n, index_t base) {
+    K::Row(out, src, n, base);
+  }
+  template<typename K, typename P, typename DataType>
+  MGLORIA_KERNEL_AVX2 static void Rows(P* out, const DataType* src, index_t step, index_t nrows,
+                                       index_t ncols, index_t base) {
+    K::Rows(out, src, step, nrows, ncols, base);
+  }
+  template<typename K, typename P>
+  MGLORIA_KERNEL_AVX2 static void Combine(P* a, const P* b, index_t ncols) {
+    K::Combine(a, b, ncols);
+  }
+};
+
+template<>
+struct ReduceArchKernel<vectorization::VecArch::AVX512_Arch> {
+  template<typename K, typename P, typename DataType>
+  MGLORIA_KERNEL_AVX512 static void Row(P* out, const DataType* src, index_t n, index_t base) {
+    K::Row(out, src, n, base);
+  }
+  template<typename K, typename P, typename DataType>
+  MGLORIA_KERNEL_AVX512 static void Rows(P* out, const DataType* src, index_t step, index_t nrows,
+                                         index_t ncols, index_t base) {
+    K::Rows(out, src, step, nrows, ncols, base);
+  }
+  template<typename K, typename P>
+  MGLORIA_KERNEL_AVX512 static void Combine(P* a, const P* b, index_t ncols) {
+    K::Combine(a, b, ncols);
+  }
+};
+
+/*!
+ *@brief    Combine count partials, pitch apart, into the first one. Pairwise, as a tree.
+ */
+template<typename K, vectorization::VecArch Arch, typename P>
+MGLORIA_INLINE_NORMAL void ReduceTreeCombine(P* p, index_t count, index_t pitch, index_t ncols) {
+  for (index_t s = 1; s < count; s *= 2) {
+    for (index_t i = 0; i + s < count; i += 2 * s) {
+      ReduceArchKernel<Arch>::template Combine<K>(p + i * pitch, p + (i + s) * pitch, ncols);
+    }
+  }
+}
+
+/*!
+ *@brief    Reduce the last axis. Each of the rows of src gives one element of dst.
+ */
+template<typename Saver, typename K, vectorization::VecArch Arch, typename OriDataType,
+         typename DisDataType>
+MGLORIA_INLINE_NORMAL void ReduceLastAxis(Tensor<CPU, 2, DisDataType> dst,
+                                          const Tensor<CPU, 2, OriDataType>& src) {
+  typedef typename K::PartialType P;
+  const index_t rows = src.size(0), n = src.size(1);
+  const index_t nchunk = (n + MGLORIA_REDUCE_CHUNK - 1) / MGLORIA_REDUCE_CHUNK;
+  WorkspaceScope __ws__(dst.m_Stream);
+  P* __part__ = __ws__.Alloc<P>(rows * nchunk);
+
+#ifndef __CUDACC__
+#pragma omp parallel for
+#endif
+  for (openmp_index_t t = 0; t < rows * nchunk; ++t) {
+    const index_t r = t / nchunk, begin = (t % nchunk) * MGLORIA_REDUCE_CHUNK;
+    const index_t len = n - begin < MGLORIA_REDUCE_CHUNK ? n - begin : MGLORIA_REDUCE_CHUNK;
+    const OriDataType* __row__ = src.__data_ptr + r * src.m_Stride_ + begin;
+    ReduceArchKernel<Arch>::template Row<K>(__part__ + t, __row__, len, begin);
+  }
+
+  const index_t cols = dst.size(1);
+#ifndef __CUDACC__
+#pragma omp parallel for
+#endif
+  for (openmp_index_t r = 0; r < rows; ++r) {
+    P* __p__ = __part__ + r * nchunk;
+    ReduceTreeCombine<K, Arch>(__p__, nchunk, 1, 1);
+    Saver::template Do<DisDataType>(dst.__data_ptr[(r / cols) * dst.m_Stride_ + r % cols],
+                                    K::Finish(*__p__, n));
+  }
+}
+
+/*!
+ *@brief    Reduce a leading axis. src is [outer * n * m, cols] rows, the row (o, k, j) is
+ * (o * n + k) * m + j. dst is [outer * m, cols].
+ */
+template<typename Saver, typename K, vectorization::VecArch Arch, typename OriDataType,
+         typename DisDataType>
+MGLORIA_INLINE_NORMAL void ReduceLeadingAxis(Tensor<CPU, 2, DisDataType> dst,
+                                             const Tensor<CPU, 2, OriDataType>& src, index_t n,
+                                             index_t m) {
+  typedef typename K::PartialType P;
+  const index_t out_rows = dst.size(0), cols = src.size(1);
+  const index_t nchunk = (n + MGLORIA_REDUCE_ROW_CHUNK - 1) / MGLORIA_REDUCE_ROW_CHUNK;
+  const index_t ntile = (cols + MGLORIA_REDUCE_COL_TILE - 1) / MGLORIA_REDUCE_COL_TILE;
+  WorkspaceScope __ws__(dst.m_Stream);
+  size_t __pitch__;
+  P* __part__ = static_cast<P*>(__ws__.AllocPitch(&__pitch__, sizeof(P) * cols, out_rows * nchunk));
+  const index_t pitch = static_cast<index_t>(__pitch__ / sizeof(P));
+
+#ifndef __CUDACC__
+#pragma omp parallel for
+#endif
+  for (openmp_index_t t = 0; t < out_rows * nchunk * ntile; ++t) {
+    const index_t c0 = (t % ntile) * MGLORIA_REDUCE_COL_TILE;
+    const index_t ch = (t / ntile) % nchunk, orow = t / ntile / nchunk;
+    const index_t k0 = ch * MGLORIA_REDUCE_ROW_CHUNK;
+    const index_t kn = n - k0 < MGLORIA_REDUCE_ROW_CHUNK ? n - k0 : MGLORIA_REDUCE_ROW_CHUNK;
+    const index_t cn = cols - c0 < MGLORIA_REDUCE_COL_TILE ? cols - c0 : MGLORIA_REDUCE_COL_TILE;
+    const index_t srow = ((orow / m) * n + k0) * m + orow % m;
+    ReduceArchKernel<Arch>::template Rows<K>(__part__ + (orow * nchunk + ch) * pitch + c0,
+                                             src.__data_ptr + srow * src.m_Stride_ + c0,
+                                             m * src.m_Stride_, kn, cn, k0);
+  }
+
+#ifndef __CUDACC__
+#pragma omp parallel for
+#endif
+  for (openmp_index_t t = 0; t < out_rows * ntile; ++t) {
+    const index_t c0 = (t % ntile) * MGLORIA_REDUCE_COL_TILE, orow = t / ntile;
+    const index_t cn = cols - c0 < MGLORIA_REDUCE_COL_TILE ? cols - c0 : MGLORIA_REDUCE_COL_TILE;
+    P* __p__ = __part__ + orow * nchunk * pitch + c0;
+    ReduceTreeCombine<K, Arch>(__p__, nchunk, pitch, cn);
+    DisDataType* __d__ = dst.__data_ptr + orow * dst.m_Stride_ + c0;
+    for (index_t c = 0; c < cn; ++c) {
+      Saver::template Do<DisDataType>(__d__[c], K::Finish(__p__[c], n));
+    }
+  }
+}
+
+/*!
+ *@brief    Check the shapes, and reduce the axis of src into dst with Arch.
+ */
+template<typename Saver, typename Reducer, vectorization::VecArch Arch, int Dims, int SrcDims,
+         typename OriDataType, typename DisDataType>
+MGLORIA_INLINE_NORMAL void ExecuteReduce(Tensor<CPU, Dims, DisDataType>* dst,
+                                         const Tensor<CPU, SrcDims, OriDataType>& src,
+                                         index_t axis) {
+  typedef ReduceKernel<Reducer, OriDataType, DisDataType, Arch,
+                       ReduceVecCheck<Reducer, OriDataType, Arch>::m_Enable>
+      K;
+  static_assert(Dims == (SrcDims > 1 ? SrcDims - 1 : 1), "reduce gives the dims of src minus 1");
+  LOG_CHECK(axis >= 0 && axis < SrcDims, " axis=", axis, " out of Bound for dim=", SrcDims);
+  LOG_CHECK(src.m_Shape[axis] > 0, " can not reduce an empty axis=", axis);
+#if MGLORIA_RUNTIME_SHAPE_CHECK == 1
+  Shape<Dims> __shape__;
+  __shape__[0] = 1;
+  for (index_t i = 0, j = 0; i < SrcDims; ++i) {
+    if (i != axis) { __shape__[j++] = src.m_Shape[i]; }
+  }
+  LOG_CHECK(__shape__ == dst->m_Shape, "\nShape_Reduced=", __shape__.str(),
+            "Shape_Left=", dst->m_Shape.str());
+#endif
+
+  if (axis == SrcDims - 1) {
+    ReduceLastAxis<Saver, K, Arch>(dst->Flatten2D(), src.Flatten2D());
+  } else {
+    index_t m = 1;
+    for (index_t i = axis + 1; i < SrcDims - 1; ++i) { m *= src.m_Shape[i]; }
+    ReduceLeadingAxis<Saver, K, Arch>(dst->Flatten2D(), src.Flatten2D(), src.m_Shape[axis], m);
+  }
+}
+
+/*!
+ *@brief    The dispatcher of ReduceExpr on CPU tensors.
+ */
+template<typename Saver, int Dims, typename Reducer, int SrcDims, typename OriDataType,
+         typename DisDataType>
+struct ExpressionComplexDispatcher<
+    Saver, Tensor<CPU, Dims, DisDataType>,
+    ReduceExpr<Reducer, Tensor<CPU, SrcDims, OriDataType>, OriDataType, DisDataType>,
+    DisDataType> {
+  typedef ReduceExpr<Reducer, Tensor<CPU, SrcDims, OriDataType>, OriDataType, DisDataType> E;
+
+  MGLORIA_INLINE_NORMAL static void Eval(Tensor<CPU, Dims, DisDataType>* dst,
+                                         const Expression<E, DisDataType, Complex_t>& exp) {
+    const E& e = exp.Self();
+#if MGLORIA_RUNTIME_DISPATCH == 1
+    using vectorization::VecArch;
+    switch (vectorization::RuntimeVecArch()) {
+      case VecArch::AVX512_Arch: {
+        ExecuteReduce<Saver, Reducer, VecArch::AVX512_Arch>(dst, e.m_a, e.m_axis);
+        break;
+      }
+      case VecArch::AVX2_Arch: {
+        ExecuteReduce<Saver, Reducer, VecArch::AVX2_Arch>(dst, e.m_a, e.m_axis);
+        break;
+      }
+#if MGLORIA_USE_SSE == 1
+      case VecArch::SSE_Arch: {
+        ExecuteReduce<Saver, Reducer, VecArch::SSE_Arch>(dst, e.m_a, e.m_axis);
+        break;
+      }
+#endif  // MGLORIA_USE_SSE == 1
+      default: {
+        ExecuteReduce<Saver, Reducer, VecArch::NONE_Arch>(dst, e.m_a, e.m_axis);
+        break;
+      }
+    }
+#else
+    ExecuteReduce<Saver, Reducer, MGLORIA_VECTORIZATION_ARCH>(dst, e.m_a, e.m_axis);
+#endif  // MGLORIA_RUNTIME_DISPATCH == 1
+  }
+};
+
+}  // namespace expr
+}  // namespace mgloria
+
+#endif  // _MGLORIA___OP_REDUCE_CPU_HPP_
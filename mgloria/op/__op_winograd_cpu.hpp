@@ -0,0 +1,583 @@
+/*!
+ *@author chenghua.wang
+ *@file   op/__op_winograd_cpu.hpp
+ *@brief  The Winograd F(4x4, 3x3) path of conv2d on CPU tensors, see ExecuteConv2d.
+ *@details A 4x4 tile of the output is computed from the 6x6 tile of the input it reads with
+ * 36 multiplies per input and output channel, instead of the 144 of the direct convolution:
+ *
+ *            Y = A^T [ (G g G^T) . (B^T d B) ] A
+ *
+ * g is the 3x3 filter, d the 6x6 tile of the input and . the element-wise product. For the 36
+ * elements xi of the 6x6 products, the sums over the input channels are 36 gemms:
+ *
+ *            M[xi] [Cog, tiles] = U[xi] [Cog, Cg] x V[xi] [Cg, tiles]
+ *
+ * U is G g G^T for every filter, transformed once per weight tensor, packed as the A panels of
+ * op/__op_dot_cpu.hpp and kept in the WinogradFilterCache. A task owns a chunk of the tiles of
+ * one image and group: it transforms the input tiles straight into the packed B panels, runs the
+ * 36 gemms with the micro kernel of the dot, and transforms M back to the output. The three
+ * transforms are done on Vectorized<float> with one tile (or one input channel, for U) per lane.
+ *
+ * The path is taken for the float 3x3 stride 1 convolutions with MGLORIA_WINOGRAD_MIN_CHANNELS
+ * or more channels per group on both sides, when the arch has vectors. The results differ from
+ * the direct convolution by the rounding of the transforms, a few ulp of the sums.
+ */
+
+#ifndef _MGLORIA___OP_WINOGRAD_CPU_HPP_
+#define _MGLORIA___OP_WINOGRAD_CPU_HPP_
+
+#pragma once
+
+#include "__op_conv_cpu.hpp"
+#include <cstring>
+#include <list>
+#include <memory>
+#include <mutex>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace mgloria {
+namespace expr {
+
+/*!
+ *@brief    The 1D transforms, applied to the columns and then to the rows of a tile. In is B^T of
+ * 6 values, Filter is G of 3 values to 6, Out is A^T of 6 values to 4.
+ */
+template<typename Vec>
+struct WinogradTransform {
+  MGLORIA_INLINE_CPU static void In(const Vec* d, index_t sd, Vec* r, index_t sr) {
+    const Vec __4__ = Vec::Fill(4.f), __5__ = Vec::Fill(5.f), __2__ = Vec::Fill(2.f);
+    const Vec d0 = d[0], d1 = d[sd], d2 = d[2 * sd], d3 = d[3 * sd], d4 = d[4 * sd],
+              d5 = d[5 * sd];
+    const Vec __a__ = d4 - d2, __b__ = Vec::MulAdd(__2__, d3 - d1, Vec::Fill(0.f));
+    r[0] = Vec::MulAdd(__4__, d0, d4 - __5__ * d2);
+    r[sr] = (d3 + d4) - __4__ * (d1 + d2);
+    r[2 * sr] = Vec::MulAdd(__4__, d1 - d2, d4 - d3);
+    r[3 * sr] = __a__ + __b__;
+    r[4 * sr] = __a__ - __b__;
+    r[5 * sr] = Vec::MulAdd(__4__, d1, d5 - __5__ * d3);
+  }
+
+  MGLORIA_INLINE_CPU static void Filter(const Vec* g, index_t sg, Vec* r, index_t sr) {
+    const Vec g0 = g[0], g1 = g[sg], g2 = g[2 * sg];
+    const Vec __e__ = g0 + g2;
+    const Vec __f__ = Vec::MulAdd(Vec::Fill(1.f / 24.f), g0, Vec::Fill(1.f / 6.f) * g2);
+    const Vec __h__ = Vec::Fill(1.f / 12.f) * g1;
+    r[0] = Vec::Fill(0.25f) * g0;
+    r[sr] = Vec::Fill(-1.f / 6.f) * (__e__ + g1);
+    r[2 * sr] = Vec::Fill(-1.f / 6.f) * (__e__ - g1);
+    r[3 * sr] = __f__ + __h__;
+    r[4 * sr] = __f__ - __h__;
+    r[5 * sr] = g2;
+  }
+
+  MGLORIA_INLINE_CPU static void Out(const Vec* m, index_t sm, Vec* r, index_t sr) {
+    const Vec m0 = m[0], m1 = m[sm], m2 = m[2 * sm], m3 = m[3 * sm], m4 = m[4 * sm],
+              m5 = m[5 * sm];
+    const Vec __a__ = m1 + m2, __b__ = m1 - m2, __c__ = m3 + m4, __d__ = m3 - m4;
+    r[0] = m0 + __a__ + __c__;
+    r[sr] = Vec::MulAdd(Vec::Fill(2.f), __d__, __b__);
+    r[2 * sr] = Vec::MulAdd(Vec::Fill(4.f), __c__, __a__);
+    r[3 * sr] = Vec::MulAdd(Vec::Fill(8.f), __d__, __b__ + m5);
+  }
+};
+
+/*!
+ *@brief    The element (c, h, w) of the input or the output of one image and group, and the
+ * element (o, c, kh, kw) of the 3x3 weight, ld being the stride of the last dim.
+ */
+template<LayoutTypeType Layout>
+struct WinogradAddr {
+  MGLORIA_INLINE_CPU static index_t At(index_t c, index_t h, index_t w, index_t H, index_t,
+                                       index_t ld) {
+    return (c * H + h) * ld + w;
+  }
+  MGLORIA_INLINE_CPU static index_t Weight(index_t o, index_t c, index_t kh, index_t kw,
+                                           index_t Cg, index_t ld) {
+    return ((o * Cg + c) * 3 + kh) * ld + kw;
+  }
+};
+
+template<>
+struct WinogradAddr<LayoutTypeType::BHWC> {
+  MGLORIA_INLINE_CPU static index_t At(index_t c, index_t h, index_t w, index_t, index_t W,
+                                       index_t ld) {
+    return (h * W + w) * ld + c;
+  }
+  MGLORIA_INLINE_CPU static index_t Weight(index_t o, index_t c, index_t kh, index_t kw,
+                                           index_t, index_t ld) {
+    return ((o * 3 + kh) * 3 + kw) * ld + c;
+  }
+};
+
+/*!
+ *@brief    The transformed filters of one weight tensor, U[xi] of each group packed as GemmPack
+ * packs the lhs of a dot: with MR and KC of the arch, mpad rows each. The key is the weight:
+ * its data, shape, stride and layout, the groups, the arch, and the fingerprint of a few of its
+ * elements, so that a weight updated in place is seen as another one.
+ */
+struct WinogradFilter {
+  WinogradFilter() : m_data(nullptr) {}
+  ~WinogradFilter() {
+    if (m_data != nullptr) { HostPoolFree(m_data); }
+  }
+  WinogradFilter(const WinogradFilter&) = delete;
+  WinogradFilter& operator=(const WinogradFilter&) = delete;
+
+  MGLORIA_INLINE_NORMAL bool Same(const WinogradFilter& key) const {
+    return m_weight == key.m_weight && m_shape == key.m_shape && m_stride == key.m_stride
+           && m_layout == key.m_layout && m_groups == key.m_groups && m_arch == key.m_arch
+           && m_print == key.m_print;
+  }
+
+  const void* m_weight;
+  Shape<4> m_shape;
+  index_t m_stride;
+  LayoutTypeType m_layout;
+  index_t m_groups;
+  vectorization::VecArch m_arch;
+  uint64_t m_print;
+  float* m_data;
+};
+
+/*!
+ *@brief    The last MGLORIA_WINOGRAD_CACHE WinogradFilter used, the most recent first. It is
+ * shared by all the threads.
+ */
+class WinogradFilterCache {
+ public:
+  MGLORIA_INLINE_NORMAL static WinogradFilterCache& Get() {
+    static WinogradFilterCache __cache__;
+    return __cache__;
+  }
+
+  MGLORIA_INLINE_NORMAL std::shared_ptr<const WinogradFilter> Find(const WinogradFilter& key) {
+    std::lock_guard<std::mutex> __lock__(m_mutex);
+    for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+      if ((*it)->Same(key)) {
+        m_entries.splice(m_entries.begin(), m_entries, it);
+        return m_entries.front();
+      }
+    }
+    return nullptr;
+  }
+
+  ///! The entries of the same weight and arch are dropped, their fingerprint is out of date.
+  MGLORIA_INLINE_NORMAL void Insert(const std::shared_ptr<const WinogradFilter>& f) {
+    std::lock_guard<std::mutex> __lock__(m_mutex);
+    m_entries.remove_if([&f](const std::shared_ptr<const WinogradFilter>& e) {
+      return e->m_weight == f->m_weight && e->m_arch == f->m_arch;
+    });
+    m_entries.push_front(f);
+    while (m_entries.size() > MGLORIA_WINOGRAD_CACHE) { m_entries.pop_back(); }
+  }
+
+  MGLORIA_INLINE_NORMAL void Release(const void* weight) {
+    std::lock_guard<std::mutex> __lock__(m_mutex);
+    m_entries.remove_if([weight](const std::shared_ptr<const WinogradFilter>& e) {
+      return e->m_weight == weight;
+    });
+  }
+
+  MGLORIA_INLINE_NORMAL void Clear() {
+    std::lock_guard<std::mutex> __lock__(m_mutex);
+    m_entries.clear();
+  }
+
+ private:
+  WinogradFilterCache() {}
+
+  std::mutex m_mutex;
+  std::list<std::shared_ptr<const WinogradFilter>> m_entries;
+};
+
+/*!
+ *@brief    Drop the transformed filters of weight. Call it after weight is changed in place, the
+ * fingerprint only sees a few of its elements, or before its memory is freed.
+ */
+template<typename DataType>
+MGLORIA_INLINE_NORMAL void ReleaseWinogradFilter(const Tensor<CPU, 4, DataType>& weight) {
+  WinogradFilterCache::Get().Release(weight.__data_ptr);
+}
+
+///! Drop all the transformed filters.
+MGLORIA_INLINE_NORMAL void ClearWinogradFilters() { WinogradFilterCache::Get().Clear(); }
+
+///! FNV-1a of 64 elements spread over the weight.
+MGLORIA_INLINE_NORMAL uint64_t WinogradFingerprint(const Tensor<CPU, 4, float>& weight) {
+  const index_t rows = weight.size(0) * weight.size(1) * weight.size(2), cols = weight.size(3);
+  const index_t total = rows * cols;
+  uint64_t h = 14695981039346656037ull;
+  for (index_t s = 0; s < 64 && total > 0; ++s) {
+    const index_t i = static_cast<index_t>(static_cast<int64_t>(s) * total / 64);
+    uint32_t __bits__;
+    std::memcpy(&__bits__, weight.__data_ptr + (i / cols) * weight.m_Stride_ + i % cols, 4);
+    h = (h ^ __bits__) * 1099511628211ull;
+  }
+  return h;
+}
+
+/*!
+ *@brief    The tiles [t0, t0 + tc) of one image and group, see WinogradKernel. src and dst are the
+ * first channel of the group in the image, u the packed U of the group, v and m the buffers of
+ * the task for the packed V and for M, tcpad tiles each.
+ */
+struct WinogradChunk {
+  const float* m_src;
+  index_t m_ld;
+  float* m_dst;
+  index_t m_dld;
+  const float* m_u;
+  float* m_v;
+  float* m_m;
+  index_t m_t0;
+  index_t m_tc;
+  index_t m_tcpad;
+  index_t m_mpad;
+  index_t m_KC;
+};
+
+/*!
+ *@brief    The transforms and the gemms of the Winograd path with Kern, the GemmKernel of Arch.
+ */
+template<typename Kern, vectorization::VecArch Arch, LayoutTypeType Layout>
+struct WinogradKernel {
+  typedef vectorization::Vectorized<float, Arch> Vec;
+
+  ///! U of the output channels [0, Cog) and the input channels [c0, c0 + num) of one group,
+  ///! w being its first filter. u is [36][Cog][Cg], there is no pad.
+  MGLORIA_INLINE_CPU static void Filter(const ConvGeometry& g, const float* w, index_t ld,
+                                        index_t c0, float* u) {
+    const index_t num = Vec::num, cn = g.m_Cg - c0 < num ? g.m_Cg - c0 : num;
+    float __buf__[9 * Vec::num] MGLORIA_ALIGNED(64);
+    float __out__[36 * Vec::num] MGLORIA_ALIGNED(64);
+    Vec __g__[9], __t__[18], __u__[36];
+    for (index_t o = 0; o < g.m_Cog; ++o) {
+      for (index_t k = 0; k < 9; ++k) {
+        for (index_t j = 0; j < num; ++j) {
+          __buf__[k * num + j] =
+              j < cn ? w[WinogradAddr<Layout>::Weight(o, c0 + j, k / 3, k % 3, g.m_Cg, ld)] : 0.f;
+        }
+        __g__[k] = Vec::Load(__buf__ + k * num);
+      }
+      // Columns 3x3 to 6x3, then rows to 6x6.
+      for (index_t j = 0; j < 3; ++j) {
+        WinogradTransform<Vec>::Filter(__g__ + j, 3, __t__ + j, 3);
+      }
+      for (index_t i = 0; i < 6; ++i) {
+        WinogradTransform<Vec>::Filter(__t__ + i * 3, 1, __u__ + i * 6, 1);
+      }
+      for (index_t x = 0; x < 36; ++x) {
+        __u__[x].Store(__out__ + x * num);
+        for (index_t j = 0; j < cn; ++j) {
+          u[(x * g.m_Cog + o) * g.m_Cg + c0 + j] = __out__[x * num + j];
+        }
+      }
+    }
+  }
+
+  ///! The input tiles of the chunk into the packed V, num tiles of one input channel at a time.
+  MGLORIA_INLINE_CPU static void Input(const ConvGeometry& g, const WinogradChunk& ch) {
+    const index_t num = Vec::num, NR = Kern::m_NR, TW = (g.m_OW + 3) / 4;
+    const index_t step = WinogradAddr<Layout>::At(0, 0, 1, g.m_H, g.m_W, ch.m_ld);
+    float __buf__[36 * Vec::num] MGLORIA_ALIGNED(64);
+    Vec __d__[36], __t__[36];
+    for (index_t l0 = 0; l0 < ch.m_tcpad; l0 += num) {
+      index_t __ih__[Vec::num], __iw__[Vec::num];
+      bool __inside__ = true;
+      for (index_t j = 0; j < num; ++j) {
+        const index_t t = ch.m_t0 + l0 + j;
+        __ih__[j] = t / TW * 4 - g.m_PH;
+        __iw__[j] = t % TW * 4 - g.m_PW;
+        __inside__ = __inside__ && l0 + j < ch.m_tc && __ih__[j] >= 0 && __iw__[j] >= 0
+                     && __ih__[j] + 6 <= g.m_H && __iw__[j] + 6 <= g.m_W;
+      }
+      for (index_t c = 0; c < g.m_Cg; ++c) {
+        if (__inside__) {
+          for (index_t j = 0; j < num; ++j) {
+            for (index_t i = 0; i < 6; ++i) {
+              const float* __row__ = ch.m_src
+                                     + WinogradAddr<Layout>::At(c, __ih__[j] + i, __iw__[j],
+                                                                g.m_H, g.m_W, ch.m_ld);
+              for (index_t k = 0; k < 6; ++k) {
+                __buf__[(i * 6 + k) * num + j] = __row__[k * step];
+              }
+            }
+          }
+        } else {
+          for (index_t j = 0; j < num; ++j) {
+            for (index_t i = 0; i < 6; ++i) {
+              for (index_t k = 0; k < 6; ++k) {
+                const index_t ih = __ih__[j] + i, iw = __iw__[j] + k;
+                __buf__[(i * 6 + k) * num + j] =
+                    l0 + j < ch.m_tc && ih >= 0 && ih < g.m_H && iw >= 0 && iw < g.m_W
+                        ? ch.m_src[WinogradAddr<Layout>::At(c, ih, iw, g.m_H, g.m_W, ch.m_ld)]
+                        : 0.f;
+              }
+            }
+          }
+        }
+        for (index_t x = 0; x < 36; ++x) { __d__[x] = Vec::Load(__buf__ + x * num); }
+        for (index_t j = 0; j < 6; ++j) { WinogradTransform<Vec>::In(__d__ + j, 6, __t__ + j, 6); }
+        for (index_t i = 0; i < 6; ++i) {
+          WinogradTransform<Vec>::In(__t__ + i * 6, 1, __d__ + i * 6, 1);
+        }
+        // V[xi] is the rhs [Cg, tcpad] of a gemm, packed as GemmPack packs it.
+        const index_t k0 = c / ch.m_KC * ch.m_KC;
+        const index_t kc = g.m_Cg - k0 < ch.m_KC ? g.m_Cg - k0 : ch.m_KC;
+        float* __v__ = ch.m_v + k0 * ch.m_tcpad + l0 / NR * NR * kc + (c - k0) * NR + l0 % NR;
+        for (index_t x = 0; x < 36; ++x) {
+          __d__[x].StoreUnAligned(__v__ + x * g.m_Cg * ch.m_tcpad);
+        }
+      }
+    }
+  }
+
+  ///! M[xi] = U[xi] x V[xi].
+  MGLORIA_INLINE_CPU static void Gemm(const ConvGeometry& g, const WinogradChunk& ch) {
+    const GemmEpilogue<op::_identity, float> __epi__ = {nullptr, 1};
+    for (index_t x = 0; x < 36; ++x) {
+      GemmBlock<Kern, op::_saveto, op::_plusto>(
+          ch.m_m + x * g.m_Cog * ch.m_tcpad, ch.m_tcpad, ch.m_u + x * ch.m_mpad * g.m_Cg,
+          ch.m_v + x * g.m_Cg * ch.m_tcpad, ch.m_mpad, ch.m_tcpad, 0, g.m_Cog, 0, ch.m_tcpad,
+          g.m_Cg, ch.m_KC, __epi__);
+    }
+  }
+
+  ///! M back to the 4x4 tiles of the output, through Saver.
+  template<typename Saver>
+  MGLORIA_INLINE_CPU static void Output(const ConvGeometry& g, const WinogradChunk& ch) {
+    const index_t num = Vec::num, TW = (g.m_OW + 3) / 4;
+    float __out__[16 * Vec::num] MGLORIA_ALIGNED(64);
+    Vec __m__[36], __t__[24], __y__[16];
+    for (index_t l0 = 0; l0 < ch.m_tc; l0 += num) {
+      for (index_t o = 0; o < g.m_Cog; ++o) {
+        const float* __src__ = ch.m_m + o * ch.m_tcpad + l0;
+        for (index_t x = 0; x < 36; ++x) {
+          __m__[x] = Vec::Load(__src__ + x * g.m_Cog * ch.m_tcpad);
+        }
+        // Columns 6x6 to 4x6, then rows to 4x4.
+        for (index_t j = 0; j < 6; ++j) { WinogradTransform<Vec>::Out(__m__ + j, 6, __t__ + j, 6); }
+        for (index_t i = 0; i < 4; ++i) {
+          WinogradTransform<Vec>::Out(__t__ + i * 6, 1, __y__ + i * 4, 1);
+        }
+        for (index_t x = 0; x < 16; ++x) { __y__[x].Store(__out__ + x * num); }
+        for (index_t j = 0; j < num && l0 + j < ch.m_tc; ++j) {
+          const index_t t = ch.m_t0 + l0 + j, oh0 = t / TW * 4, ow0 = t % TW * 4;
+          for (index_t i = 0; i < 4 && oh0 + i < g.m_OH; ++i) {
+            for (index_t k = 0; k < 4 && ow0 + k < g.m_OW; ++k) {
+              Saver::template Do<float>(
+                  ch.m_dst[WinogradAddr<Layout>::At(o, oh0 + i, ow0 + k, g.m_OH, g.m_OW, ch.m_dld)],
+                  __out__[(i * 4 + k) * num + j]);
+            }
+          }
+        }
+      }
+    }
+  }
+};
+
+/*!
+ *@brief    The roots of the Winograd kernels, compiled for Arch. See GemmArchKernel.
+ */
+template<vectorization::VecArch Arch>
+struct WinogradArchKernel {
+  template<typename Kern, LayoutTypeType Layout>
+  MGLORIA_INLINE_CPU static void Filter(const ConvGeometry& g, const float* w, index_t ld,
+                                        index_t c0, float* u) {
+    WinogradKernel<Kern, Arch, Layout>::Filter(g, w, ld, c0, u);
+  }
+
+  template<typename Kern, typename Saver, LayoutTypeType Layout>
+  MGLORIA_INLINE_CPU static void Chunk(const ConvGeometry& g, const WinogradChunk& ch) {
+    WinogradKernel<Kern, Arch, Layout>::Input(g, ch);
+    WinogradKernel<Kern, Arch, Layout>::Gemm(g, ch);
+    WinogradKernel<Kern, Arch, Layout>::template Output<Saver>(g, ch);
+  }
+};
+
+template<>
+struct WinogradArchKernel<vectorization::VecArch::AVX2_Arch> {
+  template<typename Kern, LayoutTypeType Layout>
+  MGLORIA_KERNEL_AVX2 static void Filter(const ConvGeometry& g, const float* w, index_t ld,
+                                         index_t c0, float* u) {
+    WinogradKernel<Kern, vectorization::VecArch::AVX2_Arch, Layout>::Filter(g, w, ld, c0, u);
+  }
+
+  template<typename Kern, typename Saver, LayoutTypeType Layout>
+  MGLORIA_KERNEL_AVX2 static void Chunk(const ConvGeometry& g, const WinogradChunk& ch) {
+    typedef WinogradKernel<Kern, vectorization::VecArch::AVX2_Arch, Layout> WK;
+    WK::Input(g, ch);
+    WK::Gemm(g, ch);
+    WK::template Output<Saver>(g, ch);
+  }
+};
+
+template<>
+struct WinogradArchKernel<vectorization::VecArch::AVX512_Arch> {
+  template<typename Kern, LayoutTypeType Layout>
+  MGLORIA_KERNEL_AVX512 static void Filter(const ConvGeometry& g, const float* w, index_t ld,
+                                           index_t c0, float* u) {
+    WinogradKernel<Kern, vectorization::VecArch::AVX512_Arch, Layout>::Filter(g, w, ld, c0, u);
+  }
+
+  template<typename Kern, typename Saver, LayoutTypeType Layout>
+  MGLORIA_KERNEL_AVX512 static void Chunk(const ConvGeometry& g, const WinogradChunk& ch) {
+    typedef WinogradKernel<Kern, vectorization::VecArch::AVX512_Arch, Layout> WK;
+    WK::Input(g, ch);
+    WK::Gemm(g, ch);
+    WK::template Output<Saver>(g, ch);
+  }
+};
+
+/*!
+ *@brief    The WinogradFilter of weight for Arch, from the cache or transformed now, with the
+ * scratch of the transform from the workspace of stream.
+ */
+template<typename Kern, vectorization::VecArch Arch, LayoutTypeType Layout>
+MGLORIA_INLINE_NORMAL std::shared_ptr<const WinogradFilter> WinogradGetFilter(
+    const Tensor<CPU, 4, float>& weight, const ConvGeometry& g, index_t mpad, index_t KC,
+    Stream<CPU>* stream) {
+  std::shared_ptr<WinogradFilter> __f__ = std::make_shared<WinogradFilter>();
+  __f__->m_weight = weight.__data_ptr;
+  __f__->m_shape = weight.m_Shape;
+  __f__->m_stride = weight.m_Stride_;
+  __f__->m_layout = Layout;
+  __f__->m_groups = g.m_G;
+  __f__->m_arch = Arch;
+  __f__->m_print = WinogradFingerprint(weight);
+  std::shared_ptr<const WinogradFilter> __hit__ = WinogradFilterCache::Get().Find(*__f__);
+  if (__hit__ != nullptr) { return __hit__; }
+
+  size_t __pitch__;
+  const index_t num = vectorization::Vectorized<float, Arch>::num;
+  const index_t __usize__ = 36 * g.m_Cog * g.m_Cg;
+  WorkspaceScope __ws__(stream);
+  float* __u__ = __ws__.Alloc<float>(size_t(g.m_G) * __usize__);
+  // Kept by the cache, so from the host pool rather than the workspace.
+  __f__->m_data = static_cast<float*>(
+      HostPoolMallocPitch(&__pitch__, sizeof(float) * g.m_G * 36 * mpad * g.m_Cg, 1));
+  const index_t nchunks = (g.m_Cg + num - 1) / num;
+#ifndef __CUDACC__
+#pragma omp parallel for
+#endif
+  for (openmp_index_t t = 0; t < g.m_G * nchunks; ++t) {
+    const index_t grp = t / nchunks;
+    const float* __w__ =
+        weight.__data_ptr
+        + WinogradAddr<Layout>::Weight(grp * g.m_Cog, 0, 0, 0, g.m_Cg, weight.m_Stride_);
+    WinogradArchKernel<Arch>::template Filter<Kern, Layout>(g, __w__, weight.m_Stride_,
+                                                            (t % nchunks) * num,
+                                                            __u__ + grp * __usize__);
+  }
+  for (index_t t = 0; t < g.m_G * 36; ++t) {
+    GemmPack<true>(__f__->m_data + t * mpad * g.m_Cg, __u__ + t * g.m_Cog * g.m_Cg, g.m_Cg,
+                   g.m_Cog, Kern::m_MR, g.m_Cg, KC, 1.f);
+  }
+  WinogradFilterCache::Get().Insert(__f__);
+  return __f__;
+}
+
+/*!
+ *@brief    Does the Winograd path take a conv2d of this geometry.
+ */
+MGLORIA_INLINE_NORMAL bool WinogradFits(const ConvGeometry& g) {
+  return MGLORIA_CONV_WINOGRAD == 1 && g.m_KH == 3 && g.m_KW == 3 && g.m_SH == 1 && g.m_SW == 1
+         && g.m_DH == 1 && g.m_DW == 1 && g.m_Cg >= MGLORIA_WINOGRAD_MIN_CHANNELS
+         && g.m_Cog >= MGLORIA_WINOGRAD_MIN_CHANNELS;
+}
+
+/*!
+ *@brief    Runs the Winograd path if Enable, float on an arch with vectors, and the geometry
+ * fits. Returns false if it did not.
+ */
+template<bool Enable>
+struct WinogradConv {
+  template<typename Saver, vectorization::VecArch Arch, LayoutTypeType Layout, typename DataType>
+  MGLORIA_INLINE_NORMAL static bool Execute(Tensor<CPU, 4, DataType>,
+                                            const Tensor<CPU, 4, DataType>&,
+                                            const Tensor<CPU, 4, DataType>&, const ConvGeometry&) {
+    return false;
+  }
+};
+
+template<>
+struct WinogradConv<true> {
+  template<typename Saver, vectorization::VecArch Arch, LayoutTypeType Layout>
+  MGLORIA_INLINE_NORMAL static bool Execute(Tensor<CPU, 4, float> dst,
+                                            const Tensor<CPU, 4, float>& input,
+                                            const Tensor<CPU, 4, float>& weight,
+                                            const ConvGeometry& g) {
+    if (!WinogradFits(g)) { return false; }
+    typedef GemmKernel<float, Arch, true> Kern;
+    const index_t MR = Kern::m_MR, NR = Kern::m_NR;
+    const index_t mpad = (g.m_Cog + MR - 1) / MR * MR;
+    const index_t KC = GemmDefaultBlocking<Kern, float>(g.m_Cog, NR).m_KC;
+    const std::shared_ptr<const WinogradFilter> __f__ =
+        WinogradGetFilter<Kern, Arch, Layout>(weight, g, mpad, KC, dst.m_Stream);
+
+    // A chunk is up to MGLORIA_WINOGRAD_PANELS panels of NR tiles, fewer if that leaves some
+    // threads without a chunk.
+    const index_t T = (g.m_OH + 3) / 4 * ((g.m_OW + 3) / 4), panels = (T + NR - 1) / NR;
+    index_t per = panels < MGLORIA_WINOGRAD_PANELS ? panels : MGLORIA_WINOGRAD_PANELS;
+    index_t __threads__ = 1;
+#ifdef _OPENMP
+    __threads__ = omp_get_max_threads();
+#endif
+    while (per > 1 && g.m_B * g.m_G * ((panels + per - 1) / per) < 2 * __threads__) { --per; }
+    const index_t tcpad = per * NR, nchunks = (T + tcpad - 1) / tcpad;
+
+    const index_t __vsize__ = 36 * g.m_Cg * tcpad, __msize__ = 36 * g.m_Cog * tcpad;
+    WorkspaceScope __ws__(dst.m_Stream);
+    float* __bufs__ = __ws__.Alloc<float>((__vsize__ + __msize__) * __threads__);
+    const index_t dld = dst.m_Stride_, ld = input.m_Stride_;
+#ifndef __CUDACC__
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for (openmp_index_t t = 0; t < g.m_B * g.m_G * nchunks; ++t) {
+      const index_t img = t / nchunks, b = img / g.m_G, grp = img % g.m_G;
+      index_t __id__ = 0;
+#ifdef _OPENMP
+      __id__ = omp_get_thread_num();
+#endif
+      WinogradChunk ch;
+      ch.m_src = input.__data_ptr
+                 + (Layout == LayoutTypeType::BHWC
+                        ? b * g.m_H * g.m_W * ld + grp * g.m_Cg
+                        : (b * g.m_C + grp * g.m_Cg) * g.m_H * ld);
+      ch.m_ld = ld;
+      ch.m_dst = dst.__data_ptr
+                 + (Layout == LayoutTypeType::BHWC
+                        ? b * g.m_OH * g.m_OW * dld + grp * g.m_Cog
+                        : (b * g.m_Cout + grp * g.m_Cog) * g.m_OH * dld);
+      ch.m_dld = dld;
+      ch.m_u = __f__->m_data + grp * 36 * mpad * g.m_Cg;
+      ch.m_v = __bufs__ + __id__ * (__vsize__ + __msize__);
+      ch.m_m = ch.m_v + __vsize__;
+      ch.m_t0 = (t % nchunks) * tcpad;
+      ch.m_tc = T - ch.m_t0 < tcpad ? T - ch.m_t0 : tcpad;
+      ch.m_tcpad = tcpad;
+      ch.m_mpad = mpad;
+      ch.m_KC = KC;
+      WinogradArchKernel<Arch>::template Chunk<Kern, Saver, Layout>(g, ch);
+    }
+    return true;
+  }
+};
+
+template<typename Saver, vectorization::VecArch Arch, LayoutTypeType Layout, typename DataType>
+MGLORIA_INLINE_NORMAL bool ExecuteWinogradConv2d(Tensor<CPU, 4, DataType> dst,
+                                                 const Tensor<CPU, 4, DataType>& input,
+                                                 const Tensor<CPU, 4, DataType>& weight,
+                                                 const ConvGeometry& g) {
+  return WinogradConv<std::is_same<DataType, float>::value
+                      && GemmVecCheck<DataType, Arch>::m_Enable>::template Execute<Saver, Arch,
+                                                                                   Layout>(
+      dst, input, weight, g);
+}
+
+}  // namespace expr
+}  // namespace mgloria
+
+#endif  // _MGLORIA___OP_WINOGRAD_CPU_HPP_
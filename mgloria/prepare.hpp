@@ -54,23 +54,172 @@
 #define MGLORIA_USE_BLAS 1
 #endif
 
+///! Run dot() of float and double CPU tensors on cblas_sgemm and cblas_dgemm instead of the
+///! native gemm. Needs MGLORIA_USE_BLAS or MGLORIA_USE_MKL, and the blas linked.
+#ifndef MGLORIA_DOT_USE_BLAS
+#define MGLORIA_DOT_USE_BLAS 0
+#endif
+#if MGLORIA_DOT_USE_BLAS == 1 && !MGLORIA_USE_BLAS && !MGLORIA_USE_MKL
+#error "MGLORIA_DOT_USE_BLAS needs MGLORIA_USE_BLAS or MGLORIA_USE_MKL."
+#endif
+
 #ifndef MGLORIA_USE_SSE
 #define MGLORIA_USE_SSE 1
 #endif
 
+///! AVX2 is on when the compiler is told the target has it. e.g. -mavx2 -mfma
+#ifndef MGLORIA_USE_AVX2
+#if defined(__AVX2__) && defined(__FMA__)
+#define MGLORIA_USE_AVX2 1
+#else
+#define MGLORIA_USE_AVX2 0
+#endif
+#endif
+
+///! AVX-512 needs F, BW, DQ and VL. e.g. -march=skylake-avx512
+#ifndef MGLORIA_USE_AVX512
+#if defined(__AVX512F__) && defined(__AVX512BW__) && defined(__AVX512DQ__) \
+    && defined(__AVX512VL__)
+#define MGLORIA_USE_AVX512 1
+#else
+#define MGLORIA_USE_AVX512 0
+#endif
+#endif
+
+///! Build the SSE, AVX2 and AVX-512 kernels all together, and pick one by cpuid when the
+///! program starts. The env MGLORIA_VEC_ARCH=none|sse|avx2|avx512 forces a lower level.
+#ifndef MGLORIA_RUNTIME_DISPATCH
+#define MGLORIA_RUNTIME_DISPATCH 0
+#endif
+
 #define MGLORIA_ARRAY_BOUND_CHECK 0
 #define MGLORIA_CHECK_NULL_MEM_PTR 1
 #define MGLORIA_PAD_TO_ALIGN 1
 #define MGLORIA_RUNTIME_SHAPE_CHECK 1
 #define MGLORIA_RUNTIME_DEVICE_TYPE_CHECK 1
+
+///! 1 to cache the host memory of the CPU tensors, see memory_pool.hpp. The blocks cached are of
+///! up to 2^MAX_LOG bytes, a thread keeps THREAD_BYTES of them and all the threads CACHE_BYTES.
+#ifndef MGLORIA_HOST_POOL
+#define MGLORIA_HOST_POOL 1
+#endif
+#ifndef MGLORIA_HOST_POOL_MAX_LOG
+#define MGLORIA_HOST_POOL_MAX_LOG 28
+#endif
+#ifndef MGLORIA_HOST_POOL_THREAD_BYTES
+#define MGLORIA_HOST_POOL_THREAD_BYTES (size_t(16) << 20)
+#endif
+#ifndef MGLORIA_HOST_POOL_CACHE_BYTES
+#define MGLORIA_HOST_POOL_CACHE_BYTES (size_t(1) << 30)
+#endif
+///! 1 to start the host blocks of at least HUGE_PAGE_MIN bytes on a huge page and madvise them
+///! MADV_HUGEPAGE. A NewTensor of at least FIRST_TOUCH_MIN bytes is touched first by the threads
+///! that compute on its rows, so its pages are local to them.
+#ifndef MGLORIA_HUGE_PAGES
+#define MGLORIA_HUGE_PAGES 1
+#endif
+#ifndef MGLORIA_HUGE_PAGE_BYTES
+#define MGLORIA_HUGE_PAGE_BYTES (size_t(2) << 20)
+#endif
+#ifndef MGLORIA_HUGE_PAGE_MIN
+#define MGLORIA_HUGE_PAGE_MIN (size_t(4) << 20)
+#endif
+#ifndef MGLORIA_FIRST_TOUCH_MIN
+#define MGLORIA_FIRST_TOUCH_MIN (size_t(4) << 20)
+#endif
+///! The first chunk of the workspace of a CPU stream, see workspace.hpp.
+#ifndef MGLORIA_WORKSPACE_CHUNK
+#define MGLORIA_WORKSPACE_CHUNK (size_t(1) << 20)
+#endif
+///! A checkpoint is written in chunks of CKPT_CHUNK bytes, with at most CKPT_STAGING bytes of them
+///! copied and not written yet, see checkpoint.hpp.
+#ifndef MGLORIA_CKPT_CHUNK
+#define MGLORIA_CKPT_CHUNK (size_t(4) << 20)
+#endif
+#ifndef MGLORIA_CKPT_STAGING
+#define MGLORIA_CKPT_STAGING (size_t(1) << 30)
+#endif
 #define MGLORIA_MAX_SHOW_LENGTH 8
 
-#if MGLORIA_USE_SSE == 1
+///! The work of one reduce task: elements of the last axis, or rows x columns of a leading axis.
+///! They fix the order the partials are combined in, see op/__op_reduce_cpu.hpp. The tile must
+///! be a multiple of the widest vector.
+#ifndef MGLORIA_REDUCE_CHUNK
+#define MGLORIA_REDUCE_CHUNK 8192
+#endif
+#ifndef MGLORIA_REDUCE_ROW_CHUNK
+#define MGLORIA_REDUCE_ROW_CHUNK 64
+#endif
+#ifndef MGLORIA_REDUCE_COL_TILE
+#define MGLORIA_REDUCE_COL_TILE 1024
+#endif
+
+///! The cache sizes of one core the gemm blocks for, and the most columns of dst in one gemm task.
+///! See op/__op_dot_cpu.hpp.
+#ifndef MGLORIA_GEMM_L1_BYTES
+#define MGLORIA_GEMM_L1_BYTES 32768
+#endif
+#ifndef MGLORIA_GEMM_L2_BYTES
+#define MGLORIA_GEMM_L2_BYTES 262144
+#endif
+#ifndef MGLORIA_GEMM_NC
+#define MGLORIA_GEMM_NC 1024
+#endif
+///! The tuning file of the gemm blockings, and the multiply adds under which a gemm is not tuned.
+///! A relative file is under $XDG_CACHE_HOME, else $HOME/.cache. See op/__op_dot_tune_cpu.hpp.
+#ifndef MGLORIA_GEMM_TUNE_FILE
+#define MGLORIA_GEMM_TUNE_FILE "mgloria_gemm_tune.txt"
+#endif
+#ifndef MGLORIA_GEMM_TUNE_MIN
+#define MGLORIA_GEMM_TUNE_MIN 262144
+#endif
+///! The multiply adds under which a gemm of batch_dot is not cut over the threads, see
+///! op/__op_batch_dot_cpu.hpp.
+#ifndef MGLORIA_BATCH_DOT_SMALL
+#define MGLORIA_BATCH_DOT_SMALL 262144
+#endif
+
+///! 1 to take the Winograd F(4x4, 3x3) path for the float 3x3 stride 1 conv2d, see
+///! op/__op_winograd_cpu.hpp. It needs this many channels per group on both sides.
+#ifndef MGLORIA_CONV_WINOGRAD
+#define MGLORIA_CONV_WINOGRAD 1
+#endif
+#ifndef MGLORIA_WINOGRAD_MIN_CHANNELS
+#define MGLORIA_WINOGRAD_MIN_CHANNELS 16
+#endif
+///! The transformed weights kept, and the panels of tiles a task transforms at once.
+#ifndef MGLORIA_WINOGRAD_CACHE
+#define MGLORIA_WINOGRAD_CACHE 16
+#endif
+#ifndef MGLORIA_WINOGRAD_PANELS
+#define MGLORIA_WINOGRAD_PANELS 4
+#endif
+
+///! The block an expression with Job::EvalTile (e.g. implicit_dot) is computed in, see
+///! JobTileCheck in expr_eval.hpp. The columns must be a multiple of the widest vector.
+#ifndef MGLORIA_JOB_TILE_ROWS
+#define MGLORIA_JOB_TILE_ROWS 8
+#endif
+#ifndef MGLORIA_JOB_TILE_COLS
+#define MGLORIA_JOB_TILE_COLS 64
+#endif
+
+#if MGLORIA_USE_AVX512 == 1
+#define MGLORIA_VECTORIZATION_ARCH ::mgloria::vectorization::VecArch::AVX512_Arch
+#elif MGLORIA_USE_AVX2 == 1
+#define MGLORIA_VECTORIZATION_ARCH ::mgloria::vectorization::VecArch::AVX2_Arch
+#elif MGLORIA_USE_SSE == 1
 #define MGLORIA_VECTORIZATION_ARCH ::mgloria::vectorization::VecArch::SSE_Arch
 #else
 #define MGLORIA_VECTORIZATION_ARCH ::mgloria::vectorization::VecArch::NONE_Arch
 #endif
 #define MGLORIA_DEFAULT_ALIGNBYTES 4
+///! The memory is aligned for the widest arch the binary may run with.
+#if MGLORIA_RUNTIME_DISPATCH == 1
+#define MGLORIA_VECTORIZATION_ALIGN_ARCH ::mgloria::vectorization::VecArch::AVX512_Arch
+#else
+#define MGLORIA_VECTORIZATION_ALIGN_ARCH MGLORIA_VECTORIZATION_ARCH
+#endif
 
 // include files for CUDA and C-Blas
 #if MGLORIA_USE_MKL
@@ -108,6 +257,27 @@
 // inline symbol for template code used just on cpu
 #define MGLORIA_INLINE_CPU MGLORIA_FORCE_INLINE
 #define MGLORIA_INLINE_NORMAL inline
+/*!
+ *@brief    Inline symbol for the AVX2/AVX-512 code.
+ *@details  With MGLORIA_RUNTIME_DISPATCH the file is not compiled with -mavx2 or -mavx512f, so
+ * the functions using those intrinsics are marked with the target attribute instead. They can not
+ * be always_inline then, GCC refuses to inline them into the generic template code. The
+ * MGLORIA_KERNEL_xxx functions are the roots of one arch kernel, flatten pulls all the code they
+ * call into one function compiled for that arch.
+ */
+#if MGLORIA_RUNTIME_DISPATCH == 1
+#define MGLORIA_INLINE_AVX2 inline __attribute__((target("avx2,fma")))
+#define MGLORIA_INLINE_AVX512 \
+  inline __attribute__((target("avx2,fma,avx512f,avx512bw,avx512dq,avx512vl")))
+#define MGLORIA_KERNEL_AVX2 inline __attribute__((target("avx2,fma"), flatten))
+#define MGLORIA_KERNEL_AVX512 \
+  inline __attribute__((target("avx2,fma,avx512f,avx512bw,avx512dq,avx512vl"), flatten))
+#else
+#define MGLORIA_INLINE_AVX2 MGLORIA_INLINE_CPU
+#define MGLORIA_INLINE_AVX512 MGLORIA_INLINE_CPU
+#define MGLORIA_KERNEL_AVX2 MGLORIA_INLINE_CPU
+#define MGLORIA_KERNEL_AVX512 MGLORIA_INLINE_CPU
+#endif
 
 // defined the const exp
 #define MGLORIA_CONSTEXPR constexpr
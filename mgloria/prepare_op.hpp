@@ -39,6 +39,31 @@ struct _div {
   }
 };
 
+/*!
+ *@brief  a + b and a - b clamped to the range of the integer DataType instead of wrapping around.
+ * For int32_t, int8_t and uint8_t. e.g. expr::Func<op::_sat_plus>(A, B)
+ */
+template<typename DataType>
+MGLORIA_INLINE_XPU DataType __saturate_cast__(int64_t v) {
+  return v < std::numeric_limits<DataType>::min()   ? std::numeric_limits<DataType>::min()
+         : v > std::numeric_limits<DataType>::max() ? std::numeric_limits<DataType>::max()
+                                                    : static_cast<DataType>(v);
+}
+
+struct _sat_plus {
+  template<typename DataType>
+  MGLORIA_INLINE_XPU static DataType Do(DataType a, DataType b) {
+    return __saturate_cast__<DataType>(static_cast<int64_t>(a) + static_cast<int64_t>(b));
+  }
+};
+
+struct _sat_minus {
+  template<typename DataType>
+  MGLORIA_INLINE_XPU static DataType Do(DataType a, DataType b) {
+    return __saturate_cast__<DataType>(static_cast<int64_t>(a) - static_cast<int64_t>(b));
+  }
+};
+
 struct _left {
   template<typename DataType>
   MGLORIA_INLINE_XPU static DataType Do(DataType a, DataType b) {
@@ -60,6 +85,213 @@ struct _identity {
   }
 };
 
+// ################### Math and activation op ###########################
+// They are vectorized for float by __vec_math.hpp, see the error bounds there.
+struct _exp {
+  template<typename DataType>
+  MGLORIA_INLINE_XPU static DataType Do(DataType a) {
+    return std::exp(a);
+  }
+};
+
+struct _log {
+  template<typename DataType>
+  MGLORIA_INLINE_XPU static DataType Do(DataType a) {
+    return std::log(a);
+  }
+};
+
+struct _sqrt {
+  template<typename DataType>
+  MGLORIA_INLINE_XPU static DataType Do(DataType a) {
+    return std::sqrt(a);
+  }
+};
+
+struct _rsqrt {
+  template<typename DataType>
+  MGLORIA_INLINE_XPU static DataType Do(DataType a) {
+    return DataType(1) / std::sqrt(a);
+  }
+};
+
+struct _tanh {
+  template<typename DataType>
+  MGLORIA_INLINE_XPU static DataType Do(DataType a) {
+    return std::tanh(a);
+  }
+};
+
+struct _sigmoid {
+  template<typename DataType>
+  MGLORIA_INLINE_XPU static DataType Do(DataType a) {
+    return DataType(1) / (DataType(1) + std::exp(-a));
+  }
+};
+
+///! The tanh approximation of GELU, 0.5 * a * (1 + tanh(sqrt(2 / pi) * (a + 0.044715 * a^3))).
+struct _gelu {
+  template<typename DataType>
+  MGLORIA_INLINE_XPU static DataType Do(DataType a) {
+    return DataType(0.5) * a
+           * (DataType(1)
+              + std::tanh(DataType(0.7978845608028654) * (a + DataType(0.044715) * a * a * a)));
+  }
+};
+
+struct _relu {
+  template<typename DataType>
+  MGLORIA_INLINE_XPU static DataType Do(DataType a) {
+    return a > DataType(0) ? a : DataType(0);
+  }
+};
+
+struct _abs {
+  template<typename DataType>
+  MGLORIA_INLINE_XPU static DataType Do(DataType a) {
+    return a < DataType(0) ? DataType(-a) : a;
+  }
+};
+
+struct _max {
+  template<typename DataType>
+  MGLORIA_INLINE_XPU static DataType Do(DataType a, DataType b) {
+    return a > b ? a : b;
+  }
+};
+
+struct _min {
+  template<typename DataType>
+  MGLORIA_INLINE_XPU static DataType Do(DataType a, DataType b) {
+    return a < b ? a : b;
+  }
+};
+
+// ################### Compare op #######################################
+///! 1 where the compare is true, 0 where it is not. They are the usual cond of expr::where.
+struct _lt {
+  template<typename DataType>
+  MGLORIA_INLINE_XPU static DataType Do(DataType a, DataType b) {
+    return a < b ? DataType(1) : DataType(0);
+  }
+};
+
+struct _le {
+  template<typename DataType>
+  MGLORIA_INLINE_XPU static DataType Do(DataType a, DataType b) {
+    return a <= b ? DataType(1) : DataType(0);
+  }
+};
+
+struct _gt {
+  template<typename DataType>
+  MGLORIA_INLINE_XPU static DataType Do(DataType a, DataType b) {
+    return a > b ? DataType(1) : DataType(0);
+  }
+};
+
+struct _ge {
+  template<typename DataType>
+  MGLORIA_INLINE_XPU static DataType Do(DataType a, DataType b) {
+    return a >= b ? DataType(1) : DataType(0);
+  }
+};
+
+struct _eq {
+  template<typename DataType>
+  MGLORIA_INLINE_XPU static DataType Do(DataType a, DataType b) {
+    return a == b ? DataType(1) : DataType(0);
+  }
+};
+
+struct _ne {
+  template<typename DataType>
+  MGLORIA_INLINE_XPU static DataType Do(DataType a, DataType b) {
+    return a != b ? DataType(1) : DataType(0);
+  }
+};
+
+// ################### Ternary op #######################################
+///! a clamped to [lo, hi].
+struct _clip {
+  template<typename DataType>
+  MGLORIA_INLINE_XPU static DataType Do(DataType a, DataType lo, DataType hi) {
+    return a < lo ? lo : (a > hi ? hi : a);
+  }
+};
+
+///! a * b + c. The vectorized one is fused (one rounding) on the arch with FMA.
+struct _fma {
+  template<typename DataType>
+  MGLORIA_INLINE_XPU static DataType Do(DataType a, DataType b, DataType c) {
+    return a * b + c;
+  }
+};
+
+///! a where cond is not 0, else b.
+struct _where {
+  template<typename DataType>
+  MGLORIA_INLINE_XPU static DataType Do(DataType cond, DataType a, DataType b) {
+    return cond != DataType(0) ? a : b;
+  }
+};
+
+// ################### Reducer ##########################################
+///! The reducers of ReduceExpr. The partial results are combined by OPType, starting from Init.
+///! Finish turns the combined one of n elements into the result. Only the CPU reduces for now.
+struct _red_sum {
+  typedef _plus OPType;
+  template<typename DataType>
+  MGLORIA_INLINE_CPU static DataType Init() {
+    return DataType(0);
+  }
+  template<typename DataType>
+  MGLORIA_INLINE_CPU static DataType Finish(DataType a, index_t) {
+    return a;
+  }
+};
+
+struct _red_mean {
+  typedef _plus OPType;
+  template<typename DataType>
+  MGLORIA_INLINE_CPU static DataType Init() {
+    return DataType(0);
+  }
+  template<typename DataType>
+  MGLORIA_INLINE_CPU static DataType Finish(DataType a, index_t n) {
+    return a / DataType(n);
+  }
+};
+
+struct _red_max {
+  typedef _max OPType;
+  template<typename DataType>
+  MGLORIA_INLINE_CPU static DataType Init() {
+    return std::numeric_limits<DataType>::has_infinity ? -std::numeric_limits<DataType>::infinity()
+                                                       : std::numeric_limits<DataType>::lowest();
+  }
+  template<typename DataType>
+  MGLORIA_INLINE_CPU static DataType Finish(DataType a, index_t) {
+    return a;
+  }
+};
+
+struct _red_min {
+  typedef _min OPType;
+  template<typename DataType>
+  MGLORIA_INLINE_CPU static DataType Init() {
+    return std::numeric_limits<DataType>::has_infinity ? std::numeric_limits<DataType>::infinity()
+                                                       : std::numeric_limits<DataType>::max();
+  }
+  template<typename DataType>
+  MGLORIA_INLINE_CPU static DataType Finish(DataType a, index_t) {
+    return a;
+  }
+};
+
+///! The index of the max. It keeps (value, index) pairs, see expr::ReduceKernel.
+struct _red_argmax {};
+
 struct _saveto {
   typedef _right OPType;
   template<typename DataType>
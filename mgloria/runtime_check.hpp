@@ -50,7 +50,7 @@ struct __runtime_shape_check<Dims, TypeCastExpr<OriDataType, DisDataType, A_T, E
  */
 template<int32_t Dims, typename E, typename DataType>
 struct __runtime_shape_check<Dims, TransposeExpr<E, DataType>> {
-  MGLORIA_INLINE_NORMAL static Shape<Dims> _check(const E& e) {
+  MGLORIA_INLINE_NORMAL static Shape<Dims> _check(const TransposeExpr<E, DataType>& e) {
     Shape<Dims> __tmp_s__ = __runtime_shape_check<Dims, E>::_check(e.m_expr);
     std::swap(__tmp_s__[0], __tmp_s__[1]);
     return __tmp_s__;
@@ -110,14 +110,19 @@ struct __runtime_shape_check<Dims, TernaryExpr<OP, A_T, B_T, C_T, DataType, ETyp
       const TernaryExpr<OP, A_T, B_T, C_T, DataType, EType>& e) {
     Shape<Dims> __shape_1__ = __runtime_shape_check<Dims, A_T>::_check(e.m_1);
     Shape<Dims> __shape_2__ = __runtime_shape_check<Dims, B_T>::_check(e.m_2);
-    Shape<Dims> __shape_3__ = __runtime_shape_check<Dims, B_T>::_check(e.m_3);
-    if (__shape_1__ == __shape_2__ && __shape_2__ == __shape_3__) {
-      LOG_ERR << "__shape_1__ == __shape_2__ && __shape_2__ == __shape_3__"
-              << " Found shape1 is" << __shape_1__ << ", shape2 is " << __shape_2__
-              << ", shape3 is " << __shape_3__ << std::endl;
+    Shape<Dims> __shape_3__ = __runtime_shape_check<Dims, C_T>::_check(e.m_3);
+    // The scalars (shape[0] == 0) go with any shape, the others must be the same.
+    Shape<Dims> __shape__ = __shape_1__[0] != 0 ? __shape_1__
+                            : (__shape_2__[0] != 0 ? __shape_2__ : __shape_3__);
+    if ((__shape_1__[0] != 0 && !(__shape_1__ == __shape__))
+        || (__shape_2__[0] != 0 && !(__shape_2__ == __shape__))
+        || (__shape_3__[0] != 0 && !(__shape_3__ == __shape__))) {
+      LOG_ERR << "The shapes of the ternary expression are not the same."
+              << " Found shape1 is " << __shape_1__.str() << ", shape2 is " << __shape_2__.str()
+              << ", shape3 is " << __shape_3__.str() << std::endl;
       std::exit(MGLORIA_SHAPE_ERROR_EXIT);
     }
-    return __shape_1__;
+    return __shape__;
   }
 };
 
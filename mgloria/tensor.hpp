@@ -8,7 +8,9 @@
 #ifndef _MGLORIA_TENSOR_HPP_
 #define _MGLORIA_TENSOR_HPP_
 #pragma once
+#include <atomic>
 #include <iostream>
+#include <utility>
 #include "depends.hpp"
 #include "expression.hpp"
 #include "tensor_shape.hpp"
@@ -207,6 +209,7 @@ class Tensor : public TRValue<Tensor<Device, Dims, DataType>, Device, Dims, Data
     this->m_Stream = T.m_Stream;
     this->m_Stride_ = T.m_Stride_;
     this->__data_ptr = T.__data_ptr;
+    return *this;
   }
 
   /*!
@@ -322,6 +325,9 @@ class Tensor<Device, 1, DataType>
 
   MGLORIA_INLINE_NORMAL int32_t AllElementNum() const { return SubElementNum<0>(); }
 
+  // Get the size.
+  MGLORIA_INLINE_NORMAL index_t size(index_t i) const { return m_Shape[i]; }
+
   // Get the Memory cost.
   template<index_t start>
   MGLORIA_INLINE_NORMAL size_t SubMemCost() const {
@@ -352,6 +358,7 @@ class Tensor<Device, 1, DataType>
     this->m_Stream = T.m_Stream;
     this->m_Stride_ = T.m_Stride_;
     this->__data_ptr = T.__data_ptr;
+    return *this;
   }
 
   template<typename SubType, expr::exprType EType>
@@ -403,18 +410,177 @@ MGLORIA_INLINE_NORMAL void MallocTensor(Tensor<Device, Dims, DataType>* t, bool
 template<typename Device, int Dims, typename DataType>
 MGLORIA_INLINE_NORMAL void FreeTensor(Tensor<Device, Dims, DataType>* t);
 
+/*!
+ *@brief        The memory of a TensorT and of all its views. The last one to let it go frees it.
+ */
+template<typename Device>
+struct TensorStorage {
+  void* m_data;                  ///! The block MallocTensor allocated.
+  std::atomic<int32_t> m_refs;   ///! The TensorTs holding it.
+};
+
+/*!
+ *@brief        Free the block of a storage and the storage itself.
+ */
+template<typename Device>
+MGLORIA_INLINE_NORMAL void FreeTensorStorage(TensorStorage<Device>* s);
+
 //##############################################################################
 //          Below is the definition of TensorT and implementation              #
 //##############################################################################
 
-template<typename Device, int dims, typename DataType>
-class TensorT : public Tensor<Device, dims, DataType> {
- public:
-  TensorT(bool align = MGLORIA_PAD_TO_ALIGN) {}
-  // TODO After Utils is implemented. This class could be implemented.
+template<typename Device, int Dims, typename DataType>
+class TensorT;
+
+/*!
+ *@brief        What operator[] of a TensorT gives: a view dropping the highest dimension, an
+ * element for 1 dimension.
+ */
+template<typename Device, int Dims, typename DataType>
+struct TensorTIndex {
+  typedef TensorT<Device, Dims - 1, DataType> type;
+  MGLORIA_INLINE_NORMAL static type Do(const TensorT<Device, Dims, DataType>& t, index_t idx) {
+    return type(static_cast<const Tensor<Device, Dims, DataType>&>(t)[idx], t.m_Storage);
+  }
+};
+
+template<typename Device, typename DataType>
+struct TensorTIndex<Device, 1, DataType> {
+  typedef DataType& type;
+  MGLORIA_INLINE_NORMAL static type Do(const TensorT<Device, 1, DataType>& t, index_t idx) {
+    return t.__data_ptr[idx];
+  }
+};
+
+/*!
+ *@brief        The Tensor owning its memory. A copy, Slice, operator[] and Flatten are views
+ * sharing the storage, the memory is given back to the allocator when the last of them goes.
+ *@example      TensorT<CPU, 2, float> A(Shape<2>(64, 64));
+ *              A = 1.f;
+ *              TensorT<CPU, 1, float> row = A[3];   // A view, no copy.
+ *              TensorT<CPU, 2, float> B = A.Clone(); // A copy of the data.
+ *              TensorT<CPU, 2, float> C = std::move(B);
+ *@note         Assigning a Tensor or any expression to a TensorT computes into its memory, as for
+ * Tensor. Assigning a TensorT to a TensorT shares the storage. Do not DeleteTensor a TensorT.
+ */
+template<typename Device, int Dims, typename DataType>
+class TensorT : public Tensor<Device, Dims, DataType> {
  public:
+  typedef Tensor<Device, Dims, DataType> Base;
+
+  MGLORIA_INLINE_NORMAL TensorT(bool align = MGLORIA_PAD_TO_ALIGN) : align(align) {}
+
+  MGLORIA_INLINE_NORMAL explicit TensorT(const Shape<Dims>& shape,
+                                         bool align = MGLORIA_PAD_TO_ALIGN,
+                                         Stream<Device>* stream = nullptr)
+      : Base(shape, stream), align(align) {
+    MallocTensor(static_cast<Base*>(this), align);
+    m_Storage = new TensorStorage<Device>;
+    m_Storage->m_data = this->__data_ptr;
+    m_Storage->m_refs.store(1, std::memory_order_relaxed);
+  }
+
+  MGLORIA_INLINE_NORMAL TensorT(const TensorT& T)
+      : Base(T), m_Storage(T.m_Storage), align(T.align) {
+    Retain();
+  }
+
+  MGLORIA_INLINE_NORMAL TensorT(TensorT&& T) noexcept
+      : Base(T), m_Storage(T.m_Storage), align(T.align) {
+    T.m_Storage = nullptr;
+    T.__data_ptr = nullptr;
+  }
+
+  MGLORIA_INLINE_NORMAL ~TensorT() { Release(); }
+
+  MGLORIA_INLINE_NORMAL TensorT& operator=(const TensorT& T) {
+    if (this != &T) {
+      TensorT __tmp__(T);
+      Swap(__tmp__);
+    }
+    return *this;
+  }
+
+  MGLORIA_INLINE_NORMAL TensorT& operator=(TensorT&& T) noexcept {
+    if (this != &T) {
+      Release();
+      Swap(T);
+    }
+    return *this;
+  }
+
+  template<typename SubType, expr::exprType EType>
+  MGLORIA_INLINE_NORMAL Base operator=(
+      const expr::Expression<SubType, DataType, EType>& expression) {
+    return Base::operator=(expression);
+  }
+
+  MGLORIA_INLINE_NORMAL Base operator=(const DataType& scalar) { return Base::operator=(scalar); }
+
+  ///! Lets the storage go, the tensor is empty after.
+  MGLORIA_INLINE_NORMAL void Release() {
+    if (m_Storage != nullptr && m_Storage->m_refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      FreeTensorStorage(m_Storage);
+    }
+    m_Storage = nullptr;
+    this->__data_ptr = nullptr;
+  }
+
+  ///! The TensorTs sharing the storage, 0 for an empty one.
+  MGLORIA_INLINE_NORMAL int32_t UseCount() const {
+    return m_Storage == nullptr ? 0 : m_Storage->m_refs.load(std::memory_order_relaxed);
+  }
+
+  ///! A TensorT of its own memory with the same data.
+  MGLORIA_INLINE_NORMAL TensorT Clone() const {
+    TensorT __ans__(this->m_Shape, align, this->m_Stream);
+    __ans__ = static_cast<const Base&>(*this);
+    return __ans__;
+  }
+
+  // Views, sharing the storage.
+  MGLORIA_INLINE_NORMAL TensorT Slice(index_t start, index_t end) const {
+    return TensorT(Base::Slice(start, end), m_Storage);
+  }
+
+  MGLORIA_INLINE_NORMAL typename TensorTIndex<Device, Dims, DataType>::type operator[](
+      index_t idx) const {
+    return TensorTIndex<Device, Dims, DataType>::Do(*this, idx);
+  }
+
+  MGLORIA_INLINE_NORMAL TensorT<Device, 1, DataType> Flatten1D() const {
+    return TensorT<Device, 1, DataType>(Base::Flatten1D(), m_Storage);
+  }
+
+  MGLORIA_INLINE_NORMAL TensorT<Device, 2, DataType> Flatten2D() const {
+    return TensorT<Device, 2, DataType>(Base::Flatten2D(), m_Storage);
+  }
+
+  TensorStorage<Device>* m_Storage = nullptr;
   bool align = false;
-};  /// TensorT for more than 1 dims
+
+ private:
+  template<typename out_Device, int out_Dims, typename out_DataType>
+  friend class TensorT;
+  template<typename out_Device, int out_Dims, typename out_DataType>
+  friend struct TensorTIndex;
+
+  ///! A view of the storage.
+  MGLORIA_INLINE_NORMAL TensorT(const Base& view, TensorStorage<Device>* storage)
+      : Base(view), m_Storage(storage) {
+    Retain();
+  }
+
+  MGLORIA_INLINE_NORMAL void Retain() {
+    if (m_Storage != nullptr) { m_Storage->m_refs.fetch_add(1, std::memory_order_relaxed); }
+  }
+
+  MGLORIA_INLINE_NORMAL void Swap(TensorT& T) {
+    std::swap(static_cast<Base&>(*this), static_cast<Base&>(T));
+    std::swap(m_Storage, T.m_Storage);
+    std::swap(align, T.align);
+  }
+};
 
 //##############################################################################
 //          Below is the definition of how to map the expression to tensor.    #
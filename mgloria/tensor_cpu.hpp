@@ -7,6 +7,8 @@
 
 #include "tensor.hpp"
 #include "./vectorization/veced_op.hpp"
+#include "memory_pool.hpp"
+#include "workspace.hpp"
 
 #include "expr_eval.hpp"
 
@@ -97,12 +99,12 @@ MGLORIA_INLINE_NORMAL void __HostFree__<GPU>(void* ptr) {
 template<>
 MGLORIA_INLINE_NORMAL void* __HostMalloc__<CPU>(size_t size) {
   size_t pitch;
-  return vectorization::MallocAlignedPitch(&pitch, size, 1);
+  return HostPoolMallocPitch(&pitch, size, 1);
 }
 
 template<>
 MGLORIA_INLINE_NORMAL void __HostFree__<CPU>(void* ptr) {
-  vectorization::FreeAlignedPitch(ptr);
+  HostPoolFree(ptr);
 }
 
 template<typename xpu, int Dims, typename DataType>
@@ -122,24 +124,32 @@ MGLORIA_INLINE_NORMAL void HostFree(Tensor<CPU, Dims, DataType>* T) {
 
 // ######################## Below for Tensor memory allocate. #####################
 
+/*!
+ *@brief    Allocate the memory of T. A large block new from the system is touched first by rows
+ * from the threads that compute on them, unless touch is false: T is about to be initialized.
+ */
 template<int Dims, typename DataType>
-MGLORIA_INLINE_NORMAL void HostMallocTensorMem(Tensor<CPU, Dims, DataType>* T, bool pad) {
+MGLORIA_INLINE_NORMAL void HostMallocTensorMem(Tensor<CPU, Dims, DataType>* T, bool pad,
+                                               bool touch = true) {
   size_t pitch;
   void* ptr;
+  bool fresh;
+  const size_t rows = T->m_Shape.Flatten2D()[0];
   if (pad) {
-    ptr = vectorization::MallocAlignedPitch(&pitch, T->size(Dims - 1) * sizeof(DataType),
-                                            T->m_Shape.Flatten2D()[0]);
+    ptr = HostPoolMallocPitch(&pitch, T->size(Dims - 1) * sizeof(DataType), rows, &fresh);
     T->m_Stride_ = static_cast<index_t>(pitch / sizeof(DataType));
   } else {
     T->m_Stride_ = T->size(Dims - 1);
-    ptr = vectorization::MallocAlignedPitch(&pitch, T->m_Shape.Size() * sizeof(DataType), 1);
+    ptr = HostPoolMallocPitch(&pitch, T->m_Shape.Size() * sizeof(DataType), 1, &fresh);
   }
   T->__data_ptr = reinterpret_cast<DataType*>(ptr);
+  const size_t line = T->m_Stride_ * sizeof(DataType);
+  if (touch && fresh && line * rows >= MGLORIA_FIRST_TOUCH_MIN) { HostFirstTouch(ptr, line, rows); }
 }
 
 template<int Dims, typename DataType>
 MGLORIA_INLINE_NORMAL void HostFreeTensorMem(Tensor<CPU, Dims, DataType>* T) {
-  vectorization::FreeAlignedPitch(T->__data_ptr);
+  HostPoolFree(T->__data_ptr);
   T->__data_ptr = nullptr;
 }
 
@@ -150,7 +160,8 @@ MGLORIA_INLINE_NORMAL Tensor<DeviceType, Dims, DataType> NewTensor(const Shape<D
                                                                    Stream<DeviceType>* stream_) {
   Tensor<DeviceType, Dims, DataType> T(shape);
   T.m_Stream = stream_;
-  HostMallocTensorMem(&T, pad);
+  // The init touches the rows first as the first touch would.
+  HostMallocTensorMem(&T, pad, !init);
   if (init) { T = InitValue; }
   return T;
 }
@@ -160,20 +171,79 @@ MGLORIA_INLINE_NORMAL void DeleteTensor(Tensor<DeviceType, Dims, DataType>* T) {
   HostFreeTensorMem(T);
 }
 
+template<int Dims, typename DataType>
+MGLORIA_INLINE_NORMAL void MallocTensor(Tensor<CPU, Dims, DataType>* t, bool aligned) {
+  HostMallocTensorMem(t, aligned);
+}
+
+template<int Dims, typename DataType>
+MGLORIA_INLINE_NORMAL void FreeTensor(Tensor<CPU, Dims, DataType>* t) {
+  HostFreeTensorMem(t);
+}
+
+template<>
+MGLORIA_INLINE_NORMAL void FreeTensorStorage<CPU>(TensorStorage<CPU>* s) {
+  HostPoolFree(s->m_data);
+  delete s;
+}
+
 // ######################## Below for actual tensor expression execute ############
-template<typename Saver, typename R, int Dims, typename DataType, typename E>
-MGLORIA_INLINE_NORMAL void MapJob2Tensor(TRValue<R, CPU, Dims, DataType>* dst,
-                                         const expr::Job<E, DataType>& plan) {
-  Shape<2> __shape__ = expr::__runtime_shape_check<Dims, R>::_check(dst->Self()).Flatten2D();
-  expr::Job<R, DataType> disJobs = expr::NewJob(dst->Self());
+/*!
+ *@brief    Runs a Job element by element, or block by block if it has EvalTile (JobTileCheck).
+ */
+template<bool Tiled>
+struct MapJob2Tensor_CPU {
+  template<typename Saver, typename R, int Dims, typename DataType, typename E>
+  MGLORIA_INLINE_NORMAL static void Do(TRValue<R, CPU, Dims, DataType>* dst,
+                                       const expr::Job<E, DataType>& plan) {
+    Shape<2> __shape__ = expr::__runtime_shape_check<Dims, R>::_check(dst->Self()).Flatten2D();
+    expr::Job<R, DataType> disJobs = expr::NewJob(dst->Self());
 #ifndef __CUDACC__
 #pragma omp parallel for
 #endif
-  for (openmp_index_t y = 0; y < __shape__[0]; ++y) {
-    for (index_t x = 0; x < __shape__[1]; ++x) {
-      Saver::template Do<DataType>(disJobs.REval(y, x), plan.Eval(y, x));
+    for (openmp_index_t y = 0; y < __shape__[0]; ++y) {
+      for (index_t x = 0; x < __shape__[1]; ++x) {
+        Saver::template Do<DataType>(disJobs.REval(y, x), plan.Eval(y, x));
+      }
+    }
+  }
+};
+
+template<>
+struct MapJob2Tensor_CPU<true> {
+  template<typename Saver, typename R, int Dims, typename DataType, typename E>
+  MGLORIA_INLINE_NORMAL static void Do(TRValue<R, CPU, Dims, DataType>* dst,
+                                       const expr::Job<E, DataType>& plan) {
+    Shape<2> __shape__ = expr::__runtime_shape_check<Dims, R>::_check(dst->Self()).Flatten2D();
+    expr::Job<R, DataType> disJobs = expr::NewJob(dst->Self());
+    const index_t yblocks = (__shape__[0] + MGLORIA_JOB_TILE_ROWS - 1) / MGLORIA_JOB_TILE_ROWS;
+    const index_t xblocks = (__shape__[1] + MGLORIA_JOB_TILE_COLS - 1) / MGLORIA_JOB_TILE_COLS;
+#ifndef __CUDACC__
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for (openmp_index_t t = 0; t < yblocks * xblocks; ++t) {
+      alignas(64) DataType __tile__[MGLORIA_JOB_TILE_ROWS * MGLORIA_JOB_TILE_COLS];
+      const index_t y0 = (t / xblocks) * MGLORIA_JOB_TILE_ROWS;
+      const index_t x0 = (t % xblocks) * MGLORIA_JOB_TILE_COLS;
+      const index_t rows =
+          __shape__[0] - y0 < MGLORIA_JOB_TILE_ROWS ? __shape__[0] - y0 : MGLORIA_JOB_TILE_ROWS;
+      const index_t cols =
+          __shape__[1] - x0 < MGLORIA_JOB_TILE_COLS ? __shape__[1] - x0 : MGLORIA_JOB_TILE_COLS;
+      plan.EvalTile(y0, x0, rows, cols, __tile__);
+      for (index_t r = 0; r < rows; ++r) {
+        for (index_t c = 0; c < cols; ++c) {
+          Saver::template Do<DataType>(disJobs.REval(y0 + r, x0 + c),
+                                       __tile__[r * MGLORIA_JOB_TILE_COLS + c]);
+        }
+      }
     }
   }
+};
+
+template<typename Saver, typename R, int Dims, typename DataType, typename E>
+MGLORIA_INLINE_NORMAL void MapJob2Tensor(TRValue<R, CPU, Dims, DataType>* dst,
+                                         const expr::Job<E, DataType>& plan) {
+  MapJob2Tensor_CPU<expr::JobTileCheck<E>::m_Enable>::template Do<Saver>(dst, plan);
 }
 
 template<bool Passed, typename Saver, typename R, int Dims, typename DataType, typename E,
@@ -185,21 +255,72 @@ struct MapExpr2Tensor_CPU {
   }
 };
 
-template<typename SV, int Dims, typename DataType, typename E, int etype>
-struct MapExpr2Tensor_CPU<true, SV, Tensor<CPU, Dims, DataType>, Dims, DataType, E, etype> {
+/*!
+ *@brief    Run the expression vectorized with Arch, if Passed (the VecCheck for Arch). The data
+ * aligned for Arch runs the aligned job, the others (slices, offset buffers) run the peeled job
+ * with unaligned loads. Only the dst not even aligned to its DataType falls back to the scalar job.
+ */
+template<bool Passed, vectorization::VecArch Arch>
+struct MapExpr2TensorVec_CPU {
+  template<typename SV, int Dims, typename DataType, typename E, int etype>
+  MGLORIA_INLINE_NORMAL static void Do(Tensor<CPU, Dims, DataType>* dst,
+                                       const expr::Expression<E, DataType, etype>& exp) {
+    MapJob2Tensor<SV>(dst, expr::NewJob(exp.Self()));
+  }
+};
+
+template<vectorization::VecArch Arch>
+struct MapExpr2TensorVec_CPU<true, Arch> {
+  template<typename SV, int Dims, typename DataType, typename E, int etype>
   MGLORIA_INLINE_NORMAL static void Do(Tensor<CPU, Dims, DataType>* dst,
                                        const expr::Expression<E, DataType, etype>& exp) {
-    if (VecDataAlignCheck<Dims, E, MGLORIA_VECTORIZATION_ARCH>::_check(exp.Self())
-        && VecDataAlignCheck<Dims, Tensor<CPU, Dims, DataType>, MGLORIA_VECTORIZATION_ARCH>::_check(
-            *dst)) {
-      expr::ExecuteVectorizedJob<SV>(
-          dst->Self(), expr::NewVectorizedJob<MGLORIA_VECTORIZATION_ARCH>(exp.Self()));
+    if (VecDataAlignCheck<Dims, E, Arch>::_check(exp.Self())
+        && VecDataAlignCheck<Dims, Tensor<CPU, Dims, DataType>, Arch>::_check(*dst)) {
+      expr::ExecuteVectorizedJob<SV>(dst->Self(), expr::NewVectorizedJob<Arch>(exp.Self()));
+    } else if (reinterpret_cast<size_t>(dst->__data_ptr) % sizeof(DataType) == 0) {
+      expr::ExecuteVectorizedJobPeeled<SV>(dst->Self(), expr::NewVectorizedJob<Arch>(exp.Self()));
     } else {
       MapJob2Tensor<SV>(dst, expr::NewJob(exp.Self()));
     }
   }
 };
 
+template<typename SV, int Dims, typename DataType, typename E, int etype>
+struct MapExpr2Tensor_CPU<true, SV, Tensor<CPU, Dims, DataType>, Dims, DataType, E, etype> {
+  MGLORIA_INLINE_NORMAL static void Do(Tensor<CPU, Dims, DataType>* dst,
+                                       const expr::Expression<E, DataType, etype>& exp) {
+#if MGLORIA_RUNTIME_DISPATCH == 1
+    using vectorization::VecArch;
+    switch (vectorization::RuntimeVecArch()) {
+      case VecArch::AVX512_Arch: {
+        MapExpr2TensorVec_CPU<VecSaveCheck<SV, E, DataType, VecArch::AVX512_Arch>::m_Enable,
+                              VecArch::AVX512_Arch>::template Do<SV>(dst, exp);
+        break;
+      }
+      case VecArch::AVX2_Arch: {
+        MapExpr2TensorVec_CPU<VecSaveCheck<SV, E, DataType, VecArch::AVX2_Arch>::m_Enable,
+                              VecArch::AVX2_Arch>::template Do<SV>(dst, exp);
+        break;
+      }
+#if MGLORIA_USE_SSE == 1
+      case VecArch::SSE_Arch: {
+        MapExpr2TensorVec_CPU<VecSaveCheck<SV, E, DataType, VecArch::SSE_Arch>::m_Enable,
+                              VecArch::SSE_Arch>::template Do<SV>(dst, exp);
+        break;
+      }
+#endif  // MGLORIA_USE_SSE == 1
+      default: {
+        MapJob2Tensor<SV>(dst, expr::NewJob(exp.Self()));
+        break;
+      }
+    }
+#else
+    MapExpr2TensorVec_CPU<VecSaveCheck<SV, E, DataType, MGLORIA_VECTORIZATION_ARCH>::m_Enable,
+                          MGLORIA_VECTORIZATION_ARCH>::template Do<SV>(dst, exp);
+#endif  // MGLORIA_RUNTIME_DISPATCH == 1
+  }
+};
+
 template<typename Saver, typename R, int Dims, typename DType, typename E, int etype>
 MGLORIA_INLINE_NORMAL void MapExpr2Tensor(TRValue<R, CPU, Dims, DType>* dst,
                                           const expr::Expression<E, DType, etype>& exp) {
@@ -209,8 +330,10 @@ MGLORIA_INLINE_NORMAL void MapExpr2Tensor(TRValue<R, CPU, Dims, DType>* dst,
 #endif
   LOG_CHECK(__shape_expr__ == __shape_left__ || __shape_expr__[0] == 0,
             "\nShape_Expr=", __shape_expr__.str(), "Shape_Left=", __shape_left__.str());
-  MapExpr2Tensor_CPU<VecCheck<E, MGLORIA_VECTORIZATION_ARCH>::m_Enable, Saver, R, Dims, DType, E,
-                     etype>::Do(dst->SelfPtr(), exp);
+  // With runtime dispatch, each arch checks again if it can vectorize the expression.
+  MapExpr2Tensor_CPU<VecSaveCheck<Saver, E, DType, MGLORIA_VECTORIZATION_ARCH>::m_Enable
+                         || MGLORIA_RUNTIME_DISPATCH == 1,
+                     Saver, R, Dims, DType, E, etype>::Do(dst->SelfPtr(), exp);
 }
 
 }  // namespace mgloria
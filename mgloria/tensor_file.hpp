@@ -0,0 +1,228 @@
+/*!
+ *@author   chenghua.wang
+ *@file     tensor_file.hpp
+ *@brief    The tensor file: a CPU tensor saved with its rows padded as in memory, so a loader maps
+ * the file and the tensor points straight into the mapping, with no read and no copy.
+ *@details  The file is a TensorFileHeader, then the rows from ms_DataOffset on. A row takes the
+ * bytes of its columns rounded up to 64, the pitch HostMallocTensorMem gives on AVX-512 and a
+ * multiple of it on the other archs: every row is aligned for the vectorized jobs of any build.
+ *
+ * MappedTensor maps the file read-only and shared. Opening is O(1), the pages are read when the
+ * tensor is, and every process mapping the same file shares them in the page cache.
+ *@note     The header and the data are of the byte order of the host that saved them. Writing to
+ * a mapped tensor faults. SaveTensorFile writes a new file and renames it over the old one, so
+ * the processes that mapped the old one keep their data.
+ */
+
+#ifndef _MGLORIA_TENSOR_FILE_HPP_
+#define _MGLORIA_TENSOR_FILE_HPP_
+
+#pragma once
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "tensor_cpu.hpp"
+
+namespace mgloria {
+
+/*!
+ *@brief    The head of a tensor file.
+ */
+struct TensorFileHeader {
+  static const uint32_t ms_Version = 1;
+  static const int ms_MaxDims = 8;
+  static const size_t ms_RowAlign = 64;
+  static const size_t ms_DataOffset = 4096;
+
+  char m_magic[8];                ///! "MGLTNSR", 0 ended.
+  uint32_t m_version;             ///! ms_Version.
+  uint8_t m_type;                 ///! TypeType of the elements.
+  uint8_t m_elem_bytes;           ///! sizeof an element.
+  uint16_t m_dims;                ///! Dimensions.
+  uint64_t m_stride;              ///! Elements from a row to the next.
+  uint64_t m_offset;              ///! Bytes from the start of the file to the first row.
+  uint64_t m_shape[ms_MaxDims];   ///! The shape, the unused ones are 0.
+
+  MGLORIA_INLINE_NORMAL static const char* Magic() { return "MGLTNSR"; }
+};
+
+/*!
+ *@brief    Save T to path as a tensor file, false if it can not be written.
+ */
+template<int Dims, typename DataType>
+MGLORIA_INLINE_NORMAL bool SaveTensorFile(const std::string& path,
+                                          const Tensor<CPU, Dims, DataType>& T) {
+  static_assert(Dims <= TensorFileHeader::ms_MaxDims, "Too many dimensions for a tensor file.");
+  const size_t __cols__ = T.size(Dims - 1), __rows__ = T.m_Shape.Flatten2D()[0];
+  const size_t __line__ = __cols__ * sizeof(DataType);
+  const size_t __pitch__ = (__line__ + TensorFileHeader::ms_RowAlign - 1)
+                           / TensorFileHeader::ms_RowAlign * TensorFileHeader::ms_RowAlign;
+
+  std::vector<char> __head__(TensorFileHeader::ms_DataOffset, 0);
+  TensorFileHeader* __h__ = reinterpret_cast<TensorFileHeader*>(__head__.data());
+  std::memcpy(__h__->m_magic, TensorFileHeader::Magic(), 8);
+  __h__->m_version = TensorFileHeader::ms_Version;
+  __h__->m_type = static_cast<uint8_t>(ElementType<DataType>::Type);
+  __h__->m_elem_bytes = sizeof(DataType);
+  __h__->m_dims = Dims;
+  __h__->m_stride = __pitch__ / sizeof(DataType);
+  __h__->m_offset = TensorFileHeader::ms_DataOffset;
+  for (int i = 0; i < Dims; ++i) { __h__->m_shape[i] = static_cast<uint64_t>(T.size(i)); }
+
+  // Of this process, so that two saving the same path do not write into one file.
+  const std::string __tmp__ = path + ".tmp." + std::to_string(::getpid());
+  std::FILE* __f__ = std::fopen(__tmp__.c_str(), "wb");
+  if (__f__ == nullptr) {
+    LOG_WARN << "The tensor file " << __tmp__ << " can not be created." << std::endl;
+    return false;
+  }
+  bool __ok__ = std::fwrite(__head__.data(), 1, __head__.size(), __f__) == __head__.size();
+  if (__pitch__ == __line__ && static_cast<size_t>(T.m_Stride_) == __cols__) {
+    __ok__ = __ok__ && std::fwrite(T.__data_ptr, __pitch__, __rows__, __f__) == __rows__;
+  } else {
+    std::vector<char> __row__(__pitch__, 0);
+    for (size_t r = 0; r < __rows__ && __ok__; ++r) {
+      std::memcpy(__row__.data(), T.__data_ptr + r * T.m_Stride_, __line__);
+      __ok__ = std::fwrite(__row__.data(), 1, __pitch__, __f__) == __pitch__;
+    }
+  }
+  // On disk before the rename, or a crash may leave path empty where the old file was.
+  __ok__ = __ok__ && std::fflush(__f__) == 0 && ::fdatasync(::fileno(__f__)) == 0;
+  __ok__ = std::fclose(__f__) == 0 && __ok__;
+  if (__ok__) { __ok__ = std::rename(__tmp__.c_str(), path.c_str()) == 0; }
+  if (!__ok__) {
+    std::remove(__tmp__.c_str());
+    LOG_WARN << "The tensor file " << path << " can not be written." << std::endl;
+  }
+  return __ok__;
+}
+
+/*!
+ *@brief    A tensor file mapped read-only. The tensor is valid while the MappedTensor is.
+ *@example  MappedTensor<2, float> W;
+ *          if (W.Open("weight.mgt")) { out = expr::dot(x, W.Get()); }
+ */
+template<int Dims, typename DataType>
+class MappedTensor {
+ public:
+  MGLORIA_INLINE_NORMAL MappedTensor() : m_base(nullptr), m_bytes(0) {}
+
+  MGLORIA_INLINE_NORMAL ~MappedTensor() { Close(); }
+
+  MappedTensor(const MappedTensor&) = delete;
+  MappedTensor& operator=(const MappedTensor&) = delete;
+
+  MGLORIA_INLINE_NORMAL MappedTensor(MappedTensor&& M) noexcept
+      : m_base(M.m_base), m_bytes(M.m_bytes), m_tensor(M.m_tensor) {
+    M.m_base = nullptr;
+    M.m_bytes = 0;
+    M.m_tensor.__data_ptr = nullptr;
+  }
+
+  MGLORIA_INLINE_NORMAL MappedTensor& operator=(MappedTensor&& M) noexcept {
+    if (this != &M) {
+      Close();
+      std::swap(m_base, M.m_base);
+      std::swap(m_bytes, M.m_bytes);
+      std::swap(m_tensor, M.m_tensor);
+    }
+    return *this;
+  }
+
+  ///! Map the file at path, false if it is not a tensor file of Dims and DataType.
+  MGLORIA_INLINE_NORMAL bool Open(const std::string& path) {
+    Close();
+    const int __fd__ = ::open(path.c_str(), O_RDONLY);
+    if (__fd__ < 0) { return Fail(path, "can not be opened"); }
+    struct stat __st__;
+    if (::fstat(__fd__, &__st__) != 0 || size_t(__st__.st_size) < sizeof(TensorFileHeader)) {
+      ::close(__fd__);
+      return Fail(path, "is too short");
+    }
+    m_bytes = static_cast<size_t>(__st__.st_size);
+    void* __base__ = ::mmap(nullptr, m_bytes, PROT_READ, MAP_SHARED, __fd__, 0);
+    // The mapping keeps the file.
+    ::close(__fd__);
+    if (__base__ == MAP_FAILED) {
+      m_bytes = 0;
+      return Fail(path, "can not be mapped");
+    }
+    m_base = __base__;
+
+    const TensorFileHeader* __h__ = static_cast<const TensorFileHeader*>(m_base);
+    if (std::memcmp(__h__->m_magic, TensorFileHeader::Magic(), 8) != 0
+        || __h__->m_version != TensorFileHeader::ms_Version) {
+      return Fail(path, "is not a tensor file");
+    }
+    if (__h__->m_type != static_cast<uint8_t>(ElementType<DataType>::Type)
+        || __h__->m_elem_bytes != sizeof(DataType) || __h__->m_dims != Dims) {
+      return Fail(path, "holds another type or number of dimensions");
+    }
+    Shape<Dims> __shape__;
+    // A forged header must not wrap the products below around into the file.
+    uint64_t __rows__ = 1;
+    for (int i = 0; i < Dims; ++i) {
+      const uint64_t __n__ = __h__->m_shape[i];
+      if (__n__ > uint64_t(INT32_MAX)
+          || (i < Dims - 1 && __n__ != 0 && __rows__ > UINT64_MAX / __n__)) {
+        return Fail(path, "has a too large shape");
+      }
+      __shape__[i] = static_cast<index_t>(__n__);
+      if (i < Dims - 1) { __rows__ *= __n__; }
+    }
+    if (__h__->m_stride < __h__->m_shape[Dims - 1] || __h__->m_stride > uint64_t(INT32_MAX)) {
+      return Fail(path, "has a bad stride");
+    }
+    const uint64_t __pitch__ = __h__->m_stride * sizeof(DataType);
+    const uint64_t __offset__ = __h__->m_offset;
+    if (__pitch__ % TensorFileHeader::ms_RowAlign != 0
+        || __offset__ % TensorFileHeader::ms_RowAlign != 0
+        || __offset__ < sizeof(TensorFileHeader) || __offset__ > m_bytes
+        || (__pitch__ != 0 && __rows__ > (m_bytes - __offset__) / __pitch__)) {
+      return Fail(path, "has rows out of the file or not aligned");
+    }
+    m_tensor = Tensor<CPU, Dims, DataType>(
+        reinterpret_cast<DataType*>(static_cast<char*>(m_base) + __h__->m_offset), __shape__,
+        static_cast<index_t>(__h__->m_stride), nullptr);
+    return true;
+  }
+
+  MGLORIA_INLINE_NORMAL void Close() {
+    if (m_base != nullptr) { ::munmap(m_base, m_bytes); }
+    m_base = nullptr;
+    m_bytes = 0;
+    m_tensor.__data_ptr = nullptr;
+  }
+
+  MGLORIA_INLINE_NORMAL bool Empty() const { return m_base == nullptr; }
+
+  ///! The tensor in the mapping. Reading only.
+  MGLORIA_INLINE_NORMAL const Tensor<CPU, Dims, DataType>& Get() const { return m_tensor; }
+
+  ///! Ask the kernel to read all the pages ahead, e.g. before the first step.
+  MGLORIA_INLINE_NORMAL void Prefetch() const {
+    if (m_base != nullptr) { ::madvise(m_base, m_bytes, MADV_WILLNEED); }
+  }
+
+ private:
+  MGLORIA_INLINE_NORMAL bool Fail(const std::string& path, const char* why) {
+    LOG_WARN << "The tensor file " << path << " " << why << "." << std::endl;
+    Close();
+    return false;
+  }
+
+  void* m_base;
+  size_t m_bytes;
+  Tensor<CPU, Dims, DataType> m_tensor;
+};
+
+}  // namespace mgloria
+
+#endif  // _MGLORIA_TENSOR_FILE_HPP_
@@ -0,0 +1,71 @@
+/*!
+ *@author   chenghua.wang
+ *@file     tensor_fixed.hpp
+ *@brief    FixedTensor, a small CPU matrix whose shape is known at compile time.
+ *@details  The elements are held in the object itself, there is no heap. The expressions saved to
+ * a FixedTensor are evaluated by op/__op_fixed_cpu.hpp: the shapes are checked at compile time,
+ * the loops over the shape are unrolled into register tiles, and nothing is run with OpenMP. For
+ * the small matrices (3x3, 4x4, 8x8, 16x64, ...) the shape checks, the fork/join and the packing
+ * of the Tensor path cost more than the math itself.
+ *
+ *            FixedTensor<4, 4> A, B, C;
+ *            C = dot(A, B.T());
+ *            C += A * B + 1.f;
+ *
+ * Every operand of the expression must be a FixedTensor (or a scalar) of the matching shape.
+ * AsTensor() gives a Tensor<CPU, 2> view of the same data, for all the rest.
+ */
+#ifndef _MGLORIA_TENSOR_FIXED_HPP_
+#define _MGLORIA_TENSOR_FIXED_HPP_
+#pragma once
+#include "tensor_cpu.hpp"
+
+namespace mgloria {
+
+/*!
+ *@brief        A Rows x Cols matrix of DataType, row major and without pad.
+ *@note         m_Data is aligned to 64 on the stack or as a member. A FixedTensor got by new may
+ * not be before C++17, which is fine, the kernels do not ask for it.
+ */
+template<index_t Rows, index_t Cols, typename DataType = float>
+class FixedTensor : public expr::RValueExpr<FixedTensor<Rows, Cols, DataType>, DataType> {
+ public:
+  static_assert(Rows > 0 && Cols > 0, "FixedTensor: the shape can not be empty.");
+
+  static const index_t ms_Rows = Rows;
+  static const index_t ms_Cols = Cols;
+
+  MGLORIA_INLINE_NORMAL FixedTensor() {}
+
+  MGLORIA_INLINE_NORMAL index_t size(index_t i) const { return i == 0 ? Rows : Cols; }
+
+  MGLORIA_INLINE_NORMAL Shape<2> GetShape() const { return makeShape2d(Rows, Cols); }
+
+  ///! The Tensor on the same data. It is valid as long as this FixedTensor is.
+  MGLORIA_INLINE_NORMAL Tensor<CPU, 2, DataType> AsTensor() {
+    return Tensor<CPU, 2, DataType>(m_Data, GetShape(), Cols, nullptr);
+  }
+
+  template<typename SubType, expr::exprType EType>
+  MGLORIA_INLINE_NORMAL FixedTensor& operator=(
+      const expr::Expression<SubType, DataType, EType>& expression) {
+    return this->__dispatch(expression);
+  }
+
+  MGLORIA_INLINE_NORMAL FixedTensor& operator=(const DataType& scalar) {
+    return this->__dispatch(scalar);
+  }
+
+  MGLORIA_INLINE_NORMAL DataType* operator[](index_t y) { return m_Data + y * Cols; }
+
+  MGLORIA_INLINE_NORMAL const DataType* operator[](index_t y) const { return m_Data + y * Cols; }
+
+  DataType m_Data[Rows * Cols] MGLORIA_ALIGNED(64);
+};
+
+}  // namespace mgloria
+
+///! After FixedTensor, the Jobs and the dispatchers are specialized for it there.
+#include "op/__op_fixed_cpu.hpp"
+
+#endif  // _MGLORIA_TENSOR_FIXED_HPP_
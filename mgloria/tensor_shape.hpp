@@ -414,6 +414,28 @@ MGLORIA_INLINE_NORMAL Shape<5> ConvertLayout(const Shape<5>& rhs, const LayoutTy
   return ans;
 }
 
+/*!
+ *@brief    The shape of conv2d(input, weight, param), see Conv2dExpr.
+ *@param    input The shape of the input, in layout.
+ *@param    weight The shape of the weight, [Cout, Cin / groups, KH, KW] for BCHW and
+ * [Cout, KH, KW, Cin / groups] for BHWC.
+ *@param    layout BCHW or BHWC, the layout of the input and of the result.
+ *@return   Shape<4>
+ */
+MGLORIA_INLINE_NORMAL Shape<4> Conv2dShape(const Shape<4>& input, const Shape<4>& weight,
+                                           const Conv2dParam& param, const LayoutTypeType& layout) {
+  const bool __hwc__ = layout == LayoutTypeType::BHWC;
+  const index_t H = __hwc__ ? input[1] : input[2], W = __hwc__ ? input[2] : input[3];
+  const index_t KH = __hwc__ ? weight[1] : weight[2], KW = __hwc__ ? weight[2] : weight[3];
+  // The last input a window of the output 0 reads, the output is empty if it is past the pad.
+  const index_t eh = H + 2 * param.m_pad_h - param.m_dilation_h * (KH - 1) - 1;
+  const index_t ew = W + 2 * param.m_pad_w - param.m_dilation_w * (KW - 1) - 1;
+  const index_t OH = eh < 0 ? 0 : eh / param.m_stride_h + 1;
+  const index_t OW = ew < 0 ? 0 : ew / param.m_stride_w + 1;
+  return __hwc__ ? makeShape4d(input[0], OH, OW, weight[0])
+                 : makeShape4d(input[0], weight[0], OH, OW);
+}
+
 }  // namespace mgloria
 
 #endif
\ No newline at end of file
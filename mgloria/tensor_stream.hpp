@@ -43,8 +43,7 @@ struct XPU {
 const DeviceType default_device_t = DeviceType::CPU_T;
 
 /*!
- *@brief    A naive implementation for CPU. GPU's implementation
- * is in stream_gpu.hpp.
+ *@brief    A naive implementation. CPU's is in workspace.hpp, GPU's is in stream_gpu.hpp.
  */
 template<typename device>
 struct Stream {
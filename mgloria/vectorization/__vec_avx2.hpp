@@ -0,0 +1,845 @@
+/*!
+ *@author   chenghua.wang
+ *@file     vectorization/__vec_avx2.hpp
+ *@brief    The AVX2 vectorization. 8 floats or 4 doubles in one register, and the
+ * multiply-add is done by the FMA3 instruction set which comes with every AVX2 CPU.
+ *@note     Compile with -mavx2 -mfma (cmake option USE_AVX2) to enable it.
+ */
+
+#ifndef _MGLORIA___VEC_AVX2_HPP_
+#define _MGLORIA___VEC_AVX2_HPP_
+
+#include <immintrin.h>
+#include "./vectorization/__vec_prepare.hpp"
+
+namespace mgloria {
+namespace vectorization {
+
+///! The compare of Vectorized<float, VecArch::AVX2_Arch>. True lanes are all ones.
+template<>
+struct VectorizedMask<float, VecArch::AVX2_Arch> {
+  friend struct Vectorized<float, VecArch::AVX2_Arch>;
+  VectorizedMask() = default;
+  MGLORIA_INLINE_AVX2 explicit VectorizedMask(__m256 data) : m_data(data) {}
+
+ private:
+  __m256 m_data;
+};
+
+///! The compare of Vectorized<double, VecArch::AVX2_Arch>. True lanes are all ones.
+template<>
+struct VectorizedMask<double, VecArch::AVX2_Arch> {
+  friend struct Vectorized<double, VecArch::AVX2_Arch>;
+  VectorizedMask() = default;
+  MGLORIA_INLINE_AVX2 explicit VectorizedMask(__m256d data) : m_data(data) {}
+
+ private:
+  __m256d m_data;
+};
+
+///! The compare of Vectorized<int32_t, VecArch::AVX2_Arch>. True lanes are all ones.
+template<>
+struct VectorizedMask<int32_t, VecArch::AVX2_Arch> {
+  friend struct Vectorized<int32_t, VecArch::AVX2_Arch>;
+  VectorizedMask() = default;
+  MGLORIA_INLINE_AVX2 explicit VectorizedMask(__m256i data) : m_data(data) {}
+
+ private:
+  __m256i m_data;
+};
+
+template<>
+struct Vectorized<float, VecArch::AVX2_Arch> {
+  // float in vector
+  static const index_t num = 8;
+  // friends
+  template<typename OriDataType, typename DisDataType, VecArch VArch>
+  friend struct VectorizedCast;
+  friend MGLORIA_INLINE_AVX2 Vectorized<float, VecArch::AVX2_Arch> operator+(
+      const Vectorized<float, VecArch::AVX2_Arch>& lhs,
+      const Vectorized<float, VecArch::AVX2_Arch>& rhs);
+
+  friend MGLORIA_INLINE_AVX2 Vectorized<float, VecArch::AVX2_Arch> operator-(
+      const Vectorized<float, VecArch::AVX2_Arch>& lhs,
+      const Vectorized<float, VecArch::AVX2_Arch>& rhs);
+
+  friend MGLORIA_INLINE_AVX2 Vectorized<float, VecArch::AVX2_Arch> operator*(
+      const Vectorized<float, VecArch::AVX2_Arch>& lhs,
+      const Vectorized<float, VecArch::AVX2_Arch>& rhs);
+
+  friend MGLORIA_INLINE_AVX2 Vectorized<float, VecArch::AVX2_Arch> operator/(
+      const Vectorized<float, VecArch::AVX2_Arch>& lhs,
+      const Vectorized<float, VecArch::AVX2_Arch>& rhs);
+
+  // constructor
+  Vectorized() = default;
+  MGLORIA_INLINE_AVX2 explicit Vectorized(__m256 data) : m_data(data) {}
+
+  // static create Vectorized functions
+  MGLORIA_INLINE_AVX2 static Vectorized<float, VecArch::AVX2_Arch> Fill(float s) {
+    return Vectorized<float, VecArch::AVX2_Arch>(_mm256_set1_ps(s));
+  }
+
+  MGLORIA_INLINE_AVX2 static Vectorized<float, VecArch::AVX2_Arch> Load(const float* s) {
+    return Vectorized<float, VecArch::AVX2_Arch>(_mm256_load_ps(s));
+  }
+
+  MGLORIA_INLINE_AVX2 static Vectorized<float, VecArch::AVX2_Arch> LoadUnAligned(const float* s) {
+    return Vectorized<float, VecArch::AVX2_Arch>(_mm256_loadu_ps(s));
+  }
+
+  // a * b + c in one rounding.
+  MGLORIA_INLINE_AVX2 static Vectorized<float, VecArch::AVX2_Arch> MulAdd(
+      const Vectorized<float, VecArch::AVX2_Arch>& a,
+      const Vectorized<float, VecArch::AVX2_Arch>& b,
+      const Vectorized<float, VecArch::AVX2_Arch>& c) {
+    return Vectorized<float, VecArch::AVX2_Arch>(_mm256_fmadd_ps(a.m_data, b.m_data, c.m_data));
+  }
+
+  // Lane-wise helpers for the math ops in __vec_math.hpp.
+  MGLORIA_INLINE_AVX2 static Vectorized<float, VecArch::AVX2_Arch> Max(
+      const Vectorized<float, VecArch::AVX2_Arch>& a,
+      const Vectorized<float, VecArch::AVX2_Arch>& b) {
+    return Vectorized<float, VecArch::AVX2_Arch>(_mm256_max_ps(a.m_data, b.m_data));
+  }
+
+  MGLORIA_INLINE_AVX2 static Vectorized<float, VecArch::AVX2_Arch> Min(
+      const Vectorized<float, VecArch::AVX2_Arch>& a,
+      const Vectorized<float, VecArch::AVX2_Arch>& b) {
+    return Vectorized<float, VecArch::AVX2_Arch>(_mm256_min_ps(a.m_data, b.m_data));
+  }
+
+  MGLORIA_INLINE_AVX2 static Vectorized<float, VecArch::AVX2_Arch> Abs(
+      const Vectorized<float, VecArch::AVX2_Arch>& a) {
+    return Vectorized<float, VecArch::AVX2_Arch>(_mm256_andnot_ps(_mm256_set1_ps(-0.f), a.m_data));
+  }
+
+  MGLORIA_INLINE_AVX2 static Vectorized<float, VecArch::AVX2_Arch> Sqrt(
+      const Vectorized<float, VecArch::AVX2_Arch>& a) {
+    return Vectorized<float, VecArch::AVX2_Arch>(_mm256_sqrt_ps(a.m_data));
+  }
+
+  // About 1 / sqrt(a), relative error < 1.5 * 2^-12.
+  MGLORIA_INLINE_AVX2 static Vectorized<float, VecArch::AVX2_Arch> RSqrtEstimate(
+      const Vectorized<float, VecArch::AVX2_Arch>& a) {
+    return Vectorized<float, VecArch::AVX2_Arch>(_mm256_rsqrt_ps(a.m_data));
+  }
+
+  // a < b ? t : e for each lane.
+  MGLORIA_INLINE_AVX2 static Vectorized<float, VecArch::AVX2_Arch> IfLess(
+      const Vectorized<float, VecArch::AVX2_Arch>& a,
+      const Vectorized<float, VecArch::AVX2_Arch>& b,
+      const Vectorized<float, VecArch::AVX2_Arch>& t,
+      const Vectorized<float, VecArch::AVX2_Arch>& e) {
+    return Vectorized<float, VecArch::AVX2_Arch>(
+        _mm256_blendv_ps(e.m_data, t.m_data, _mm256_cmp_ps(a.m_data, b.m_data, _CMP_LT_OQ)));
+  }
+
+  // 2^n, n is an integer in [-126, 127].
+  MGLORIA_INLINE_AVX2 static Vectorized<float, VecArch::AVX2_Arch> Pow2i(
+      const Vectorized<float, VecArch::AVX2_Arch>& n) {
+    const __m256i __e__ =
+        _mm256_add_epi32(_mm256_cvttps_epi32(n.m_data), _mm256_set1_epi32(127));
+    return Vectorized<float, VecArch::AVX2_Arch>(_mm256_castsi256_ps(_mm256_slli_epi32(__e__, 23)));
+  }
+
+  // Split a normal a > 0 to m * 2^e, m in [0.5, 1).
+  MGLORIA_INLINE_AVX2 static Vectorized<float, VecArch::AVX2_Arch> Frexp(
+      const Vectorized<float, VecArch::AVX2_Arch>& a, Vectorized<float, VecArch::AVX2_Arch>* e) {
+    const __m256i __bits__ = _mm256_castps_si256(a.m_data);
+    *e = Vectorized<float, VecArch::AVX2_Arch>(_mm256_cvtepi32_ps(
+        _mm256_sub_epi32(_mm256_srli_epi32(__bits__, 23), _mm256_set1_epi32(126))));
+    const __m256 __mant__ =
+        _mm256_and_ps(a.m_data, _mm256_castsi256_ps(_mm256_set1_epi32(0x807FFFFF)));
+    return Vectorized<float, VecArch::AVX2_Arch>(_mm256_or_ps(__mant__, _mm256_set1_ps(0.5f)));
+  }
+
+  // The lanes where a < b, a <= b, a == b and a != b. A NaN lane is only != to anything.
+  MGLORIA_INLINE_AVX2 static VectorizedMask<float, VecArch::AVX2_Arch> CmpLt(
+      const Vectorized<float, VecArch::AVX2_Arch>& a,
+      const Vectorized<float, VecArch::AVX2_Arch>& b) {
+    return VectorizedMask<float, VecArch::AVX2_Arch>(_mm256_cmp_ps(a.m_data, b.m_data, _CMP_LT_OQ));
+  }
+
+  MGLORIA_INLINE_AVX2 static VectorizedMask<float, VecArch::AVX2_Arch> CmpLe(
+      const Vectorized<float, VecArch::AVX2_Arch>& a,
+      const Vectorized<float, VecArch::AVX2_Arch>& b) {
+    return VectorizedMask<float, VecArch::AVX2_Arch>(_mm256_cmp_ps(a.m_data, b.m_data, _CMP_LE_OQ));
+  }
+
+  MGLORIA_INLINE_AVX2 static VectorizedMask<float, VecArch::AVX2_Arch> CmpEq(
+      const Vectorized<float, VecArch::AVX2_Arch>& a,
+      const Vectorized<float, VecArch::AVX2_Arch>& b) {
+    return VectorizedMask<float, VecArch::AVX2_Arch>(_mm256_cmp_ps(a.m_data, b.m_data, _CMP_EQ_OQ));
+  }
+
+  MGLORIA_INLINE_AVX2 static VectorizedMask<float, VecArch::AVX2_Arch> CmpNe(
+      const Vectorized<float, VecArch::AVX2_Arch>& a,
+      const Vectorized<float, VecArch::AVX2_Arch>& b) {
+    return VectorizedMask<float, VecArch::AVX2_Arch>(
+        _mm256_cmp_ps(a.m_data, b.m_data, _CMP_NEQ_UQ));
+  }
+
+  // t where the lane of m is set, e where it is not. No branch.
+  MGLORIA_INLINE_AVX2 static Vectorized<float, VecArch::AVX2_Arch> Select(
+      const VectorizedMask<float, VecArch::AVX2_Arch>& m,
+      const Vectorized<float, VecArch::AVX2_Arch>& t,
+      const Vectorized<float, VecArch::AVX2_Arch>& e) {
+    return Vectorized<float, VecArch::AVX2_Arch>(_mm256_blendv_ps(e.m_data, t.m_data, m.m_data));
+  }
+
+  // operator overload.
+  MGLORIA_INLINE_AVX2 Vectorized<float, VecArch::AVX2_Arch>& operator=(float s) {
+    m_data = _mm256_set1_ps(s);
+    return *this;
+  }
+
+  MGLORIA_INLINE_AVX2 Vectorized<float, VecArch::AVX2_Arch>& operator=(const float* s) {
+    m_data = _mm256_load_ps(s);
+    return *this;
+  }
+
+  MGLORIA_INLINE_AVX2 float Sum() const {
+    __m128 ans = _mm_add_ps(_mm256_castps256_ps128(m_data), _mm256_extractf128_ps(m_data, 1));
+    ans = _mm_add_ps(ans, _mm_movehl_ps(ans, ans));
+    ans = _mm_add_ss(ans, _mm_shuffle_ps(ans, ans, 1));
+    return _mm_cvtss_f32(ans);
+  }
+
+  // Store vectorized data to normal data.
+  MGLORIA_INLINE_AVX2 void Store(float* data) const { _mm256_store_ps(data, m_data); }
+  MGLORIA_INLINE_AVX2 void StoreUnAligned(float* data) const { _mm256_storeu_ps(data, m_data); }
+  MGLORIA_INLINE_AVX2 void StoreEach(float* data) const {
+    _mm256_store_ps(data, _mm256_broadcastss_ps(_mm256_castps256_ps128(m_data)));
+  }
+
+ private:
+  // parameters
+  __m256 m_data;
+};
+
+template<>
+struct Vectorized<double, VecArch::AVX2_Arch> {
+  // double in vector
+  static const index_t num = 4;
+  // friends
+  friend MGLORIA_INLINE_AVX2 Vectorized<double, VecArch::AVX2_Arch> operator+(
+      const Vectorized<double, VecArch::AVX2_Arch>& lhs,
+      const Vectorized<double, VecArch::AVX2_Arch>& rhs);
+
+  friend MGLORIA_INLINE_AVX2 Vectorized<double, VecArch::AVX2_Arch> operator-(
+      const Vectorized<double, VecArch::AVX2_Arch>& lhs,
+      const Vectorized<double, VecArch::AVX2_Arch>& rhs);
+
+  friend MGLORIA_INLINE_AVX2 Vectorized<double, VecArch::AVX2_Arch> operator*(
+      const Vectorized<double, VecArch::AVX2_Arch>& lhs,
+      const Vectorized<double, VecArch::AVX2_Arch>& rhs);
+
+  friend MGLORIA_INLINE_AVX2 Vectorized<double, VecArch::AVX2_Arch> operator/(
+      const Vectorized<double, VecArch::AVX2_Arch>& lhs,
+      const Vectorized<double, VecArch::AVX2_Arch>& rhs);
+
+  // constructor
+  Vectorized() = default;
+  MGLORIA_INLINE_AVX2 explicit Vectorized(__m256d data) : m_data(data) {}
+
+  // static create Vectorized functions
+  MGLORIA_INLINE_AVX2 static Vectorized<double, VecArch::AVX2_Arch> Fill(double s) {
+    return Vectorized<double, VecArch::AVX2_Arch>(_mm256_set1_pd(s));
+  }
+
+  MGLORIA_INLINE_AVX2 static Vectorized<double, VecArch::AVX2_Arch> Load(const double* s) {
+    return Vectorized<double, VecArch::AVX2_Arch>(_mm256_load_pd(s));
+  }
+
+  MGLORIA_INLINE_AVX2 static Vectorized<double, VecArch::AVX2_Arch> LoadUnAligned(const double* s) {
+    return Vectorized<double, VecArch::AVX2_Arch>(_mm256_loadu_pd(s));
+  }
+
+  // a * b + c in one rounding.
+  MGLORIA_INLINE_AVX2 static Vectorized<double, VecArch::AVX2_Arch> MulAdd(
+      const Vectorized<double, VecArch::AVX2_Arch>& a,
+      const Vectorized<double, VecArch::AVX2_Arch>& b,
+      const Vectorized<double, VecArch::AVX2_Arch>& c) {
+    return Vectorized<double, VecArch::AVX2_Arch>(_mm256_fmadd_pd(a.m_data, b.m_data, c.m_data));
+  }
+
+  // Lane-wise helpers for the math ops in __vec_math.hpp.
+  MGLORIA_INLINE_AVX2 static Vectorized<double, VecArch::AVX2_Arch> Max(
+      const Vectorized<double, VecArch::AVX2_Arch>& a,
+      const Vectorized<double, VecArch::AVX2_Arch>& b) {
+    return Vectorized<double, VecArch::AVX2_Arch>(_mm256_max_pd(a.m_data, b.m_data));
+  }
+
+  MGLORIA_INLINE_AVX2 static Vectorized<double, VecArch::AVX2_Arch> Min(
+      const Vectorized<double, VecArch::AVX2_Arch>& a,
+      const Vectorized<double, VecArch::AVX2_Arch>& b) {
+    return Vectorized<double, VecArch::AVX2_Arch>(_mm256_min_pd(a.m_data, b.m_data));
+  }
+
+  MGLORIA_INLINE_AVX2 static Vectorized<double, VecArch::AVX2_Arch> Abs(
+      const Vectorized<double, VecArch::AVX2_Arch>& a) {
+    return Vectorized<double, VecArch::AVX2_Arch>(_mm256_andnot_pd(_mm256_set1_pd(-0.0), a.m_data));
+  }
+
+  MGLORIA_INLINE_AVX2 static Vectorized<double, VecArch::AVX2_Arch> Sqrt(
+      const Vectorized<double, VecArch::AVX2_Arch>& a) {
+    return Vectorized<double, VecArch::AVX2_Arch>(_mm256_sqrt_pd(a.m_data));
+  }
+
+  // The lanes where a < b, a <= b, a == b and a != b. A NaN lane is only != to anything.
+  MGLORIA_INLINE_AVX2 static VectorizedMask<double, VecArch::AVX2_Arch> CmpLt(
+      const Vectorized<double, VecArch::AVX2_Arch>& a,
+      const Vectorized<double, VecArch::AVX2_Arch>& b) {
+    return VectorizedMask<double, VecArch::AVX2_Arch>(
+        _mm256_cmp_pd(a.m_data, b.m_data, _CMP_LT_OQ));
+  }
+
+  MGLORIA_INLINE_AVX2 static VectorizedMask<double, VecArch::AVX2_Arch> CmpLe(
+      const Vectorized<double, VecArch::AVX2_Arch>& a,
+      const Vectorized<double, VecArch::AVX2_Arch>& b) {
+    return VectorizedMask<double, VecArch::AVX2_Arch>(
+        _mm256_cmp_pd(a.m_data, b.m_data, _CMP_LE_OQ));
+  }
+
+  MGLORIA_INLINE_AVX2 static VectorizedMask<double, VecArch::AVX2_Arch> CmpEq(
+      const Vectorized<double, VecArch::AVX2_Arch>& a,
+      const Vectorized<double, VecArch::AVX2_Arch>& b) {
+    return VectorizedMask<double, VecArch::AVX2_Arch>(
+        _mm256_cmp_pd(a.m_data, b.m_data, _CMP_EQ_OQ));
+  }
+
+  MGLORIA_INLINE_AVX2 static VectorizedMask<double, VecArch::AVX2_Arch> CmpNe(
+      const Vectorized<double, VecArch::AVX2_Arch>& a,
+      const Vectorized<double, VecArch::AVX2_Arch>& b) {
+    return VectorizedMask<double, VecArch::AVX2_Arch>(
+        _mm256_cmp_pd(a.m_data, b.m_data, _CMP_NEQ_UQ));
+  }
+
+  // t where the lane of m is set, e where it is not. No branch.
+  MGLORIA_INLINE_AVX2 static Vectorized<double, VecArch::AVX2_Arch> Select(
+      const VectorizedMask<double, VecArch::AVX2_Arch>& m,
+      const Vectorized<double, VecArch::AVX2_Arch>& t,
+      const Vectorized<double, VecArch::AVX2_Arch>& e) {
+    return Vectorized<double, VecArch::AVX2_Arch>(_mm256_blendv_pd(e.m_data, t.m_data, m.m_data));
+  }
+
+  // operator overload.
+  MGLORIA_INLINE_AVX2 Vectorized<double, VecArch::AVX2_Arch>& operator=(double s) {
+    m_data = _mm256_set1_pd(s);
+    return *this;
+  }
+
+  MGLORIA_INLINE_AVX2 Vectorized<double, VecArch::AVX2_Arch>& operator=(const double* s) {
+    m_data = _mm256_load_pd(s);
+    return *this;
+  }
+
+  MGLORIA_INLINE_AVX2 double Sum(void) const {
+    __m128d ans = _mm_add_pd(_mm256_castpd256_pd128(m_data), _mm256_extractf128_pd(m_data, 1));
+    ans = _mm_add_sd(ans, _mm_unpackhi_pd(ans, ans));
+    return _mm_cvtsd_f64(ans);
+  }
+
+  // Store vectorized data to normal data.
+  MGLORIA_INLINE_AVX2 void Store(double* data) const { _mm256_store_pd(data, m_data); }
+  MGLORIA_INLINE_AVX2 void StoreUnAligned(double* data) const { _mm256_storeu_pd(data, m_data); }
+  MGLORIA_INLINE_AVX2 void StoreEach(double* data) const {
+    _mm256_store_pd(data, _mm256_broadcastsd_pd(_mm256_castpd256_pd128(m_data)));
+  }
+
+ private:
+  // parameters
+  __m256d m_data;
+};
+
+template<>
+struct Vectorized<int32_t, VecArch::AVX2_Arch> {
+  // int32_t in vector
+  static const index_t num = 8;
+  // friends
+  template<typename OriDataType, typename DisDataType, VecArch VArch>
+  friend struct VectorizedCast;
+  friend MGLORIA_INLINE_AVX2 Vectorized<int32_t, VecArch::AVX2_Arch> operator+(
+      const Vectorized<int32_t, VecArch::AVX2_Arch>& lhs,
+      const Vectorized<int32_t, VecArch::AVX2_Arch>& rhs);
+
+  friend MGLORIA_INLINE_AVX2 Vectorized<int32_t, VecArch::AVX2_Arch> operator-(
+      const Vectorized<int32_t, VecArch::AVX2_Arch>& lhs,
+      const Vectorized<int32_t, VecArch::AVX2_Arch>& rhs);
+
+  friend MGLORIA_INLINE_AVX2 Vectorized<int32_t, VecArch::AVX2_Arch> operator*(
+      const Vectorized<int32_t, VecArch::AVX2_Arch>& lhs,
+      const Vectorized<int32_t, VecArch::AVX2_Arch>& rhs);
+
+  // constructor
+  Vectorized() = default;
+  MGLORIA_INLINE_AVX2 explicit Vectorized(__m256i data) : m_data(data) {}
+
+  // static create Vectorized functions
+  MGLORIA_INLINE_AVX2 static Vectorized<int32_t, VecArch::AVX2_Arch> Fill(int32_t s) {
+    return Vectorized<int32_t, VecArch::AVX2_Arch>(_mm256_set1_epi32(static_cast<int>(s)));
+  }
+
+  MGLORIA_INLINE_AVX2 static Vectorized<int32_t, VecArch::AVX2_Arch> Load(const int32_t* s) {
+    return Vectorized<int32_t, VecArch::AVX2_Arch>(
+        _mm256_load_si256(reinterpret_cast<const __m256i*>(s)));
+  }
+
+  MGLORIA_INLINE_AVX2 static Vectorized<int32_t, VecArch::AVX2_Arch> LoadUnAligned(
+      const int32_t* s) {
+    return Vectorized<int32_t, VecArch::AVX2_Arch>(
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s)));
+  }
+
+  // 16 int8_t widened to int16, the lane q holding s[2q] and s[2q + 1]. See MulAddPairs.
+  MGLORIA_INLINE_AVX2 static Vectorized<int32_t, VecArch::AVX2_Arch> LoadPairs(const int8_t* s) {
+    return Vectorized<int32_t, VecArch::AVX2_Arch>(
+        _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(s))));
+  }
+
+  // a + b, clamped to [INT32_MIN, INT32_MAX] when it overflows.
+  MGLORIA_INLINE_AVX2 static Vectorized<int32_t, VecArch::AVX2_Arch> AddSat(
+      const Vectorized<int32_t, VecArch::AVX2_Arch>& a,
+      const Vectorized<int32_t, VecArch::AVX2_Arch>& b) {
+    const __m256i s = _mm256_add_epi32(a.m_data, b.m_data);
+    // Overflow only if a and b have the same sign and s has the other one.
+    const __m256i ov = _mm256_and_si256(_mm256_xor_si256(s, a.m_data),
+                                        _mm256_xor_si256(s, b.m_data));
+    return Vectorized<int32_t, VecArch::AVX2_Arch>(Saturate(s, a.m_data, ov));
+  }
+
+  // a - b, clamped to [INT32_MIN, INT32_MAX] when it overflows.
+  MGLORIA_INLINE_AVX2 static Vectorized<int32_t, VecArch::AVX2_Arch> SubSat(
+      const Vectorized<int32_t, VecArch::AVX2_Arch>& a,
+      const Vectorized<int32_t, VecArch::AVX2_Arch>& b) {
+    const __m256i s = _mm256_sub_epi32(a.m_data, b.m_data);
+    // Overflow only if a and b have different signs and s has the sign of b.
+    const __m256i ov = _mm256_and_si256(_mm256_xor_si256(a.m_data, b.m_data),
+                                        _mm256_xor_si256(s, a.m_data));
+    return Vectorized<int32_t, VecArch::AVX2_Arch>(Saturate(s, a.m_data, ov));
+  }
+
+  // a * b + c, all wrap around.
+  MGLORIA_INLINE_AVX2 static Vectorized<int32_t, VecArch::AVX2_Arch> MulAdd(
+      const Vectorized<int32_t, VecArch::AVX2_Arch>& a,
+      const Vectorized<int32_t, VecArch::AVX2_Arch>& b,
+      const Vectorized<int32_t, VecArch::AVX2_Arch>& c) {
+    return a * b + c;
+  }
+
+  // c + a0 * b0 + a1 * b1 per lane, each lane of a and b holding two int16, a0 in the low half.
+  MGLORIA_INLINE_AVX2 static Vectorized<int32_t, VecArch::AVX2_Arch> MulAddPairs(
+      const Vectorized<int32_t, VecArch::AVX2_Arch>& a,
+      const Vectorized<int32_t, VecArch::AVX2_Arch>& b,
+      const Vectorized<int32_t, VecArch::AVX2_Arch>& c) {
+    return Vectorized<int32_t, VecArch::AVX2_Arch>(
+        _mm256_add_epi32(c.m_data, _mm256_madd_epi16(a.m_data, b.m_data)));
+  }
+
+  // The lanes where a < b, a <= b, a == b and a != b.
+  MGLORIA_INLINE_AVX2 static VectorizedMask<int32_t, VecArch::AVX2_Arch> CmpLt(
+      const Vectorized<int32_t, VecArch::AVX2_Arch>& a,
+      const Vectorized<int32_t, VecArch::AVX2_Arch>& b) {
+    return VectorizedMask<int32_t, VecArch::AVX2_Arch>(_mm256_cmpgt_epi32(b.m_data, a.m_data));
+  }
+
+  MGLORIA_INLINE_AVX2 static VectorizedMask<int32_t, VecArch::AVX2_Arch> CmpLe(
+      const Vectorized<int32_t, VecArch::AVX2_Arch>& a,
+      const Vectorized<int32_t, VecArch::AVX2_Arch>& b) {
+    return VectorizedMask<int32_t, VecArch::AVX2_Arch>(
+        _mm256_xor_si256(_mm256_cmpgt_epi32(a.m_data, b.m_data), _mm256_set1_epi32(-1)));
+  }
+
+  MGLORIA_INLINE_AVX2 static VectorizedMask<int32_t, VecArch::AVX2_Arch> CmpEq(
+      const Vectorized<int32_t, VecArch::AVX2_Arch>& a,
+      const Vectorized<int32_t, VecArch::AVX2_Arch>& b) {
+    return VectorizedMask<int32_t, VecArch::AVX2_Arch>(_mm256_cmpeq_epi32(a.m_data, b.m_data));
+  }
+
+  MGLORIA_INLINE_AVX2 static VectorizedMask<int32_t, VecArch::AVX2_Arch> CmpNe(
+      const Vectorized<int32_t, VecArch::AVX2_Arch>& a,
+      const Vectorized<int32_t, VecArch::AVX2_Arch>& b) {
+    return VectorizedMask<int32_t, VecArch::AVX2_Arch>(
+        _mm256_xor_si256(_mm256_cmpeq_epi32(a.m_data, b.m_data), _mm256_set1_epi32(-1)));
+  }
+
+  // t where the lane of m is set, e where it is not. No branch.
+  MGLORIA_INLINE_AVX2 static Vectorized<int32_t, VecArch::AVX2_Arch> Select(
+      const VectorizedMask<int32_t, VecArch::AVX2_Arch>& m,
+      const Vectorized<int32_t, VecArch::AVX2_Arch>& t,
+      const Vectorized<int32_t, VecArch::AVX2_Arch>& e) {
+    return Vectorized<int32_t, VecArch::AVX2_Arch>(
+        _mm256_blendv_epi8(e.m_data, t.m_data, m.m_data));
+  }
+
+  // operator overload.
+  MGLORIA_INLINE_AVX2 Vectorized<int32_t, VecArch::AVX2_Arch>& operator=(int32_t s) {
+    m_data = _mm256_set1_epi32(static_cast<int>(s));
+    return *this;
+  }
+
+  MGLORIA_INLINE_AVX2 Vectorized<int32_t, VecArch::AVX2_Arch>& operator=(const int32_t* s) {
+    m_data = _mm256_load_si256(reinterpret_cast<const __m256i*>(s));
+    return *this;
+  }
+
+  MGLORIA_INLINE_AVX2 int32_t Sum() const {
+    __m128i ans = _mm_add_epi32(_mm256_castsi256_si128(m_data),
+                                _mm256_extracti128_si256(m_data, 1));
+    ans = _mm_add_epi32(ans, _mm_shuffle_epi32(ans, _MM_SHUFFLE(1, 0, 3, 2)));
+    ans = _mm_add_epi32(ans, _mm_shuffle_epi32(ans, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(ans);
+  }
+
+  // Store vectorized data to normal data.
+  MGLORIA_INLINE_AVX2 void Store(int32_t* data) const {
+    _mm256_store_si256(reinterpret_cast<__m256i*>(data), m_data);
+  }
+  MGLORIA_INLINE_AVX2 void StoreUnAligned(int32_t* data) const {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(data), m_data);
+  }
+
+ private:
+  // Where ov has the sign bit, INT32_MAX if a >= 0 else INT32_MIN. Or s.
+  MGLORIA_INLINE_AVX2 static __m256i Saturate(__m256i s, __m256i a, __m256i ov) {
+    const __m256i __ov__ = _mm256_srai_epi32(ov, 31);
+    const __m256i __sat__ = _mm256_xor_si256(_mm256_srai_epi32(a, 31),
+                                             _mm256_set1_epi32(INT32_MAX));
+    return _mm256_or_si256(_mm256_and_si256(__ov__, __sat__), _mm256_andnot_si256(__ov__, s));
+  }
+  // parameters
+  __m256i m_data;
+};
+
+template<>
+struct Vectorized<int8_t, VecArch::AVX2_Arch> {
+  // int8_t in vector
+  static const index_t num = 32;
+  // friends
+  friend MGLORIA_INLINE_AVX2 Vectorized<int8_t, VecArch::AVX2_Arch> operator+(
+      const Vectorized<int8_t, VecArch::AVX2_Arch>& lhs,
+      const Vectorized<int8_t, VecArch::AVX2_Arch>& rhs);
+
+  friend MGLORIA_INLINE_AVX2 Vectorized<int8_t, VecArch::AVX2_Arch> operator-(
+      const Vectorized<int8_t, VecArch::AVX2_Arch>& lhs,
+      const Vectorized<int8_t, VecArch::AVX2_Arch>& rhs);
+
+  friend MGLORIA_INLINE_AVX2 Vectorized<int8_t, VecArch::AVX2_Arch> operator*(
+      const Vectorized<int8_t, VecArch::AVX2_Arch>& lhs,
+      const Vectorized<int8_t, VecArch::AVX2_Arch>& rhs);
+
+  // constructor
+  Vectorized() = default;
+  MGLORIA_INLINE_AVX2 explicit Vectorized(__m256i data) : m_data(data) {}
+
+  // static create Vectorized functions
+  MGLORIA_INLINE_AVX2 static Vectorized<int8_t, VecArch::AVX2_Arch> Fill(int8_t s) {
+    return Vectorized<int8_t, VecArch::AVX2_Arch>(_mm256_set1_epi8(static_cast<char>(s)));
+  }
+
+  MGLORIA_INLINE_AVX2 static Vectorized<int8_t, VecArch::AVX2_Arch> Load(const int8_t* s) {
+    return Vectorized<int8_t, VecArch::AVX2_Arch>(
+        _mm256_load_si256(reinterpret_cast<const __m256i*>(s)));
+  }
+
+  MGLORIA_INLINE_AVX2 static Vectorized<int8_t, VecArch::AVX2_Arch> LoadUnAligned(const int8_t* s) {
+    return Vectorized<int8_t, VecArch::AVX2_Arch>(
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s)));
+  }
+
+  // a + b, clamped to [-128, 127].
+  MGLORIA_INLINE_AVX2 static Vectorized<int8_t, VecArch::AVX2_Arch> AddSat(
+      const Vectorized<int8_t, VecArch::AVX2_Arch>& a,
+      const Vectorized<int8_t, VecArch::AVX2_Arch>& b) {
+    return Vectorized<int8_t, VecArch::AVX2_Arch>(_mm256_adds_epi8(a.m_data, b.m_data));
+  }
+
+  // a - b, clamped to [-128, 127].
+  MGLORIA_INLINE_AVX2 static Vectorized<int8_t, VecArch::AVX2_Arch> SubSat(
+      const Vectorized<int8_t, VecArch::AVX2_Arch>& a,
+      const Vectorized<int8_t, VecArch::AVX2_Arch>& b) {
+    return Vectorized<int8_t, VecArch::AVX2_Arch>(_mm256_subs_epi8(a.m_data, b.m_data));
+  }
+
+  // operator overload.
+  MGLORIA_INLINE_AVX2 Vectorized<int8_t, VecArch::AVX2_Arch>& operator=(int8_t s) {
+    m_data = _mm256_set1_epi8(static_cast<char>(s));
+    return *this;
+  }
+
+  MGLORIA_INLINE_AVX2 Vectorized<int8_t, VecArch::AVX2_Arch>& operator=(const int8_t* s) {
+    m_data = _mm256_load_si256(reinterpret_cast<const __m256i*>(s));
+    return *this;
+  }
+
+  // Store vectorized data to normal data.
+  MGLORIA_INLINE_AVX2 void Store(int8_t* data) const {
+    _mm256_store_si256(reinterpret_cast<__m256i*>(data), m_data);
+  }
+  MGLORIA_INLINE_AVX2 void StoreUnAligned(int8_t* data) const {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(data), m_data);
+  }
+
+ private:
+  // parameters
+  __m256i m_data;
+};
+
+template<>
+struct Vectorized<uint8_t, VecArch::AVX2_Arch> {
+  // uint8_t in vector
+  static const index_t num = 32;
+  // friends
+  friend MGLORIA_INLINE_AVX2 Vectorized<uint8_t, VecArch::AVX2_Arch> operator+(
+      const Vectorized<uint8_t, VecArch::AVX2_Arch>& lhs,
+      const Vectorized<uint8_t, VecArch::AVX2_Arch>& rhs);
+
+  friend MGLORIA_INLINE_AVX2 Vectorized<uint8_t, VecArch::AVX2_Arch> operator-(
+      const Vectorized<uint8_t, VecArch::AVX2_Arch>& lhs,
+      const Vectorized<uint8_t, VecArch::AVX2_Arch>& rhs);
+
+  friend MGLORIA_INLINE_AVX2 Vectorized<uint8_t, VecArch::AVX2_Arch> operator*(
+      const Vectorized<uint8_t, VecArch::AVX2_Arch>& lhs,
+      const Vectorized<uint8_t, VecArch::AVX2_Arch>& rhs);
+
+  // constructor
+  Vectorized() = default;
+  MGLORIA_INLINE_AVX2 explicit Vectorized(__m256i data) : m_data(data) {}
+
+  // static create Vectorized functions
+  MGLORIA_INLINE_AVX2 static Vectorized<uint8_t, VecArch::AVX2_Arch> Fill(uint8_t s) {
+    return Vectorized<uint8_t, VecArch::AVX2_Arch>(_mm256_set1_epi8(static_cast<char>(s)));
+  }
+
+  MGLORIA_INLINE_AVX2 static Vectorized<uint8_t, VecArch::AVX2_Arch> Load(const uint8_t* s) {
+    return Vectorized<uint8_t, VecArch::AVX2_Arch>(
+        _mm256_load_si256(reinterpret_cast<const __m256i*>(s)));
+  }
+
+  MGLORIA_INLINE_AVX2 static Vectorized<uint8_t, VecArch::AVX2_Arch> LoadUnAligned(
+      const uint8_t* s) {
+    return Vectorized<uint8_t, VecArch::AVX2_Arch>(
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s)));
+  }
+
+  // a + b, clamped to [0, 255].
+  MGLORIA_INLINE_AVX2 static Vectorized<uint8_t, VecArch::AVX2_Arch> AddSat(
+      const Vectorized<uint8_t, VecArch::AVX2_Arch>& a,
+      const Vectorized<uint8_t, VecArch::AVX2_Arch>& b) {
+    return Vectorized<uint8_t, VecArch::AVX2_Arch>(_mm256_adds_epu8(a.m_data, b.m_data));
+  }
+
+  // a - b, clamped to [0, 255].
+  MGLORIA_INLINE_AVX2 static Vectorized<uint8_t, VecArch::AVX2_Arch> SubSat(
+      const Vectorized<uint8_t, VecArch::AVX2_Arch>& a,
+      const Vectorized<uint8_t, VecArch::AVX2_Arch>& b) {
+    return Vectorized<uint8_t, VecArch::AVX2_Arch>(_mm256_subs_epu8(a.m_data, b.m_data));
+  }
+
+  // operator overload.
+  MGLORIA_INLINE_AVX2 Vectorized<uint8_t, VecArch::AVX2_Arch>& operator=(uint8_t s) {
+    m_data = _mm256_set1_epi8(static_cast<char>(s));
+    return *this;
+  }
+
+  MGLORIA_INLINE_AVX2 Vectorized<uint8_t, VecArch::AVX2_Arch>& operator=(const uint8_t* s) {
+    m_data = _mm256_load_si256(reinterpret_cast<const __m256i*>(s));
+    return *this;
+  }
+
+  // Store vectorized data to normal data.
+  MGLORIA_INLINE_AVX2 void Store(uint8_t* data) const {
+    _mm256_store_si256(reinterpret_cast<__m256i*>(data), m_data);
+  }
+  MGLORIA_INLINE_AVX2 void StoreUnAligned(uint8_t* data) const {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(data), m_data);
+  }
+
+ private:
+  // parameters
+  __m256i m_data;
+};
+
+MGLORIA_INLINE_AVX2 Vectorized<float, VecArch::AVX2_Arch> operator+(
+    const Vectorized<float, VecArch::AVX2_Arch>& lhs,
+    const Vectorized<float, VecArch::AVX2_Arch>& rhs) {
+  return Vectorized<float, VecArch::AVX2_Arch>(_mm256_add_ps(lhs.m_data, rhs.m_data));
+}
+
+MGLORIA_INLINE_AVX2 Vectorized<float, VecArch::AVX2_Arch> operator-(
+    const Vectorized<float, VecArch::AVX2_Arch>& lhs,
+    const Vectorized<float, VecArch::AVX2_Arch>& rhs) {
+  return Vectorized<float, VecArch::AVX2_Arch>(_mm256_sub_ps(lhs.m_data, rhs.m_data));
+}
+
+MGLORIA_INLINE_AVX2 Vectorized<float, VecArch::AVX2_Arch> operator*(
+    const Vectorized<float, VecArch::AVX2_Arch>& lhs,
+    const Vectorized<float, VecArch::AVX2_Arch>& rhs) {
+  return Vectorized<float, VecArch::AVX2_Arch>(_mm256_mul_ps(lhs.m_data, rhs.m_data));
+}
+
+MGLORIA_INLINE_AVX2 Vectorized<float, VecArch::AVX2_Arch> operator/(
+    const Vectorized<float, VecArch::AVX2_Arch>& lhs,
+    const Vectorized<float, VecArch::AVX2_Arch>& rhs) {
+  return Vectorized<float, VecArch::AVX2_Arch>(_mm256_div_ps(lhs.m_data, rhs.m_data));
+}
+
+MGLORIA_INLINE_AVX2 Vectorized<double, VecArch::AVX2_Arch> operator+(
+    const Vectorized<double, VecArch::AVX2_Arch>& lhs,
+    const Vectorized<double, VecArch::AVX2_Arch>& rhs) {
+  return Vectorized<double, VecArch::AVX2_Arch>(_mm256_add_pd(lhs.m_data, rhs.m_data));
+}
+
+MGLORIA_INLINE_AVX2 Vectorized<double, VecArch::AVX2_Arch> operator-(
+    const Vectorized<double, VecArch::AVX2_Arch>& lhs,
+    const Vectorized<double, VecArch::AVX2_Arch>& rhs) {
+  return Vectorized<double, VecArch::AVX2_Arch>(_mm256_sub_pd(lhs.m_data, rhs.m_data));
+}
+
+MGLORIA_INLINE_AVX2 Vectorized<double, VecArch::AVX2_Arch> operator*(
+    const Vectorized<double, VecArch::AVX2_Arch>& lhs,
+    const Vectorized<double, VecArch::AVX2_Arch>& rhs) {
+  return Vectorized<double, VecArch::AVX2_Arch>(_mm256_mul_pd(lhs.m_data, rhs.m_data));
+}
+
+MGLORIA_INLINE_AVX2 Vectorized<double, VecArch::AVX2_Arch> operator/(
+    const Vectorized<double, VecArch::AVX2_Arch>& lhs,
+    const Vectorized<double, VecArch::AVX2_Arch>& rhs) {
+  return Vectorized<double, VecArch::AVX2_Arch>(_mm256_div_pd(lhs.m_data, rhs.m_data));
+}
+
+MGLORIA_INLINE_AVX2 Vectorized<int32_t, VecArch::AVX2_Arch> operator+(
+    const Vectorized<int32_t, VecArch::AVX2_Arch>& lhs,
+    const Vectorized<int32_t, VecArch::AVX2_Arch>& rhs) {
+  return Vectorized<int32_t, VecArch::AVX2_Arch>(_mm256_add_epi32(lhs.m_data, rhs.m_data));
+}
+
+MGLORIA_INLINE_AVX2 Vectorized<int32_t, VecArch::AVX2_Arch> operator-(
+    const Vectorized<int32_t, VecArch::AVX2_Arch>& lhs,
+    const Vectorized<int32_t, VecArch::AVX2_Arch>& rhs) {
+  return Vectorized<int32_t, VecArch::AVX2_Arch>(_mm256_sub_epi32(lhs.m_data, rhs.m_data));
+}
+
+MGLORIA_INLINE_AVX2 Vectorized<int32_t, VecArch::AVX2_Arch> operator*(
+    const Vectorized<int32_t, VecArch::AVX2_Arch>& lhs,
+    const Vectorized<int32_t, VecArch::AVX2_Arch>& rhs) {
+  return Vectorized<int32_t, VecArch::AVX2_Arch>(_mm256_mullo_epi32(lhs.m_data, rhs.m_data));
+}
+MGLORIA_INLINE_AVX2 Vectorized<int8_t, VecArch::AVX2_Arch> operator+(
+    const Vectorized<int8_t, VecArch::AVX2_Arch>& lhs,
+    const Vectorized<int8_t, VecArch::AVX2_Arch>& rhs) {
+  return Vectorized<int8_t, VecArch::AVX2_Arch>(_mm256_add_epi8(lhs.m_data, rhs.m_data));
+}
+
+MGLORIA_INLINE_AVX2 Vectorized<int8_t, VecArch::AVX2_Arch> operator-(
+    const Vectorized<int8_t, VecArch::AVX2_Arch>& lhs,
+    const Vectorized<int8_t, VecArch::AVX2_Arch>& rhs) {
+  return Vectorized<int8_t, VecArch::AVX2_Arch>(_mm256_sub_epi8(lhs.m_data, rhs.m_data));
+}
+
+MGLORIA_INLINE_AVX2 Vectorized<int8_t, VecArch::AVX2_Arch> operator*(
+    const Vectorized<int8_t, VecArch::AVX2_Arch>& lhs,
+    const Vectorized<int8_t, VecArch::AVX2_Arch>& rhs) {
+  // No 8 bits multiply. Do the even and odd bytes in 16 bits lanes, the low byte is the answer.
+  const __m256i __even__ = _mm256_mullo_epi16(lhs.m_data, rhs.m_data);
+  const __m256i __odd__ =
+      _mm256_mullo_epi16(_mm256_srli_epi16(lhs.m_data, 8), _mm256_srli_epi16(rhs.m_data, 8));
+  return Vectorized<int8_t, VecArch::AVX2_Arch>(_mm256_or_si256(_mm256_slli_epi16(__odd__, 8),
+                         _mm256_and_si256(__even__, _mm256_set1_epi16(0x00FF))));
+}
+MGLORIA_INLINE_AVX2 Vectorized<uint8_t, VecArch::AVX2_Arch> operator+(
+    const Vectorized<uint8_t, VecArch::AVX2_Arch>& lhs,
+    const Vectorized<uint8_t, VecArch::AVX2_Arch>& rhs) {
+  return Vectorized<uint8_t, VecArch::AVX2_Arch>(_mm256_add_epi8(lhs.m_data, rhs.m_data));
+}
+
+MGLORIA_INLINE_AVX2 Vectorized<uint8_t, VecArch::AVX2_Arch> operator-(
+    const Vectorized<uint8_t, VecArch::AVX2_Arch>& lhs,
+    const Vectorized<uint8_t, VecArch::AVX2_Arch>& rhs) {
+  return Vectorized<uint8_t, VecArch::AVX2_Arch>(_mm256_sub_epi8(lhs.m_data, rhs.m_data));
+}
+
+MGLORIA_INLINE_AVX2 Vectorized<uint8_t, VecArch::AVX2_Arch> operator*(
+    const Vectorized<uint8_t, VecArch::AVX2_Arch>& lhs,
+    const Vectorized<uint8_t, VecArch::AVX2_Arch>& rhs) {
+  // No 8 bits multiply. Do the even and odd bytes in 16 bits lanes, the low byte is the answer.
+  const __m256i __even__ = _mm256_mullo_epi16(lhs.m_data, rhs.m_data);
+  const __m256i __odd__ =
+      _mm256_mullo_epi16(_mm256_srli_epi16(lhs.m_data, 8), _mm256_srli_epi16(rhs.m_data, 8));
+  return Vectorized<uint8_t, VecArch::AVX2_Arch>(_mm256_or_si256(_mm256_slli_epi16(__odd__, 8),
+                         _mm256_and_si256(__even__, _mm256_set1_epi16(0x00FF))));
+}
+
+/*!
+ *@brief      float <-> int32_t, see VectorizedCast.
+ */
+template<>
+struct VectorizedCast<float, int32_t, VecArch::AVX2_Arch> {
+  MGLORIA_INLINE_AVX2 static Vectorized<int32_t, VecArch::AVX2_Arch> Do(
+      const Vectorized<float, VecArch::AVX2_Arch>& src) {
+    return Vectorized<int32_t, VecArch::AVX2_Arch>(_mm256_cvttps_epi32(src.m_data));
+  }
+
+  static const bool m_Enable = MGLORIA_VECTORIZATION_TRUE;
+};
+
+template<>
+struct VectorizedCast<int32_t, float, VecArch::AVX2_Arch> {
+  MGLORIA_INLINE_AVX2 static Vectorized<float, VecArch::AVX2_Arch> Do(
+      const Vectorized<int32_t, VecArch::AVX2_Arch>& src) {
+    return Vectorized<float, VecArch::AVX2_Arch>(_mm256_cvtepi32_ps(src.m_data));
+  }
+
+  static const bool m_Enable = MGLORIA_VECTORIZATION_TRUE;
+};
+
+/*!
+ *@brief      The gathers of AVX2, see VectorizedGather. The lanes not below n are masked off.
+ */
+MGLORIA_INLINE_AVX2 __m256i __gather_index_avx2__(index_t stride) {
+  return _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(stride));
+}
+
+MGLORIA_INLINE_AVX2 __m256i __gather_mask_avx2__(index_t n) {
+  return _mm256_cmpgt_epi32(_mm256_set1_epi32(n), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+}
+
+template<>
+struct VectorizedGather<float, VecArch::AVX2_Arch> {
+  MGLORIA_INLINE_AVX2 static Vectorized<float, VecArch::AVX2_Arch> Do(const float* src,
+                                                                      index_t stride, index_t n) {
+    return Vectorized<float, VecArch::AVX2_Arch>(
+        _mm256_mask_i32gather_ps(_mm256_setzero_ps(), src, __gather_index_avx2__(stride),
+                                 _mm256_castsi256_ps(__gather_mask_avx2__(n)), 4));
+  }
+};
+
+template<>
+struct VectorizedGather<int32_t, VecArch::AVX2_Arch> {
+  MGLORIA_INLINE_AVX2 static Vectorized<int32_t, VecArch::AVX2_Arch> Do(const int32_t* src,
+                                                                        index_t stride, index_t n) {
+    return Vectorized<int32_t, VecArch::AVX2_Arch>(
+        _mm256_mask_i32gather_epi32(_mm256_setzero_si256(), reinterpret_cast<const int*>(src),
+                                    __gather_index_avx2__(stride), __gather_mask_avx2__(n), 4));
+  }
+};
+
+template<>
+struct VectorizedGather<double, VecArch::AVX2_Arch> {
+  MGLORIA_INLINE_AVX2 static Vectorized<double, VecArch::AVX2_Arch> Do(const double* src,
+                                                                       index_t stride, index_t n) {
+    const __m128i __index__ =
+        _mm_mullo_epi32(_mm_setr_epi32(0, 1, 2, 3), _mm_set1_epi32(stride));
+    // 4 lanes of 64 bits, each lane of the mask is two of the 32 bits ones.
+    const __m256i __mask__ =
+        _mm256_cmpgt_epi64(_mm256_set1_epi64x(n), _mm256_setr_epi64x(0, 1, 2, 3));
+    return Vectorized<double, VecArch::AVX2_Arch>(_mm256_mask_i32gather_pd(
+        _mm256_setzero_pd(), src, __index__, _mm256_castsi256_pd(__mask__), 8));
+  }
+};
+
+}  // namespace vectorization
+}  // namespace mgloria
+
+#endif
@@ -0,0 +1,930 @@
+/*!
+ *@author   chenghua.wang
+ *@file     vectorization/__vec_avx512.hpp
+ *@brief    The AVX-512 vectorization. 16 floats or 8 doubles in one register. AVX-512
+ * has mask registers, so the columns left after the last full vector can be loaded and
+ * stored with one masked instruction instead of a scalar loop.
+ *@note     Needs AVX512F/BW/DQ/VL (Skylake-SP and later). Compile with the cmake option
+ * USE_AVX512 to enable it.
+ */
+
+#ifndef _MGLORIA___VEC_AVX512_HPP_
+#define _MGLORIA___VEC_AVX512_HPP_
+
+#include <immintrin.h>
+#include "./vectorization/__vec_prepare.hpp"
+
+namespace mgloria {
+namespace vectorization {
+
+///! The compare of Vectorized<float, VecArch::AVX512_Arch>. One bit per lane.
+template<>
+struct VectorizedMask<float, VecArch::AVX512_Arch> {
+  friend struct Vectorized<float, VecArch::AVX512_Arch>;
+  VectorizedMask() = default;
+  MGLORIA_INLINE_AVX512 explicit VectorizedMask(__mmask16 data) : m_data(data) {}
+
+ private:
+  __mmask16 m_data;
+};
+
+///! The compare of Vectorized<double, VecArch::AVX512_Arch>. One bit per lane.
+template<>
+struct VectorizedMask<double, VecArch::AVX512_Arch> {
+  friend struct Vectorized<double, VecArch::AVX512_Arch>;
+  VectorizedMask() = default;
+  MGLORIA_INLINE_AVX512 explicit VectorizedMask(__mmask8 data) : m_data(data) {}
+
+ private:
+  __mmask8 m_data;
+};
+
+///! The compare of Vectorized<int32_t, VecArch::AVX512_Arch>. One bit per lane.
+template<>
+struct VectorizedMask<int32_t, VecArch::AVX512_Arch> {
+  friend struct Vectorized<int32_t, VecArch::AVX512_Arch>;
+  VectorizedMask() = default;
+  MGLORIA_INLINE_AVX512 explicit VectorizedMask(__mmask16 data) : m_data(data) {}
+
+ private:
+  __mmask16 m_data;
+};
+
+template<>
+struct Vectorized<float, VecArch::AVX512_Arch> {
+  // float in vector
+  static const index_t num = 16;
+  // friends
+  template<typename OriDataType, typename DisDataType, VecArch VArch>
+  friend struct VectorizedCast;
+  friend MGLORIA_INLINE_AVX512 Vectorized<float, VecArch::AVX512_Arch> operator+(
+      const Vectorized<float, VecArch::AVX512_Arch>& lhs,
+      const Vectorized<float, VecArch::AVX512_Arch>& rhs);
+
+  friend MGLORIA_INLINE_AVX512 Vectorized<float, VecArch::AVX512_Arch> operator-(
+      const Vectorized<float, VecArch::AVX512_Arch>& lhs,
+      const Vectorized<float, VecArch::AVX512_Arch>& rhs);
+
+  friend MGLORIA_INLINE_AVX512 Vectorized<float, VecArch::AVX512_Arch> operator*(
+      const Vectorized<float, VecArch::AVX512_Arch>& lhs,
+      const Vectorized<float, VecArch::AVX512_Arch>& rhs);
+
+  friend MGLORIA_INLINE_AVX512 Vectorized<float, VecArch::AVX512_Arch> operator/(
+      const Vectorized<float, VecArch::AVX512_Arch>& lhs,
+      const Vectorized<float, VecArch::AVX512_Arch>& rhs);
+
+  // constructor
+  Vectorized() = default;
+  MGLORIA_INLINE_AVX512 explicit Vectorized(__m512 data) : m_data(data) {}
+
+  // static create Vectorized functions
+  MGLORIA_INLINE_AVX512 static Vectorized<float, VecArch::AVX512_Arch> Fill(float s) {
+    return Vectorized<float, VecArch::AVX512_Arch>(_mm512_set1_ps(s));
+  }
+
+  MGLORIA_INLINE_AVX512 static Vectorized<float, VecArch::AVX512_Arch> Load(const float* s) {
+    return Vectorized<float, VecArch::AVX512_Arch>(_mm512_load_ps(s));
+  }
+
+  MGLORIA_INLINE_AVX512 static Vectorized<float, VecArch::AVX512_Arch> LoadUnAligned(
+      const float* s) {
+    return Vectorized<float, VecArch::AVX512_Arch>(_mm512_loadu_ps(s));
+  }
+
+  // Load the first n (n < num) floats, the other lanes are zero. s needs no alignment.
+  MGLORIA_INLINE_AVX512 static Vectorized<float, VecArch::AVX512_Arch> LoadMasked(
+      const float* s, index_t n) {
+    return Vectorized<float, VecArch::AVX512_Arch>(_mm512_maskz_loadu_ps(Mask(n), s));
+  }
+
+  // a * b + c in one rounding.
+  MGLORIA_INLINE_AVX512 static Vectorized<float, VecArch::AVX512_Arch> MulAdd(
+      const Vectorized<float, VecArch::AVX512_Arch>& a,
+      const Vectorized<float, VecArch::AVX512_Arch>& b,
+      const Vectorized<float, VecArch::AVX512_Arch>& c) {
+    return Vectorized<float, VecArch::AVX512_Arch>(_mm512_fmadd_ps(a.m_data, b.m_data, c.m_data));
+  }
+
+  // Lane-wise helpers for the math ops in __vec_math.hpp.
+  MGLORIA_INLINE_AVX512 static Vectorized<float, VecArch::AVX512_Arch> Max(
+      const Vectorized<float, VecArch::AVX512_Arch>& a,
+      const Vectorized<float, VecArch::AVX512_Arch>& b) {
+    return Vectorized<float, VecArch::AVX512_Arch>(_mm512_max_ps(a.m_data, b.m_data));
+  }
+
+  MGLORIA_INLINE_AVX512 static Vectorized<float, VecArch::AVX512_Arch> Min(
+      const Vectorized<float, VecArch::AVX512_Arch>& a,
+      const Vectorized<float, VecArch::AVX512_Arch>& b) {
+    return Vectorized<float, VecArch::AVX512_Arch>(_mm512_min_ps(a.m_data, b.m_data));
+  }
+
+  MGLORIA_INLINE_AVX512 static Vectorized<float, VecArch::AVX512_Arch> Abs(
+      const Vectorized<float, VecArch::AVX512_Arch>& a) {
+    return Vectorized<float, VecArch::AVX512_Arch>(_mm512_abs_ps(a.m_data));
+  }
+
+  MGLORIA_INLINE_AVX512 static Vectorized<float, VecArch::AVX512_Arch> Sqrt(
+      const Vectorized<float, VecArch::AVX512_Arch>& a) {
+    return Vectorized<float, VecArch::AVX512_Arch>(_mm512_sqrt_ps(a.m_data));
+  }
+
+  // About 1 / sqrt(a), relative error < 1.5 * 2^-14.
+  MGLORIA_INLINE_AVX512 static Vectorized<float, VecArch::AVX512_Arch> RSqrtEstimate(
+      const Vectorized<float, VecArch::AVX512_Arch>& a) {
+    return Vectorized<float, VecArch::AVX512_Arch>(_mm512_rsqrt14_ps(a.m_data));
+  }
+
+  // a < b ? t : e for each lane.
+  MGLORIA_INLINE_AVX512 static Vectorized<float, VecArch::AVX512_Arch> IfLess(
+      const Vectorized<float, VecArch::AVX512_Arch>& a,
+      const Vectorized<float, VecArch::AVX512_Arch>& b,
+      const Vectorized<float, VecArch::AVX512_Arch>& t,
+      const Vectorized<float, VecArch::AVX512_Arch>& e) {
+    return Vectorized<float, VecArch::AVX512_Arch>(_mm512_mask_blend_ps(
+        _mm512_cmp_ps_mask(a.m_data, b.m_data, _CMP_LT_OQ), e.m_data, t.m_data));
+  }
+
+  // 2^n, n is an integer in [-126, 127].
+  MGLORIA_INLINE_AVX512 static Vectorized<float, VecArch::AVX512_Arch> Pow2i(
+      const Vectorized<float, VecArch::AVX512_Arch>& n) {
+    const __m512i __e__ =
+        _mm512_add_epi32(_mm512_cvttps_epi32(n.m_data), _mm512_set1_epi32(127));
+    return Vectorized<float, VecArch::AVX512_Arch>(
+        _mm512_castsi512_ps(_mm512_slli_epi32(__e__, 23)));
+  }
+
+  // Split a normal a > 0 to m * 2^e, m in [0.5, 1).
+  MGLORIA_INLINE_AVX512 static Vectorized<float, VecArch::AVX512_Arch> Frexp(
+      const Vectorized<float, VecArch::AVX512_Arch>& a,
+      Vectorized<float, VecArch::AVX512_Arch>* e) {
+    const __m512i __bits__ = _mm512_castps_si512(a.m_data);
+    *e = Vectorized<float, VecArch::AVX512_Arch>(_mm512_cvtepi32_ps(
+        _mm512_sub_epi32(_mm512_srli_epi32(__bits__, 23), _mm512_set1_epi32(126))));
+    const __m512 __mant__ =
+        _mm512_and_ps(a.m_data, _mm512_castsi512_ps(_mm512_set1_epi32(0x807FFFFF)));
+    return Vectorized<float, VecArch::AVX512_Arch>(_mm512_or_ps(__mant__, _mm512_set1_ps(0.5f)));
+  }
+
+  // The lanes where a < b, a <= b, a == b and a != b. A NaN lane is only != to anything.
+  MGLORIA_INLINE_AVX512 static VectorizedMask<float, VecArch::AVX512_Arch> CmpLt(
+      const Vectorized<float, VecArch::AVX512_Arch>& a,
+      const Vectorized<float, VecArch::AVX512_Arch>& b) {
+    return VectorizedMask<float, VecArch::AVX512_Arch>(
+        _mm512_cmp_ps_mask(a.m_data, b.m_data, _CMP_LT_OQ));
+  }
+
+  MGLORIA_INLINE_AVX512 static VectorizedMask<float, VecArch::AVX512_Arch> CmpLe(
+      const Vectorized<float, VecArch::AVX512_Arch>& a,
+      const Vectorized<float, VecArch::AVX512_Arch>& b) {
+    return VectorizedMask<float, VecArch::AVX512_Arch>(
+        _mm512_cmp_ps_mask(a.m_data, b.m_data, _CMP_LE_OQ));
+  }
+
+  MGLORIA_INLINE_AVX512 static VectorizedMask<float, VecArch::AVX512_Arch> CmpEq(
+      const Vectorized<float, VecArch::AVX512_Arch>& a,
+      const Vectorized<float, VecArch::AVX512_Arch>& b) {
+    return VectorizedMask<float, VecArch::AVX512_Arch>(
+        _mm512_cmp_ps_mask(a.m_data, b.m_data, _CMP_EQ_OQ));
+  }
+
+  MGLORIA_INLINE_AVX512 static VectorizedMask<float, VecArch::AVX512_Arch> CmpNe(
+      const Vectorized<float, VecArch::AVX512_Arch>& a,
+      const Vectorized<float, VecArch::AVX512_Arch>& b) {
+    return VectorizedMask<float, VecArch::AVX512_Arch>(
+        _mm512_cmp_ps_mask(a.m_data, b.m_data, _CMP_NEQ_UQ));
+  }
+
+  // t where the lane of m is set, e where it is not. No branch.
+  MGLORIA_INLINE_AVX512 static Vectorized<float, VecArch::AVX512_Arch> Select(
+      const VectorizedMask<float, VecArch::AVX512_Arch>& m,
+      const Vectorized<float, VecArch::AVX512_Arch>& t,
+      const Vectorized<float, VecArch::AVX512_Arch>& e) {
+    return Vectorized<float, VecArch::AVX512_Arch>(
+        _mm512_mask_blend_ps(m.m_data, e.m_data, t.m_data));
+  }
+
+  // operator overload.
+  MGLORIA_INLINE_AVX512 Vectorized<float, VecArch::AVX512_Arch>& operator=(float s) {
+    m_data = _mm512_set1_ps(s);
+    return *this;
+  }
+
+  MGLORIA_INLINE_AVX512 Vectorized<float, VecArch::AVX512_Arch>& operator=(const float* s) {
+    m_data = _mm512_load_ps(s);
+    return *this;
+  }
+
+  MGLORIA_INLINE_AVX512 float Sum() const { return _mm512_reduce_add_ps(m_data); }
+
+  // Store vectorized data to normal data.
+  MGLORIA_INLINE_AVX512 void Store(float* data) const { _mm512_store_ps(data, m_data); }
+  MGLORIA_INLINE_AVX512 void StoreUnAligned(float* data) const { _mm512_storeu_ps(data, m_data); }
+  MGLORIA_INLINE_AVX512 void StoreEach(float* data) const {
+    _mm512_store_ps(data, _mm512_broadcastss_ps(_mm512_castps512_ps128(m_data)));
+  }
+  // Store the first n (n < num) floats. data needs no alignment.
+  MGLORIA_INLINE_AVX512 void StoreMasked(float* data, index_t n) const {
+    _mm512_mask_storeu_ps(data, Mask(n), m_data);
+  }
+
+ private:
+  MGLORIA_INLINE_AVX512 static __mmask16 Mask(index_t n) {
+    return static_cast<__mmask16>((1u << n) - 1u);
+  }
+  // parameters
+  __m512 m_data;
+};
+
+template<>
+struct Vectorized<double, VecArch::AVX512_Arch> {
+  // double in vector
+  static const index_t num = 8;
+  // friends
+  friend MGLORIA_INLINE_AVX512 Vectorized<double, VecArch::AVX512_Arch> operator+(
+      const Vectorized<double, VecArch::AVX512_Arch>& lhs,
+      const Vectorized<double, VecArch::AVX512_Arch>& rhs);
+
+  friend MGLORIA_INLINE_AVX512 Vectorized<double, VecArch::AVX512_Arch> operator-(
+      const Vectorized<double, VecArch::AVX512_Arch>& lhs,
+      const Vectorized<double, VecArch::AVX512_Arch>& rhs);
+
+  friend MGLORIA_INLINE_AVX512 Vectorized<double, VecArch::AVX512_Arch> operator*(
+      const Vectorized<double, VecArch::AVX512_Arch>& lhs,
+      const Vectorized<double, VecArch::AVX512_Arch>& rhs);
+
+  friend MGLORIA_INLINE_AVX512 Vectorized<double, VecArch::AVX512_Arch> operator/(
+      const Vectorized<double, VecArch::AVX512_Arch>& lhs,
+      const Vectorized<double, VecArch::AVX512_Arch>& rhs);
+
+  // constructor
+  Vectorized() = default;
+  MGLORIA_INLINE_AVX512 explicit Vectorized(__m512d data) : m_data(data) {}
+
+  // static create Vectorized functions
+  MGLORIA_INLINE_AVX512 static Vectorized<double, VecArch::AVX512_Arch> Fill(double s) {
+    return Vectorized<double, VecArch::AVX512_Arch>(_mm512_set1_pd(s));
+  }
+
+  MGLORIA_INLINE_AVX512 static Vectorized<double, VecArch::AVX512_Arch> Load(const double* s) {
+    return Vectorized<double, VecArch::AVX512_Arch>(_mm512_load_pd(s));
+  }
+
+  MGLORIA_INLINE_AVX512 static Vectorized<double, VecArch::AVX512_Arch> LoadUnAligned(
+      const double* s) {
+    return Vectorized<double, VecArch::AVX512_Arch>(_mm512_loadu_pd(s));
+  }
+
+  // Load the first n (n < num) doubles, the other lanes are zero. s needs no alignment.
+  MGLORIA_INLINE_AVX512 static Vectorized<double, VecArch::AVX512_Arch> LoadMasked(
+      const double* s, index_t n) {
+    return Vectorized<double, VecArch::AVX512_Arch>(_mm512_maskz_loadu_pd(Mask(n), s));
+  }
+
+  // a * b + c in one rounding.
+  MGLORIA_INLINE_AVX512 static Vectorized<double, VecArch::AVX512_Arch> MulAdd(
+      const Vectorized<double, VecArch::AVX512_Arch>& a,
+      const Vectorized<double, VecArch::AVX512_Arch>& b,
+      const Vectorized<double, VecArch::AVX512_Arch>& c) {
+    return Vectorized<double, VecArch::AVX512_Arch>(_mm512_fmadd_pd(a.m_data, b.m_data, c.m_data));
+  }
+
+  // Lane-wise helpers for the math ops in __vec_math.hpp.
+  MGLORIA_INLINE_AVX512 static Vectorized<double, VecArch::AVX512_Arch> Max(
+      const Vectorized<double, VecArch::AVX512_Arch>& a,
+      const Vectorized<double, VecArch::AVX512_Arch>& b) {
+    return Vectorized<double, VecArch::AVX512_Arch>(_mm512_max_pd(a.m_data, b.m_data));
+  }
+
+  MGLORIA_INLINE_AVX512 static Vectorized<double, VecArch::AVX512_Arch> Min(
+      const Vectorized<double, VecArch::AVX512_Arch>& a,
+      const Vectorized<double, VecArch::AVX512_Arch>& b) {
+    return Vectorized<double, VecArch::AVX512_Arch>(_mm512_min_pd(a.m_data, b.m_data));
+  }
+
+  MGLORIA_INLINE_AVX512 static Vectorized<double, VecArch::AVX512_Arch> Abs(
+      const Vectorized<double, VecArch::AVX512_Arch>& a) {
+    return Vectorized<double, VecArch::AVX512_Arch>(_mm512_abs_pd(a.m_data));
+  }
+
+  MGLORIA_INLINE_AVX512 static Vectorized<double, VecArch::AVX512_Arch> Sqrt(
+      const Vectorized<double, VecArch::AVX512_Arch>& a) {
+    return Vectorized<double, VecArch::AVX512_Arch>(_mm512_sqrt_pd(a.m_data));
+  }
+
+  // The lanes where a < b, a <= b, a == b and a != b. A NaN lane is only != to anything.
+  MGLORIA_INLINE_AVX512 static VectorizedMask<double, VecArch::AVX512_Arch> CmpLt(
+      const Vectorized<double, VecArch::AVX512_Arch>& a,
+      const Vectorized<double, VecArch::AVX512_Arch>& b) {
+    return VectorizedMask<double, VecArch::AVX512_Arch>(
+        _mm512_cmp_pd_mask(a.m_data, b.m_data, _CMP_LT_OQ));
+  }
+
+  MGLORIA_INLINE_AVX512 static VectorizedMask<double, VecArch::AVX512_Arch> CmpLe(
+      const Vectorized<double, VecArch::AVX512_Arch>& a,
+      const Vectorized<double, VecArch::AVX512_Arch>& b) {
+    return VectorizedMask<double, VecArch::AVX512_Arch>(
+        _mm512_cmp_pd_mask(a.m_data, b.m_data, _CMP_LE_OQ));
+  }
+
+  MGLORIA_INLINE_AVX512 static VectorizedMask<double, VecArch::AVX512_Arch> CmpEq(
+      const Vectorized<double, VecArch::AVX512_Arch>& a,
+      const Vectorized<double, VecArch::AVX512_Arch>& b) {
+    return VectorizedMask<double, VecArch::AVX512_Arch>(
+        _mm512_cmp_pd_mask(a.m_data, b.m_data, _CMP_EQ_OQ));
+  }
+
+  MGLORIA_INLINE_AVX512 static VectorizedMask<double, VecArch::AVX512_Arch> CmpNe(
+      const Vectorized<double, VecArch::AVX512_Arch>& a,
+      const Vectorized<double, VecArch::AVX512_Arch>& b) {
+    return VectorizedMask<double, VecArch::AVX512_Arch>(
+        _mm512_cmp_pd_mask(a.m_data, b.m_data, _CMP_NEQ_UQ));
+  }
+
+  // t where the lane of m is set, e where it is not. No branch.
+  MGLORIA_INLINE_AVX512 static Vectorized<double, VecArch::AVX512_Arch> Select(
+      const VectorizedMask<double, VecArch::AVX512_Arch>& m,
+      const Vectorized<double, VecArch::AVX512_Arch>& t,
+      const Vectorized<double, VecArch::AVX512_Arch>& e) {
+    return Vectorized<double, VecArch::AVX512_Arch>(
+        _mm512_mask_blend_pd(m.m_data, e.m_data, t.m_data));
+  }
+
+  // operator overload.
+  MGLORIA_INLINE_AVX512 Vectorized<double, VecArch::AVX512_Arch>& operator=(double s) {
+    m_data = _mm512_set1_pd(s);
+    return *this;
+  }
+
+  MGLORIA_INLINE_AVX512 Vectorized<double, VecArch::AVX512_Arch>& operator=(const double* s) {
+    m_data = _mm512_load_pd(s);
+    return *this;
+  }
+
+  MGLORIA_INLINE_AVX512 double Sum(void) const { return _mm512_reduce_add_pd(m_data); }
+
+  // Store vectorized data to normal data.
+  MGLORIA_INLINE_AVX512 void Store(double* data) const { _mm512_store_pd(data, m_data); }
+  MGLORIA_INLINE_AVX512 void StoreUnAligned(double* data) const { _mm512_storeu_pd(data, m_data); }
+  MGLORIA_INLINE_AVX512 void StoreEach(double* data) const {
+    _mm512_store_pd(data, _mm512_broadcastsd_pd(_mm512_castpd512_pd128(m_data)));
+  }
+  // Store the first n (n < num) doubles. data needs no alignment.
+  MGLORIA_INLINE_AVX512 void StoreMasked(double* data, index_t n) const {
+    _mm512_mask_storeu_pd(data, Mask(n), m_data);
+  }
+
+ private:
+  MGLORIA_INLINE_AVX512 static __mmask8 Mask(index_t n) {
+    return static_cast<__mmask8>((1u << n) - 1u);
+  }
+  // parameters
+  __m512d m_data;
+};
+
+template<>
+struct Vectorized<int32_t, VecArch::AVX512_Arch> {
+  // int32_t in vector
+  static const index_t num = 16;
+  // friends
+  template<typename OriDataType, typename DisDataType, VecArch VArch>
+  friend struct VectorizedCast;
+  friend MGLORIA_INLINE_AVX512 Vectorized<int32_t, VecArch::AVX512_Arch> operator+(
+      const Vectorized<int32_t, VecArch::AVX512_Arch>& lhs,
+      const Vectorized<int32_t, VecArch::AVX512_Arch>& rhs);
+
+  friend MGLORIA_INLINE_AVX512 Vectorized<int32_t, VecArch::AVX512_Arch> operator-(
+      const Vectorized<int32_t, VecArch::AVX512_Arch>& lhs,
+      const Vectorized<int32_t, VecArch::AVX512_Arch>& rhs);
+
+  friend MGLORIA_INLINE_AVX512 Vectorized<int32_t, VecArch::AVX512_Arch> operator*(
+      const Vectorized<int32_t, VecArch::AVX512_Arch>& lhs,
+      const Vectorized<int32_t, VecArch::AVX512_Arch>& rhs);
+
+  // constructor
+  Vectorized() = default;
+  MGLORIA_INLINE_AVX512 explicit Vectorized(__m512i data) : m_data(data) {}
+
+  // static create Vectorized functions
+  MGLORIA_INLINE_AVX512 static Vectorized<int32_t, VecArch::AVX512_Arch> Fill(int32_t s) {
+    return Vectorized<int32_t, VecArch::AVX512_Arch>(_mm512_set1_epi32(static_cast<int>(s)));
+  }
+
+  MGLORIA_INLINE_AVX512 static Vectorized<int32_t, VecArch::AVX512_Arch> Load(const int32_t* s) {
+    return Vectorized<int32_t, VecArch::AVX512_Arch>(_mm512_load_si512(s));
+  }
+
+  MGLORIA_INLINE_AVX512 static Vectorized<int32_t, VecArch::AVX512_Arch> LoadUnAligned(
+      const int32_t* s) {
+    return Vectorized<int32_t, VecArch::AVX512_Arch>(_mm512_loadu_si512(s));
+  }
+
+  // Load the first n (n < num) elements, the other lanes are zero. s needs no alignment.
+  MGLORIA_INLINE_AVX512 static Vectorized<int32_t, VecArch::AVX512_Arch> LoadMasked(
+      const int32_t* s, index_t n) {
+    return Vectorized<int32_t, VecArch::AVX512_Arch>(_mm512_maskz_loadu_epi32(Mask(n), s));
+  }
+
+  // 32 int8_t widened to int16, the lane q holding s[2q] and s[2q + 1]. See MulAddPairs.
+  MGLORIA_INLINE_AVX512 static Vectorized<int32_t, VecArch::AVX512_Arch> LoadPairs(
+      const int8_t* s) {
+    return Vectorized<int32_t, VecArch::AVX512_Arch>(
+        _mm512_cvtepi8_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(s))));
+  }
+
+  // a + b, clamped to [INT32_MIN, INT32_MAX] when it overflows.
+  MGLORIA_INLINE_AVX512 static Vectorized<int32_t, VecArch::AVX512_Arch> AddSat(
+      const Vectorized<int32_t, VecArch::AVX512_Arch>& a,
+      const Vectorized<int32_t, VecArch::AVX512_Arch>& b) {
+    const __m512i s = _mm512_add_epi32(a.m_data, b.m_data);
+    // Overflow only if a and b have the same sign and s has the other one.
+    const __m512i ov = _mm512_and_si512(_mm512_xor_si512(s, a.m_data),
+                                        _mm512_xor_si512(s, b.m_data));
+    return Vectorized<int32_t, VecArch::AVX512_Arch>(Saturate(s, a.m_data, ov));
+  }
+
+  // a - b, clamped to [INT32_MIN, INT32_MAX] when it overflows.
+  MGLORIA_INLINE_AVX512 static Vectorized<int32_t, VecArch::AVX512_Arch> SubSat(
+      const Vectorized<int32_t, VecArch::AVX512_Arch>& a,
+      const Vectorized<int32_t, VecArch::AVX512_Arch>& b) {
+    const __m512i s = _mm512_sub_epi32(a.m_data, b.m_data);
+    // Overflow only if a and b have different signs and s has the sign of b.
+    const __m512i ov = _mm512_and_si512(_mm512_xor_si512(a.m_data, b.m_data),
+                                        _mm512_xor_si512(s, a.m_data));
+    return Vectorized<int32_t, VecArch::AVX512_Arch>(Saturate(s, a.m_data, ov));
+  }
+
+  // a * b + c, all wrap around.
+  MGLORIA_INLINE_AVX512 static Vectorized<int32_t, VecArch::AVX512_Arch> MulAdd(
+      const Vectorized<int32_t, VecArch::AVX512_Arch>& a,
+      const Vectorized<int32_t, VecArch::AVX512_Arch>& b,
+      const Vectorized<int32_t, VecArch::AVX512_Arch>& c) {
+    return a * b + c;
+  }
+
+  // c + a0 * b0 + a1 * b1 per lane, each lane of a and b holding two int16, a0 in the low half.
+  // One vpdpwssd when built for AVX512-VNNI.
+  MGLORIA_INLINE_AVX512 static Vectorized<int32_t, VecArch::AVX512_Arch> MulAddPairs(
+      const Vectorized<int32_t, VecArch::AVX512_Arch>& a,
+      const Vectorized<int32_t, VecArch::AVX512_Arch>& b,
+      const Vectorized<int32_t, VecArch::AVX512_Arch>& c) {
+#ifdef __AVX512VNNI__
+    return Vectorized<int32_t, VecArch::AVX512_Arch>(
+        _mm512_dpwssd_epi32(c.m_data, a.m_data, b.m_data));
+#else
+    return Vectorized<int32_t, VecArch::AVX512_Arch>(
+        _mm512_add_epi32(c.m_data, _mm512_madd_epi16(a.m_data, b.m_data)));
+#endif
+  }
+
+  // The lanes where a < b, a <= b, a == b and a != b.
+  MGLORIA_INLINE_AVX512 static VectorizedMask<int32_t, VecArch::AVX512_Arch> CmpLt(
+      const Vectorized<int32_t, VecArch::AVX512_Arch>& a,
+      const Vectorized<int32_t, VecArch::AVX512_Arch>& b) {
+    return VectorizedMask<int32_t, VecArch::AVX512_Arch>(
+        _mm512_cmp_epi32_mask(a.m_data, b.m_data, _MM_CMPINT_LT));
+  }
+
+  MGLORIA_INLINE_AVX512 static VectorizedMask<int32_t, VecArch::AVX512_Arch> CmpLe(
+      const Vectorized<int32_t, VecArch::AVX512_Arch>& a,
+      const Vectorized<int32_t, VecArch::AVX512_Arch>& b) {
+    return VectorizedMask<int32_t, VecArch::AVX512_Arch>(
+        _mm512_cmp_epi32_mask(a.m_data, b.m_data, _MM_CMPINT_LE));
+  }
+
+  MGLORIA_INLINE_AVX512 static VectorizedMask<int32_t, VecArch::AVX512_Arch> CmpEq(
+      const Vectorized<int32_t, VecArch::AVX512_Arch>& a,
+      const Vectorized<int32_t, VecArch::AVX512_Arch>& b) {
+    return VectorizedMask<int32_t, VecArch::AVX512_Arch>(
+        _mm512_cmp_epi32_mask(a.m_data, b.m_data, _MM_CMPINT_EQ));
+  }
+
+  MGLORIA_INLINE_AVX512 static VectorizedMask<int32_t, VecArch::AVX512_Arch> CmpNe(
+      const Vectorized<int32_t, VecArch::AVX512_Arch>& a,
+      const Vectorized<int32_t, VecArch::AVX512_Arch>& b) {
+    return VectorizedMask<int32_t, VecArch::AVX512_Arch>(
+        _mm512_cmp_epi32_mask(a.m_data, b.m_data, _MM_CMPINT_NE));
+  }
+
+  // t where the lane of m is set, e where it is not. No branch.
+  MGLORIA_INLINE_AVX512 static Vectorized<int32_t, VecArch::AVX512_Arch> Select(
+      const VectorizedMask<int32_t, VecArch::AVX512_Arch>& m,
+      const Vectorized<int32_t, VecArch::AVX512_Arch>& t,
+      const Vectorized<int32_t, VecArch::AVX512_Arch>& e) {
+    return Vectorized<int32_t, VecArch::AVX512_Arch>(
+        _mm512_mask_blend_epi32(m.m_data, e.m_data, t.m_data));
+  }
+
+  // operator overload.
+  MGLORIA_INLINE_AVX512 Vectorized<int32_t, VecArch::AVX512_Arch>& operator=(int32_t s) {
+    m_data = _mm512_set1_epi32(static_cast<int>(s));
+    return *this;
+  }
+
+  MGLORIA_INLINE_AVX512 Vectorized<int32_t, VecArch::AVX512_Arch>& operator=(const int32_t* s) {
+    m_data = _mm512_load_si512(s);
+    return *this;
+  }
+
+  MGLORIA_INLINE_AVX512 int32_t Sum() const { return _mm512_reduce_add_epi32(m_data); }
+
+  // Store vectorized data to normal data.
+  MGLORIA_INLINE_AVX512 void Store(int32_t* data) const { _mm512_store_si512(data, m_data); }
+  MGLORIA_INLINE_AVX512 void StoreUnAligned(int32_t* data) const {
+    _mm512_storeu_si512(data, m_data);
+  }
+  // Store the first n (n < num) elements. data needs no alignment.
+  MGLORIA_INLINE_AVX512 void StoreMasked(int32_t* data, index_t n) const {
+    _mm512_mask_storeu_epi32(data, Mask(n), m_data);
+  }
+
+ private:
+  // Where ov has the sign bit, INT32_MAX if a >= 0 else INT32_MIN. Or s.
+  MGLORIA_INLINE_AVX512 static __m512i Saturate(__m512i s, __m512i a, __m512i ov) {
+    const __m512i __ov__ = _mm512_srai_epi32(ov, 31);
+    const __m512i __sat__ = _mm512_xor_si512(_mm512_srai_epi32(a, 31),
+                                             _mm512_set1_epi32(INT32_MAX));
+    return _mm512_or_si512(_mm512_and_si512(__ov__, __sat__), _mm512_andnot_si512(__ov__, s));
+  }
+  MGLORIA_INLINE_AVX512 static __mmask16 Mask(index_t n) {
+    return static_cast<__mmask16>((1u << n) - 1u);
+  }
+  // parameters
+  __m512i m_data;
+};
+
+template<>
+struct Vectorized<int8_t, VecArch::AVX512_Arch> {
+  // int8_t in vector
+  static const index_t num = 64;
+  // friends
+  friend MGLORIA_INLINE_AVX512 Vectorized<int8_t, VecArch::AVX512_Arch> operator+(
+      const Vectorized<int8_t, VecArch::AVX512_Arch>& lhs,
+      const Vectorized<int8_t, VecArch::AVX512_Arch>& rhs);
+
+  friend MGLORIA_INLINE_AVX512 Vectorized<int8_t, VecArch::AVX512_Arch> operator-(
+      const Vectorized<int8_t, VecArch::AVX512_Arch>& lhs,
+      const Vectorized<int8_t, VecArch::AVX512_Arch>& rhs);
+
+  friend MGLORIA_INLINE_AVX512 Vectorized<int8_t, VecArch::AVX512_Arch> operator*(
+      const Vectorized<int8_t, VecArch::AVX512_Arch>& lhs,
+      const Vectorized<int8_t, VecArch::AVX512_Arch>& rhs);
+
+  // constructor
+  Vectorized() = default;
+  MGLORIA_INLINE_AVX512 explicit Vectorized(__m512i data) : m_data(data) {}
+
+  // static create Vectorized functions
+  MGLORIA_INLINE_AVX512 static Vectorized<int8_t, VecArch::AVX512_Arch> Fill(int8_t s) {
+    return Vectorized<int8_t, VecArch::AVX512_Arch>(_mm512_set1_epi8(static_cast<char>(s)));
+  }
+
+  MGLORIA_INLINE_AVX512 static Vectorized<int8_t, VecArch::AVX512_Arch> Load(const int8_t* s) {
+    return Vectorized<int8_t, VecArch::AVX512_Arch>(_mm512_load_si512(s));
+  }
+
+  MGLORIA_INLINE_AVX512 static Vectorized<int8_t, VecArch::AVX512_Arch> LoadUnAligned(
+      const int8_t* s) {
+    return Vectorized<int8_t, VecArch::AVX512_Arch>(_mm512_loadu_si512(s));
+  }
+
+  // Load the first n (n < num) elements, the other lanes are zero. s needs no alignment.
+  MGLORIA_INLINE_AVX512 static Vectorized<int8_t, VecArch::AVX512_Arch> LoadMasked(
+      const int8_t* s, index_t n) {
+    return Vectorized<int8_t, VecArch::AVX512_Arch>(_mm512_maskz_loadu_epi8(Mask(n), s));
+  }
+
+  // a + b, clamped to [-128, 127].
+  MGLORIA_INLINE_AVX512 static Vectorized<int8_t, VecArch::AVX512_Arch> AddSat(
+      const Vectorized<int8_t, VecArch::AVX512_Arch>& a,
+      const Vectorized<int8_t, VecArch::AVX512_Arch>& b) {
+    return Vectorized<int8_t, VecArch::AVX512_Arch>(_mm512_adds_epi8(a.m_data, b.m_data));
+  }
+
+  // a - b, clamped to [-128, 127].
+  MGLORIA_INLINE_AVX512 static Vectorized<int8_t, VecArch::AVX512_Arch> SubSat(
+      const Vectorized<int8_t, VecArch::AVX512_Arch>& a,
+      const Vectorized<int8_t, VecArch::AVX512_Arch>& b) {
+    return Vectorized<int8_t, VecArch::AVX512_Arch>(_mm512_subs_epi8(a.m_data, b.m_data));
+  }
+
+  // operator overload.
+  MGLORIA_INLINE_AVX512 Vectorized<int8_t, VecArch::AVX512_Arch>& operator=(int8_t s) {
+    m_data = _mm512_set1_epi8(static_cast<char>(s));
+    return *this;
+  }
+
+  MGLORIA_INLINE_AVX512 Vectorized<int8_t, VecArch::AVX512_Arch>& operator=(const int8_t* s) {
+    m_data = _mm512_load_si512(s);
+    return *this;
+  }
+
+  // Store vectorized data to normal data.
+  MGLORIA_INLINE_AVX512 void Store(int8_t* data) const { _mm512_store_si512(data, m_data); }
+  MGLORIA_INLINE_AVX512 void StoreUnAligned(int8_t* data) const {
+    _mm512_storeu_si512(data, m_data);
+  }
+  // Store the first n (n < num) elements. data needs no alignment.
+  MGLORIA_INLINE_AVX512 void StoreMasked(int8_t* data, index_t n) const {
+    _mm512_mask_storeu_epi8(data, Mask(n), m_data);
+  }
+
+ private:
+  MGLORIA_INLINE_AVX512 static __mmask64 Mask(index_t n) {
+    return static_cast<__mmask64>((1ull << n) - 1ull);
+  }
+  // parameters
+  __m512i m_data;
+};
+
+template<>
+struct Vectorized<uint8_t, VecArch::AVX512_Arch> {
+  // uint8_t in vector
+  static const index_t num = 64;
+  // friends
+  friend MGLORIA_INLINE_AVX512 Vectorized<uint8_t, VecArch::AVX512_Arch> operator+(
+      const Vectorized<uint8_t, VecArch::AVX512_Arch>& lhs,
+      const Vectorized<uint8_t, VecArch::AVX512_Arch>& rhs);
+
+  friend MGLORIA_INLINE_AVX512 Vectorized<uint8_t, VecArch::AVX512_Arch> operator-(
+      const Vectorized<uint8_t, VecArch::AVX512_Arch>& lhs,
+      const Vectorized<uint8_t, VecArch::AVX512_Arch>& rhs);
+
+  friend MGLORIA_INLINE_AVX512 Vectorized<uint8_t, VecArch::AVX512_Arch> operator*(
+      const Vectorized<uint8_t, VecArch::AVX512_Arch>& lhs,
+      const Vectorized<uint8_t, VecArch::AVX512_Arch>& rhs);
+
+  // constructor
+  Vectorized() = default;
+  MGLORIA_INLINE_AVX512 explicit Vectorized(__m512i data) : m_data(data) {}
+
+  // static create Vectorized functions
+  MGLORIA_INLINE_AVX512 static Vectorized<uint8_t, VecArch::AVX512_Arch> Fill(uint8_t s) {
+    return Vectorized<uint8_t, VecArch::AVX512_Arch>(_mm512_set1_epi8(static_cast<char>(s)));
+  }
+
+  MGLORIA_INLINE_AVX512 static Vectorized<uint8_t, VecArch::AVX512_Arch> Load(const uint8_t* s) {
+    return Vectorized<uint8_t, VecArch::AVX512_Arch>(_mm512_load_si512(s));
+  }
+
+  MGLORIA_INLINE_AVX512 static Vectorized<uint8_t, VecArch::AVX512_Arch> LoadUnAligned(
+      const uint8_t* s) {
+    return Vectorized<uint8_t, VecArch::AVX512_Arch>(_mm512_loadu_si512(s));
+  }
+
+  // Load the first n (n < num) elements, the other lanes are zero. s needs no alignment.
+  MGLORIA_INLINE_AVX512 static Vectorized<uint8_t, VecArch::AVX512_Arch> LoadMasked(
+      const uint8_t* s, index_t n) {
+    return Vectorized<uint8_t, VecArch::AVX512_Arch>(_mm512_maskz_loadu_epi8(Mask(n), s));
+  }
+
+  // a + b, clamped to [0, 255].
+  MGLORIA_INLINE_AVX512 static Vectorized<uint8_t, VecArch::AVX512_Arch> AddSat(
+      const Vectorized<uint8_t, VecArch::AVX512_Arch>& a,
+      const Vectorized<uint8_t, VecArch::AVX512_Arch>& b) {
+    return Vectorized<uint8_t, VecArch::AVX512_Arch>(_mm512_adds_epu8(a.m_data, b.m_data));
+  }
+
+  // a - b, clamped to [0, 255].
+  MGLORIA_INLINE_AVX512 static Vectorized<uint8_t, VecArch::AVX512_Arch> SubSat(
+      const Vectorized<uint8_t, VecArch::AVX512_Arch>& a,
+      const Vectorized<uint8_t, VecArch::AVX512_Arch>& b) {
+    return Vectorized<uint8_t, VecArch::AVX512_Arch>(_mm512_subs_epu8(a.m_data, b.m_data));
+  }
+
+  // operator overload.
+  MGLORIA_INLINE_AVX512 Vectorized<uint8_t, VecArch::AVX512_Arch>& operator=(uint8_t s) {
+    m_data = _mm512_set1_epi8(static_cast<char>(s));
+    return *this;
+  }
+
+  MGLORIA_INLINE_AVX512 Vectorized<uint8_t, VecArch::AVX512_Arch>& operator=(const uint8_t* s) {
+    m_data = _mm512_load_si512(s);
+    return *this;
+  }
+
+  // Store vectorized data to normal data.
+  MGLORIA_INLINE_AVX512 void Store(uint8_t* data) const { _mm512_store_si512(data, m_data); }
+  MGLORIA_INLINE_AVX512 void StoreUnAligned(uint8_t* data) const {
+    _mm512_storeu_si512(data, m_data);
+  }
+  // Store the first n (n < num) elements. data needs no alignment.
+  MGLORIA_INLINE_AVX512 void StoreMasked(uint8_t* data, index_t n) const {
+    _mm512_mask_storeu_epi8(data, Mask(n), m_data);
+  }
+
+ private:
+  MGLORIA_INLINE_AVX512 static __mmask64 Mask(index_t n) {
+    return static_cast<__mmask64>((1ull << n) - 1ull);
+  }
+  // parameters
+  __m512i m_data;
+};
+
+MGLORIA_INLINE_AVX512 Vectorized<float, VecArch::AVX512_Arch> operator+(
+    const Vectorized<float, VecArch::AVX512_Arch>& lhs,
+    const Vectorized<float, VecArch::AVX512_Arch>& rhs) {
+  return Vectorized<float, VecArch::AVX512_Arch>(_mm512_add_ps(lhs.m_data, rhs.m_data));
+}
+
+MGLORIA_INLINE_AVX512 Vectorized<float, VecArch::AVX512_Arch> operator-(
+    const Vectorized<float, VecArch::AVX512_Arch>& lhs,
+    const Vectorized<float, VecArch::AVX512_Arch>& rhs) {
+  return Vectorized<float, VecArch::AVX512_Arch>(_mm512_sub_ps(lhs.m_data, rhs.m_data));
+}
+
+MGLORIA_INLINE_AVX512 Vectorized<float, VecArch::AVX512_Arch> operator*(
+    const Vectorized<float, VecArch::AVX512_Arch>& lhs,
+    const Vectorized<float, VecArch::AVX512_Arch>& rhs) {
+  return Vectorized<float, VecArch::AVX512_Arch>(_mm512_mul_ps(lhs.m_data, rhs.m_data));
+}
+
+MGLORIA_INLINE_AVX512 Vectorized<float, VecArch::AVX512_Arch> operator/(
+    const Vectorized<float, VecArch::AVX512_Arch>& lhs,
+    const Vectorized<float, VecArch::AVX512_Arch>& rhs) {
+  return Vectorized<float, VecArch::AVX512_Arch>(_mm512_div_ps(lhs.m_data, rhs.m_data));
+}
+
+MGLORIA_INLINE_AVX512 Vectorized<double, VecArch::AVX512_Arch> operator+(
+    const Vectorized<double, VecArch::AVX512_Arch>& lhs,
+    const Vectorized<double, VecArch::AVX512_Arch>& rhs) {
+  return Vectorized<double, VecArch::AVX512_Arch>(_mm512_add_pd(lhs.m_data, rhs.m_data));
+}
+
+MGLORIA_INLINE_AVX512 Vectorized<double, VecArch::AVX512_Arch> operator-(
+    const Vectorized<double, VecArch::AVX512_Arch>& lhs,
+    const Vectorized<double, VecArch::AVX512_Arch>& rhs) {
+  return Vectorized<double, VecArch::AVX512_Arch>(_mm512_sub_pd(lhs.m_data, rhs.m_data));
+}
+
+MGLORIA_INLINE_AVX512 Vectorized<double, VecArch::AVX512_Arch> operator*(
+    const Vectorized<double, VecArch::AVX512_Arch>& lhs,
+    const Vectorized<double, VecArch::AVX512_Arch>& rhs) {
+  return Vectorized<double, VecArch::AVX512_Arch>(_mm512_mul_pd(lhs.m_data, rhs.m_data));
+}
+
+MGLORIA_INLINE_AVX512 Vectorized<double, VecArch::AVX512_Arch> operator/(
+    const Vectorized<double, VecArch::AVX512_Arch>& lhs,
+    const Vectorized<double, VecArch::AVX512_Arch>& rhs) {
+  return Vectorized<double, VecArch::AVX512_Arch>(_mm512_div_pd(lhs.m_data, rhs.m_data));
+}
+
+MGLORIA_INLINE_AVX512 Vectorized<int32_t, VecArch::AVX512_Arch> operator+(
+    const Vectorized<int32_t, VecArch::AVX512_Arch>& lhs,
+    const Vectorized<int32_t, VecArch::AVX512_Arch>& rhs) {
+  return Vectorized<int32_t, VecArch::AVX512_Arch>(_mm512_add_epi32(lhs.m_data, rhs.m_data));
+}
+
+MGLORIA_INLINE_AVX512 Vectorized<int32_t, VecArch::AVX512_Arch> operator-(
+    const Vectorized<int32_t, VecArch::AVX512_Arch>& lhs,
+    const Vectorized<int32_t, VecArch::AVX512_Arch>& rhs) {
+  return Vectorized<int32_t, VecArch::AVX512_Arch>(_mm512_sub_epi32(lhs.m_data, rhs.m_data));
+}
+
+MGLORIA_INLINE_AVX512 Vectorized<int32_t, VecArch::AVX512_Arch> operator*(
+    const Vectorized<int32_t, VecArch::AVX512_Arch>& lhs,
+    const Vectorized<int32_t, VecArch::AVX512_Arch>& rhs) {
+  return Vectorized<int32_t, VecArch::AVX512_Arch>(_mm512_mullo_epi32(lhs.m_data, rhs.m_data));
+}
+MGLORIA_INLINE_AVX512 Vectorized<int8_t, VecArch::AVX512_Arch> operator+(
+    const Vectorized<int8_t, VecArch::AVX512_Arch>& lhs,
+    const Vectorized<int8_t, VecArch::AVX512_Arch>& rhs) {
+  return Vectorized<int8_t, VecArch::AVX512_Arch>(_mm512_add_epi8(lhs.m_data, rhs.m_data));
+}
+
+MGLORIA_INLINE_AVX512 Vectorized<int8_t, VecArch::AVX512_Arch> operator-(
+    const Vectorized<int8_t, VecArch::AVX512_Arch>& lhs,
+    const Vectorized<int8_t, VecArch::AVX512_Arch>& rhs) {
+  return Vectorized<int8_t, VecArch::AVX512_Arch>(_mm512_sub_epi8(lhs.m_data, rhs.m_data));
+}
+
+MGLORIA_INLINE_AVX512 Vectorized<int8_t, VecArch::AVX512_Arch> operator*(
+    const Vectorized<int8_t, VecArch::AVX512_Arch>& lhs,
+    const Vectorized<int8_t, VecArch::AVX512_Arch>& rhs) {
+  // No 8 bits multiply. Do the even and odd bytes in 16 bits lanes, the low byte is the answer.
+  const __m512i __even__ = _mm512_mullo_epi16(lhs.m_data, rhs.m_data);
+  const __m512i __odd__ =
+      _mm512_mullo_epi16(_mm512_srli_epi16(lhs.m_data, 8), _mm512_srli_epi16(rhs.m_data, 8));
+  return Vectorized<int8_t, VecArch::AVX512_Arch>(_mm512_or_si512(_mm512_slli_epi16(__odd__, 8),
+                         _mm512_and_si512(__even__, _mm512_set1_epi16(0x00FF))));
+}
+MGLORIA_INLINE_AVX512 Vectorized<uint8_t, VecArch::AVX512_Arch> operator+(
+    const Vectorized<uint8_t, VecArch::AVX512_Arch>& lhs,
+    const Vectorized<uint8_t, VecArch::AVX512_Arch>& rhs) {
+  return Vectorized<uint8_t, VecArch::AVX512_Arch>(_mm512_add_epi8(lhs.m_data, rhs.m_data));
+}
+
+MGLORIA_INLINE_AVX512 Vectorized<uint8_t, VecArch::AVX512_Arch> operator-(
+    const Vectorized<uint8_t, VecArch::AVX512_Arch>& lhs,
+    const Vectorized<uint8_t, VecArch::AVX512_Arch>& rhs) {
+  return Vectorized<uint8_t, VecArch::AVX512_Arch>(_mm512_sub_epi8(lhs.m_data, rhs.m_data));
+}
+
+MGLORIA_INLINE_AVX512 Vectorized<uint8_t, VecArch::AVX512_Arch> operator*(
+    const Vectorized<uint8_t, VecArch::AVX512_Arch>& lhs,
+    const Vectorized<uint8_t, VecArch::AVX512_Arch>& rhs) {
+  // No 8 bits multiply. Do the even and odd bytes in 16 bits lanes, the low byte is the answer.
+  const __m512i __even__ = _mm512_mullo_epi16(lhs.m_data, rhs.m_data);
+  const __m512i __odd__ =
+      _mm512_mullo_epi16(_mm512_srli_epi16(lhs.m_data, 8), _mm512_srli_epi16(rhs.m_data, 8));
+  return Vectorized<uint8_t, VecArch::AVX512_Arch>(_mm512_or_si512(_mm512_slli_epi16(__odd__, 8),
+                         _mm512_and_si512(__even__, _mm512_set1_epi16(0x00FF))));
+}
+
+/*!
+ *@brief      The masked tail saver. Only AVX-512 has it, see VectorizedTailSaver.
+ */
+template<typename LeftValue, typename TFloat>
+struct VectorizedTailSaver<LeftValue, TFloat, VecArch::AVX512_Arch> {
+  static const bool m_Enable = MGLORIA_VECTORIZATION_TRUE;
+  MGLORIA_INLINE_AVX512 static void Do(TFloat* dst,
+                                       const Vectorized<TFloat, VecArch::AVX512_Arch>& src,
+                                       index_t n) {
+    Vectorized<TFloat, VecArch::AVX512_Arch> lhs =
+        Vectorized<TFloat, VecArch::AVX512_Arch>::LoadMasked(dst, n);
+    Vectorized<TFloat, VecArch::AVX512_Arch> ans =
+        VectorizedOP<typename LeftValue::OPType, TFloat, VecArch::AVX512_Arch>::Do(lhs, src);
+    ans.StoreMasked(dst, n);
+  }
+};
+
+template<typename TFloat>
+struct VectorizedTailSaver<op::_saveto, TFloat, VecArch::AVX512_Arch> {
+  static const bool m_Enable = MGLORIA_VECTORIZATION_TRUE;
+  MGLORIA_INLINE_AVX512 static void Do(TFloat* dst,
+                                       const Vectorized<TFloat, VecArch::AVX512_Arch>& src,
+                                       index_t n) {
+    src.StoreMasked(dst, n);
+  }
+};
+
+/*!
+ *@brief      float <-> int32_t, see VectorizedCast.
+ */
+template<>
+struct VectorizedCast<float, int32_t, VecArch::AVX512_Arch> {
+  MGLORIA_INLINE_AVX512 static Vectorized<int32_t, VecArch::AVX512_Arch> Do(
+      const Vectorized<float, VecArch::AVX512_Arch>& src) {
+    return Vectorized<int32_t, VecArch::AVX512_Arch>(_mm512_cvttps_epi32(src.m_data));
+  }
+
+  static const bool m_Enable = MGLORIA_VECTORIZATION_TRUE;
+};
+
+template<>
+struct VectorizedCast<int32_t, float, VecArch::AVX512_Arch> {
+  MGLORIA_INLINE_AVX512 static Vectorized<float, VecArch::AVX512_Arch> Do(
+      const Vectorized<int32_t, VecArch::AVX512_Arch>& src) {
+    return Vectorized<float, VecArch::AVX512_Arch>(_mm512_cvtepi32_ps(src.m_data));
+  }
+
+  static const bool m_Enable = MGLORIA_VECTORIZATION_TRUE;
+};
+
+/*!
+ *@brief      The gathers of AVX-512, see VectorizedGather. The lanes not below n are masked off.
+ */
+template<>
+struct VectorizedGather<float, VecArch::AVX512_Arch> {
+  MGLORIA_INLINE_AVX512 static Vectorized<float, VecArch::AVX512_Arch> Do(const float* src,
+                                                                          index_t stride,
+                                                                          index_t n) {
+    const __m512i __index__ = _mm512_mullo_epi32(
+        _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15),
+        _mm512_set1_epi32(stride));
+    return Vectorized<float, VecArch::AVX512_Arch>(
+        _mm512_mask_i32gather_ps(_mm512_setzero_ps(), static_cast<__mmask16>((1u << n) - 1u),
+                                 __index__, src, 4));
+  }
+};
+
+template<>
+struct VectorizedGather<int32_t, VecArch::AVX512_Arch> {
+  MGLORIA_INLINE_AVX512 static Vectorized<int32_t, VecArch::AVX512_Arch> Do(const int32_t* src,
+                                                                            index_t stride,
+                                                                            index_t n) {
+    const __m512i __index__ = _mm512_mullo_epi32(
+        _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15),
+        _mm512_set1_epi32(stride));
+    return Vectorized<int32_t, VecArch::AVX512_Arch>(
+        _mm512_mask_i32gather_epi32(_mm512_setzero_si512(), static_cast<__mmask16>((1u << n) - 1u),
+                                    __index__, src, 4));
+  }
+};
+
+template<>
+struct VectorizedGather<double, VecArch::AVX512_Arch> {
+  MGLORIA_INLINE_AVX512 static Vectorized<double, VecArch::AVX512_Arch> Do(const double* src,
+                                                                           index_t stride,
+                                                                           index_t n) {
+    const __m256i __index__ =
+        _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(stride));
+    return Vectorized<double, VecArch::AVX512_Arch>(
+        _mm512_mask_i32gather_pd(_mm512_setzero_pd(), static_cast<__mmask8>((1u << n) - 1u),
+                                 __index__, src, 8));
+  }
+};
+
+}  // namespace vectorization
+}  // namespace mgloria
+
+#endif
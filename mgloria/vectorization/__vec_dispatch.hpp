@@ -0,0 +1,114 @@
+/*!
+ *@author   chenghua.wang
+ *@file     vectorization/__vec_dispatch.hpp
+ *@brief    Pick the vectorization arch when the program runs. Only used when the lib is built
+ * with MGLORIA_RUNTIME_DISPATCH, otherwise the arch is MGLORIA_VECTORIZATION_ARCH.
+ *@note     The level is detected by cpuid the first time it is asked for. Set the env
+ * MGLORIA_VEC_ARCH to none, sse, avx2 or avx512 to force a level, e.g. for benchmarking. A level
+ * the CPU does not have is ignored with a warning.
+ */
+
+#ifndef _MGLORIA___VEC_DISPATCH_HPP_
+#define _MGLORIA___VEC_DISPATCH_HPP_
+
+#pragma once
+
+#include <cstdlib>
+#include <cstring>
+#include "./vectorization/__vec_prepare.hpp"
+
+#if !defined(__x86_64__) && !defined(__i386__)
+#error "MGLORIA_RUNTIME_DISPATCH needs a x86 CPU to run cpuid."
+#endif
+
+namespace mgloria {
+namespace vectorization {
+
+MGLORIA_INLINE_NORMAL const char* VecArchName(VecArch arch) {
+  switch (arch) {
+    case VecArch::SSE_Arch: return "sse";
+    case VecArch::AVX2_Arch: return "avx2";
+    case VecArch::AVX512_Arch: return "avx512";
+    default: return "none";
+  }
+}
+
+/*!
+ *@brief    The widest arch this CPU supports.
+ */
+MGLORIA_INLINE_NORMAL VecArch DetectVecArch() {
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")
+      && __builtin_cpu_supports("avx512dq") && __builtin_cpu_supports("avx512vl")) {
+    return VecArch::AVX512_Arch;
+  }
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+    return VecArch::AVX2_Arch;
+  }
+#if MGLORIA_USE_SSE == 1
+  if (__builtin_cpu_supports("sse2")) { return VecArch::SSE_Arch; }
+#endif
+  return VecArch::NONE_Arch;
+}
+
+/*!
+ *@brief    Parse the name given by VecArchName back. Return false if it is not a known name.
+ */
+MGLORIA_INLINE_NORMAL bool ParseVecArch(const char* name, VecArch* arch) {
+  const VecArch __all__[] = {VecArch::NONE_Arch, VecArch::SSE_Arch, VecArch::AVX2_Arch,
+                             VecArch::AVX512_Arch};
+  for (VecArch a : __all__) {
+    if (std::strcmp(name, VecArchName(a)) == 0) {
+      *arch = a;
+      return true;
+    }
+  }
+  return false;
+}
+
+MGLORIA_INLINE_NORMAL VecArch __init_runtime_vec_arch__() {
+  VecArch __detected__ = DetectVecArch();
+  const char* __env__ = std::getenv("MGLORIA_VEC_ARCH");
+  if (__env__ == nullptr || __env__[0] == '\0') return __detected__;
+  VecArch __forced__;
+  if (!ParseVecArch(__env__, &__forced__)) {
+    LOG_WARN << "MGLORIA_VEC_ARCH=" << __env__ << " is unknown, use "
+             << VecArchName(__detected__) << std::endl;
+    return __detected__;
+  }
+  if (static_cast<int>(__forced__) > static_cast<int>(__detected__)) {
+    LOG_WARN << "MGLORIA_VEC_ARCH=" << __env__ << " is not supported by this CPU, use "
+             << VecArchName(__detected__) << std::endl;
+    return __detected__;
+  }
+  return __forced__;
+}
+
+MGLORIA_INLINE_NORMAL VecArch& __runtime_vec_arch__() {
+  static VecArch arch = __init_runtime_vec_arch__();
+  return arch;
+}
+
+/*!
+ *@brief    The arch all the CPU tensor expressions are vectorized with.
+ */
+MGLORIA_INLINE_NORMAL VecArch RuntimeVecArch() { return __runtime_vec_arch__(); }
+
+/*!
+ *@brief    Change the arch after the start. Can not go beyond what the CPU supports.
+ *@note     Not thread safe, do not call it while expressions are running.
+ */
+MGLORIA_INLINE_NORMAL void SetRuntimeVecArch(VecArch arch) {
+  VecArch __detected__ = DetectVecArch();
+  if (static_cast<int>(arch) > static_cast<int>(__detected__)) {
+    LOG_WARN << VecArchName(arch) << " is not supported by this CPU, use "
+             << VecArchName(__detected__) << std::endl;
+    arch = __detected__;
+  }
+  __runtime_vec_arch__() = arch;
+}
+
+}  // namespace vectorization
+}  // namespace mgloria
+
+#endif  // _MGLORIA___VEC_DISPATCH_HPP_
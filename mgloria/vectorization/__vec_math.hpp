@@ -0,0 +1,349 @@
+/*!
+ *@author   chenghua.wang
+ *@file     vectorization/__vec_math.hpp
+ *@brief    Vectorized math and activation ops for op::_exp, _log, _sqrt, _rsqrt, _tanh,
+ * _sigmoid, _gelu, _relu, _abs, _max, _min and _clip. Written once on top of the lane-wise helpers
+ * (Max, Min, Abs, Sqrt, RSqrtEstimate, IfLess, Pow2i, Frexp) every arch provides.
+ *@note     relu, abs, max, min, clip and sqrt are exact, for float and double. relu, abs, max, min
+ * and clip are also exact for int32_t, as blends by its compare masks. The others are polynomial
+ * approximations for float only, a double expression with them runs on the scalar job.
+ * The max relative error against the double precision libm result, measured over the range:
+ *   exp      < 2e-7, x in [-87.3, 88.7]. Results below FLT_MIN are flushed to 0.
+ *   log      < 1e-7, x > 0. Denormal inputs are handled.
+ *   rsqrt    < 3e-7, one Newton step on the rsqrt estimate instruction.
+ *   tanh     < 2e-7, odd polynomial for |x| < 0.625, exp based for the rest.
+ *   sigmoid  < 2e-7.
+ *   gelu     < 2e-7 of max(|gelu(x)|, |x|), it cancels for negative x. The formula of op::_gelu.
+ * exp/log/tanh/sigmoid follow the scalar ops for nan, inf and the out of range inputs. The
+ * polynomials are the ones of Cephes (expf, logf, tanhf).
+ */
+
+#ifndef _MGLORIA___VEC_MATH_HPP_
+#define _MGLORIA___VEC_MATH_HPP_
+
+#pragma once
+
+#include <limits>
+#include "./vectorization/__vec_prepare.hpp"
+
+namespace mgloria {
+namespace vectorization {
+
+/*!
+ *@brief    Round to the nearest integer by adding and removing 1.5 * 2^23. |x| < 2^22.
+ */
+template<VecArch Arch>
+MGLORIA_INLINE_CPU Vectorized<float, Arch> VecRound(const Vectorized<float, Arch>& x) {
+  typedef Vectorized<float, Arch> VF;
+  return (x + VF::Fill(12582912.f)) - VF::Fill(12582912.f);
+}
+
+/*!
+ *@brief    exp(x) = 2^n * exp(r), n = round(x / ln2), |r| <= ln2 / 2.
+ */
+template<VecArch Arch>
+MGLORIA_INLINE_CPU Vectorized<float, Arch> VecExp(const Vectorized<float, Arch>& x) {
+  typedef Vectorized<float, Arch> VF;
+  const VF __hi__ = VF::Fill(88.72283935546875f);   // ln(FLT_MAX)
+  const VF __lo__ = VF::Fill(-87.33654022216797f);  // ln(FLT_MIN)
+  const VF v = VF::Min(VF::Max(x, __lo__), __hi__);
+  const VF n = VecRound<Arch>(v * VF::Fill(1.44269504088896341f));
+  // ln2 in two parts, so r is exact.
+  VF r = v - n * VF::Fill(0.693359375f);
+  r = r - n * VF::Fill(-2.12194440e-4f);
+  VF p = VF::Fill(1.9875691500E-4f);
+  p = VF::MulAdd(p, r, VF::Fill(1.3981999507E-3f));
+  p = VF::MulAdd(p, r, VF::Fill(8.3334519073E-3f));
+  p = VF::MulAdd(p, r, VF::Fill(4.1665795894E-2f));
+  p = VF::MulAdd(p, r, VF::Fill(1.6666665459E-1f));
+  p = VF::MulAdd(p, r, VF::Fill(5.0000001201E-1f));
+  p = VF::MulAdd(p, r * r, r + VF::Fill(1.f));
+  // n is at most 128, which has no float exponent. Take 2^127 * 2 for it.
+  const VF m = VF::Min(n, VF::Fill(127.f));
+  VF ans = p * VF::Pow2i(m) * (VF::Fill(1.f) + (n - m));
+  // nan for nan, and the out of range ones.
+  ans = ans + (x - x);
+  ans = VF::IfLess(__hi__, x, VF::Fill(std::numeric_limits<float>::infinity()), ans);
+  ans = VF::IfLess(x, __lo__, VF::Fill(0.f), ans);
+  return ans;
+}
+
+/*!
+ *@brief    log(x) = e * ln2 + log(m), x = m * 2^e, m in [sqrt(0.5), sqrt(2)).
+ */
+template<VecArch Arch>
+MGLORIA_INLINE_CPU Vectorized<float, Arch> VecLog(const Vectorized<float, Arch>& x) {
+  typedef Vectorized<float, Arch> VF;
+  const VF __min_normal__ = VF::Fill(std::numeric_limits<float>::min());
+  // Scale the denormals up to normal numbers first.
+  const VF v = VF::IfLess(x, __min_normal__, x * VF::Fill(8388608.f), x);
+  VF e;
+  VF m = VF::Frexp(v, &e);
+  e = VF::IfLess(x, __min_normal__, e - VF::Fill(23.f), e);
+  // m < sqrt(0.5): m = 2m - 1, e = e - 1. Or: m = m - 1.
+  const VF __lt__ = VF::IfLess(m, VF::Fill(0.707106781186547524f), VF::Fill(1.f), VF::Fill(0.f));
+  e = e - __lt__;
+  m = m + m * __lt__ - VF::Fill(1.f);
+  const VF z = m * m;
+  VF p = VF::Fill(7.0376836292E-2f);
+  p = VF::MulAdd(p, m, VF::Fill(-1.1514610310E-1f));
+  p = VF::MulAdd(p, m, VF::Fill(1.1676998740E-1f));
+  p = VF::MulAdd(p, m, VF::Fill(-1.2420140846E-1f));
+  p = VF::MulAdd(p, m, VF::Fill(1.4249322787E-1f));
+  p = VF::MulAdd(p, m, VF::Fill(-1.6668057665E-1f));
+  p = VF::MulAdd(p, m, VF::Fill(2.0000714765E-1f));
+  p = VF::MulAdd(p, m, VF::Fill(-2.4999993993E-1f));
+  p = VF::MulAdd(p, m, VF::Fill(3.3333331174E-1f));
+  VF y = p * m * z;
+  y = VF::MulAdd(e, VF::Fill(-2.12194440e-4f), y);
+  y = VF::MulAdd(z, VF::Fill(-0.5f), y);
+  VF ans = VF::MulAdd(e, VF::Fill(0.693359375f), m + y);
+  // nan for nan and inf, then inf, 0 and the negatives.
+  const VF __inf__ = VF::Fill(std::numeric_limits<float>::infinity());
+  ans = ans + (x - x);
+  ans = VF::IfLess(VF::Fill(std::numeric_limits<float>::max()), x, __inf__, ans);
+  ans = VF::IfLess(x, VF::Fill(std::numeric_limits<float>::denorm_min()), VF::Fill(0.f) - __inf__,
+                   ans);
+  ans = VF::IfLess(x, VF::Fill(0.f), VF::Fill(std::numeric_limits<float>::quiet_NaN()), ans);
+  return ans;
+}
+
+/*!
+ *@brief    1 / sqrt(x) with one Newton step, y = y * (1.5 - 0.5 * x * y * y).
+ */
+template<VecArch Arch>
+MGLORIA_INLINE_CPU Vectorized<float, Arch> VecRSqrt(const Vectorized<float, Arch>& x) {
+  typedef Vectorized<float, Arch> VF;
+  const VF y = VF::RSqrtEstimate(x);
+  const VF __half_x__ = x * VF::Fill(0.5f);
+  const VF ans = y * (VF::Fill(1.5f) - __half_x__ * y * y);
+  // The step makes nan of 0 and inf, the estimate is right for them.
+  return VF::IfLess(x, VF::Fill(std::numeric_limits<float>::min()), y,
+                    VF::IfLess(VF::Fill(std::numeric_limits<float>::max()), x, y, ans));
+}
+
+template<VecArch Arch>
+MGLORIA_INLINE_CPU Vectorized<double, Arch> VecRSqrt(const Vectorized<double, Arch>& x) {
+  typedef Vectorized<double, Arch> VD;
+  return VD::Fill(1.0) / VD::Sqrt(x);
+}
+
+/*!
+ *@brief    tanh(x). Odd polynomial for |x| < 0.625, or 1 - 2 / (exp(2|x|) + 1) with the sign.
+ */
+template<VecArch Arch>
+MGLORIA_INLINE_CPU Vectorized<float, Arch> VecTanh(const Vectorized<float, Arch>& x) {
+  typedef Vectorized<float, Arch> VF;
+  const VF a = VF::Abs(x);
+  const VF z = x * x;
+  VF p = VF::Fill(-5.70498872745E-3f);
+  p = VF::MulAdd(p, z, VF::Fill(2.06390887954E-2f));
+  p = VF::MulAdd(p, z, VF::Fill(-5.37397155531E-2f));
+  p = VF::MulAdd(p, z, VF::Fill(1.33314422036E-1f));
+  p = VF::MulAdd(p, z, VF::Fill(-3.33332819422E-1f));
+  const VF __small__ = VF::MulAdd(p * z, x, x);
+  VF __big__ = VF::Fill(1.f) - VF::Fill(2.f) / (VecExp<Arch>(a + a) + VF::Fill(1.f));
+  __big__ = VF::IfLess(x, VF::Fill(0.f), VF::Fill(0.f) - __big__, __big__);
+  // nan goes to the small one.
+  return VF::IfLess(VF::Fill(0.625f), a, __big__, __small__);
+}
+
+/*!
+ *@brief    1 / (1 + exp(-x)).
+ */
+template<VecArch Arch>
+MGLORIA_INLINE_CPU Vectorized<float, Arch> VecSigmoid(const Vectorized<float, Arch>& x) {
+  typedef Vectorized<float, Arch> VF;
+  return VF::Fill(1.f) / (VF::Fill(1.f) + VecExp<Arch>(VF::Fill(0.f) - x));
+}
+
+/*!
+ *@brief    The tanh approximation of GELU, the same formula as op::_gelu.
+ */
+template<VecArch Arch>
+MGLORIA_INLINE_CPU Vectorized<float, Arch> VecGelu(const Vectorized<float, Arch>& x) {
+  typedef Vectorized<float, Arch> VF;
+  const VF __inner__ =
+      VF::Fill(0.7978845608028654f) * VF::MulAdd(VF::Fill(0.044715f) * x * x, x, x);
+  return VF::Fill(0.5f) * x * (VF::Fill(1.f) + VecTanh<Arch>(__inner__));
+}
+
+// ########################## The ops. #############################
+template<VecArch Arch>
+struct VectorizedOP<op::_exp, float, Arch> {
+  MGLORIA_INLINE_CPU static Vectorized<float, Arch> Do(const Vectorized<float, Arch>& single) {
+    return VecExp<Arch>(single);
+  }
+
+  static const bool m_Enable = MGLORIA_VECTORIZATION_TRUE;
+};
+
+template<VecArch Arch>
+struct VectorizedOP<op::_log, float, Arch> {
+  MGLORIA_INLINE_CPU static Vectorized<float, Arch> Do(const Vectorized<float, Arch>& single) {
+    return VecLog<Arch>(single);
+  }
+
+  static const bool m_Enable = MGLORIA_VECTORIZATION_TRUE;
+};
+
+template<VecArch Arch>
+struct VectorizedOP<op::_tanh, float, Arch> {
+  MGLORIA_INLINE_CPU static Vectorized<float, Arch> Do(const Vectorized<float, Arch>& single) {
+    return VecTanh<Arch>(single);
+  }
+
+  static const bool m_Enable = MGLORIA_VECTORIZATION_TRUE;
+};
+
+template<VecArch Arch>
+struct VectorizedOP<op::_sigmoid, float, Arch> {
+  MGLORIA_INLINE_CPU static Vectorized<float, Arch> Do(const Vectorized<float, Arch>& single) {
+    return VecSigmoid<Arch>(single);
+  }
+
+  static const bool m_Enable = MGLORIA_VECTORIZATION_TRUE;
+};
+
+template<VecArch Arch>
+struct VectorizedOP<op::_gelu, float, Arch> {
+  MGLORIA_INLINE_CPU static Vectorized<float, Arch> Do(const Vectorized<float, Arch>& single) {
+    return VecGelu<Arch>(single);
+  }
+
+  static const bool m_Enable = MGLORIA_VECTORIZATION_TRUE;
+};
+
+template<typename DataType, VecArch Arch>
+struct VectorizedOP<op::_rsqrt, DataType, Arch> {
+  MGLORIA_INLINE_CPU static Vectorized<DataType, Arch> Do(
+      const Vectorized<DataType, Arch>& single) {
+    return VecRSqrt<Arch>(single);
+  }
+
+  static const bool m_Enable = std::is_floating_point<DataType>::value;
+};
+
+template<typename DataType, VecArch Arch>
+struct VectorizedOP<op::_sqrt, DataType, Arch> {
+  MGLORIA_INLINE_CPU static Vectorized<DataType, Arch> Do(
+      const Vectorized<DataType, Arch>& single) {
+    return Vectorized<DataType, Arch>::Sqrt(single);
+  }
+
+  static const bool m_Enable = std::is_floating_point<DataType>::value;
+};
+
+template<typename DataType, VecArch Arch>
+struct VectorizedOP<op::_relu, DataType, Arch> {
+  MGLORIA_INLINE_CPU static Vectorized<DataType, Arch> Do(
+      const Vectorized<DataType, Arch>& single) {
+    return Vectorized<DataType, Arch>::Max(single, Vectorized<DataType, Arch>::Fill(DataType(0)));
+  }
+
+  static const bool m_Enable = std::is_floating_point<DataType>::value;
+};
+
+template<typename DataType, VecArch Arch>
+struct VectorizedOP<op::_abs, DataType, Arch> {
+  MGLORIA_INLINE_CPU static Vectorized<DataType, Arch> Do(
+      const Vectorized<DataType, Arch>& single) {
+    return Vectorized<DataType, Arch>::Abs(single);
+  }
+
+  static const bool m_Enable = std::is_floating_point<DataType>::value;
+};
+
+template<typename DataType, VecArch Arch>
+struct VectorizedOP<op::_max, DataType, Arch> {
+  MGLORIA_INLINE_CPU static Vectorized<DataType, Arch> Do(const Vectorized<DataType, Arch>& lhs,
+                                                          const Vectorized<DataType, Arch>& rhs) {
+    return Vectorized<DataType, Arch>::Max(lhs, rhs);
+  }
+
+  static const bool m_Enable = std::is_floating_point<DataType>::value;
+};
+
+template<typename DataType, VecArch Arch>
+struct VectorizedOP<op::_min, DataType, Arch> {
+  MGLORIA_INLINE_CPU static Vectorized<DataType, Arch> Do(const Vectorized<DataType, Arch>& lhs,
+                                                          const Vectorized<DataType, Arch>& rhs) {
+    return Vectorized<DataType, Arch>::Min(lhs, rhs);
+  }
+
+  static const bool m_Enable = std::is_floating_point<DataType>::value;
+};
+
+///! The order of Max and Min keeps a nan of a, as op::_clip does.
+template<typename DataType, VecArch Arch>
+struct VectorizedOP<op::_clip, DataType, Arch> {
+  MGLORIA_INLINE_CPU static Vectorized<DataType, Arch> Do(const Vectorized<DataType, Arch>& a,
+                                                          const Vectorized<DataType, Arch>& lo,
+                                                          const Vectorized<DataType, Arch>& hi) {
+    return Vectorized<DataType, Arch>::Min(hi, Vectorized<DataType, Arch>::Max(lo, a));
+  }
+
+  static const bool m_Enable = std::is_floating_point<DataType>::value;
+};
+
+// int32_t has no Max, Min or Abs. They are blends by the compare masks, the same branches as the
+// scalar ops.
+template<VecArch Arch>
+struct VectorizedOP<op::_relu, int32_t, Arch> {
+  MGLORIA_INLINE_CPU static Vectorized<int32_t, Arch> Do(const Vectorized<int32_t, Arch>& single) {
+    const Vectorized<int32_t, Arch> __zero__ = Vectorized<int32_t, Arch>::Fill(0);
+    return Vectorized<int32_t, Arch>::Select(Vectorized<int32_t, Arch>::CmpLt(__zero__, single),
+                                             single, __zero__);
+  }
+
+  static const bool m_Enable = true;
+};
+
+template<VecArch Arch>
+struct VectorizedOP<op::_abs, int32_t, Arch> {
+  MGLORIA_INLINE_CPU static Vectorized<int32_t, Arch> Do(const Vectorized<int32_t, Arch>& single) {
+    const Vectorized<int32_t, Arch> __zero__ = Vectorized<int32_t, Arch>::Fill(0);
+    return Vectorized<int32_t, Arch>::Select(Vectorized<int32_t, Arch>::CmpLt(single, __zero__),
+                                             __zero__ - single, single);
+  }
+
+  static const bool m_Enable = true;
+};
+
+template<VecArch Arch>
+struct VectorizedOP<op::_max, int32_t, Arch> {
+  MGLORIA_INLINE_CPU static Vectorized<int32_t, Arch> Do(const Vectorized<int32_t, Arch>& lhs,
+                                                         const Vectorized<int32_t, Arch>& rhs) {
+    return Vectorized<int32_t, Arch>::Select(Vectorized<int32_t, Arch>::CmpLt(rhs, lhs), lhs, rhs);
+  }
+
+  static const bool m_Enable = true;
+};
+
+template<VecArch Arch>
+struct VectorizedOP<op::_min, int32_t, Arch> {
+  MGLORIA_INLINE_CPU static Vectorized<int32_t, Arch> Do(const Vectorized<int32_t, Arch>& lhs,
+                                                         const Vectorized<int32_t, Arch>& rhs) {
+    return Vectorized<int32_t, Arch>::Select(Vectorized<int32_t, Arch>::CmpLt(lhs, rhs), lhs, rhs);
+  }
+
+  static const bool m_Enable = true;
+};
+
+template<VecArch Arch>
+struct VectorizedOP<op::_clip, int32_t, Arch> {
+  MGLORIA_INLINE_CPU static Vectorized<int32_t, Arch> Do(const Vectorized<int32_t, Arch>& a,
+                                                         const Vectorized<int32_t, Arch>& lo,
+                                                         const Vectorized<int32_t, Arch>& hi) {
+    return Vectorized<int32_t, Arch>::Select(
+        Vectorized<int32_t, Arch>::CmpLt(a, lo), lo,
+        Vectorized<int32_t, Arch>::Select(Vectorized<int32_t, Arch>::CmpLt(hi, a), hi, a));
+  }
+
+  static const bool m_Enable = true;
+};
+
+}  // namespace vectorization
+}  // namespace mgloria
+
+#endif  // _MGLORIA___VEC_MATH_HPP_
@@ -12,6 +12,9 @@
 #pragma once
 
 #include <malloc.h>
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
 #include "../tensor.hpp"
 #include "./vectorization/__vec_prepare.hpp"
 
@@ -43,6 +46,40 @@ MGLORIA_INLINE_NORMAL index_t FloorAlign(index_t size) {
   return (((size * data_size) >> aligned_bits) << aligned_bits) / data_size;
 }
 
+/*!
+ *@brief        The number of elements from ptr to the next address aligned for Arch. They are
+ * peeled off as the head of a row when the row does not start aligned.
+ *@note         ptr must be aligned to sizeof(DataType), or no number of elements reaches it.
+ */
+template<VecArch Arch, typename DataType>
+MGLORIA_INLINE_NORMAL index_t PeelHead(const DataType* ptr) {
+  const size_t masked = (size_t(1) << AlignBytes<Arch>::Default) - 1;
+  return static_cast<index_t>(((~reinterpret_cast<size_t>(ptr) + 1) & masked) / sizeof(DataType));
+}
+
+/*!
+ *@brief        The alignment of a block of bytes: a large one starts on a huge page, so it takes
+ * the fewest huge pages, the others are aligned to align.
+ */
+MGLORIA_INLINE_NORMAL size_t BlockAlign(size_t bytes, size_t align) {
+#if MGLORIA_HUGE_PAGES == 1
+  if (bytes >= MGLORIA_HUGE_PAGE_MIN && align < MGLORIA_HUGE_PAGE_BYTES) {
+    return MGLORIA_HUGE_PAGE_BYTES;
+  }
+#endif  // MGLORIA_HUGE_PAGES == 1
+  return align;
+}
+
+/*!
+ *@brief        Ask for transparent huge pages behind a large block, before it is touched. Only a
+ * hint: with THP off, or not on Linux, the block keeps small pages.
+ */
+MGLORIA_INLINE_NORMAL void AdviseHugePages(NO_TYPE_PTR ptr, size_t bytes) {
+#if MGLORIA_HUGE_PAGES == 1 && defined(__linux__) && defined(MADV_HUGEPAGE)
+  if (bytes >= MGLORIA_HUGE_PAGE_MIN) { madvise(ptr, bytes, MADV_HUGEPAGE); }
+#endif
+}
+
 /*!
  *@brief        Work almost same as CUDA's cudaMallocPitch function. It will allocate a memory space
  *lines * line_cells cells.
@@ -53,12 +90,13 @@ MGLORIA_INLINE_NORMAL index_t FloorAlign(index_t size) {
  */
 MGLORIA_INLINE_NORMAL NO_TYPE_PTR MallocAlignedPitch(size_t* actual_mem, size_t line_cells,
                                                      size_t lines) {
-  const index_t aligned_bits = AlignBytes<MGLORIA_VECTORIZATION_ARCH>::Default;
+  const index_t aligned_bits = AlignBytes<MGLORIA_VECTORIZATION_ALIGN_ARCH>::Default;
   const index_t masked = (1 << aligned_bits) - 1;  // (1<<4) - 1 => 15
   size_t pitch_mem = ((line_cells + masked) >> aligned_bits) << aligned_bits;
   *actual_mem = pitch_mem;
   void* ans;
-  int ret = posix_memalign(&ans, 1 << aligned_bits, pitch_mem * lines);
+  int ret = posix_memalign(&ans, BlockAlign(pitch_mem * lines, size_t(1) << aligned_bits),
+                           pitch_mem * lines);
 #if MGLORIA_CHECK_NULL_MEM_PTR == 1
   CHECK_EQUAL(ret, 0, " The posix_memalign failed.");
   if (ans == nullptr) {
@@ -69,6 +107,7 @@ MGLORIA_INLINE_NORMAL NO_TYPE_PTR MallocAlignedPitch(size_t* actual_mem, size_t
     std::exit(MGLORIA_MEM_ERROR_EXIT);
   }
 #endif  // MGLORIA_CHECK_NULL_MEM_PTR == 1
+  if (ret == 0) { AdviseHugePages(ans, pitch_mem * lines); }
   return ans;
 }
 
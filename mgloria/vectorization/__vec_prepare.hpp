@@ -10,6 +10,7 @@
 
 #pragma once
 
+#include <type_traits>
 #include "../depends.hpp"
 #include "../tensor.hpp"
 #include "../expression.hpp"
@@ -20,16 +21,29 @@ namespace vectorization {
 enum class VecArch {
   NONE_Arch = 0,
   SSE_Arch = 1,
+  AVX2_Arch = 2,
+  AVX512_Arch = 3,
 };
 
 /*!
  *@brief      Quite similar to cub::AlignBytes in cuda toolkit.
+ *@note       Default is the bits of the alignment, 4 means 1 << 4 = 16 bytes.
  */
 template<VecArch ArchType>
 struct AlignBytes {
   static const index_t Default = MGLORIA_DEFAULT_ALIGNBYTES;
 };
 
+template<>
+struct AlignBytes<VecArch::AVX2_Arch> {
+  static const index_t Default = 5;  ///! 32 bytes for __m256.
+};
+
+template<>
+struct AlignBytes<VecArch::AVX512_Arch> {
+  static const index_t Default = 6;  ///! 64 bytes for __m512, also one cache line.
+};
+
 }  // namespace vectorization
 }  // namespace mgloria
 
@@ -41,6 +55,15 @@ namespace vectorization {
 template<typename DataType, VecArch Arch = MGLORIA_VECTORIZATION_ARCH>
 struct Vectorized {};
 
+/*!
+ *@brief      The lanes of a compare of two Vectorized<DataType, Arch>, made by its CmpLt, CmpLe,
+ * CmpEq and CmpNe. Vectorized<DataType, Arch>::Select blends two vectors by it.
+ *@note       Only float, double and int32_t have it. It is a vector register with the true lanes
+ * all ones on SSE and AVX2, and a k register on AVX-512.
+ */
+template<typename DataType, VecArch Arch = MGLORIA_VECTORIZATION_ARCH>
+struct VectorizedMask {};
+
 template<typename OP, typename DataType, VecArch Arch>
 struct VectorizedOP {
   static const bool m_Enable = MGLORIA_VECTORIZATION_FALSE;
@@ -86,6 +109,43 @@ struct VectorizedOP<op::_div, DataType, Arch> {
   static const bool m_Enable = MGLORIA_VECTORIZATION_TRUE;
 };
 
+///! There is no SIMD integer division.
+template<VecArch Arch>
+struct VectorizedOP<op::_div, int32_t, Arch> {
+  static const bool m_Enable = MGLORIA_VECTORIZATION_FALSE;
+};
+
+template<VecArch Arch>
+struct VectorizedOP<op::_div, int8_t, Arch> {
+  static const bool m_Enable = MGLORIA_VECTORIZATION_FALSE;
+};
+
+template<VecArch Arch>
+struct VectorizedOP<op::_div, uint8_t, Arch> {
+  static const bool m_Enable = MGLORIA_VECTORIZATION_FALSE;
+};
+
+///! Saturating ops, only the integer types have them.
+template<typename DataType, VecArch Arch>
+struct VectorizedOP<op::_sat_plus, DataType, Arch> {
+  MGLORIA_INLINE_CPU static Vectorized<DataType, Arch> Do(const Vectorized<DataType, Arch>& lhs,
+                                                          const Vectorized<DataType, Arch>& rhs) {
+    return Vectorized<DataType, Arch>::AddSat(lhs, rhs);
+  }
+
+  static const bool m_Enable = std::is_integral<DataType>::value;
+};
+
+template<typename DataType, VecArch Arch>
+struct VectorizedOP<op::_sat_minus, DataType, Arch> {
+  MGLORIA_INLINE_CPU static Vectorized<DataType, Arch> Do(const Vectorized<DataType, Arch>& lhs,
+                                                          const Vectorized<DataType, Arch>& rhs) {
+    return Vectorized<DataType, Arch>::SubSat(lhs, rhs);
+  }
+
+  static const bool m_Enable = std::is_integral<DataType>::value;
+};
+
 template<typename DataType, VecArch Arch>
 struct VectorizedOP<op::_left, DataType, Arch> {
   MGLORIA_INLINE_CPU static Vectorized<DataType, Arch> Do(const Vectorized<DataType, Arch>& lhs,
@@ -116,6 +176,172 @@ struct VectorizedOP<op::_identity, DataType, Arch> {
   static const bool m_Enable = MGLORIA_VECTORIZATION_TRUE;
 };
 
+///! a * b + c, fused where the arch has FMA. The 8 bits types have no MulAdd.
+template<typename DataType, VecArch Arch>
+struct VectorizedOP<op::_fma, DataType, Arch> {
+  MGLORIA_INLINE_CPU static Vectorized<DataType, Arch> Do(const Vectorized<DataType, Arch>& a,
+                                                          const Vectorized<DataType, Arch>& b,
+                                                          const Vectorized<DataType, Arch>& c) {
+    return Vectorized<DataType, Arch>::MulAdd(a, b, c);
+  }
+
+  static const bool m_Enable =
+      std::is_floating_point<DataType>::value || std::is_same<DataType, int32_t>::value;
+};
+
+template<typename DataType>
+struct VectorizedMaskCheck {
+  static const bool m_Enable =
+      std::is_floating_point<DataType>::value || std::is_same<DataType, int32_t>::value;
+};
+
+/*!
+ *@brief      The mask where OP(lhs, rhs) is true. A compare op gives its mask directly, the others
+ * are compared with 0, as op::_where does.
+ */
+template<typename OP, typename DataType, VecArch Arch>
+struct VectorizedMaskOP {
+  MGLORIA_INLINE_CPU static VectorizedMask<DataType, Arch> Do(
+      const Vectorized<DataType, Arch>& lhs, const Vectorized<DataType, Arch>& rhs) {
+    return Vectorized<DataType, Arch>::CmpNe(VectorizedOP<OP, DataType, Arch>::Do(lhs, rhs),
+                                             Vectorized<DataType, Arch>::Fill(DataType(0)));
+  }
+};
+
+template<typename DataType, VecArch Arch>
+struct VectorizedMaskOP<op::_lt, DataType, Arch> {
+  MGLORIA_INLINE_CPU static VectorizedMask<DataType, Arch> Do(
+      const Vectorized<DataType, Arch>& lhs, const Vectorized<DataType, Arch>& rhs) {
+    return Vectorized<DataType, Arch>::CmpLt(lhs, rhs);
+  }
+};
+
+template<typename DataType, VecArch Arch>
+struct VectorizedMaskOP<op::_le, DataType, Arch> {
+  MGLORIA_INLINE_CPU static VectorizedMask<DataType, Arch> Do(
+      const Vectorized<DataType, Arch>& lhs, const Vectorized<DataType, Arch>& rhs) {
+    return Vectorized<DataType, Arch>::CmpLe(lhs, rhs);
+  }
+};
+
+template<typename DataType, VecArch Arch>
+struct VectorizedMaskOP<op::_gt, DataType, Arch> {
+  MGLORIA_INLINE_CPU static VectorizedMask<DataType, Arch> Do(
+      const Vectorized<DataType, Arch>& lhs, const Vectorized<DataType, Arch>& rhs) {
+    return Vectorized<DataType, Arch>::CmpLt(rhs, lhs);
+  }
+};
+
+template<typename DataType, VecArch Arch>
+struct VectorizedMaskOP<op::_ge, DataType, Arch> {
+  MGLORIA_INLINE_CPU static VectorizedMask<DataType, Arch> Do(
+      const Vectorized<DataType, Arch>& lhs, const Vectorized<DataType, Arch>& rhs) {
+    return Vectorized<DataType, Arch>::CmpLe(rhs, lhs);
+  }
+};
+
+template<typename DataType, VecArch Arch>
+struct VectorizedMaskOP<op::_eq, DataType, Arch> {
+  MGLORIA_INLINE_CPU static VectorizedMask<DataType, Arch> Do(
+      const Vectorized<DataType, Arch>& lhs, const Vectorized<DataType, Arch>& rhs) {
+    return Vectorized<DataType, Arch>::CmpEq(lhs, rhs);
+  }
+};
+
+template<typename DataType, VecArch Arch>
+struct VectorizedMaskOP<op::_ne, DataType, Arch> {
+  MGLORIA_INLINE_CPU static VectorizedMask<DataType, Arch> Do(
+      const Vectorized<DataType, Arch>& lhs, const Vectorized<DataType, Arch>& rhs) {
+    return Vectorized<DataType, Arch>::CmpNe(lhs, rhs);
+  }
+};
+
+///! The compare ops give 1 or 0 in each lane, as the scalar ones.
+template<typename OP, typename DataType, VecArch Arch>
+struct VectorizedCompareOP {
+  MGLORIA_INLINE_CPU static Vectorized<DataType, Arch> Do(const Vectorized<DataType, Arch>& lhs,
+                                                          const Vectorized<DataType, Arch>& rhs) {
+    return Vectorized<DataType, Arch>::Select(VectorizedMaskOP<OP, DataType, Arch>::Do(lhs, rhs),
+                                              Vectorized<DataType, Arch>::Fill(DataType(1)),
+                                              Vectorized<DataType, Arch>::Fill(DataType(0)));
+  }
+
+  static const bool m_Enable = VectorizedMaskCheck<DataType>::m_Enable;
+};
+
+template<typename DataType, VecArch Arch>
+struct VectorizedOP<op::_lt, DataType, Arch> : public VectorizedCompareOP<op::_lt, DataType, Arch> {
+};
+
+template<typename DataType, VecArch Arch>
+struct VectorizedOP<op::_le, DataType, Arch> : public VectorizedCompareOP<op::_le, DataType, Arch> {
+};
+
+template<typename DataType, VecArch Arch>
+struct VectorizedOP<op::_gt, DataType, Arch> : public VectorizedCompareOP<op::_gt, DataType, Arch> {
+};
+
+template<typename DataType, VecArch Arch>
+struct VectorizedOP<op::_ge, DataType, Arch> : public VectorizedCompareOP<op::_ge, DataType, Arch> {
+};
+
+template<typename DataType, VecArch Arch>
+struct VectorizedOP<op::_eq, DataType, Arch> : public VectorizedCompareOP<op::_eq, DataType, Arch> {
+};
+
+template<typename DataType, VecArch Arch>
+struct VectorizedOP<op::_ne, DataType, Arch> : public VectorizedCompareOP<op::_ne, DataType, Arch> {
+};
+
+///! A blend by the mask of cond != 0. A where of a compare is blended by the compare's mask, see
+///! its VectorizedJob.
+template<typename DataType, VecArch Arch>
+struct VectorizedOP<op::_where, DataType, Arch> {
+  MGLORIA_INLINE_CPU static Vectorized<DataType, Arch> Do(const Vectorized<DataType, Arch>& cond,
+                                                          const Vectorized<DataType, Arch>& a,
+                                                          const Vectorized<DataType, Arch>& b) {
+    return Vectorized<DataType, Arch>::Select(
+        Vectorized<DataType, Arch>::CmpNe(cond, Vectorized<DataType, Arch>::Fill(DataType(0))), a,
+        b);
+  }
+
+  static const bool m_Enable = VectorizedMaskCheck<DataType>::m_Enable;
+};
+
+/*!
+ *@brief      Convert the lanes of a vector from OriDataType to DisDataType, the same as the C++
+ * cast (float to int32_t truncates). Only for the types with the same number of lanes, the arch
+ * headers specialize float <-> int32_t. A TypeCastExpr of other types is done lane by lane.
+ */
+template<typename OriDataType, typename DisDataType, VecArch Arch>
+struct VectorizedCast {
+  static const bool m_Enable = MGLORIA_VECTORIZATION_FALSE;
+};
+
+template<typename DataType, VecArch Arch>
+struct VectorizedCast<DataType, DataType, Arch> {
+  MGLORIA_INLINE_CPU static Vectorized<DataType, Arch> Do(const Vectorized<DataType, Arch>& src) {
+    return src;
+  }
+
+  static const bool m_Enable = MGLORIA_VECTORIZATION_TRUE;
+};
+
+/*!
+ *@brief      Load the n (n <= num) lanes src[0], src[stride], src[2 * stride], ... The other lanes
+ * are 0. Used to read a column of a tensor, e.g. for the TransposeExpr.
+ *@note       The arch with a gather instruction specializes it, others load lane by lane.
+ */
+template<typename DataType, VecArch Arch>
+struct VectorizedGather {
+  MGLORIA_INLINE_CPU static Vectorized<DataType, Arch> Do(const DataType* src, index_t stride,
+                                                          index_t n) {
+    alignas(64) DataType __lanes__[Vectorized<DataType, Arch>::num] = {};
+    for (index_t i = 0; i < n; ++i) { __lanes__[i] = src[i * stride]; }
+    return Vectorized<DataType, Arch>::Load(__lanes__);
+  }
+};
+
 template<typename LeftValue, typename TFloat, VecArch Arch>
 struct VectorizedSaver {
   MGLORIA_INLINE_CPU static void Do(TFloat* dst, const Vectorized<TFloat, Arch>& src) {
@@ -132,6 +358,16 @@ struct VectorizedSaver<op::_saveto, TFloat, Arch> {
   }
 };
 
+/*!
+ *@brief      Save the first n (n < num) lanes of src to dst with one masked store.
+ *@note       Only the arch which has masked load/store (AVX-512) enables it. Others handle
+ * the columns left after the last full vector with a scalar loop.
+ */
+template<typename LeftValue, typename TFloat, VecArch Arch>
+struct VectorizedTailSaver {
+  static const bool m_Enable = MGLORIA_VECTORIZATION_FALSE;
+};
+
 }  // namespace vectorization
 }  // namespace mgloria
 
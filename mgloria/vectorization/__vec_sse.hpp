@@ -7,11 +7,46 @@
 namespace mgloria {
 namespace vectorization {
 
+///! The compare of Vectorized<float, VecArch::SSE_Arch>. True lanes are all ones.
+template<>
+struct VectorizedMask<float, VecArch::SSE_Arch> {
+  friend struct Vectorized<float, VecArch::SSE_Arch>;
+  VectorizedMask() = default;
+  MGLORIA_INLINE_CPU explicit VectorizedMask(__m128 data) : m_data(data) {}
+
+ private:
+  __m128 m_data;
+};
+
+///! The compare of Vectorized<double, VecArch::SSE_Arch>. True lanes are all ones.
+template<>
+struct VectorizedMask<double, VecArch::SSE_Arch> {
+  friend struct Vectorized<double, VecArch::SSE_Arch>;
+  VectorizedMask() = default;
+  MGLORIA_INLINE_CPU explicit VectorizedMask(__m128d data) : m_data(data) {}
+
+ private:
+  __m128d m_data;
+};
+
+///! The compare of Vectorized<int32_t, VecArch::SSE_Arch>. True lanes are all ones.
+template<>
+struct VectorizedMask<int32_t, VecArch::SSE_Arch> {
+  friend struct Vectorized<int32_t, VecArch::SSE_Arch>;
+  VectorizedMask() = default;
+  MGLORIA_INLINE_CPU explicit VectorizedMask(__m128i data) : m_data(data) {}
+
+ private:
+  __m128i m_data;
+};
+
 template<>
 struct Vectorized<float, VecArch::SSE_Arch> {
   // float in vector
   static const index_t num = 4;
   // friends
+  template<typename OriDataType, typename DisDataType, VecArch VArch>
+  friend struct VectorizedCast;
   friend MGLORIA_INLINE_CPU Vectorized<float, VecArch::SSE_Arch> operator+(
       const Vectorized<float, VecArch::SSE_Arch>& lhs,
       const Vectorized<float, VecArch::SSE_Arch>& rhs);
@@ -45,6 +80,105 @@ struct Vectorized<float, VecArch::SSE_Arch> {
     return Vectorized<float, VecArch::SSE_Arch>(_mm_loadu_ps(s));
   }
 
+  // a * b + c. SSE has no fused instruction, so it is a mul followed by an add.
+  MGLORIA_INLINE_CPU static Vectorized<float, VecArch::SSE_Arch> MulAdd(
+      const Vectorized<float, VecArch::SSE_Arch>& a, const Vectorized<float, VecArch::SSE_Arch>& b,
+      const Vectorized<float, VecArch::SSE_Arch>& c) {
+    return Vectorized<float, VecArch::SSE_Arch>(
+        _mm_add_ps(_mm_mul_ps(a.m_data, b.m_data), c.m_data));
+  }
+
+  // Lane-wise helpers for the math ops in __vec_math.hpp.
+  MGLORIA_INLINE_CPU static Vectorized<float, VecArch::SSE_Arch> Max(
+      const Vectorized<float, VecArch::SSE_Arch>& a,
+      const Vectorized<float, VecArch::SSE_Arch>& b) {
+    return Vectorized<float, VecArch::SSE_Arch>(_mm_max_ps(a.m_data, b.m_data));
+  }
+
+  MGLORIA_INLINE_CPU static Vectorized<float, VecArch::SSE_Arch> Min(
+      const Vectorized<float, VecArch::SSE_Arch>& a,
+      const Vectorized<float, VecArch::SSE_Arch>& b) {
+    return Vectorized<float, VecArch::SSE_Arch>(_mm_min_ps(a.m_data, b.m_data));
+  }
+
+  MGLORIA_INLINE_CPU static Vectorized<float, VecArch::SSE_Arch> Abs(
+      const Vectorized<float, VecArch::SSE_Arch>& a) {
+    return Vectorized<float, VecArch::SSE_Arch>(_mm_andnot_ps(_mm_set1_ps(-0.f), a.m_data));
+  }
+
+  MGLORIA_INLINE_CPU static Vectorized<float, VecArch::SSE_Arch> Sqrt(
+      const Vectorized<float, VecArch::SSE_Arch>& a) {
+    return Vectorized<float, VecArch::SSE_Arch>(_mm_sqrt_ps(a.m_data));
+  }
+
+  // About 1 / sqrt(a), relative error < 1.5 * 2^-12.
+  MGLORIA_INLINE_CPU static Vectorized<float, VecArch::SSE_Arch> RSqrtEstimate(
+      const Vectorized<float, VecArch::SSE_Arch>& a) {
+    return Vectorized<float, VecArch::SSE_Arch>(_mm_rsqrt_ps(a.m_data));
+  }
+
+  // a < b ? t : e for each lane.
+  MGLORIA_INLINE_CPU static Vectorized<float, VecArch::SSE_Arch> IfLess(
+      const Vectorized<float, VecArch::SSE_Arch>& a,
+      const Vectorized<float, VecArch::SSE_Arch>& b,
+      const Vectorized<float, VecArch::SSE_Arch>& t,
+      const Vectorized<float, VecArch::SSE_Arch>& e) {
+    const __m128 __mask__ = _mm_cmplt_ps(a.m_data, b.m_data);
+    return Vectorized<float, VecArch::SSE_Arch>(
+        _mm_or_ps(_mm_and_ps(__mask__, t.m_data), _mm_andnot_ps(__mask__, e.m_data)));
+  }
+
+  // 2^n, n is an integer in [-126, 127].
+  MGLORIA_INLINE_CPU static Vectorized<float, VecArch::SSE_Arch> Pow2i(
+      const Vectorized<float, VecArch::SSE_Arch>& n) {
+    const __m128i __e__ = _mm_add_epi32(_mm_cvttps_epi32(n.m_data), _mm_set1_epi32(127));
+    return Vectorized<float, VecArch::SSE_Arch>(_mm_castsi128_ps(_mm_slli_epi32(__e__, 23)));
+  }
+
+  // Split a normal a > 0 to m * 2^e, m in [0.5, 1).
+  MGLORIA_INLINE_CPU static Vectorized<float, VecArch::SSE_Arch> Frexp(
+      const Vectorized<float, VecArch::SSE_Arch>& a, Vectorized<float, VecArch::SSE_Arch>* e) {
+    const __m128i __bits__ = _mm_castps_si128(a.m_data);
+    *e = Vectorized<float, VecArch::SSE_Arch>(
+        _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(__bits__, 23), _mm_set1_epi32(126))));
+    const __m128 __mant__ = _mm_and_ps(a.m_data, _mm_castsi128_ps(_mm_set1_epi32(0x807FFFFF)));
+    return Vectorized<float, VecArch::SSE_Arch>(_mm_or_ps(__mant__, _mm_set1_ps(0.5f)));
+  }
+
+  // The lanes where a < b, a <= b, a == b and a != b. A NaN lane is only != to anything.
+  MGLORIA_INLINE_CPU static VectorizedMask<float, VecArch::SSE_Arch> CmpLt(
+      const Vectorized<float, VecArch::SSE_Arch>& a,
+      const Vectorized<float, VecArch::SSE_Arch>& b) {
+    return VectorizedMask<float, VecArch::SSE_Arch>(_mm_cmplt_ps(a.m_data, b.m_data));
+  }
+
+  MGLORIA_INLINE_CPU static VectorizedMask<float, VecArch::SSE_Arch> CmpLe(
+      const Vectorized<float, VecArch::SSE_Arch>& a,
+      const Vectorized<float, VecArch::SSE_Arch>& b) {
+    return VectorizedMask<float, VecArch::SSE_Arch>(_mm_cmple_ps(a.m_data, b.m_data));
+  }
+
+  MGLORIA_INLINE_CPU static VectorizedMask<float, VecArch::SSE_Arch> CmpEq(
+      const Vectorized<float, VecArch::SSE_Arch>& a,
+      const Vectorized<float, VecArch::SSE_Arch>& b) {
+    return VectorizedMask<float, VecArch::SSE_Arch>(_mm_cmpeq_ps(a.m_data, b.m_data));
+  }
+
+  MGLORIA_INLINE_CPU static VectorizedMask<float, VecArch::SSE_Arch> CmpNe(
+      const Vectorized<float, VecArch::SSE_Arch>& a,
+      const Vectorized<float, VecArch::SSE_Arch>& b) {
+    return VectorizedMask<float, VecArch::SSE_Arch>(_mm_cmpneq_ps(a.m_data, b.m_data));
+  }
+
+  // t where the lane of m is set, e where it is not. No branch.
+  MGLORIA_INLINE_CPU static Vectorized<float, VecArch::SSE_Arch> Select(
+      const VectorizedMask<float, VecArch::SSE_Arch>& m,
+      const Vectorized<float, VecArch::SSE_Arch>& t,
+      const Vectorized<float, VecArch::SSE_Arch>& e) {
+    return Vectorized<float, VecArch::SSE_Arch>(
+        _mm_or_ps(_mm_and_ps(m.m_data, t.m_data), _mm_andnot_ps(m.m_data, e.m_data)));
+  }
+
   // operator overload.
   MGLORIA_INLINE_CPU Vectorized<float, VecArch::SSE_Arch>& operator=(float s) {
     m_data = _mm_set1_ps(s);
@@ -66,6 +200,7 @@ struct Vectorized<float, VecArch::SSE_Arch> {
 
   // Store vectorized data to normal data.
   MGLORIA_INLINE_CPU void Store(float* data) const { _mm_store_ps(data, m_data); }
+  MGLORIA_INLINE_CPU void StoreUnAligned(float* data) const { _mm_storeu_ps(data, m_data); }
   MGLORIA_INLINE_CPU void StoreEach(float* data) const { _mm_store1_ps(data, m_data); }
 
  private:
@@ -96,7 +231,7 @@ struct Vectorized<double, VecArch::SSE_Arch> {
 
   // constructor
   Vectorized() = default;
-  explicit Vectorized(__m128 data) : m_data(data) {}
+  explicit Vectorized(__m128d data) : m_data(data) {}
 
   // static create Vectorized functions
   MGLORIA_INLINE_CPU static Vectorized<double, VecArch::SSE_Arch> Fill(double s) {
@@ -104,13 +239,79 @@ struct Vectorized<double, VecArch::SSE_Arch> {
   }
 
   MGLORIA_INLINE_CPU static Vectorized<double, VecArch::SSE_Arch> Load(const double* s) {
-    return Vectorized<double, VecArch::SSE_Arch>(_mm_load1_pd(s));
+    return Vectorized<double, VecArch::SSE_Arch>(_mm_load_pd(s));
   }
 
   MGLORIA_INLINE_CPU static Vectorized<double, VecArch::SSE_Arch> LoadUnAligned(const double* s) {
     return Vectorized<double, VecArch::SSE_Arch>(_mm_loadu_pd(s));
   }
 
+  // a * b + c. SSE has no fused instruction, so it is a mul followed by an add.
+  MGLORIA_INLINE_CPU static Vectorized<double, VecArch::SSE_Arch> MulAdd(
+      const Vectorized<double, VecArch::SSE_Arch>& a,
+      const Vectorized<double, VecArch::SSE_Arch>& b,
+      const Vectorized<double, VecArch::SSE_Arch>& c) {
+    return Vectorized<double, VecArch::SSE_Arch>(
+        _mm_add_pd(_mm_mul_pd(a.m_data, b.m_data), c.m_data));
+  }
+
+  // Lane-wise helpers for the math ops in __vec_math.hpp.
+  MGLORIA_INLINE_CPU static Vectorized<double, VecArch::SSE_Arch> Max(
+      const Vectorized<double, VecArch::SSE_Arch>& a,
+      const Vectorized<double, VecArch::SSE_Arch>& b) {
+    return Vectorized<double, VecArch::SSE_Arch>(_mm_max_pd(a.m_data, b.m_data));
+  }
+
+  MGLORIA_INLINE_CPU static Vectorized<double, VecArch::SSE_Arch> Min(
+      const Vectorized<double, VecArch::SSE_Arch>& a,
+      const Vectorized<double, VecArch::SSE_Arch>& b) {
+    return Vectorized<double, VecArch::SSE_Arch>(_mm_min_pd(a.m_data, b.m_data));
+  }
+
+  MGLORIA_INLINE_CPU static Vectorized<double, VecArch::SSE_Arch> Abs(
+      const Vectorized<double, VecArch::SSE_Arch>& a) {
+    return Vectorized<double, VecArch::SSE_Arch>(_mm_andnot_pd(_mm_set1_pd(-0.0), a.m_data));
+  }
+
+  MGLORIA_INLINE_CPU static Vectorized<double, VecArch::SSE_Arch> Sqrt(
+      const Vectorized<double, VecArch::SSE_Arch>& a) {
+    return Vectorized<double, VecArch::SSE_Arch>(_mm_sqrt_pd(a.m_data));
+  }
+
+  // The lanes where a < b, a <= b, a == b and a != b. A NaN lane is only != to anything.
+  MGLORIA_INLINE_CPU static VectorizedMask<double, VecArch::SSE_Arch> CmpLt(
+      const Vectorized<double, VecArch::SSE_Arch>& a,
+      const Vectorized<double, VecArch::SSE_Arch>& b) {
+    return VectorizedMask<double, VecArch::SSE_Arch>(_mm_cmplt_pd(a.m_data, b.m_data));
+  }
+
+  MGLORIA_INLINE_CPU static VectorizedMask<double, VecArch::SSE_Arch> CmpLe(
+      const Vectorized<double, VecArch::SSE_Arch>& a,
+      const Vectorized<double, VecArch::SSE_Arch>& b) {
+    return VectorizedMask<double, VecArch::SSE_Arch>(_mm_cmple_pd(a.m_data, b.m_data));
+  }
+
+  MGLORIA_INLINE_CPU static VectorizedMask<double, VecArch::SSE_Arch> CmpEq(
+      const Vectorized<double, VecArch::SSE_Arch>& a,
+      const Vectorized<double, VecArch::SSE_Arch>& b) {
+    return VectorizedMask<double, VecArch::SSE_Arch>(_mm_cmpeq_pd(a.m_data, b.m_data));
+  }
+
+  MGLORIA_INLINE_CPU static VectorizedMask<double, VecArch::SSE_Arch> CmpNe(
+      const Vectorized<double, VecArch::SSE_Arch>& a,
+      const Vectorized<double, VecArch::SSE_Arch>& b) {
+    return VectorizedMask<double, VecArch::SSE_Arch>(_mm_cmpneq_pd(a.m_data, b.m_data));
+  }
+
+  // t where the lane of m is set, e where it is not. No branch.
+  MGLORIA_INLINE_CPU static Vectorized<double, VecArch::SSE_Arch> Select(
+      const VectorizedMask<double, VecArch::SSE_Arch>& m,
+      const Vectorized<double, VecArch::SSE_Arch>& t,
+      const Vectorized<double, VecArch::SSE_Arch>& e) {
+    return Vectorized<double, VecArch::SSE_Arch>(
+        _mm_or_pd(_mm_and_pd(m.m_data, t.m_data), _mm_andnot_pd(m.m_data, e.m_data)));
+  }
+
   // operator overload.
   MGLORIA_INLINE_CPU Vectorized<double, VecArch::SSE_Arch>& operator=(double s) {
     m_data = _mm_set1_pd(s);
@@ -130,11 +331,316 @@ struct Vectorized<double, VecArch::SSE_Arch> {
 
   // Store vectorized data to normal data.
   MGLORIA_INLINE_CPU void Store(double* data) const { _mm_store_pd(data, m_data); }
+  MGLORIA_INLINE_CPU void StoreUnAligned(double* data) const { _mm_storeu_pd(data, m_data); }
   MGLORIA_INLINE_CPU void StoreEach(double* data) const { _mm_store1_pd(data, m_data); }
 
  private:
   // parameters
-  __m128 m_data;
+  __m128d m_data;
+};
+
+template<>
+struct Vectorized<int32_t, VecArch::SSE_Arch> {
+  // int32_t in vector
+  static const index_t num = 4;
+  // friends
+  template<typename OriDataType, typename DisDataType, VecArch VArch>
+  friend struct VectorizedCast;
+  friend MGLORIA_INLINE_CPU Vectorized<int32_t, VecArch::SSE_Arch> operator+(
+      const Vectorized<int32_t, VecArch::SSE_Arch>& lhs,
+      const Vectorized<int32_t, VecArch::SSE_Arch>& rhs);
+
+  friend MGLORIA_INLINE_CPU Vectorized<int32_t, VecArch::SSE_Arch> operator-(
+      const Vectorized<int32_t, VecArch::SSE_Arch>& lhs,
+      const Vectorized<int32_t, VecArch::SSE_Arch>& rhs);
+
+  friend MGLORIA_INLINE_CPU Vectorized<int32_t, VecArch::SSE_Arch> operator*(
+      const Vectorized<int32_t, VecArch::SSE_Arch>& lhs,
+      const Vectorized<int32_t, VecArch::SSE_Arch>& rhs);
+
+  // constructor
+  Vectorized() = default;
+  explicit Vectorized(__m128i data) : m_data(data) {}
+
+  // static create Vectorized functions
+  MGLORIA_INLINE_CPU static Vectorized<int32_t, VecArch::SSE_Arch> Fill(int32_t s) {
+    return Vectorized<int32_t, VecArch::SSE_Arch>(_mm_set1_epi32(static_cast<int>(s)));
+  }
+
+  MGLORIA_INLINE_CPU static Vectorized<int32_t, VecArch::SSE_Arch> Load(const int32_t* s) {
+    return Vectorized<int32_t, VecArch::SSE_Arch>(
+        _mm_load_si128(reinterpret_cast<const __m128i*>(s)));
+  }
+
+  MGLORIA_INLINE_CPU static Vectorized<int32_t, VecArch::SSE_Arch> LoadUnAligned(const int32_t* s) {
+    return Vectorized<int32_t, VecArch::SSE_Arch>(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(s)));
+  }
+
+  // 8 int8_t widened to int16, the lane q holding s[2q] and s[2q + 1]. See MulAddPairs.
+  MGLORIA_INLINE_CPU static Vectorized<int32_t, VecArch::SSE_Arch> LoadPairs(const int8_t* s) {
+    // SSE2 has no cvtepi8_epi16, each byte twice in 16 bits shifted back with its sign.
+    const __m128i __b__ = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(s));
+    return Vectorized<int32_t, VecArch::SSE_Arch>(
+        _mm_srai_epi16(_mm_unpacklo_epi8(__b__, __b__), 8));
+  }
+
+  // a + b, clamped to [INT32_MIN, INT32_MAX] when it overflows.
+  MGLORIA_INLINE_CPU static Vectorized<int32_t, VecArch::SSE_Arch> AddSat(
+      const Vectorized<int32_t, VecArch::SSE_Arch>& a,
+      const Vectorized<int32_t, VecArch::SSE_Arch>& b) {
+    const __m128i s = _mm_add_epi32(a.m_data, b.m_data);
+    // Overflow only if a and b have the same sign and s has the other one.
+    const __m128i ov = _mm_and_si128(_mm_xor_si128(s, a.m_data), _mm_xor_si128(s, b.m_data));
+    return Vectorized<int32_t, VecArch::SSE_Arch>(Saturate(s, a.m_data, ov));
+  }
+
+  // a - b, clamped to [INT32_MIN, INT32_MAX] when it overflows.
+  MGLORIA_INLINE_CPU static Vectorized<int32_t, VecArch::SSE_Arch> SubSat(
+      const Vectorized<int32_t, VecArch::SSE_Arch>& a,
+      const Vectorized<int32_t, VecArch::SSE_Arch>& b) {
+    const __m128i s = _mm_sub_epi32(a.m_data, b.m_data);
+    // Overflow only if a and b have different signs and s has the sign of b.
+    const __m128i ov = _mm_and_si128(_mm_xor_si128(a.m_data, b.m_data), _mm_xor_si128(s, a.m_data));
+    return Vectorized<int32_t, VecArch::SSE_Arch>(Saturate(s, a.m_data, ov));
+  }
+
+  // a * b + c, all wrap around.
+  MGLORIA_INLINE_CPU static Vectorized<int32_t, VecArch::SSE_Arch> MulAdd(
+      const Vectorized<int32_t, VecArch::SSE_Arch>& a,
+      const Vectorized<int32_t, VecArch::SSE_Arch>& b,
+      const Vectorized<int32_t, VecArch::SSE_Arch>& c) {
+    return a * b + c;
+  }
+
+  // c + a0 * b0 + a1 * b1 per lane, each lane of a and b holding two int16, a0 in the low half.
+  // The products and the sum are exact for the int16 widened int8 of the quantized dot.
+  MGLORIA_INLINE_CPU static Vectorized<int32_t, VecArch::SSE_Arch> MulAddPairs(
+      const Vectorized<int32_t, VecArch::SSE_Arch>& a,
+      const Vectorized<int32_t, VecArch::SSE_Arch>& b,
+      const Vectorized<int32_t, VecArch::SSE_Arch>& c) {
+    return Vectorized<int32_t, VecArch::SSE_Arch>(
+        _mm_add_epi32(c.m_data, _mm_madd_epi16(a.m_data, b.m_data)));
+  }
+
+  // The lanes where a < b, a <= b, a == b and a != b.
+  MGLORIA_INLINE_CPU static VectorizedMask<int32_t, VecArch::SSE_Arch> CmpLt(
+      const Vectorized<int32_t, VecArch::SSE_Arch>& a,
+      const Vectorized<int32_t, VecArch::SSE_Arch>& b) {
+    return VectorizedMask<int32_t, VecArch::SSE_Arch>(_mm_cmplt_epi32(a.m_data, b.m_data));
+  }
+
+  MGLORIA_INLINE_CPU static VectorizedMask<int32_t, VecArch::SSE_Arch> CmpLe(
+      const Vectorized<int32_t, VecArch::SSE_Arch>& a,
+      const Vectorized<int32_t, VecArch::SSE_Arch>& b) {
+    return VectorizedMask<int32_t, VecArch::SSE_Arch>(
+        _mm_xor_si128(_mm_cmpgt_epi32(a.m_data, b.m_data), _mm_set1_epi32(-1)));
+  }
+
+  MGLORIA_INLINE_CPU static VectorizedMask<int32_t, VecArch::SSE_Arch> CmpEq(
+      const Vectorized<int32_t, VecArch::SSE_Arch>& a,
+      const Vectorized<int32_t, VecArch::SSE_Arch>& b) {
+    return VectorizedMask<int32_t, VecArch::SSE_Arch>(_mm_cmpeq_epi32(a.m_data, b.m_data));
+  }
+
+  MGLORIA_INLINE_CPU static VectorizedMask<int32_t, VecArch::SSE_Arch> CmpNe(
+      const Vectorized<int32_t, VecArch::SSE_Arch>& a,
+      const Vectorized<int32_t, VecArch::SSE_Arch>& b) {
+    return VectorizedMask<int32_t, VecArch::SSE_Arch>(
+        _mm_xor_si128(_mm_cmpeq_epi32(a.m_data, b.m_data), _mm_set1_epi32(-1)));
+  }
+
+  // t where the lane of m is set, e where it is not. No branch.
+  MGLORIA_INLINE_CPU static Vectorized<int32_t, VecArch::SSE_Arch> Select(
+      const VectorizedMask<int32_t, VecArch::SSE_Arch>& m,
+      const Vectorized<int32_t, VecArch::SSE_Arch>& t,
+      const Vectorized<int32_t, VecArch::SSE_Arch>& e) {
+    return Vectorized<int32_t, VecArch::SSE_Arch>(
+        _mm_or_si128(_mm_and_si128(m.m_data, t.m_data), _mm_andnot_si128(m.m_data, e.m_data)));
+  }
+
+  // operator overload.
+  MGLORIA_INLINE_CPU Vectorized<int32_t, VecArch::SSE_Arch>& operator=(int32_t s) {
+    m_data = _mm_set1_epi32(static_cast<int>(s));
+    return *this;
+  }
+
+  MGLORIA_INLINE_CPU Vectorized<int32_t, VecArch::SSE_Arch>& operator=(const int32_t* s) {
+    m_data = _mm_load_si128(reinterpret_cast<const __m128i*>(s));
+    return *this;
+  }
+
+  MGLORIA_INLINE_CPU int32_t Sum() const {
+    __m128i ans = _mm_add_epi32(m_data, _mm_shuffle_epi32(m_data, _MM_SHUFFLE(1, 0, 3, 2)));
+    ans = _mm_add_epi32(ans, _mm_shuffle_epi32(ans, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(ans);
+  }
+
+  // Store vectorized data to normal data.
+  MGLORIA_INLINE_CPU void Store(int32_t* data) const {
+    _mm_store_si128(reinterpret_cast<__m128i*>(data), m_data);
+  }
+  MGLORIA_INLINE_CPU void StoreUnAligned(int32_t* data) const {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(data), m_data);
+  }
+
+ private:
+  // Where ov has the sign bit, INT32_MAX if a >= 0 else INT32_MIN. Or s.
+  MGLORIA_INLINE_CPU static __m128i Saturate(__m128i s, __m128i a, __m128i ov) {
+    const __m128i __ov__ = _mm_srai_epi32(ov, 31);
+    const __m128i __sat__ = _mm_xor_si128(_mm_srai_epi32(a, 31), _mm_set1_epi32(INT32_MAX));
+    return _mm_or_si128(_mm_and_si128(__ov__, __sat__), _mm_andnot_si128(__ov__, s));
+  }
+  // parameters
+  __m128i m_data;
+};
+
+template<>
+struct Vectorized<int8_t, VecArch::SSE_Arch> {
+  // int8_t in vector
+  static const index_t num = 16;
+  // friends
+  friend MGLORIA_INLINE_CPU Vectorized<int8_t, VecArch::SSE_Arch> operator+(
+      const Vectorized<int8_t, VecArch::SSE_Arch>& lhs,
+      const Vectorized<int8_t, VecArch::SSE_Arch>& rhs);
+
+  friend MGLORIA_INLINE_CPU Vectorized<int8_t, VecArch::SSE_Arch> operator-(
+      const Vectorized<int8_t, VecArch::SSE_Arch>& lhs,
+      const Vectorized<int8_t, VecArch::SSE_Arch>& rhs);
+
+  friend MGLORIA_INLINE_CPU Vectorized<int8_t, VecArch::SSE_Arch> operator*(
+      const Vectorized<int8_t, VecArch::SSE_Arch>& lhs,
+      const Vectorized<int8_t, VecArch::SSE_Arch>& rhs);
+
+  // constructor
+  Vectorized() = default;
+  explicit Vectorized(__m128i data) : m_data(data) {}
+
+  // static create Vectorized functions
+  MGLORIA_INLINE_CPU static Vectorized<int8_t, VecArch::SSE_Arch> Fill(int8_t s) {
+    return Vectorized<int8_t, VecArch::SSE_Arch>(_mm_set1_epi8(static_cast<char>(s)));
+  }
+
+  MGLORIA_INLINE_CPU static Vectorized<int8_t, VecArch::SSE_Arch> Load(const int8_t* s) {
+    return Vectorized<int8_t, VecArch::SSE_Arch>(
+        _mm_load_si128(reinterpret_cast<const __m128i*>(s)));
+  }
+
+  MGLORIA_INLINE_CPU static Vectorized<int8_t, VecArch::SSE_Arch> LoadUnAligned(const int8_t* s) {
+    return Vectorized<int8_t, VecArch::SSE_Arch>(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(s)));
+  }
+
+  // a + b, clamped to [-128, 127].
+  MGLORIA_INLINE_CPU static Vectorized<int8_t, VecArch::SSE_Arch> AddSat(
+      const Vectorized<int8_t, VecArch::SSE_Arch>& a,
+      const Vectorized<int8_t, VecArch::SSE_Arch>& b) {
+    return Vectorized<int8_t, VecArch::SSE_Arch>(_mm_adds_epi8(a.m_data, b.m_data));
+  }
+
+  // a - b, clamped to [-128, 127].
+  MGLORIA_INLINE_CPU static Vectorized<int8_t, VecArch::SSE_Arch> SubSat(
+      const Vectorized<int8_t, VecArch::SSE_Arch>& a,
+      const Vectorized<int8_t, VecArch::SSE_Arch>& b) {
+    return Vectorized<int8_t, VecArch::SSE_Arch>(_mm_subs_epi8(a.m_data, b.m_data));
+  }
+
+  // operator overload.
+  MGLORIA_INLINE_CPU Vectorized<int8_t, VecArch::SSE_Arch>& operator=(int8_t s) {
+    m_data = _mm_set1_epi8(static_cast<char>(s));
+    return *this;
+  }
+
+  MGLORIA_INLINE_CPU Vectorized<int8_t, VecArch::SSE_Arch>& operator=(const int8_t* s) {
+    m_data = _mm_load_si128(reinterpret_cast<const __m128i*>(s));
+    return *this;
+  }
+
+  // Store vectorized data to normal data.
+  MGLORIA_INLINE_CPU void Store(int8_t* data) const {
+    _mm_store_si128(reinterpret_cast<__m128i*>(data), m_data);
+  }
+  MGLORIA_INLINE_CPU void StoreUnAligned(int8_t* data) const {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(data), m_data);
+  }
+
+ private:
+  // parameters
+  __m128i m_data;
+};
+
+template<>
+struct Vectorized<uint8_t, VecArch::SSE_Arch> {
+  // uint8_t in vector
+  static const index_t num = 16;
+  // friends
+  friend MGLORIA_INLINE_CPU Vectorized<uint8_t, VecArch::SSE_Arch> operator+(
+      const Vectorized<uint8_t, VecArch::SSE_Arch>& lhs,
+      const Vectorized<uint8_t, VecArch::SSE_Arch>& rhs);
+
+  friend MGLORIA_INLINE_CPU Vectorized<uint8_t, VecArch::SSE_Arch> operator-(
+      const Vectorized<uint8_t, VecArch::SSE_Arch>& lhs,
+      const Vectorized<uint8_t, VecArch::SSE_Arch>& rhs);
+
+  friend MGLORIA_INLINE_CPU Vectorized<uint8_t, VecArch::SSE_Arch> operator*(
+      const Vectorized<uint8_t, VecArch::SSE_Arch>& lhs,
+      const Vectorized<uint8_t, VecArch::SSE_Arch>& rhs);
+
+  // constructor
+  Vectorized() = default;
+  explicit Vectorized(__m128i data) : m_data(data) {}
+
+  // static create Vectorized functions
+  MGLORIA_INLINE_CPU static Vectorized<uint8_t, VecArch::SSE_Arch> Fill(uint8_t s) {
+    return Vectorized<uint8_t, VecArch::SSE_Arch>(_mm_set1_epi8(static_cast<char>(s)));
+  }
+
+  MGLORIA_INLINE_CPU static Vectorized<uint8_t, VecArch::SSE_Arch> Load(const uint8_t* s) {
+    return Vectorized<uint8_t, VecArch::SSE_Arch>(
+        _mm_load_si128(reinterpret_cast<const __m128i*>(s)));
+  }
+
+  MGLORIA_INLINE_CPU static Vectorized<uint8_t, VecArch::SSE_Arch> LoadUnAligned(const uint8_t* s) {
+    return Vectorized<uint8_t, VecArch::SSE_Arch>(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(s)));
+  }
+
+  // a + b, clamped to [0, 255].
+  MGLORIA_INLINE_CPU static Vectorized<uint8_t, VecArch::SSE_Arch> AddSat(
+      const Vectorized<uint8_t, VecArch::SSE_Arch>& a,
+      const Vectorized<uint8_t, VecArch::SSE_Arch>& b) {
+    return Vectorized<uint8_t, VecArch::SSE_Arch>(_mm_adds_epu8(a.m_data, b.m_data));
+  }
+
+  // a - b, clamped to [0, 255].
+  MGLORIA_INLINE_CPU static Vectorized<uint8_t, VecArch::SSE_Arch> SubSat(
+      const Vectorized<uint8_t, VecArch::SSE_Arch>& a,
+      const Vectorized<uint8_t, VecArch::SSE_Arch>& b) {
+    return Vectorized<uint8_t, VecArch::SSE_Arch>(_mm_subs_epu8(a.m_data, b.m_data));
+  }
+
+  // operator overload.
+  MGLORIA_INLINE_CPU Vectorized<uint8_t, VecArch::SSE_Arch>& operator=(uint8_t s) {
+    m_data = _mm_set1_epi8(static_cast<char>(s));
+    return *this;
+  }
+
+  MGLORIA_INLINE_CPU Vectorized<uint8_t, VecArch::SSE_Arch>& operator=(const uint8_t* s) {
+    m_data = _mm_load_si128(reinterpret_cast<const __m128i*>(s));
+    return *this;
+  }
+
+  // Store vectorized data to normal data.
+  MGLORIA_INLINE_CPU void Store(uint8_t* data) const {
+    _mm_store_si128(reinterpret_cast<__m128i*>(data), m_data);
+  }
+  MGLORIA_INLINE_CPU void StoreUnAligned(uint8_t* data) const {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(data), m_data);
+  }
+
+ private:
+  // parameters
+  __m128i m_data;
 };
 
 MGLORIA_INLINE_CPU Vectorized<float, VecArch::SSE_Arch> operator+(
@@ -185,6 +691,97 @@ MGLORIA_INLINE_CPU Vectorized<double, VecArch::SSE_Arch> operator/(
   return Vectorized<double, VecArch::SSE_Arch>(_mm_div_pd(lhs.m_data, rhs.m_data));
 }
 
+MGLORIA_INLINE_CPU Vectorized<int32_t, VecArch::SSE_Arch> operator+(
+    const Vectorized<int32_t, VecArch::SSE_Arch>& lhs,
+    const Vectorized<int32_t, VecArch::SSE_Arch>& rhs) {
+  return Vectorized<int32_t, VecArch::SSE_Arch>(_mm_add_epi32(lhs.m_data, rhs.m_data));
+}
+
+MGLORIA_INLINE_CPU Vectorized<int32_t, VecArch::SSE_Arch> operator-(
+    const Vectorized<int32_t, VecArch::SSE_Arch>& lhs,
+    const Vectorized<int32_t, VecArch::SSE_Arch>& rhs) {
+  return Vectorized<int32_t, VecArch::SSE_Arch>(_mm_sub_epi32(lhs.m_data, rhs.m_data));
+}
+
+MGLORIA_INLINE_CPU Vectorized<int32_t, VecArch::SSE_Arch> operator*(
+    const Vectorized<int32_t, VecArch::SSE_Arch>& lhs,
+    const Vectorized<int32_t, VecArch::SSE_Arch>& rhs) {
+  // SSE2 has no mullo_epi32. Multiply the lanes 0, 2 and 1, 3 to 64 bits, keep the low halves.
+  const __m128i __even__ = _mm_mul_epu32(lhs.m_data, rhs.m_data);
+  const __m128i __odd__ = _mm_mul_epu32(_mm_srli_si128(lhs.m_data, 4),
+                                        _mm_srli_si128(rhs.m_data, 4));
+  return Vectorized<int32_t, VecArch::SSE_Arch>(
+      _mm_unpacklo_epi32(_mm_shuffle_epi32(__even__, _MM_SHUFFLE(0, 0, 2, 0)),
+                         _mm_shuffle_epi32(__odd__, _MM_SHUFFLE(0, 0, 2, 0))));
+}
+MGLORIA_INLINE_CPU Vectorized<int8_t, VecArch::SSE_Arch> operator+(
+    const Vectorized<int8_t, VecArch::SSE_Arch>& lhs,
+    const Vectorized<int8_t, VecArch::SSE_Arch>& rhs) {
+  return Vectorized<int8_t, VecArch::SSE_Arch>(_mm_add_epi8(lhs.m_data, rhs.m_data));
+}
+
+MGLORIA_INLINE_CPU Vectorized<int8_t, VecArch::SSE_Arch> operator-(
+    const Vectorized<int8_t, VecArch::SSE_Arch>& lhs,
+    const Vectorized<int8_t, VecArch::SSE_Arch>& rhs) {
+  return Vectorized<int8_t, VecArch::SSE_Arch>(_mm_sub_epi8(lhs.m_data, rhs.m_data));
+}
+
+MGLORIA_INLINE_CPU Vectorized<int8_t, VecArch::SSE_Arch> operator*(
+    const Vectorized<int8_t, VecArch::SSE_Arch>& lhs,
+    const Vectorized<int8_t, VecArch::SSE_Arch>& rhs) {
+  // No 8 bits multiply. Do the even and odd bytes in 16 bits lanes, the low byte is the answer.
+  const __m128i __even__ = _mm_mullo_epi16(lhs.m_data, rhs.m_data);
+  const __m128i __odd__ =
+      _mm_mullo_epi16(_mm_srli_epi16(lhs.m_data, 8), _mm_srli_epi16(rhs.m_data, 8));
+  return Vectorized<int8_t, VecArch::SSE_Arch>(_mm_or_si128(_mm_slli_epi16(__odd__, 8),
+                         _mm_and_si128(__even__, _mm_set1_epi16(0x00FF))));
+}
+MGLORIA_INLINE_CPU Vectorized<uint8_t, VecArch::SSE_Arch> operator+(
+    const Vectorized<uint8_t, VecArch::SSE_Arch>& lhs,
+    const Vectorized<uint8_t, VecArch::SSE_Arch>& rhs) {
+  return Vectorized<uint8_t, VecArch::SSE_Arch>(_mm_add_epi8(lhs.m_data, rhs.m_data));
+}
+
+MGLORIA_INLINE_CPU Vectorized<uint8_t, VecArch::SSE_Arch> operator-(
+    const Vectorized<uint8_t, VecArch::SSE_Arch>& lhs,
+    const Vectorized<uint8_t, VecArch::SSE_Arch>& rhs) {
+  return Vectorized<uint8_t, VecArch::SSE_Arch>(_mm_sub_epi8(lhs.m_data, rhs.m_data));
+}
+
+MGLORIA_INLINE_CPU Vectorized<uint8_t, VecArch::SSE_Arch> operator*(
+    const Vectorized<uint8_t, VecArch::SSE_Arch>& lhs,
+    const Vectorized<uint8_t, VecArch::SSE_Arch>& rhs) {
+  // No 8 bits multiply. Do the even and odd bytes in 16 bits lanes, the low byte is the answer.
+  const __m128i __even__ = _mm_mullo_epi16(lhs.m_data, rhs.m_data);
+  const __m128i __odd__ =
+      _mm_mullo_epi16(_mm_srli_epi16(lhs.m_data, 8), _mm_srli_epi16(rhs.m_data, 8));
+  return Vectorized<uint8_t, VecArch::SSE_Arch>(_mm_or_si128(_mm_slli_epi16(__odd__, 8),
+                         _mm_and_si128(__even__, _mm_set1_epi16(0x00FF))));
+}
+
+/*!
+ *@brief      float <-> int32_t, see VectorizedCast.
+ */
+template<>
+struct VectorizedCast<float, int32_t, VecArch::SSE_Arch> {
+  MGLORIA_INLINE_CPU static Vectorized<int32_t, VecArch::SSE_Arch> Do(
+      const Vectorized<float, VecArch::SSE_Arch>& src) {
+    return Vectorized<int32_t, VecArch::SSE_Arch>(_mm_cvttps_epi32(src.m_data));
+  }
+
+  static const bool m_Enable = MGLORIA_VECTORIZATION_TRUE;
+};
+
+template<>
+struct VectorizedCast<int32_t, float, VecArch::SSE_Arch> {
+  MGLORIA_INLINE_CPU static Vectorized<float, VecArch::SSE_Arch> Do(
+      const Vectorized<int32_t, VecArch::SSE_Arch>& src) {
+    return Vectorized<float, VecArch::SSE_Arch>(_mm_cvtepi32_ps(src.m_data));
+  }
+
+  static const bool m_Enable = MGLORIA_VECTORIZATION_TRUE;
+};
+
 }  // namespace vectorization
 }  // namespace mgloria
 
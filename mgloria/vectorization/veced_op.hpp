@@ -16,6 +16,16 @@
 #else
 #include "./vectorization/__vec_none.hpp"
 #endif  //  MGLORIA_USE_SSE == 1
+#if MGLORIA_USE_AVX2 == 1 || MGLORIA_RUNTIME_DISPATCH == 1
+#include "./vectorization/__vec_avx2.hpp"
+#endif  //  MGLORIA_USE_AVX2 == 1 || MGLORIA_RUNTIME_DISPATCH == 1
+#if MGLORIA_USE_AVX512 == 1 || MGLORIA_RUNTIME_DISPATCH == 1
+#include "./vectorization/__vec_avx512.hpp"
+#endif  //  MGLORIA_USE_AVX512 == 1 || MGLORIA_RUNTIME_DISPATCH == 1
+#if MGLORIA_RUNTIME_DISPATCH == 1
+#include "./vectorization/__vec_dispatch.hpp"
+#endif  //  MGLORIA_RUNTIME_DISPATCH == 1
+#include "./vectorization/__vec_math.hpp"
 
 namespace mgloria {
 namespace expr {
@@ -27,6 +37,12 @@ template<typename ExpressionType, typename DataType, vectorization::VecArch Arch
 struct VectorizedJob {
   MGLORIA_INLINE_CPU DataType Eval(index_t y, index_t x) const;
   MGLORIA_INLINE_CPU vectorization::Vectorized<DataType, Arch> EvalVec(index_t y, index_t x) const;
+  ///! The same as EvalVec, but (y, x) of the tensors may not be aligned. Used by the peeled rows.
+  MGLORIA_INLINE_CPU vectorization::Vectorized<DataType, Arch> EvalVecUnAligned(index_t y,
+                                                                              index_t x) const;
+  ///! Only the first n lanes are valid. Used for the tail of a row on the arch with masks.
+  MGLORIA_INLINE_CPU vectorization::Vectorized<DataType, Arch> EvalVecMasked(index_t y, index_t x,
+                                                                           index_t n) const;
 };
 
 /*!
@@ -40,6 +56,14 @@ struct VectorizedJob<Tensor<Device, 1, DataType>, DataType, Arch> {
   MGLORIA_INLINE_CPU vectorization::Vectorized<DataType, Arch> EvalVec(index_t y, index_t x) const {
     return vectorization::Vectorized<DataType, Arch>::Load(&__data_ptr[x]);
   }
+  MGLORIA_INLINE_CPU vectorization::Vectorized<DataType, Arch> EvalVecUnAligned(index_t,
+                                                                              index_t x) const {
+    return vectorization::Vectorized<DataType, Arch>::LoadUnAligned(&__data_ptr[x]);
+  }
+  MGLORIA_INLINE_CPU vectorization::Vectorized<DataType, Arch> EvalVecMasked(index_t, index_t x,
+                                                                           index_t n) const {
+    return vectorization::Vectorized<DataType, Arch>::LoadMasked(&__data_ptr[x], n);
+  }
 
  private:
   DataType* __data_ptr;
@@ -59,6 +83,14 @@ struct VectorizedJob<Tensor<Device, Dims, DataType>, DataType, Arch> {
   MGLORIA_INLINE_CPU vectorization::Vectorized<DataType, Arch> EvalVec(index_t y, index_t x) const {
     return vectorization::Vectorized<DataType, Arch>::Load(&__data_ptr[y * m_Stride + x]);
   }
+  MGLORIA_INLINE_CPU vectorization::Vectorized<DataType, Arch> EvalVecUnAligned(index_t y,
+                                                                              index_t x) const {
+    return vectorization::Vectorized<DataType, Arch>::LoadUnAligned(&__data_ptr[y * m_Stride + x]);
+  }
+  MGLORIA_INLINE_CPU vectorization::Vectorized<DataType, Arch> EvalVecMasked(index_t y, index_t x,
+                                                                           index_t n) const {
+    return vectorization::Vectorized<DataType, Arch>::LoadMasked(&__data_ptr[y * m_Stride + x], n);
+  }
 
  private:
   DataType* __data_ptr;
@@ -76,6 +108,14 @@ class VectorizedJob<ScalarExpr<DataType>, DataType, Arch> {
   MGLORIA_INLINE_CPU vectorization::Vectorized<DataType, Arch> EvalVec(index_t y, index_t x) const {
     return vectorization::Vectorized<DataType, Arch>::Fill(m_Scalar);
   }
+  MGLORIA_INLINE_CPU vectorization::Vectorized<DataType, Arch> EvalVecUnAligned(index_t,
+                                                                              index_t) const {
+    return vectorization::Vectorized<DataType, Arch>::Fill(m_Scalar);
+  }
+  MGLORIA_INLINE_CPU vectorization::Vectorized<DataType, Arch> EvalVecMasked(index_t, index_t,
+                                                                           index_t) const {
+    return vectorization::Vectorized<DataType, Arch>::Fill(m_Scalar);
+  }
   MGLORIA_INLINE_CPU DataType Eval(index_t y, index_t x) const { return m_Scalar; }
 
  private:
@@ -96,9 +136,35 @@ class VectorizedJob<BinaryExpr<OP, A_T, B_T, DataType, EType>, DataType, Arch> {
     return vectorization::VectorizedOP<OP, DataType, Arch>::Do(m_lhs.EvalVec(y, x),
                                                                m_rhs.EvalVec(y, x));
   }
+  MGLORIA_INLINE_CPU vectorization::Vectorized<DataType, Arch> EvalVecUnAligned(index_t y,
+                                                                              index_t x) const {
+    return vectorization::VectorizedOP<OP, DataType, Arch>::Do(m_lhs.EvalVecUnAligned(y, x),
+                                                               m_rhs.EvalVecUnAligned(y, x));
+  }
+  MGLORIA_INLINE_CPU vectorization::Vectorized<DataType, Arch> EvalVecMasked(index_t y, index_t x,
+                                                                           index_t n) const {
+    return vectorization::VectorizedOP<OP, DataType, Arch>::Do(m_lhs.EvalVecMasked(y, x, n),
+                                                               m_rhs.EvalVecMasked(y, x, n));
+  }
   MGLORIA_INLINE_CPU DataType Eval(index_t y, index_t x) const {
     return OP::Do(m_lhs.Eval(y, x), m_rhs.Eval(y, x));
   }
+  ///! The lanes where OP is true, without the 1 or 0 of EvalVec. Used by the where job.
+  MGLORIA_INLINE_CPU vectorization::VectorizedMask<DataType, Arch> MaskVec(index_t y,
+                                                                         index_t x) const {
+    return vectorization::VectorizedMaskOP<OP, DataType, Arch>::Do(m_lhs.EvalVec(y, x),
+                                                                   m_rhs.EvalVec(y, x));
+  }
+  MGLORIA_INLINE_CPU vectorization::VectorizedMask<DataType, Arch> MaskVecUnAligned(
+      index_t y, index_t x) const {
+    return vectorization::VectorizedMaskOP<OP, DataType, Arch>::Do(m_lhs.EvalVecUnAligned(y, x),
+                                                                   m_rhs.EvalVecUnAligned(y, x));
+  }
+  MGLORIA_INLINE_CPU vectorization::VectorizedMask<DataType, Arch> MaskVecMasked(
+      index_t y, index_t x, index_t n) const {
+    return vectorization::VectorizedMaskOP<OP, DataType, Arch>::Do(m_lhs.EvalVecMasked(y, x, n),
+                                                                   m_rhs.EvalVecMasked(y, x, n));
+  }
 
  private:
   VectorizedJob<A_T, DataType, Arch> m_lhs;
@@ -112,15 +178,219 @@ template<typename OP, typename A_T, int EType, typename DataType, vectorization:
 class VectorizedJob<UnaryExpr<OP, A_T, DataType, EType>, DataType, Arch> {
  public:
   VectorizedJob(const VectorizedJob<A_T, DataType, Arch>& src) : m_src(src) {}
-  MGLORIA_INLINE_CPU vectorization::Vectorized<DataType> EvalVec(index_t y, index_t x) const {
+  MGLORIA_INLINE_CPU vectorization::Vectorized<DataType, Arch> EvalVec(index_t y, index_t x) const {
     return vectorization::VectorizedOP<OP, DataType, Arch>::Do(m_src.EvalVec(y, x));
   }
+  MGLORIA_INLINE_CPU vectorization::Vectorized<DataType, Arch> EvalVecUnAligned(index_t y,
+                                                                              index_t x) const {
+    return vectorization::VectorizedOP<OP, DataType, Arch>::Do(m_src.EvalVecUnAligned(y, x));
+  }
+  MGLORIA_INLINE_CPU vectorization::Vectorized<DataType, Arch> EvalVecMasked(index_t y, index_t x,
+                                                                           index_t n) const {
+    return vectorization::VectorizedOP<OP, DataType, Arch>::Do(m_src.EvalVecMasked(y, x, n));
+  }
   MGLORIA_INLINE_CPU DataType Eval(index_t y, index_t x) const { return OP::Do(m_src.Eval(y, x)); }
 
  private:
   VectorizedJob<A_T, DataType, Arch> m_src;
 };
 
+/*!
+ *@brief
+ */
+template<typename OP, typename A_T, typename B_T, typename C_T, exprType EType, typename DataType,
+         vectorization::VecArch Arch>
+class VectorizedJob<TernaryExpr<OP, A_T, B_T, C_T, DataType, EType>, DataType, Arch> {
+ public:
+  VectorizedJob(const VectorizedJob<A_T, DataType, Arch>& _1,
+                const VectorizedJob<B_T, DataType, Arch>& _2,
+                const VectorizedJob<C_T, DataType, Arch>& _3)
+      : m_1(_1), m_2(_2), m_3(_3) {}
+  MGLORIA_INLINE_CPU vectorization::Vectorized<DataType, Arch> EvalVec(index_t y, index_t x) const {
+    return vectorization::VectorizedOP<OP, DataType, Arch>::Do(
+        m_1.EvalVec(y, x), m_2.EvalVec(y, x), m_3.EvalVec(y, x));
+  }
+  MGLORIA_INLINE_CPU vectorization::Vectorized<DataType, Arch> EvalVecUnAligned(index_t y,
+                                                                              index_t x) const {
+    return vectorization::VectorizedOP<OP, DataType, Arch>::Do(
+        m_1.EvalVecUnAligned(y, x), m_2.EvalVecUnAligned(y, x), m_3.EvalVecUnAligned(y, x));
+  }
+  MGLORIA_INLINE_CPU vectorization::Vectorized<DataType, Arch> EvalVecMasked(index_t y, index_t x,
+                                                                           index_t n) const {
+    return vectorization::VectorizedOP<OP, DataType, Arch>::Do(
+        m_1.EvalVecMasked(y, x, n), m_2.EvalVecMasked(y, x, n), m_3.EvalVecMasked(y, x, n));
+  }
+  MGLORIA_INLINE_CPU DataType Eval(index_t y, index_t x) const {
+    return OP::Do(m_1.Eval(y, x), m_2.Eval(y, x), m_3.Eval(y, x));
+  }
+
+ private:
+  VectorizedJob<A_T, DataType, Arch> m_1;
+  VectorizedJob<B_T, DataType, Arch> m_2;
+  VectorizedJob<C_T, DataType, Arch> m_3;
+};
+
+/*!
+ *@brief      where(compare, a, b) blends by the mask of the compare itself, no 1 or 0 lanes are
+ * made and compared again.
+ */
+template<typename CmpOP, typename X_T, typename Y_T, exprType CEType, typename A_T, typename B_T,
+         exprType EType, typename DataType, vectorization::VecArch Arch>
+class VectorizedJob<
+    TernaryExpr<op::_where, BinaryExpr<CmpOP, X_T, Y_T, DataType, CEType>, A_T, B_T, DataType,
+                EType>,
+    DataType, Arch> {
+ public:
+  VectorizedJob(const VectorizedJob<BinaryExpr<CmpOP, X_T, Y_T, DataType, CEType>, DataType,
+                                    Arch>& cond,
+                const VectorizedJob<A_T, DataType, Arch>& a,
+                const VectorizedJob<B_T, DataType, Arch>& b)
+      : m_cond(cond), m_a(a), m_b(b) {}
+  MGLORIA_INLINE_CPU vectorization::Vectorized<DataType, Arch> EvalVec(index_t y, index_t x) const {
+    return vectorization::Vectorized<DataType, Arch>::Select(m_cond.MaskVec(y, x),
+                                                             m_a.EvalVec(y, x), m_b.EvalVec(y, x));
+  }
+  MGLORIA_INLINE_CPU vectorization::Vectorized<DataType, Arch> EvalVecUnAligned(index_t y,
+                                                                              index_t x) const {
+    return vectorization::Vectorized<DataType, Arch>::Select(m_cond.MaskVecUnAligned(y, x),
+                                                             m_a.EvalVecUnAligned(y, x),
+                                                             m_b.EvalVecUnAligned(y, x));
+  }
+  MGLORIA_INLINE_CPU vectorization::Vectorized<DataType, Arch> EvalVecMasked(index_t y, index_t x,
+                                                                           index_t n) const {
+    return vectorization::Vectorized<DataType, Arch>::Select(m_cond.MaskVecMasked(y, x, n),
+                                                             m_a.EvalVecMasked(y, x, n),
+                                                             m_b.EvalVecMasked(y, x, n));
+  }
+  MGLORIA_INLINE_CPU DataType Eval(index_t y, index_t x) const {
+    return op::_where::Do(m_cond.Eval(y, x), m_a.Eval(y, x), m_b.Eval(y, x));
+  }
+
+ private:
+  VectorizedJob<BinaryExpr<CmpOP, X_T, Y_T, DataType, CEType>, DataType, Arch> m_cond;
+  VectorizedJob<A_T, DataType, Arch> m_a;
+  VectorizedJob<B_T, DataType, Arch> m_b;
+};
+
+/*!
+ *@brief      The cast is one instruction if VectorizedCast has the two types (same lanes, e.g.
+ * float and int32_t). Or the lanes are cast one by one from the scalar Eval of the source.
+ */
+template<typename OriDataType, typename DisDataType, typename A_T, exprType EType,
+         vectorization::VecArch Arch>
+class VectorizedJob<TypeCastExpr<OriDataType, DisDataType, A_T, EType>, DisDataType, Arch> {
+  typedef vectorization::VectorizedCast<OriDataType, DisDataType, Arch> CastType;
+  typedef std::integral_constant<bool, CastType::m_Enable> CastTag;
+
+ public:
+  explicit VectorizedJob(const VectorizedJob<A_T, OriDataType, Arch>& src) : m_src(src) {}
+  MGLORIA_INLINE_CPU vectorization::Vectorized<DisDataType, Arch> EvalVec(index_t y,
+                                                                          index_t x) const {
+    return EvalVec(y, x, CastTag());
+  }
+  MGLORIA_INLINE_CPU vectorization::Vectorized<DisDataType, Arch> EvalVecUnAligned(
+      index_t y, index_t x) const {
+    return EvalVecUnAligned(y, x, CastTag());
+  }
+  MGLORIA_INLINE_CPU vectorization::Vectorized<DisDataType, Arch> EvalVecMasked(index_t y,
+                                                                                index_t x,
+                                                                                index_t n) const {
+    return EvalVecMasked(y, x, n, CastTag());
+  }
+  MGLORIA_INLINE_CPU DisDataType Eval(index_t y, index_t x) const {
+    return DisDataType(m_src.Eval(y, x));
+  }
+
+ private:
+  MGLORIA_INLINE_CPU vectorization::Vectorized<DisDataType, Arch> EvalVec(index_t y, index_t x,
+                                                                          std::true_type) const {
+    return CastType::Do(m_src.EvalVec(y, x));
+  }
+  MGLORIA_INLINE_CPU vectorization::Vectorized<DisDataType, Arch> EvalVec(index_t y, index_t x,
+                                                                          std::false_type) const {
+    return EvalLanes(y, x, vectorization::Vectorized<DisDataType, Arch>::num);
+  }
+  MGLORIA_INLINE_CPU vectorization::Vectorized<DisDataType, Arch> EvalVecUnAligned(
+      index_t y, index_t x, std::true_type) const {
+    return CastType::Do(m_src.EvalVecUnAligned(y, x));
+  }
+  MGLORIA_INLINE_CPU vectorization::Vectorized<DisDataType, Arch> EvalVecUnAligned(
+      index_t y, index_t x, std::false_type) const {
+    return EvalLanes(y, x, vectorization::Vectorized<DisDataType, Arch>::num);
+  }
+  MGLORIA_INLINE_CPU vectorization::Vectorized<DisDataType, Arch> EvalVecMasked(
+      index_t y, index_t x, index_t n, std::true_type) const {
+    return CastType::Do(m_src.EvalVecMasked(y, x, n));
+  }
+  MGLORIA_INLINE_CPU vectorization::Vectorized<DisDataType, Arch> EvalVecMasked(
+      index_t y, index_t x, index_t n, std::false_type) const {
+    return EvalLanes(y, x, n);
+  }
+  MGLORIA_INLINE_CPU vectorization::Vectorized<DisDataType, Arch> EvalLanes(index_t y, index_t x,
+                                                                            index_t n) const {
+    alignas(64) DisDataType __lanes__[vectorization::Vectorized<DisDataType, Arch>::num] = {};
+    for (index_t i = 0; i < n; ++i) { __lanes__[i] = DisDataType(m_src.Eval(y, x + i)); }
+    return vectorization::Vectorized<DisDataType, Arch>::Load(__lanes__);
+  }
+
+  VectorizedJob<A_T, OriDataType, Arch> m_src;
+};
+
+/*!
+ *@brief      The row y of the transposed is the column y of the source. Read lane by lane from the
+ * scalar Eval of the source, the specialization below gathers a tensor's column directly.
+ */
+template<typename E, typename DataType, vectorization::VecArch Arch>
+class VectorizedJob<TransposeExpr<E, DataType>, DataType, Arch> {
+ public:
+  explicit VectorizedJob(const VectorizedJob<E, DataType, Arch>& src) : m_src(src) {}
+  MGLORIA_INLINE_CPU vectorization::Vectorized<DataType, Arch> EvalVec(index_t y, index_t x) const {
+    return EvalVecMasked(y, x, vectorization::Vectorized<DataType, Arch>::num);
+  }
+  MGLORIA_INLINE_CPU vectorization::Vectorized<DataType, Arch> EvalVecUnAligned(index_t y,
+                                                                              index_t x) const {
+    return EvalVec(y, x);
+  }
+  MGLORIA_INLINE_CPU vectorization::Vectorized<DataType, Arch> EvalVecMasked(index_t y, index_t x,
+                                                                           index_t n) const {
+    alignas(64) DataType __lanes__[vectorization::Vectorized<DataType, Arch>::num] = {};
+    for (index_t i = 0; i < n; ++i) { __lanes__[i] = m_src.Eval(x + i, y); }
+    return vectorization::Vectorized<DataType, Arch>::Load(__lanes__);
+  }
+  ///! Note that I index the value by (x, y) and Eval is (y, x)
+  MGLORIA_INLINE_CPU DataType Eval(index_t y, index_t x) const { return m_src.Eval(x, y); }
+
+ private:
+  VectorizedJob<E, DataType, Arch> m_src;
+};
+
+template<typename Device, int Dims, typename DataType, vectorization::VecArch Arch>
+class VectorizedJob<TransposeExpr<Tensor<Device, Dims, DataType>, DataType>, DataType, Arch> {
+ public:
+  explicit VectorizedJob(const Tensor<Device, Dims, DataType>& t)
+      : __data_ptr(t.__data_ptr), m_Stride(t.m_Stride_) {}
+  MGLORIA_INLINE_CPU vectorization::Vectorized<DataType, Arch> EvalVec(index_t y, index_t x) const {
+    return vectorization::VectorizedGather<DataType, Arch>::Do(
+        &__data_ptr[x * m_Stride + y], m_Stride, vectorization::Vectorized<DataType, Arch>::num);
+  }
+  MGLORIA_INLINE_CPU vectorization::Vectorized<DataType, Arch> EvalVecUnAligned(index_t y,
+                                                                              index_t x) const {
+    return EvalVec(y, x);
+  }
+  MGLORIA_INLINE_CPU vectorization::Vectorized<DataType, Arch> EvalVecMasked(index_t y, index_t x,
+                                                                           index_t n) const {
+    return vectorization::VectorizedGather<DataType, Arch>::Do(&__data_ptr[x * m_Stride + y],
+                                                               m_Stride, n);
+  }
+  MGLORIA_INLINE_CPU DataType Eval(index_t y, index_t x) const {
+    return __data_ptr[x * m_Stride + y];
+  }
+
+ private:
+  DataType* __data_ptr;
+  index_t m_Stride;
+};
+
 /*!
  *@brief
  */
@@ -145,7 +415,7 @@ template<vectorization::VecArch Arch, typename OP, typename A_T, typename DataTy
 inline VectorizedJob<UnaryExpr<OP, A_T, DataType, EType>, DataType, Arch> NewVectorizedJob(
     const UnaryExpr<OP, A_T, DataType, EType>& e) {
   return VectorizedJob<UnaryExpr<OP, A_T, DataType, EType>, DataType, Arch>(
-      NewVectorizedJob<Arch>(e.m_src));
+      NewVectorizedJob<Arch>(e.m_entity));
 }
 
 /*!
@@ -159,6 +429,168 @@ inline VectorizedJob<BinaryExpr<OP, A_T, B_T, DataType, EType>, DataType, Arch>
       NewVectorizedJob<Arch>(e.m_lhs), NewVectorizedJob<Arch>(e.m_rhs));
 }
 
+/*!
+ *@brief
+ */
+template<vectorization::VecArch Arch, typename OP, typename A_T, typename B_T, typename C_T,
+         typename DataType, exprType EType>
+inline VectorizedJob<TernaryExpr<OP, A_T, B_T, C_T, DataType, EType>, DataType, Arch>
+NewVectorizedJob(const TernaryExpr<OP, A_T, B_T, C_T, DataType, EType>& e) {
+  return VectorizedJob<TernaryExpr<OP, A_T, B_T, C_T, DataType, EType>, DataType, Arch>(
+      NewVectorizedJob<Arch>(e.m_1), NewVectorizedJob<Arch>(e.m_2), NewVectorizedJob<Arch>(e.m_3));
+}
+
+/*!
+ *@brief
+ */
+template<vectorization::VecArch Arch, typename OriDataType, typename DisDataType, typename A_T,
+         exprType EType>
+inline VectorizedJob<TypeCastExpr<OriDataType, DisDataType, A_T, EType>, DisDataType, Arch>
+NewVectorizedJob(const TypeCastExpr<OriDataType, DisDataType, A_T, EType>& e) {
+  return VectorizedJob<TypeCastExpr<OriDataType, DisDataType, A_T, EType>, DisDataType, Arch>(
+      NewVectorizedJob<Arch>(e.m_expr));
+}
+
+/*!
+ *@brief
+ */
+template<vectorization::VecArch Arch, typename E, typename DataType>
+inline VectorizedJob<TransposeExpr<E, DataType>, DataType, Arch> NewVectorizedJob(
+    const TransposeExpr<E, DataType>& e) {
+  return VectorizedJob<TransposeExpr<E, DataType>, DataType, Arch>(
+      NewVectorizedJob<Arch>(e.m_expr));
+}
+
+template<vectorization::VecArch Arch, typename Device, int Dims, typename DataType>
+inline VectorizedJob<TransposeExpr<Tensor<Device, Dims, DataType>, DataType>, DataType, Arch>
+NewVectorizedJob(const TransposeExpr<Tensor<Device, Dims, DataType>, DataType>& e) {
+  return VectorizedJob<TransposeExpr<Tensor<Device, Dims, DataType>, DataType>, DataType, Arch>(
+      e.m_expr);
+}
+
+/*!
+ *@brief      Handle the columns [xlen, xend) of row y, which are less than one vector.
+ *@tparam     Masked true if the arch can do it with one masked vector op.
+ */
+template<bool Masked>
+struct VectorizedTailJob {
+  template<typename LeftValue, typename E, typename DataType, vectorization::VecArch Arch>
+  MGLORIA_INLINE_CPU static void Do(Tensor<CPU, 2, DataType>& dst,
+                                    const VectorizedJob<E, DataType, Arch>& plan, index_t y,
+                                    index_t xlen, index_t xend) {
+    for (index_t x = xlen; x < xend; ++x) { LeftValue::Do(dst[y][x], plan.Eval(y, x)); }
+  }
+};
+
+template<>
+struct VectorizedTailJob<true> {
+  template<typename LeftValue, typename E, typename DataType, vectorization::VecArch Arch>
+  MGLORIA_INLINE_CPU static void Do(Tensor<CPU, 2, DataType>& dst,
+                                    const VectorizedJob<E, DataType, Arch>& plan, index_t y,
+                                    index_t xlen, index_t xend) {
+    if (xlen == xend) return;
+    vectorization::VectorizedTailSaver<LeftValue, DataType, Arch>::Do(
+        &dst[y][xlen], plan.EvalVecMasked(y, xlen, xend - xlen), xend - xlen);
+  }
+};
+
+/*!
+ *@brief      Compute the row y of dst with the vectorized plan.
+ */
+template<typename LeftValue, typename E, typename DataType, vectorization::VecArch Arch>
+MGLORIA_INLINE_CPU void ExecuteVectorizedRow(Tensor<CPU, 2, DataType>& dst,
+                                             const VectorizedJob<E, DataType, Arch>& plan,
+                                             index_t y, index_t xlen) {
+  static_assert(Arch != vectorization::VecArch::NONE_Arch, "NONE_Arch has no vectors.");
+  const index_t vec_size = vectorization::Vectorized<DataType, Arch>::num;
+  // This pat is can be vectorized.
+  for (index_t x = 0; x < xlen; x += vec_size) {
+    vectorization::VectorizedSaver<LeftValue, DataType, Arch>::Do(&dst[y][x], plan.EvalVec(y, x));
+  }
+  // The left is less than one vector. Masked if the arch supports, or scalar.
+  VectorizedTailJob<vectorization::VectorizedTailSaver<LeftValue, DataType, Arch>::m_Enable>::
+      template Do<LeftValue>(dst, plan, y, xlen, dst.size(1));
+}
+
+/*!
+ *@brief      Compute the row y of dst, which may not start aligned. The head before the first
+ * aligned element of dst is peeled off and done like the tail, then the vectors are stored aligned
+ * and the expression is read with unaligned loads.
+ */
+template<typename LeftValue, typename E, typename DataType, vectorization::VecArch Arch>
+MGLORIA_INLINE_CPU void ExecuteVectorizedRowPeeled(Tensor<CPU, 2, DataType>& dst,
+                                                   const VectorizedJob<E, DataType, Arch>& plan,
+                                                   index_t y) {
+  static_assert(Arch != vectorization::VecArch::NONE_Arch, "NONE_Arch has no vectors.");
+  typedef VectorizedTailJob<
+      vectorization::VectorizedTailSaver<LeftValue, DataType, Arch>::m_Enable>
+      PeelJob;
+  const index_t vec_size = vectorization::Vectorized<DataType, Arch>::num;
+  const index_t xend = dst.size(1);
+  const index_t head = std::min(vectorization::PeelHead<Arch>(&dst[y][0]), xend);
+  const index_t xlen = head + (xend - head) / vec_size * vec_size;
+  PeelJob::template Do<LeftValue>(dst, plan, y, 0, head);
+  for (index_t x = head; x < xlen; x += vec_size) {
+    vectorization::VectorizedSaver<LeftValue, DataType, Arch>::Do(&dst[y][x],
+                                                                  plan.EvalVecUnAligned(y, x));
+  }
+  PeelJob::template Do<LeftValue>(dst, plan, y, xlen, xend);
+}
+
+/*!
+ *@brief      The root of one arch's kernel. With MGLORIA_RUNTIME_DISPATCH the AVX2/AVX-512
+ * versions are compiled for their arch, and all the code of the row is inlined into them.
+ */
+template<vectorization::VecArch Arch>
+struct VectorizedRowKernel {
+  template<typename LeftValue, typename E, typename DataType>
+  MGLORIA_INLINE_CPU static void Do(Tensor<CPU, 2, DataType>& dst,
+                                    const VectorizedJob<E, DataType, Arch>& plan, index_t y,
+                                    index_t xlen) {
+    ExecuteVectorizedRow<LeftValue>(dst, plan, y, xlen);
+  }
+  template<typename LeftValue, typename E, typename DataType>
+  MGLORIA_INLINE_CPU static void DoPeeled(Tensor<CPU, 2, DataType>& dst,
+                                          const VectorizedJob<E, DataType, Arch>& plan,
+                                          index_t y) {
+    ExecuteVectorizedRowPeeled<LeftValue>(dst, plan, y);
+  }
+};
+
+template<>
+struct VectorizedRowKernel<vectorization::VecArch::AVX2_Arch> {
+  template<typename LeftValue, typename E, typename DataType>
+  MGLORIA_KERNEL_AVX2 static void Do(
+      Tensor<CPU, 2, DataType>& dst,
+      const VectorizedJob<E, DataType, vectorization::VecArch::AVX2_Arch>& plan, index_t y,
+      index_t xlen) {
+    ExecuteVectorizedRow<LeftValue>(dst, plan, y, xlen);
+  }
+  template<typename LeftValue, typename E, typename DataType>
+  MGLORIA_KERNEL_AVX2 static void DoPeeled(
+      Tensor<CPU, 2, DataType>& dst,
+      const VectorizedJob<E, DataType, vectorization::VecArch::AVX2_Arch>& plan, index_t y) {
+    ExecuteVectorizedRowPeeled<LeftValue>(dst, plan, y);
+  }
+};
+
+template<>
+struct VectorizedRowKernel<vectorization::VecArch::AVX512_Arch> {
+  template<typename LeftValue, typename E, typename DataType>
+  MGLORIA_KERNEL_AVX512 static void Do(
+      Tensor<CPU, 2, DataType>& dst,
+      const VectorizedJob<E, DataType, vectorization::VecArch::AVX512_Arch>& plan, index_t y,
+      index_t xlen) {
+    ExecuteVectorizedRow<LeftValue>(dst, plan, y, xlen);
+  }
+  template<typename LeftValue, typename E, typename DataType>
+  MGLORIA_KERNEL_AVX512 static void DoPeeled(
+      Tensor<CPU, 2, DataType>& dst,
+      const VectorizedJob<E, DataType, vectorization::VecArch::AVX512_Arch>& plan, index_t y) {
+    ExecuteVectorizedRowPeeled<LeftValue>(dst, plan, y);
+  }
+};
+
 /*!
  *@brief
  */
@@ -167,24 +599,30 @@ MGLORIA_INLINE_NORMAL void ExecuteVectorizedJob(Tensor<CPU, Dims, DataType> _dst
                                                 const VectorizedJob<E, DataType, Arch>& plan) {
   Tensor<CPU, 2, DataType> dst = _dst.Flatten2D();
   const index_t xlen = vectorization::FloorAlign<Arch, DataType>(dst.size(1));
-  const size_t vec_size = vectorization::Vectorized<DataType, Arch>::num;
 
-  // LOG << "------------------- DEBUG LLVM ---------------------------------\n";
-  // LOG << dst.m_Shape.str();
-  // LOG << xlen << std::endl;
-  // LOG << vec_size << std::endl;
-  // LOG << "------------------- DEBUG LLVM ---------------------------------\n";
+#ifndef __CUDACC__
+#pragma omp parallel for
+#endif
+  for (openmp_index_t y = 0; y < dst.size(0); ++y) {
+    VectorizedRowKernel<Arch>::template Do<LeftValue>(dst, plan, y, xlen);
+  }
+}
+
+/*!
+ *@brief      The same as ExecuteVectorizedJob, for the tensors not aligned for Arch, e.g. a slice
+ * or a buffer from the user. Each row of dst is peeled to be stored aligned.
+ *@note       The data of dst must be aligned to sizeof(DataType), see vectorization::PeelHead.
+ */
+template<typename LeftValue, typename E, int Dims, typename DataType, vectorization::VecArch Arch>
+MGLORIA_INLINE_NORMAL void ExecuteVectorizedJobPeeled(
+    Tensor<CPU, Dims, DataType> _dst, const VectorizedJob<E, DataType, Arch>& plan) {
+  Tensor<CPU, 2, DataType> dst = _dst.Flatten2D();
 
 #ifndef __CUDACC__
 #pragma omp parallel for
 #endif
   for (openmp_index_t y = 0; y < dst.size(0); ++y) {
-    // This pat is can be vectorized.
-    for (index_t x = 0; x < xlen; x += vec_size) {
-      vectorization::VectorizedSaver<LeftValue, DataType, Arch>::Do(&dst[y][x], plan.EvalVec(y, x));
-    }
-    // The left can not be vectorized.
-    for (index_t x = xlen; x < dst.size(1); ++x) { LeftValue::Do(dst[y][x], plan.Eval(y, x)); }
+    VectorizedRowKernel<Arch>::template DoPeeled<LeftValue>(dst, plan, y);
   }
 }
 }  // namespace expr
@@ -195,14 +633,30 @@ struct VecCheck {
   static const bool m_Enable = MGLORIA_VECTORIZATION_FALSE;
 };
 
+///! The element types with vectors. NONE_Arch has no Vectorized, nothing is vectorized for it.
 template<vectorization::VecArch Arch>
 struct VecCheck<float, Arch> {
-  static const bool m_Enable = MGLORIA_VECTORIZATION_TRUE;
+  static const bool m_Enable = Arch != vectorization::VecArch::NONE_Arch;
 };
 
 template<vectorization::VecArch Arch>
 struct VecCheck<double, Arch> {
-  static const bool m_Enable = MGLORIA_VECTORIZATION_TRUE;
+  static const bool m_Enable = Arch != vectorization::VecArch::NONE_Arch;
+};
+
+template<vectorization::VecArch Arch>
+struct VecCheck<int32_t, Arch> {
+  static const bool m_Enable = Arch != vectorization::VecArch::NONE_Arch;
+};
+
+template<vectorization::VecArch Arch>
+struct VecCheck<int8_t, Arch> {
+  static const bool m_Enable = Arch != vectorization::VecArch::NONE_Arch;
+};
+
+template<vectorization::VecArch Arch>
+struct VecCheck<uint8_t, Arch> {
+  static const bool m_Enable = Arch != vectorization::VecArch::NONE_Arch;
 };
 
 template<typename DataType, vectorization::VecArch Arch>
@@ -229,6 +683,36 @@ struct VecCheck<expr::BinaryExpr<OP, A_T, B_T, DataType, EType>, Arch> {
                                && VecCheck<A_T, Arch>::m_Enable && VecCheck<B_T, Arch>::m_Enable;
 };
 
+template<typename OP, typename A_T, typename B_T, typename C_T, typename DataType,
+         expr::exprType EType, vectorization::VecArch Arch>
+struct VecCheck<expr::TernaryExpr<OP, A_T, B_T, C_T, DataType, EType>, Arch> {
+  static const bool m_Enable = vectorization::VectorizedOP<OP, DataType, Arch>::m_Enable
+                               && VecCheck<A_T, Arch>::m_Enable && VecCheck<B_T, Arch>::m_Enable
+                               && VecCheck<C_T, Arch>::m_Enable;
+};
+
+template<typename OriDataType, typename DisDataType, typename A_T, expr::exprType EType,
+         vectorization::VecArch Arch>
+struct VecCheck<expr::TypeCastExpr<OriDataType, DisDataType, A_T, EType>, Arch> {
+  static const bool m_Enable =
+      VecCheck<DisDataType, Arch>::m_Enable && VecCheck<A_T, Arch>::m_Enable;
+};
+
+template<typename E, typename DataType, vectorization::VecArch Arch>
+struct VecCheck<expr::TransposeExpr<E, DataType>, Arch> {
+  static const bool m_Enable = VecCheck<DataType, Arch>::m_Enable && VecCheck<E, Arch>::m_Enable;
+};
+
+/*!
+ *@brief    The expression and the saver (e.g. /= on integers can not) both need to be vectorized.
+ */
+template<typename Saver, typename E, typename DataType, vectorization::VecArch Arch>
+struct VecSaveCheck {
+  static const bool m_Enable =
+      VecCheck<E, Arch>::m_Enable
+      && vectorization::VectorizedOP<typename Saver::OPType, DataType, Arch>::m_Enable;
+};
+
 // ############################### Below for check Data is ok for Vec ########################
 template<int Dims, typename E, vectorization::VecArch Arch>
 struct VecDataAlignCheck {
@@ -265,6 +749,30 @@ struct VecDataAlignCheck<Dims, expr::BinaryExpr<OP, A_T, B_T, DataType, EType>,
   }
 };
 
+template<int Dims, typename OP, typename A_T, typename B_T, typename C_T, typename DataType,
+         expr::exprType EType, vectorization::VecArch Arch>
+struct VecDataAlignCheck<Dims, expr::TernaryExpr<OP, A_T, B_T, C_T, DataType, EType>, Arch> {
+  inline static bool _check(const expr::TernaryExpr<OP, A_T, B_T, C_T, DataType, EType>& t) {
+    return VecDataAlignCheck<Dims, A_T, Arch>::_check(t.m_1)
+           && VecDataAlignCheck<Dims, B_T, Arch>::_check(t.m_2)
+           && VecDataAlignCheck<Dims, C_T, Arch>::_check(t.m_3);
+  }
+};
+
+template<int Dims, typename OriDataType, typename DisDataType, typename A_T, expr::exprType EType,
+         vectorization::VecArch Arch>
+struct VecDataAlignCheck<Dims, expr::TypeCastExpr<OriDataType, DisDataType, A_T, EType>, Arch> {
+  inline static bool _check(const expr::TypeCastExpr<OriDataType, DisDataType, A_T, EType>& t) {
+    return VecDataAlignCheck<Dims, A_T, Arch>::_check(t.m_expr);
+  }
+};
+
+///! The transposed is read by gather or lane by lane, any alignment is fine.
+template<int Dims, typename E, typename DataType, vectorization::VecArch Arch>
+struct VecDataAlignCheck<Dims, expr::TransposeExpr<E, DataType>, Arch> {
+  inline static bool _check(const expr::TransposeExpr<E, DataType>&) { return true; }
+};
+
 }  // namespace mgloria
 
 #endif
\ No newline at end of file
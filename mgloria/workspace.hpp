@@ -0,0 +1,212 @@
+/*!
+ *@author   chenghua.wang
+ *@file     workspace.hpp
+ *@brief    The workspace of a CPU stream: a bump pointer arena the kernels take their scratch
+ * memory from, the packed panels of a gemm, the partials of a reduce, the tiles of a conv.
+ *@details  Taking memory is moving a pointer, giving it back is moving it back to a mark: the
+ * memory is taken and given back in LIFO order, by WorkspaceScope. When a chunk is full the next
+ * one is at least twice as large, and once everything is given back the chunks are merged into
+ * one as large as them all. The second step of a training loop then runs in a single chunk, with
+ * no allocation at all.
+ *@note     The workspace of a stream is for the host thread that runs the stream. A scope taken
+ * inside a parallel region, or with no stream, takes its memory from the host pool instead.
+ */
+
+#ifndef _MGLORIA_WORKSPACE_HPP_
+#define _MGLORIA_WORKSPACE_HPP_
+
+#pragma once
+
+#include <vector>
+#include "memory_pool.hpp"
+#include "tensor_stream.hpp"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace mgloria {
+
+/*!
+ *@brief    Where a workspace was, to go back to.
+ */
+struct WorkspaceMark {
+  size_t m_chunk;   ///! The chunk taken from.
+  size_t m_offset;  ///! The bytes taken of it.
+};
+
+/*!
+ *@brief    The counters of a workspace.
+ */
+struct WorkspaceStats {
+  size_t m_capacity;  ///! Held by all the chunks.
+  size_t m_used;      ///! Taken now, with the ends of the chunks skipped.
+  size_t m_peak;      ///! The most m_used has been.
+  size_t m_chunks;    ///! Number of chunks.
+  size_t m_grows;     ///! Chunks allocated, merges included.
+};
+
+class Workspace {
+ public:
+  static const size_t ms_Align = 64;
+
+  Workspace() : m_chunk(0), m_offset(0), m_base(0), m_peak(0), m_grows(0) {}
+
+  ~Workspace() {
+    for (const Chunk& c : m_chunks) { HostPoolFree(c.m_data); }
+  }
+
+  Workspace(const Workspace&) = delete;
+  Workspace& operator=(const Workspace&) = delete;
+
+  ///! bytes of scratch memory aligned to ms_Align, valid until the mark before it is released.
+  MGLORIA_INLINE_NORMAL void* Alloc(size_t bytes) {
+    bytes = (bytes + ms_Align - 1) / ms_Align * ms_Align;
+    while (m_chunk < m_chunks.size() && m_offset + bytes > m_chunks[m_chunk].m_size) {
+      // The end of a chunk too small is skipped until the mark before it is released.
+      m_base += m_chunks[m_chunk].m_size;
+      ++m_chunk;
+      m_offset = 0;
+    }
+    if (m_chunk == m_chunks.size()) {
+      const size_t __last__ = m_chunks.empty() ? 0 : m_chunks.back().m_size;
+      size_t __size__ = __last__ * 2 > size_t(MGLORIA_WORKSPACE_CHUNK)
+                            ? __last__ * 2
+                            : size_t(MGLORIA_WORKSPACE_CHUNK);
+      Grow(__size__ > bytes ? __size__ : bytes);
+    }
+    char* __ptr__ = m_chunks[m_chunk].m_data + m_offset;
+    m_offset += bytes;
+    if (m_base + m_offset > m_peak) { m_peak = m_base + m_offset; }
+    return __ptr__;
+  }
+
+  ///! As MallocAlignedPitch: lines of line_bytes, each padded to the vector alignment.
+  MGLORIA_INLINE_NORMAL void* AllocPitch(size_t* pitch, size_t line_bytes, size_t lines) {
+    const size_t masked =
+        (size_t(1) << vectorization::AlignBytes<MGLORIA_VECTORIZATION_ALIGN_ARCH>::Default) - 1;
+    *pitch = (line_bytes + masked) & ~masked;
+    return Alloc(*pitch * lines);
+  }
+
+  MGLORIA_INLINE_NORMAL WorkspaceMark Mark() const { return WorkspaceMark{m_chunk, m_offset}; }
+
+  ///! Gives back all that was taken since the mark. The marks after it are not valid any more.
+  MGLORIA_INLINE_NORMAL void Release(const WorkspaceMark& mark) {
+    LOG_CHECK(mark.m_chunk < m_chunk || (mark.m_chunk == m_chunk && mark.m_offset <= m_offset),
+              " Workspace: released out of order, mark=(", mark.m_chunk, ", ", mark.m_offset,
+              ") now=(", m_chunk, ", ", m_offset, ")");
+    for (size_t c = mark.m_chunk; c < m_chunk; ++c) { m_base -= m_chunks[c].m_size; }
+    m_chunk = mark.m_chunk;
+    m_offset = mark.m_offset;
+    if (m_chunk == 0 && m_offset == 0 && m_chunks.size() > 1) {
+      // All given back: one chunk holds what took several, without the ends skipped.
+      const size_t __size__ = Capacity();
+      Trim();
+      Grow(__size__);
+    }
+  }
+
+  ///! Gives back everything taken.
+  MGLORIA_INLINE_NORMAL void Reset() { Release(WorkspaceMark{0, 0}); }
+
+  ///! Gives the chunks back to the host pool. Only when nothing is taken.
+  MGLORIA_INLINE_NORMAL void Trim() {
+    LOG_CHECK(m_chunk == 0 && m_offset == 0, " Workspace: trimmed while ", m_base + m_offset,
+              " bytes are taken");
+    for (const Chunk& c : m_chunks) { HostPoolFree(c.m_data); }
+    m_chunks.clear();
+  }
+
+  MGLORIA_INLINE_NORMAL WorkspaceStats Stats() const {
+    return WorkspaceStats{Capacity(), m_base + m_offset, m_peak, m_chunks.size(), m_grows};
+  }
+
+  MGLORIA_INLINE_NORMAL void ResetPeak() { m_peak = m_base + m_offset; }
+
+ private:
+  struct Chunk {
+    char* m_data;
+    size_t m_size;
+  };
+
+  MGLORIA_INLINE_NORMAL size_t Capacity() const {
+    size_t __size__ = 0;
+    for (const Chunk& c : m_chunks) { __size__ += c.m_size; }
+    return __size__;
+  }
+
+  MGLORIA_INLINE_NORMAL void Grow(size_t bytes) {
+    size_t __pitch__;
+    char* __data__ = static_cast<char*>(HostPoolMallocPitch(&__pitch__, bytes, 1));
+    m_chunks.push_back(Chunk{__data__, bytes});
+    ++m_grows;
+  }
+
+  std::vector<Chunk> m_chunks;
+  size_t m_chunk;   ///! The chunk taken from now.
+  size_t m_offset;  ///! The bytes taken of it.
+  size_t m_base;    ///! The bytes of the chunks before it.
+  size_t m_peak;
+  size_t m_grows;
+};
+
+/*!
+ *@brief    The stream of CPU. The kernels run on it take their scratch memory from its workspace.
+ */
+template<>
+struct Stream<CPU> {
+  MGLORIA_INLINE_NORMAL void Wait() {}
+  MGLORIA_INLINE_NORMAL bool IsIdle() { return true; }
+  MGLORIA_INLINE_NORMAL void CreateBlasHandle() {}
+  MGLORIA_INLINE_NORMAL Workspace& GetWorkspace() { return m_workspace; }
+
+  Workspace m_workspace;
+};
+
+/*!
+ *@brief    The scratch memory of a kernel, given back when the scope ends.
+ *@example  WorkspaceScope __ws__(dst.m_Stream);
+ *          float* __buf__ = __ws__.Alloc<float>(n);
+ */
+class WorkspaceScope {
+ public:
+  explicit WorkspaceScope(Stream<CPU>* stream) : m_ws(nullptr), m_mark{0, 0} {
+    bool __serial__ = true;
+#ifdef _OPENMP
+    __serial__ = !omp_in_parallel();
+#endif
+    if (stream != nullptr && __serial__) {
+      m_ws = &stream->m_workspace;
+      m_mark = m_ws->Mark();
+    }
+  }
+
+  ~WorkspaceScope() {
+    if (m_ws != nullptr) { m_ws->Release(m_mark); }
+    for (void* p : m_heap) { HostPoolFree(p); }
+  }
+
+  WorkspaceScope(const WorkspaceScope&) = delete;
+  WorkspaceScope& operator=(const WorkspaceScope&) = delete;
+
+  template<typename DataType>
+  MGLORIA_INLINE_NORMAL DataType* Alloc(size_t n) {
+    size_t __pitch__;
+    return static_cast<DataType*>(AllocPitch(&__pitch__, sizeof(DataType) * n, 1));
+  }
+
+  MGLORIA_INLINE_NORMAL void* AllocPitch(size_t* pitch, size_t line_bytes, size_t lines) {
+    if (m_ws != nullptr) { return m_ws->AllocPitch(pitch, line_bytes, lines); }
+    m_heap.push_back(HostPoolMallocPitch(pitch, line_bytes, lines));
+    return m_heap.back();
+  }
+
+ private:
+  Workspace* m_ws;
+  WorkspaceMark m_mark;
+  std::vector<void*> m_heap;
+};
+
+}  // namespace mgloria
+
+#endif  // _MGLORIA_WORKSPACE_HPP_
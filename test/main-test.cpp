@@ -2,6 +2,12 @@
 // the compile_command.json for clangd enable.
 #define TEST_TENSOR_SHAPE 0
 #define TEST_TENSOR_BASIC_OP 1
+#define TEST_TENSOR_VECTORIZATION 1
+#define TEST_TENSOR_REDUCE 1
+#define TEST_TENSOR_DOT 1
+#define TEST_TENSOR_CONV 1
+#define TEST_TENSOR_MEMORY 1
+#define TEST_TENSOR_IO 1
 
 #if TEST_TENSOR_SHAPE == 1
 #include "tensor/shape_test.hpp"
@@ -9,6 +15,24 @@
 #if TEST_TENSOR_BASIC_OP == 1
 #include "tensor/basic_op_test.hpp"
 #endif
+#if TEST_TENSOR_VECTORIZATION == 1
+#include "tensor/vectorization_test.hpp"
+#endif
+#if TEST_TENSOR_REDUCE == 1
+#include "tensor/reduce_test.hpp"
+#endif
+#if TEST_TENSOR_DOT == 1
+#include "tensor/dot_test.hpp"
+#endif
+#if TEST_TENSOR_CONV == 1
+#include "tensor/conv_test.hpp"
+#endif
+#if TEST_TENSOR_MEMORY == 1
+#include "tensor/memory_test.hpp"
+#endif
+#if TEST_TENSOR_IO == 1
+#include "tensor/io_test.hpp"
+#endif
 
 int main() {
   LOG << "Starting tests for MGloria project.\n";
@@ -17,6 +41,24 @@ int main() {
 #endif
 #if TEST_TENSOR_BASIC_OP == 1
   __test_tensor_basic_OP__();
+#endif
+#if TEST_TENSOR_VECTORIZATION == 1
+  __test_tensor_vectorization__();
+#endif
+#if TEST_TENSOR_REDUCE == 1
+  __test_tensor_reduce__();
+#endif
+#if TEST_TENSOR_DOT == 1
+  __test_tensor_dot__();
+#endif
+#if TEST_TENSOR_CONV == 1
+  __test_tensor_conv__();
+#endif
+#if TEST_TENSOR_MEMORY == 1
+  __test_tensor_memory__();
+#endif
+#if TEST_TENSOR_IO == 1
+  __test_tensor_io__();
 #endif
   return 0;
 }
\ No newline at end of file
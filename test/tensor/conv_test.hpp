@@ -0,0 +1,186 @@
+#include "core.hpp"
+#include <cmath>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+template<typename DataType>
+inline DataType& __conv_at__(const mgloria::Tensor<mgloria::CPU, 4, DataType>& T, int i0, int i1,
+                             int i2, int i3) {
+  return T.__data_ptr[((i0 * T.size(1) + i1) * T.size(2) + i2) * T.m_Stride_ + i3];
+}
+
+///! The element (d0, c, h, w) of T in Layout, for the input, the weight and the dst alike.
+template<mgloria::LayoutTypeType Layout, typename DataType>
+inline DataType& __conv_elem__(const mgloria::Tensor<mgloria::CPU, 4, DataType>& T, int d0, int c,
+                               int h, int w) {
+  return Layout == mgloria::LayoutTypeType::BHWC ? __conv_at__(T, d0, h, w, c)
+                                                 : __conv_at__(T, d0, c, h, w);
+}
+
+template<typename DataType>
+inline void __fill_conv_pattern__(mgloria::Tensor<mgloria::CPU, 4, DataType> T, int seed) {
+  using namespace mgloria;
+  for (index_t i = 0; i < T.size(0) * T.size(1) * T.size(2); ++i) {
+    for (index_t j = 0; j < T.size(3); ++j) {
+      T.__data_ptr[i * T.m_Stride_ + j] = DataType(((i * 5 + j * 3 + seed) % 7) - 3);
+    }
+  }
+}
+
+/*!
+ *@brief    conv2d(X, Wt) at (b, o, oh, ow), with double. mag is the sum of the |x * w|.
+ */
+template<mgloria::LayoutTypeType Layout, typename DataType>
+inline double __conv_ref__(const mgloria::Tensor<mgloria::CPU, 4, DataType>& X,
+                           const mgloria::Tensor<mgloria::CPU, 4, DataType>& Wt,
+                           const mgloria::Conv2dParam& p, int b, int o, int oh, int ow,
+                           double* mag) {
+  using namespace mgloria;
+  const bool hwc = Layout == LayoutTypeType::BHWC;
+  const index_t H = hwc ? X.size(1) : X.size(2), W = hwc ? X.size(2) : X.size(3);
+  const index_t Cg = hwc ? Wt.size(3) : Wt.size(1);
+  const index_t KH = hwc ? Wt.size(1) : Wt.size(2), KW = hwc ? Wt.size(2) : Wt.size(3);
+  const index_t g = o / (Wt.size(0) / p.m_groups);
+  double __sum__ = 0;
+  *mag = 0;
+  for (index_t c = 0; c < Cg; ++c) {
+    for (index_t kh = 0; kh < KH; ++kh) {
+      for (index_t kw = 0; kw < KW; ++kw) {
+        const index_t ih = oh * p.m_stride_h - p.m_pad_h + kh * p.m_dilation_h;
+        const index_t iw = ow * p.m_stride_w - p.m_pad_w + kw * p.m_dilation_w;
+        if (ih < 0 || ih >= H || iw < 0 || iw >= W) { continue; }
+        const double __xw__ = double(__conv_elem__<Layout>(X, b, g * Cg + c, ih, iw))
+                              * double(__conv_elem__<Layout>(Wt, o, c, kh, kw));
+        __sum__ += __xw__;
+        *mag += std::fabs(__xw__);
+      }
+    }
+  }
+  return __sum__;
+}
+
+/*!
+ *@brief    =, += and *= of conv2d on a [B, C, H, W] input and Cout KH x KW filters in Layout.
+ * *= is not split over K, with a K over one KC it goes through a buffer. The pattern is small
+ * integers, so the results are exact with tol 0. Else they are within tol of the sum of the
+ * |x * w|, for the Winograd path. The weight is then filled again and conv2d run once more, the
+ * transformed weight must not be the one of before.
+ */
+template<typename DataType, mgloria::LayoutTypeType Layout>
+inline void __test_conv_shape__(mgloria::Stream<mgloria::CPU>* __stream__, mgloria::index_t B,
+                                mgloria::index_t C, mgloria::index_t H, mgloria::index_t W,
+                                mgloria::index_t Cout, mgloria::index_t KH, mgloria::index_t KW,
+                                const mgloria::Conv2dParam& p, bool pad, double tol = 0) {
+  using namespace mgloria;
+  const bool hwc = Layout == LayoutTypeType::BHWC;
+  const index_t Cg = C / p.m_groups;
+  const Shape<4> xs = hwc ? makeShape4d(B, H, W, C) : makeShape4d(B, C, H, W);
+  const Shape<4> ws = hwc ? makeShape4d(Cout, KH, KW, Cg) : makeShape4d(Cout, Cg, KH, KW);
+  const Shape<4> ys = Conv2dShape(xs, ws, p, Layout);
+  Tensor<CPU, 4, DataType> X = NewTensor(xs, false, DataType(0), pad, __stream__);
+  Tensor<CPU, 4, DataType> Wt = NewTensor(ws, false, DataType(0), pad, __stream__);
+  Tensor<CPU, 4, DataType> Y = NewTensor(ys, false, DataType(0), pad, __stream__);
+  Tensor<CPU, 4, DataType> Y0 = NewTensor(ys, false, DataType(0), false, __stream__);
+  __fill_conv_pattern__(X, 1);
+  __fill_conv_pattern__(Wt, 4);
+  __fill_conv_pattern__(Y0, 2);
+  const index_t OH = hwc ? ys[1] : ys[2], OW = hwc ? ys[2] : ys[3];
+
+  for (int s = 0; s < 4; ++s) {
+    for (index_t b = 0; b < B; ++b) {
+      for (index_t o = 0; o < Cout; ++o) {
+        for (index_t y = 0; y < OH; ++y) {
+          for (index_t x = 0; x < OW; ++x) {
+            __conv_elem__<Layout>(Y, b, o, y, x) = __conv_elem__<Layout>(Y0, b, o, y, x);
+          }
+        }
+      }
+    }
+    switch (s) {
+      case 0: Y = expr::conv2d<Layout>(X, Wt, p); break;
+      case 1: Y += expr::conv2d<Layout>(X, Wt, p); break;
+      case 2: Y *= expr::conv2d<Layout>(X, Wt, p); break;
+      default:
+        __fill_conv_pattern__(Wt, 5);
+        Y = expr::conv2d<Layout>(X, Wt, p);
+        break;
+    }
+    for (index_t b = 0; b < B; ++b) {
+      for (index_t o = 0; o < Cout; ++o) {
+        for (index_t y = 0; y < OH; ++y) {
+          for (index_t x = 0; x < OW; ++x) {
+            double mag;
+            const double r = __conv_ref__<Layout>(X, Wt, p, b, o, y, x, &mag);
+            const double y0 = double(__conv_elem__<Layout>(Y0, b, o, y, x));
+            const double want = s == 1 ? y0 + r : (s == 2 ? y0 * r : r);
+            const double got = double(__conv_elem__<Layout>(Y, b, o, y, x));
+            CHECK_EQUAL(std::fabs(got - want) <= tol * (s == 2 ? std::fabs(y0) * mag : mag), true,
+                        " conv2d layout=", int(Layout), " saver=", s, " at (", b, ", ", o, ", ",
+                        y, ", ", x, ") got=", got, " want=", want);
+          }
+        }
+      }
+    }
+  }
+  expr::ReleaseWinogradFilter(Wt);
+  DeleteTensor(&X);
+  DeleteTensor(&Wt);
+  DeleteTensor(&Y);
+  DeleteTensor(&Y0);
+}
+
+template<mgloria::LayoutTypeType Layout>
+inline void __test_conv_layout__(mgloria::Stream<mgloria::CPU>* __stream__) {
+  using namespace mgloria;
+  // 3x3 same, strided and dilated groups, 1x1, depthwise and a K over one KC, none of them
+  // Winograd.
+  __test_conv_shape__<float, Layout>(__stream__, 2, 3, 7, 7, 5, 3, 3, Conv2dParam(1, 1), false);
+  __test_conv_shape__<float, Layout>(__stream__, 1, 4, 9, 11, 6, 3, 2, Conv2dParam(2, 0, 2, 2),
+                                     true);
+  __test_conv_shape__<float, Layout>(__stream__, 2, 70, 5, 6, 33, 1, 1, Conv2dParam(), true);
+  __test_conv_shape__<float, Layout>(__stream__, 1, 8, 10, 9, 8, 3, 3, Conv2dParam(1, 1, 1, 8),
+                                     false);
+  __test_conv_shape__<float, Layout>(__stream__, 2, 64, 6, 5, 20, 3, 3, Conv2dParam(1, 2, 2),
+                                     true);
+  Conv2dParam __p__(1, 1);
+  __p__.m_stride_w = 3;
+  __p__.m_pad_h = 0;
+  __test_conv_shape__<double, Layout>(__stream__, 2, 5, 6, 13, 7, 2, 3, __p__, false);
+  __test_conv_shape__<int32_t, Layout>(__stream__, 3, 6, 8, 8, 18, 3, 3, Conv2dParam(1, 1, 1, 2),
+                                       true);
+  // Winograd: same and valid, groups, and an image of several chunks of tiles.
+  __test_conv_shape__<float, Layout>(__stream__, 1, 16, 9, 11, 16, 3, 3, Conv2dParam(1, 1), false,
+                                     1e-5);
+  __test_conv_shape__<float, Layout>(__stream__, 2, 32, 8, 8, 24, 3, 3, Conv2dParam(1, 0), true,
+                                     1e-5);
+  __test_conv_shape__<float, Layout>(__stream__, 1, 64, 12, 7, 48, 3, 3, Conv2dParam(1, 1, 1, 2),
+                                     false, 1e-5);
+  __test_conv_shape__<float, Layout>(__stream__, 1, 16, 40, 37, 16, 3, 3, Conv2dParam(1, 1), true,
+                                     1e-5);
+}
+
+inline void __test_conv_all_shapes__(mgloria::Stream<mgloria::CPU>* __stream__) {
+  __test_conv_layout__<mgloria::LayoutTypeType::BCHW>(__stream__);
+  __test_conv_layout__<mgloria::LayoutTypeType::BHWC>(__stream__);
+}
+
+inline void __test_tensor_conv__() {
+  using namespace mgloria;
+  LOG << "-------- Starting test [Tensor][Conv] \n";
+  auto __stream__ = NewStream<CPU>(0);
+#if MGLORIA_RUNTIME_DISPATCH == 1
+  const vectorization::VecArch __saved__ = vectorization::RuntimeVecArch();
+  const vectorization::VecArch __detected__ = vectorization::DetectVecArch();
+  for (int a = 0; a <= static_cast<int>(__detected__); ++a) {
+    vectorization::SetRuntimeVecArch(static_cast<vectorization::VecArch>(a));
+    LOG << "Conv with " << vectorization::VecArchName(vectorization::RuntimeVecArch()) << "\n";
+    __test_conv_all_shapes__(__stream__);
+  }
+  vectorization::SetRuntimeVecArch(__saved__);
+#else
+  __test_conv_all_shapes__(__stream__);
+#endif
+  FreeStream(__stream__);
+  LOG << "-------- Successfully tested [Tensor][Conv] \n";
+}
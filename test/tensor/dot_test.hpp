@@ -0,0 +1,591 @@
+#include "core.hpp"
+#include <cstdio>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+template<typename DataType>
+inline void __fill_dot_pattern__(mgloria::Tensor<mgloria::CPU, 2, DataType> T, int seed) {
+  using namespace mgloria;
+  for (index_t y = 0; y < T.size(0); ++y) {
+    for (index_t x = 0; x < T.size(1); ++x) {
+      T.__data_ptr[y * T.m_Stride_ + x] = DataType(((y * 7 + x * 5 + seed) % 13) - 6);
+    }
+  }
+}
+
+/*!
+ *@brief    scale * op(L) * op(R) at (i, j), with double.
+ */
+template<typename DataType>
+inline double __dot_ref__(const mgloria::Tensor<mgloria::CPU, 2, DataType>& L,
+                          const mgloria::Tensor<mgloria::CPU, 2, DataType>& R, bool lt, bool rt,
+                          int i, int j, double scale) {
+  using namespace mgloria;
+  const index_t K = lt ? L.size(0) : L.size(1);
+  double __sum__ = 0;
+  for (index_t k = 0; k < K; ++k) {
+    double l = lt ? L.__data_ptr[k * L.m_Stride_ + i] : L.__data_ptr[i * L.m_Stride_ + k];
+    double r = rt ? R.__data_ptr[j * R.m_Stride_ + k] : R.__data_ptr[k * R.m_Stride_ + j];
+    __sum__ += l * r;
+  }
+  return __sum__ * scale;
+}
+
+/*!
+ *@brief    All the transposes of [M, K] x [K, N], with =, += and -=, a scale and *= that is not
+ * split over K. The pattern is small integers, so the float results are exact.
+ */
+template<typename DataType>
+inline void __test_dot_shape__(mgloria::Stream<mgloria::CPU>* __stream__, mgloria::index_t M,
+                               mgloria::index_t K, mgloria::index_t N, bool pad) {
+  using namespace mgloria;
+  Tensor<CPU, 2, DataType> L = NewTensor(makeShape2d(M, K), false, DataType(0), pad, __stream__);
+  Tensor<CPU, 2, DataType> LT = NewTensor(makeShape2d(K, M), false, DataType(0), pad, __stream__);
+  Tensor<CPU, 2, DataType> R = NewTensor(makeShape2d(K, N), false, DataType(0), pad, __stream__);
+  Tensor<CPU, 2, DataType> RT = NewTensor(makeShape2d(N, K), false, DataType(0), pad, __stream__);
+  Tensor<CPU, 2, DataType> C = NewTensor(makeShape2d(M, N), false, DataType(0), pad, __stream__);
+  __fill_dot_pattern__(L, 1);
+  __fill_dot_pattern__(R, 4);
+  for (index_t y = 0; y < M; ++y) {
+    for (index_t x = 0; x < K; ++x) {
+      LT.__data_ptr[x * LT.m_Stride_ + y] = L.__data_ptr[y * L.m_Stride_ + x];
+    }
+  }
+  for (index_t y = 0; y < K; ++y) {
+    for (index_t x = 0; x < N; ++x) {
+      RT.__data_ptr[x * RT.m_Stride_ + y] = R.__data_ptr[y * R.m_Stride_ + x];
+    }
+  }
+
+  for (int t = 0; t < 4; ++t) {
+    const bool lt = t & 1, rt = t & 2;
+    const Tensor<CPU, 2, DataType>& l = lt ? LT : L;
+    const Tensor<CPU, 2, DataType>& r = rt ? RT : R;
+    for (int s = 0; s < 4; ++s) {
+      __fill_dot_pattern__(C, 9);
+      double __scale__ = 1;
+      if (s == 0) {
+        switch (t) {
+          case 0: C = expr::dot(L, R); break;
+          case 1: C = expr::dot(LT.T(), R); break;
+          case 2: C = expr::dot(L, RT.T()); break;
+          default: C = expr::dot(LT.T(), RT.T()); break;
+        }
+      } else if (s == 1) {
+        __scale__ = 2;
+        switch (t) {
+          case 0: C += expr::dot(L, R) * DataType(2); break;
+          case 1: C += expr::dot(LT.T(), R) * DataType(2); break;
+          case 2: C += DataType(2) * expr::dot(L, RT.T()); break;
+          default: C += DataType(2) * expr::dot(LT.T(), RT.T()); break;
+        }
+      } else if (s == 2) {
+        __scale__ = -1;
+        switch (t) {
+          case 0: C -= expr::dot(L, R); break;
+          case 1: C -= expr::dot(LT.T(), R); break;
+          case 2: C -= expr::dot(L, RT.T()); break;
+          default: C -= expr::dot(LT.T(), RT.T()); break;
+        }
+      } else {
+        switch (t) {
+          case 0: C *= expr::dot(L, R); break;
+          case 1: C *= expr::dot(LT.T(), R); break;
+          case 2: C *= expr::dot(L, RT.T()); break;
+          default: C *= expr::dot(LT.T(), RT.T()); break;
+        }
+      }
+      for (index_t i = 0; i < M; ++i) {
+        for (index_t j = 0; j < N; ++j) {
+          const double c0 = DataType(((i * 7 + j * 5 + 9) % 13) - 6);
+          const double d = __dot_ref__(l, r, lt, rt, i, j, __scale__);
+          double ref = s == 3 ? c0 * d : (s == 0 ? d : c0 + d);
+          // The integer sums wrap around, the same as the adds of DataType.
+          if (std::is_integral<DataType>::value) { ref = DataType(static_cast<int64_t>(ref)); }
+          CHECK_EQUAL(double(C.__data_ptr[i * C.m_Stride_ + j]), ref, " M=", M, " K=", K, " N=",
+                      N, " transposed=", t, " saver=", s, " at (", i, ", ", j, ")");
+        }
+      }
+    }
+  }
+  DeleteTensor(&L);
+  DeleteTensor(&LT);
+  DeleteTensor(&R);
+  DeleteTensor(&RT);
+  DeleteTensor(&C);
+}
+
+/*!
+ *@brief    The epilogues: a bias of either axis, an OP, a scale and the savers. K over one KC
+ * keeps the sums in dst for =, and goes through a buffer for +=.
+ */
+template<typename DataType>
+inline void __test_dot_epilogue__(mgloria::Stream<mgloria::CPU>* __stream__, mgloria::index_t M,
+                                  mgloria::index_t K, mgloria::index_t N) {
+  using namespace mgloria;
+  Tensor<CPU, 2, DataType> L = NewTensor(makeShape2d(M, K), false, DataType(0), true, __stream__);
+  Tensor<CPU, 2, DataType> LT = NewTensor(makeShape2d(K, M), false, DataType(0), true, __stream__);
+  Tensor<CPU, 2, DataType> R = NewTensor(makeShape2d(K, N), false, DataType(0), true, __stream__);
+  Tensor<CPU, 2, DataType> C = NewTensor(makeShape2d(M, N), false, DataType(0), true, __stream__);
+  // The 1D tensors are views of 2D ones.
+  Tensor<CPU, 2, DataType> B2 = NewTensor(makeShape2d(2, M + N), false, DataType(0), false,
+                                          __stream__);
+  Tensor<CPU, 1, DataType> bn(B2.__data_ptr, makeShape1d(N), N, __stream__);
+  Tensor<CPU, 1, DataType> bm(B2.__data_ptr + B2.m_Stride_, makeShape1d(M), M, __stream__);
+  __fill_dot_pattern__(L, 1);
+  __fill_dot_pattern__(R, 4);
+  __fill_dot_pattern__(B2, 2);
+  for (index_t y = 0; y < M; ++y) {
+    for (index_t x = 0; x < K; ++x) {
+      LT.__data_ptr[x * LT.m_Stride_ + y] = L.__data_ptr[y * L.m_Stride_ + x];
+    }
+  }
+
+  for (int s = 0; s < 4; ++s) {
+    __fill_dot_pattern__(C, 9);
+    switch (s) {
+      case 0: C = expr::Func<op::_relu>(expr::dot(L, R) + bn); break;
+      case 1: C += expr::Func<op::_relu>(expr::add_bias(expr::dot(LT.T(), R) * DataType(2), bm, 0));
+        break;
+      case 2: C -= expr::dot(L, R) + bn; break;
+      default: C = expr::Func<op::_relu>(expr::dot(LT.T(), R)); break;
+    }
+    for (index_t i = 0; i < M; ++i) {
+      for (index_t j = 0; j < N; ++j) {
+        const double c0 = DataType(((i * 7 + j * 5 + 9) % 13) - 6);
+        double v = __dot_ref__(L, R, false, false, i, j, s == 1 ? 2 : 1);
+        if (s == 0 || s == 2) { v += bn.__data_ptr[j]; }
+        if (s == 1) { v += bm.__data_ptr[i]; }
+        if (s != 2) { v = v > 0 ? v : 0; }
+        const double ref = s == 1 ? c0 + v : (s == 2 ? c0 - v : v);
+        CHECK_EQUAL(double(C.__data_ptr[i * C.m_Stride_ + j]), ref, " M=", M, " K=", K, " N=", N,
+                    " epilogue=", s, " at (", i, ", ", j, ")");
+      }
+    }
+  }
+  DeleteTensor(&L);
+  DeleteTensor(&LT);
+  DeleteTensor(&R);
+  DeleteTensor(&C);
+  DeleteTensor(&B2);
+}
+
+/*!
+ *@brief    A view of the rows of a bigger tensor, as both sides and as dst.
+ */
+template<typename DataType>
+inline void __test_dot_slice__(mgloria::Stream<mgloria::CPU>* __stream__) {
+  using namespace mgloria;
+  Tensor<CPU, 3, DataType> A = NewTensor(makeShape3d(3, 40, 33), false, DataType(0), true,
+                                         __stream__);
+  Tensor<CPU, 3, DataType> C = NewTensor(makeShape3d(3, 40, 40), false, DataType(0), true,
+                                         __stream__);
+  __fill_dot_pattern__(A.Flatten2D(), 2);
+  Tensor<CPU, 2, DataType> a = A.Slice(1, 2).Flatten2D(), c = C.Slice(2, 3).Flatten2D();
+  c = expr::dot(a, a.T());
+  for (index_t i = 0; i < 40; ++i) {
+    for (index_t j = 0; j < 40; ++j) {
+      CHECK_EQUAL(double(c.__data_ptr[i * c.m_Stride_ + j]),
+                  __dot_ref__(a, a, false, true, i, j, 1), " at (", i, ", ", j, ")");
+    }
+  }
+  DeleteTensor(&A);
+  DeleteTensor(&C);
+}
+
+/*!
+ *@brief    batch_dot of Bt [M, K] x [K, N]: the transposes of 3D tensors with =, += and *=, and a
+ * rhs shared by the batch, as a 2D tensor and as a batch of 1, with an epilogue. Run with 1 and 3
+ * threads, for gemms over the batch and inside each.
+ */
+template<typename DataType>
+inline void __test_batch_dot__(mgloria::Stream<mgloria::CPU>* __stream__, mgloria::index_t Bt,
+                               mgloria::index_t M, mgloria::index_t K, mgloria::index_t N) {
+  using namespace mgloria;
+  Tensor<CPU, 3, DataType> L = NewTensor(makeShape3d(Bt, M, K), false, DataType(0), true,
+                                         __stream__);
+  Tensor<CPU, 3, DataType> LT = NewTensor(makeShape3d(Bt, K, M), false, DataType(0), false,
+                                          __stream__);
+  Tensor<CPU, 3, DataType> R = NewTensor(makeShape3d(Bt, K, N), false, DataType(0), false,
+                                         __stream__);
+  Tensor<CPU, 3, DataType> RT = NewTensor(makeShape3d(Bt, N, K), false, DataType(0), true,
+                                          __stream__);
+  Tensor<CPU, 3, DataType> C = NewTensor(makeShape3d(Bt, M, N), false, DataType(0), true,
+                                         __stream__);
+  Tensor<CPU, 2, DataType> R2 = R.Slice(0, 1).Flatten2D();
+  Tensor<CPU, 3, DataType> R1 = R.Slice(0, 1);
+  Tensor<CPU, 2, DataType> B2 = NewTensor(makeShape2d(1, N), false, DataType(0), false,
+                                          __stream__);
+  Tensor<CPU, 1, DataType> bn(B2.__data_ptr, makeShape1d(N), N, __stream__);
+  __fill_dot_pattern__(L.Flatten2D(), 1);
+  __fill_dot_pattern__(R.Flatten2D(), 4);
+  __fill_dot_pattern__(B2, 2);
+  for (index_t b = 0; b < Bt; ++b) {
+    Tensor<CPU, 2, DataType> l = L.Slice(b, b + 1).Flatten2D(), r = R.Slice(b, b + 1).Flatten2D();
+    Tensor<CPU, 2, DataType> lt = LT.Slice(b, b + 1).Flatten2D();
+    Tensor<CPU, 2, DataType> rt = RT.Slice(b, b + 1).Flatten2D();
+    for (index_t y = 0; y < M; ++y) {
+      for (index_t x = 0; x < K; ++x) {
+        lt.__data_ptr[x * lt.m_Stride_ + y] = l.__data_ptr[y * l.m_Stride_ + x];
+      }
+    }
+    for (index_t y = 0; y < K; ++y) {
+      for (index_t x = 0; x < N; ++x) {
+        rt.__data_ptr[x * rt.m_Stride_ + y] = r.__data_ptr[y * r.m_Stride_ + x];
+      }
+    }
+  }
+
+#ifdef _OPENMP
+  const int __threads__ = omp_get_max_threads();
+  for (int th = 1; th <= 3; th += 2) {
+    omp_set_num_threads(th);
+#endif
+    for (int c = 0; c < 16; ++c) {
+      const int t = c < 12 ? c / 3 : 0, s = c < 12 ? c % 3 : c - 12;
+      __fill_dot_pattern__(C.Flatten2D(), 9);
+      switch (c) {
+        case 0: C = expr::batch_dot(L, R); break;
+        case 1: C += expr::batch_dot(L, R); break;
+        case 2: C *= expr::batch_dot(L, R); break;
+        case 3: C = expr::batch_dot<true>(LT, R); break;
+        case 4: C += expr::batch_dot<true>(LT, R); break;
+        case 5: C *= expr::batch_dot<true>(LT, R); break;
+        case 6: C = expr::batch_dot<false, true>(L, RT); break;
+        case 7: C += expr::batch_dot<false, true>(L, RT); break;
+        case 8: C *= expr::batch_dot<false, true>(L, RT); break;
+        case 9: C = expr::batch_dot<true, true>(LT, RT); break;
+        case 10: C += expr::batch_dot<true, true>(LT, RT); break;
+        case 11: C *= expr::batch_dot<true, true>(LT, RT); break;
+        case 12: C = expr::batch_dot(L, R2); break;
+        case 13: C += expr::batch_dot(L, R1); break;
+        case 14: C *= expr::batch_dot(L, R2); break;
+        default: C = expr::Func<op::_relu>(expr::batch_dot(L, R1) + bn); break;
+      }
+      for (index_t b = 0; b < Bt; ++b) {
+        Tensor<CPU, 2, DataType> l = L.Slice(b, b + 1).Flatten2D();
+        Tensor<CPU, 2, DataType> r = c < 12 ? R.Slice(b, b + 1).Flatten2D() : R2;
+        for (index_t i = 0; i < M; ++i) {
+          for (index_t j = 0; j < N; ++j) {
+            const double c0 = DataType((((b * M + i) * 7 + j * 5 + 9) % 13) - 6);
+            double d = __dot_ref__(l, r, false, false, i, j, 1);
+            if (c == 15) { d = d + bn.__data_ptr[j] > 0 ? d + bn.__data_ptr[j] : 0; }
+            const double ref = s == 2 ? c0 * d : (s == 0 || c == 15 ? d : c0 + d);
+            CHECK_EQUAL(double(C.__data_ptr[(b * M + i) * C.m_Stride_ + j]), ref, " Bt=", Bt,
+                        " M=", M, " K=", K, " N=", N, " transposed=", t, " case=", c, " at (", b,
+                        ", ", i, ", ", j, ")");
+          }
+        }
+      }
+    }
+#ifdef _OPENMP
+  }
+  omp_set_num_threads(__threads__);
+#endif
+  DeleteTensor(&L);
+  DeleteTensor(&LT);
+  DeleteTensor(&R);
+  DeleteTensor(&RT);
+  DeleteTensor(&C);
+  DeleteTensor(&B2);
+}
+
+/*!
+ *@brief    The tuner: a shape class is tuned on its first dot and written to the tuning file, which
+ * is read back after the tuner is cleared, with the classes written by others in between. The dots
+ * are exact whatever the blocking.
+ */
+inline void __test_dot_tune__(mgloria::Stream<mgloria::CPU>* __stream__) {
+  using namespace mgloria;
+  expr::GemmTuner& __tuner__ = expr::GemmTuner::Get();
+  const std::string __path__ = __tuner__.Path();
+  const bool __enabled__ = __tuner__.Enabled();
+  const char* __file__ = "mgloria_gemm_tune_test.txt";
+  std::remove(__file__);
+  __tuner__.SetPath(__file__);
+  __tuner__.Clear();
+  __tuner__.SetEnabled(true);
+  // int32_t, the float and double dots may run on the cblas.
+  __test_dot_shape__<int32_t>(__stream__, 70, 300, 90, true);
+  __test_dot_shape__<int32_t>(__stream__, 40, 200, 50, false);
+  // A class another process wrote in between is merged by the next write.
+  std::FILE* f = std::fopen(__file__, "a");
+  std::fprintf(f, "%s\tother\t8 8 8\n", expr::GemmCpuModel().c_str());
+  std::fclose(f);
+  __test_dot_shape__<int32_t>(__stream__, 20, 600, 30, false);
+  const size_t __tuned__ = __tuner__.Size();
+  CHECK_EQUAL(__tuned__ >= 4, true, " tuned classes=", __tuned__);
+  __tuner__.Clear();
+  __tuner__.SetEnabled(false);
+  __test_dot_shape__<int32_t>(__stream__, 70, 300, 90, true);
+  CHECK_EQUAL(__tuner__.Size(), __tuned__, " the classes read back from ", __file__);
+  std::remove(__file__);
+  std::remove((std::string(__file__) + ".lock").c_str());
+  __tuner__.Clear();
+  __tuner__.SetPath(__path__);
+  __tuner__.SetEnabled(__enabled__);
+}
+
+/*!
+ *@brief    Each element is computed in the same order for any number of threads.
+ */
+inline void __test_dot_deterministic__(mgloria::Stream<mgloria::CPU>* __stream__) {
+  using namespace mgloria;
+  const index_t M = 150, K = 700, N = 90;
+  Tensor<CPU, 2, float> L = NewTensor(makeShape2d(M, K), false, 0.f, true, __stream__);
+  Tensor<CPU, 2, float> R = NewTensor(makeShape2d(K, N), false, 0.f, true, __stream__);
+  Tensor<CPU, 2, float> C = NewTensor(makeShape2d(M, N), false, 0.f, true, __stream__);
+  Tensor<CPU, 2, float> D = NewTensor(makeShape2d(M, N), false, 0.f, true, __stream__);
+  for (index_t y = 0; y < M; ++y) {
+    for (index_t x = 0; x < K; ++x) { L.__data_ptr[y * L.m_Stride_ + x] = 1.f / (y + x + 1); }
+  }
+  for (index_t y = 0; y < K; ++y) {
+    for (index_t x = 0; x < N; ++x) { R.__data_ptr[y * R.m_Stride_ + x] = 1.f / (y * 3 + x + 2); }
+  }
+  C = expr::dot(L, R);
+  for (index_t i = 0; i < M; ++i) {
+    for (index_t j = 0; j < N; ++j) {
+      const double ref = __dot_ref__(L, R, false, false, i, j, 1);
+      CHECK_EQUAL(std::fabs(C.__data_ptr[i * C.m_Stride_ + j] - ref) < 1e-5 * ref, true, " at (",
+                  i, ", ", j, ")");
+    }
+  }
+#ifdef _OPENMP
+  const int __threads__ = omp_get_max_threads();
+  for (int t = 1; t <= 3; ++t) {
+    omp_set_num_threads(t);
+    D = expr::dot(L, R);
+    for (index_t i = 0; i < M; ++i) {
+      for (index_t j = 0; j < N; ++j) {
+        CHECK_EQUAL(D.__data_ptr[i * D.m_Stride_ + j] == C.__data_ptr[i * C.m_Stride_ + j], true,
+                    " threads=", t, " at (", i, ", ", j, ")");
+      }
+    }
+  }
+  omp_set_num_threads(__threads__);
+#endif
+  DeleteTensor(&L);
+  DeleteTensor(&R);
+  DeleteTensor(&C);
+  DeleteTensor(&D);
+}
+
+/*!
+ *@brief    The quantized dot of uint8_t A and int8_t W over their full range, to int32_t exactly
+ * and requantized to float and int8_t per tensor and per column.
+ */
+inline void __test_qdot__(mgloria::Stream<mgloria::CPU>* __stream__, mgloria::index_t M,
+                          mgloria::index_t K, mgloria::index_t N, int32_t a_zero) {
+  using namespace mgloria;
+  Tensor<CPU, 2, uint8_t> A = NewTensor(makeShape2d(M, K), false, uint8_t(0), true, __stream__);
+  Tensor<CPU, 2, int8_t> W = NewTensor(makeShape2d(N, K), false, int8_t(0), true, __stream__);
+  Tensor<CPU, 2, int8_t> WK = NewTensor(makeShape2d(K, N), false, int8_t(0), true, __stream__);
+  Tensor<CPU, 2, int32_t> C = NewTensor(makeShape2d(M, N), false, int32_t(0), true, __stream__);
+  Tensor<CPU, 2, int32_t> R = NewTensor(makeShape2d(M, N), false, int32_t(0), true, __stream__);
+  Tensor<CPU, 2, float> F = NewTensor(makeShape2d(M, N), false, 0.f, true, __stream__);
+  Tensor<CPU, 2, int8_t> Q = NewTensor(makeShape2d(M, N), false, int8_t(0), true, __stream__);
+  Tensor<CPU, 2, float> S2 = NewTensor(makeShape2d(1, N), false, 0.f, false, __stream__);
+  Tensor<CPU, 1, float> S(S2.__data_ptr, makeShape1d(N), N, __stream__);
+  for (index_t y = 0; y < M; ++y) {
+    for (index_t x = 0; x < K; ++x) { A.__data_ptr[y * A.m_Stride_ + x] = (y * 37 + x * 11) % 256; }
+  }
+  for (index_t y = 0; y < N; ++y) {
+    for (index_t x = 0; x < K; ++x) {
+      const int8_t w = int8_t(((y * 29 + x * 13 + 5) % 256) - 128);
+      W.__data_ptr[y * W.m_Stride_ + x] = w;
+      WK.__data_ptr[x * WK.m_Stride_ + y] = w;
+    }
+  }
+  for (index_t j = 0; j < N; ++j) { S.__data_ptr[j] = 2e-5f * float(j % 7 + 1); }
+  for (index_t i = 0; i < M; ++i) {
+    for (index_t j = 0; j < N; ++j) {
+      int32_t __sum__ = 0;
+      for (index_t k = 0; k < K; ++k) {
+        __sum__ += (int32_t(A.__data_ptr[i * A.m_Stride_ + k]) - a_zero)
+                   * int32_t(W.__data_ptr[j * W.m_Stride_ + k]);
+      }
+      R.__data_ptr[i * R.m_Stride_ + j] = __sum__;
+    }
+  }
+
+  for (int s = 0; s < 5; ++s) {
+    switch (s) {
+      case 0: C = expr::dot(A, WK, a_zero); break;
+      case 1: C = expr::dot(A, W.T(), a_zero); break;
+      case 2: C += expr::dot(A, WK, a_zero); break;
+      case 3: F = expr::requantize<float>(expr::dot(A, W.T(), a_zero), 0.5f); break;
+      default: F = expr::requantize<float>(expr::dot(A, WK, a_zero), S); break;
+    }
+    for (index_t i = 0; i < M; ++i) {
+      for (index_t j = 0; j < N; ++j) {
+        const int32_t r = R.__data_ptr[i * R.m_Stride_ + j];
+        if (s < 3) {
+          CHECK_EQUAL(C.__data_ptr[i * C.m_Stride_ + j], s == 2 ? 2 * r : r, " M=", M, " K=", K,
+                      " N=", N, " case=", s, " at (", i, ", ", j, ")");
+        } else {
+          const float __s__ = s == 3 ? 0.5f : S.__data_ptr[j];
+          CHECK_EQUAL(F.__data_ptr[i * F.m_Stride_ + j], __s__ * float(r), " M=", M, " K=", K,
+                      " N=", N, " case=", s, " at (", i, ", ", j, ")");
+        }
+      }
+    }
+  }
+
+  // To int8_t, rounded half to even and saturated, a part of the outputs is out of range.
+  for (int s = 0; s < 2; ++s) {
+    if (s == 0) {
+      Q = expr::requantize<int8_t>(expr::dot(A, W.T(), a_zero), 1e-4f, -3);
+    } else {
+      Q = expr::requantize<int8_t>(expr::dot(A, W.T(), a_zero), S, 5);
+    }
+    for (index_t i = 0; i < M; ++i) {
+      for (index_t j = 0; j < N; ++j) {
+        const float __s__ = s == 0 ? 1e-4f : S.__data_ptr[j];
+        long q = std::lrint(__s__ * float(R.__data_ptr[i * R.m_Stride_ + j])) + (s == 0 ? -3 : 5);
+        q = q < -128 ? -128 : (q > 127 ? 127 : q);
+        CHECK_EQUAL(int(Q.__data_ptr[i * Q.m_Stride_ + j]), int(q), " M=", M, " K=", K, " N=", N,
+                    " int8 case=", s, " at (", i, ", ", j, ")");
+      }
+    }
+  }
+  DeleteTensor(&A);
+  DeleteTensor(&W);
+  DeleteTensor(&WK);
+  DeleteTensor(&C);
+  DeleteTensor(&R);
+  DeleteTensor(&F);
+  DeleteTensor(&Q);
+  DeleteTensor(&S2);
+}
+
+/*!
+ *@brief    The dots of FixedTensor: all the transposes, a Saver and a scale, a bias of either axis
+ * with an OP. Checked on their Tensor views against __dot_ref__.
+ */
+template<typename DataType, mgloria::index_t M, mgloria::index_t K, mgloria::index_t N>
+inline void __test_fixed_dot__() {
+  using namespace mgloria;
+  FixedTensor<M, K, DataType> L;
+  FixedTensor<K, M, DataType> LT;
+  FixedTensor<K, N, DataType> R;
+  FixedTensor<N, K, DataType> RT;
+  FixedTensor<M, N, DataType> C;
+  DataType __bn__[N], __bm__[M];
+  Tensor<CPU, 1, DataType> bn(__bn__, makeShape1d(N)), bm(__bm__, makeShape1d(M));
+  for (index_t j = 0; j < N; ++j) { __bn__[j] = DataType((j * 3 % 7) - 3); }
+  for (index_t i = 0; i < M; ++i) { __bm__[i] = DataType((i * 5 % 7) - 3); }
+  __fill_dot_pattern__(L.AsTensor(), 1);
+  __fill_dot_pattern__(R.AsTensor(), 4);
+  LT = L.T();
+  RT = R.T();
+
+  for (int t = 0; t < 4; ++t) {
+    const bool lt = t & 1, rt = t & 2;
+    for (int s = 0; s < 4; ++s) {
+      __fill_dot_pattern__(C.AsTensor(), 9);
+      if (s == 0) {
+        switch (t) {
+          case 0: C = expr::dot(L, R); break;
+          case 1: C = expr::dot(LT.T(), R); break;
+          case 2: C = expr::dot(L, RT.T()); break;
+          default: C = expr::dot(LT.T(), RT.T()); break;
+        }
+      } else if (s == 1) {
+        switch (t) {
+          case 0: C += expr::dot(L, R) * DataType(2); break;
+          case 1: C += expr::dot(LT.T(), R) * DataType(2); break;
+          case 2: C += expr::dot(L, RT.T()) * DataType(2); break;
+          default: C += expr::dot(LT.T(), RT.T()) * DataType(2); break;
+        }
+      } else if (s == 2) {
+        switch (t) {
+          case 0: C = expr::Func<op::_relu>(expr::dot(L, R) + bn); break;
+          case 1: C = expr::Func<op::_relu>(expr::dot(LT.T(), R) + bn); break;
+          case 2: C = expr::Func<op::_relu>(expr::dot(L, RT.T()) + bn); break;
+          default: C = expr::Func<op::_relu>(expr::dot(LT.T(), RT.T()) + bn); break;
+        }
+      } else {
+        switch (t) {
+          case 0: C -= expr::add_bias(expr::dot(L, R), bm, 0); break;
+          case 1: C -= expr::add_bias(expr::dot(LT.T(), R), bm, 0); break;
+          case 2: C -= expr::add_bias(expr::dot(L, RT.T()), bm, 0); break;
+          default: C -= expr::add_bias(expr::dot(LT.T(), RT.T()), bm, 0); break;
+        }
+      }
+      for (index_t i = 0; i < M; ++i) {
+        for (index_t j = 0; j < N; ++j) {
+          const double c0 = DataType(((i * 7 + j * 5 + 9) % 13) - 6);
+          double v = __dot_ref__(lt ? LT.AsTensor() : L.AsTensor(),
+                                 rt ? RT.AsTensor() : R.AsTensor(), lt, rt, i, j, 1);
+          double ref = v;
+          if (s == 1) { ref = c0 + 2 * v; }
+          if (s == 2) { ref = v + __bn__[j] > 0 ? v + __bn__[j] : 0; }
+          if (s == 3) { ref = c0 - (v + __bm__[i]); }
+          CHECK_EQUAL(double(C[i][j]), ref, " M=", M, " K=", K, " N=", N, " transposed=", t,
+                      " saver=", s, " at (", i, ", ", j, ")");
+        }
+      }
+    }
+  }
+}
+
+inline void __test_dot_all_shapes__(mgloria::Stream<mgloria::CPU>* __stream__) {
+  using namespace mgloria;
+  // Edges of the micro tiles of every arch, K over one KC, M over one MC.
+  __test_dot_shape__<float>(__stream__, 1, 1, 1, true);
+  __test_dot_shape__<float>(__stream__, 7, 13, 37, false);
+  __test_dot_shape__<float>(__stream__, 30, 600, 50, true);
+  __test_dot_shape__<float>(__stream__, 300, 20, 45, false);
+  __test_dot_shape__<double>(__stream__, 13, 300, 19, true);
+  __test_dot_shape__<int32_t>(__stream__, 25, 70, 33, false);
+  __test_dot_shape__<int8_t>(__stream__, 5, 6, 7, true);
+  __test_dot_slice__<float>(__stream__);
+  __test_dot_deterministic__(__stream__);
+  __test_dot_tune__(__stream__);
+  __test_dot_epilogue__<float>(__stream__, 7, 13, 37);
+  __test_dot_epilogue__<float>(__stream__, 30, 600, 50);
+  __test_dot_epilogue__<double>(__stream__, 13, 300, 19);
+  __test_dot_epilogue__<int32_t>(__stream__, 25, 70, 33);
+  // Small gemms over the batch, and gemms of several blocks with K over one KC inside.
+  __test_batch_dot__<float>(__stream__, 6, 7, 13, 37);
+  __test_batch_dot__<float>(__stream__, 2, 130, 300, 70);
+  __test_batch_dot__<double>(__stream__, 3, 9, 5, 11);
+  __test_batch_dot__<int32_t>(__stream__, 4, 20, 40, 19);
+  // Batch 1, odd K, rows of full and partial tiles and more columns than one block.
+  __test_qdot__(__stream__, 1, 301, 77, 128);
+  __test_qdot__(__stream__, 19, 150, 70, 0);
+  __test_qdot__(__stream__, 30, 1, 33, 7);
+  __test_qdot__(__stream__, 40, 1200, 1100, 128);
+  // The small sizes of FixedTensor, less than a vector, tiles with edges and long K.
+  __test_fixed_dot__<float, 3, 3, 3>();
+  __test_fixed_dot__<float, 4, 4, 4>();
+  __test_fixed_dot__<float, 8, 8, 8>();
+  __test_fixed_dot__<float, 16, 64, 64>();
+  __test_fixed_dot__<float, 13, 9, 37>();
+  __test_fixed_dot__<double, 7, 5, 19>();
+  __test_fixed_dot__<int32_t, 6, 17, 20>();
+}
+
+inline void __test_tensor_dot__() {
+  using namespace mgloria;
+  LOG << "-------- Starting test [Tensor][Dot] \n";
+  auto __stream__ = NewStream<CPU>(0);
+#if MGLORIA_DOT_USE_BLAS == 1
+  LOG << "Dot of float and double on the cblas\n";
+#endif
+#if MGLORIA_RUNTIME_DISPATCH == 1
+  const vectorization::VecArch __saved__ = vectorization::RuntimeVecArch();
+  const vectorization::VecArch __detected__ = vectorization::DetectVecArch();
+  for (int a = 0; a <= static_cast<int>(__detected__); ++a) {
+    vectorization::SetRuntimeVecArch(static_cast<vectorization::VecArch>(a));
+    LOG << "Dot with " << vectorization::VecArchName(vectorization::RuntimeVecArch()) << "\n";
+    __test_dot_all_shapes__(__stream__);
+  }
+  vectorization::SetRuntimeVecArch(__saved__);
+#else
+  __test_dot_all_shapes__(__stream__);
+#endif
+  FreeStream(__stream__);
+  LOG << "-------- Successfully tested [Tensor][Dot] \n";
+}
@@ -0,0 +1,231 @@
+#include "core.hpp"
+#include <cstdio>
+
+/*!
+ *@brief    A tensor saved and mapped back has the same elements, on aligned rows of the file.
+ */
+template<int Dims, typename DataType>
+inline void __test_tensor_file__(mgloria::Stream<mgloria::CPU>* __stream__,
+                                 const mgloria::Shape<Dims>& shape, bool pad) {
+  using namespace mgloria;
+  const char* __path__ = "mgloria_tensor_file_test.mgt";
+  Tensor<CPU, Dims, DataType> A = NewTensor(shape, false, DataType(0), pad, __stream__);
+  Tensor<CPU, 2, DataType> __a__ = A.Flatten2D();
+  const index_t rows = __a__.size(0), cols = __a__.size(1);
+  for (index_t i = 0; i < rows; ++i) {
+    for (index_t j = 0; j < cols; ++j) {
+      __a__.__data_ptr[i * __a__.m_Stride_ + j] = DataType((i * 31 + j * 7) % 113) - DataType(50);
+    }
+  }
+  CHECK_EQUAL(SaveTensorFile(__path__, A), true, " save");
+
+  MappedTensor<Dims, DataType> M;
+  CHECK_EQUAL(M.Open(__path__), true, " open");
+  const Tensor<CPU, Dims, DataType>& B = M.Get();
+  for (int i = 0; i < Dims; ++i) { CHECK_EQUAL(B.size(i), A.size(i), " shape at ", i); }
+  CHECK_EQUAL(reinterpret_cast<size_t>(B.__data_ptr) % TensorFileHeader::ms_RowAlign, size_t(0),
+              " not aligned");
+  CHECK_EQUAL(B.m_Stride_ * sizeof(DataType) % TensorFileHeader::ms_RowAlign, size_t(0),
+              " the rows are not aligned");
+  Tensor<CPU, 2, DataType> __b__ = B.Flatten2D();
+  for (index_t i = 0; i < rows; ++i) {
+    for (index_t j = 0; j < cols; ++j) {
+      CHECK_EQUAL(__b__.__data_ptr[i * __b__.m_Stride_ + j],
+                  __a__.__data_ptr[i * __a__.m_Stride_ + j], " at ", i, ", ", j);
+    }
+  }
+
+  // An expression reads the mapping as any tensor.
+  Tensor<CPU, Dims, DataType> C = NewTensor(shape, false, DataType(0), true, __stream__);
+  C = B + A;
+  Tensor<CPU, 2, DataType> __c__ = C.Flatten2D();
+  CHECK_EQUAL(__c__.__data_ptr[(rows - 1) * __c__.m_Stride_ + cols - 1],
+              DataType(2) * __a__.__data_ptr[(rows - 1) * __a__.m_Stride_ + cols - 1], " B + A");
+
+  // Saved over while mapped: the mapping keeps the old data.
+  A = DataType(1);
+  CHECK_EQUAL(SaveTensorFile(__path__, A), true, " save over");
+  CHECK_EQUAL(__b__.__data_ptr[0], DataType(-50), " the old mapping changed");
+  MappedTensor<Dims, DataType> N = std::move(M);
+  CHECK_EQUAL(M.Empty() && !N.Empty(), true, " move");
+  CHECK_EQUAL(N.Open(__path__) && N.Get().__data_ptr[0] == DataType(1), true, " the new file");
+
+  // A forged header: rows x pitch wrapping around 2^64, or the data over the header.
+  TensorFileHeader __h__;
+  std::FILE* __f__ = std::fopen(__path__, "r+b");
+  CHECK_EQUAL(std::fread(&__h__, sizeof(__h__), 1, __f__), size_t(1), " read the header");
+  TensorFileHeader __forged__ = __h__;
+  for (int i = 0; i < Dims - 1; ++i) { __forged__.m_shape[i] = 1; }
+  __forged__.m_shape[0] = uint64_t(1) << 30;
+  if (Dims > 2) { __forged__.m_shape[1] = uint64_t(1) << 28; }
+  std::rewind(__f__);
+  std::fwrite(&__forged__, sizeof(__forged__), 1, __f__);
+  std::fflush(__f__);
+  CHECK_EQUAL(N.Open(__path__), false, " opened rows out of the file");
+  __forged__ = __h__;
+  __forged__.m_offset = 0;
+  std::rewind(__f__);
+  std::fwrite(&__forged__, sizeof(__forged__), 1, __f__);
+  std::fclose(__f__);
+  CHECK_EQUAL(N.Open(__path__), false, " opened rows over the header");
+
+  // Of another type, or not a tensor file.
+  MappedTensor<Dims, int8_t> W;
+  CHECK_EQUAL(W.Open(__path__), false, " opened as another type");
+  __f__ = std::fopen(__path__, "wb");
+  std::fputs("not a tensor", __f__);
+  std::fclose(__f__);
+  CHECK_EQUAL(N.Open(__path__), false, " opened a text file");
+  CHECK_EQUAL(N.Empty(), true, " empty after a failed open");
+
+  std::remove(__path__);
+  DeleteTensor(&A);
+  DeleteTensor(&C);
+}
+
+/*!
+ *@brief    Fill the rows of T with values of seed, the padding is left.
+ */
+template<int Dims, typename DataType>
+inline void __fill_ckpt__(const mgloria::Tensor<mgloria::CPU, Dims, DataType>& T, int seed) {
+  mgloria::Tensor<mgloria::CPU, 2, DataType> __t__ = T.Flatten2D();
+  for (mgloria::index_t i = 0; i < __t__.size(0); ++i) {
+    for (mgloria::index_t j = 0; j < __t__.size(1); ++j) {
+      __t__.__data_ptr[i * __t__.m_Stride_ + j] = DataType((i * 17 + j * 5 + seed) % 97);
+    }
+  }
+}
+
+template<int Dims, typename DataType>
+inline bool __same_ckpt__(const mgloria::Tensor<mgloria::CPU, Dims, DataType>& A,
+                          const mgloria::Tensor<mgloria::CPU, Dims, DataType>& B) {
+  mgloria::Tensor<mgloria::CPU, 2, DataType> __a__ = A.Flatten2D(), __b__ = B.Flatten2D();
+  for (mgloria::index_t i = 0; i < __a__.size(0); ++i) {
+    for (mgloria::index_t j = 0; j < __a__.size(1); ++j) {
+      if (__a__.__data_ptr[i * __a__.m_Stride_ + j] != __b__.__data_ptr[i * __b__.m_Stride_ + j]) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+/*!
+ *@brief    Tensors checkpointed are read back the same, in any order and into other pitches, the
+ * copies are taken when added, a changed byte is found by its checksum and a forged size by the
+ * bounds of the file and of the tensor.
+ */
+inline void __test_checkpoint__(mgloria::Stream<mgloria::CPU>* __stream__) {
+  using namespace mgloria;
+  const char* __path__ = "mgloria_checkpoint_test.ckpt";
+  CHECK_EQUAL(CheckpointChecksum("", 0), uint64_t(0xEF46DB3751D8E999ULL), " XXH64 of nothing");
+
+  // Larger than a chunk, with padded rows: the chunks cut rows.
+  Tensor<CPU, 2, float> W = NewTensor(makeShape2d(1031, 1027), false, 0.f, true, __stream__);
+  Tensor<CPU, 3, double> D = NewTensor(makeShape3d(3, 5, 7), false, 0.0, false, __stream__);
+  Tensor<CPU, 1, int32_t> I = NewTensor(makeShape1d(13), false, 0, false, __stream__);
+  __fill_ckpt__(W, 1);
+  __fill_ckpt__(D, 2);
+  __fill_ckpt__(I, 3);
+
+  {
+    // Two staging chunks: Add waits for the I/O thread in the middle of W.
+    CheckpointWriter __w__;
+    CHECK_EQUAL(__w__.Open(__path__, 0), true, " open to write");
+    CHECK_EQUAL(__w__.Add("w", W) && __w__.Add("d", D) && __w__.Add("i", I), true, " add");
+    // Left out, or the reader would take the file as bad.
+    const std::string __long__(CheckpointRecord::ms_MaxNameBytes + 1, 'n');
+    CHECK_EQUAL(__w__.Add(__long__, I), false, " added a too long name");
+    W = 0.f;
+    D = 0.0;
+    CHECK_EQUAL(__w__.Finish(), true, " finish");
+  }
+  W = 0.f;
+  __fill_ckpt__(W, 1);
+  __fill_ckpt__(D, 2);
+
+  CheckpointReader __r__;
+  CHECK_EQUAL(__r__.Open(__path__), true, " open to read");
+  CHECK_EQUAL(__r__.Names().size(), size_t(3), " names");
+  CHECK_EQUAL(__r__.Names()[0] == "w" && __r__.Has("i") && !__r__.Has("x"), true, " names");
+  Tensor<CPU, 1, int32_t> I2 = NewTensor(makeShape1d(13), false, 0, false, __stream__);
+  Tensor<CPU, 3, double> D2 = NewTensor(makeShape3d(3, 5, 7), false, 0.0, true, __stream__);
+  Tensor<CPU, 2, float> W2 = NewTensor(makeShape2d(1031, 1027), false, 0.f, false, __stream__);
+  CHECK_EQUAL(__r__.Read("i", &I2) && __same_ckpt__(I, I2), true, " i");
+  CHECK_EQUAL(__r__.Read("d", &D2) && __same_ckpt__(D, D2), true, " d");
+  CHECK_EQUAL(__r__.Read("w", &W2) && __same_ckpt__(W, W2), true, " w");
+  CHECK_EQUAL(__r__.Read("x", &W2), false, " a name not in");
+  CHECK_EQUAL(__r__.Read("d", &W2), false, " another shape");
+  Tensor<CPU, 1, float> F = NewTensor(makeShape1d(13), false, 0.f, false, __stream__);
+  CHECK_EQUAL(__r__.Read("i", &F), false, " another type");
+  __r__.Close();
+
+  // A byte of the second chunk of w changed.
+  std::FILE* __f__ = std::fopen(__path__, "r+b");
+  std::fseek(__f__, long(MGLORIA_CKPT_CHUNK) + 1000, SEEK_SET);
+  std::fputc(0x5a, __f__);
+  std::fclose(__f__);
+  CHECK_EQUAL(__r__.Open(__path__), true, " open changed");
+  CHECK_EQUAL(__r__.Read("w", &W2), false, " read changed");
+  CHECK_EQUAL(__r__.Read("d", &D2), true, " the others read");
+
+  // Cut: the END record is lost.
+  CHECK_EQUAL(::truncate(__path__, 4000), 0, " truncate");
+  CHECK_EQUAL(__r__.Open(__path__), false, " open cut");
+
+  // The size in the head of i forged, with its chunk and checksum made to match.
+  {
+    CheckpointWriter __w__;
+    CHECK_EQUAL(__w__.Open(__path__) && __w__.Add("i", I) && __w__.Finish(), true, " write i");
+  }
+  __f__ = std::fopen(__path__, "rb");
+  std::string __file__(sizeof(CheckpointHeader) + 2 * sizeof(CheckpointRecord) + 1 + 13 * 4 + 8,
+                       '\0');
+  CHECK_EQUAL(std::fread(&__file__[0], 1, __file__.size(), __f__), __file__.size(), " read i");
+  std::fclose(__f__);
+  const size_t __head__ = sizeof(CheckpointHeader);
+  const size_t __data__ = __head__ + sizeof(CheckpointRecord) + 1;
+  CheckpointRecord __rec__;
+  std::memcpy(&__rec__, &__file__[__head__], sizeof(__rec__));
+  __rec__.m_bytes += 8;
+  std::memcpy(&__file__[__head__], &__rec__, sizeof(__rec__));
+  std::string __forged__ = __file__.substr(0, __data__ + 13 * 4) + std::string(8, '\0');
+  const uint64_t __sum__ = CheckpointChecksum(&__forged__[__data__], 13 * 4 + 8);
+  __forged__.append(reinterpret_cast<const char*>(&__sum__), sizeof(__sum__));
+  __forged__.append(__file__, __file__.size() - sizeof(CheckpointRecord), sizeof(CheckpointRecord));
+  __f__ = std::fopen(__path__, "wb");
+  std::fwrite(__forged__.data(), 1, __forged__.size(), __f__);
+  std::fclose(__f__);
+  CHECK_EQUAL(__r__.Open(__path__), true, " open a forged size");
+  CHECK_EQUAL(__r__.Read("i", &I2), false, " read more bytes than i");
+  __r__.Close();
+  // Past the end of the file, or wrapping the offsets around.
+  __rec__.m_bytes = ~uint64_t(0) - 4;
+  std::memcpy(&__forged__[__head__], &__rec__, sizeof(__rec__));
+  __f__ = std::fopen(__path__, "wb");
+  std::fwrite(__forged__.data(), 1, __forged__.size(), __f__);
+  std::fclose(__f__);
+  CHECK_EQUAL(__r__.Open(__path__), false, " open a size past the end");
+
+  std::remove(__path__);
+  DeleteTensor(&W);
+  DeleteTensor(&D);
+  DeleteTensor(&I);
+  DeleteTensor(&W2);
+  DeleteTensor(&D2);
+  DeleteTensor(&I2);
+  DeleteTensor(&F);
+}
+
+inline void __test_tensor_io__() {
+  using namespace mgloria;
+  LOG << "-------- Starting test [Tensor][IO] \n";
+  auto __stream__ = NewStream<CPU>(0);
+  __test_tensor_file__<2, float>(__stream__, makeShape2d(37, 53), true);
+  __test_tensor_file__<2, float>(__stream__, makeShape2d(20, 64), false);
+  __test_tensor_file__<3, double>(__stream__, makeShape3d(3, 5, 7), false);
+  __test_tensor_file__<4, int32_t>(__stream__, makeShape4d(2, 3, 4, 100), true);
+  __test_checkpoint__(__stream__);
+  FreeStream(__stream__);
+  LOG << "-------- Successfully tested [Tensor][IO] \n";
+}
@@ -0,0 +1,288 @@
+#include "core.hpp"
+#include <vector>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/*!
+ *@brief    The size classes cover every size with under 25% more, in order.
+ */
+inline void __test_pool_classes__() {
+  using namespace mgloria;
+  size_t __last__ = 0;
+  int __last_cls__ = 0;
+  for (size_t bytes = 1; bytes < (size_t(1) << 24); bytes += 1 + bytes / 7) {
+    size_t __size__;
+    const int __cls__ = HostMemoryPool::ClassOf(bytes, &__size__);
+    CHECK_EQUAL(__cls__ >= __last_cls__ && __cls__ < HostMemoryPool::ms_Classes, true,
+                " bytes=", bytes, " class=", __cls__);
+    CHECK_EQUAL(__size__ >= bytes && __size__ >= __last__
+                    && (bytes <= 64 || __size__ * 4 < bytes * 5),
+                true, " bytes=", bytes, " size=", __size__);
+    __last__ = __size__;
+    __last_cls__ = __cls__;
+  }
+  size_t __size__;
+  CHECK_EQUAL(HostMemoryPool::ClassOf((size_t(1) << MGLORIA_HOST_POOL_MAX_LOG) + 1, &__size__), -1,
+              " the largest blocks are not cached");
+}
+
+/*!
+ *@brief    A tensor freed is the next one of its class, aligned, and freed by other threads too.
+ */
+inline void __test_pool_reuse__(mgloria::Stream<mgloria::CPU>* __stream__) {
+  using namespace mgloria;
+  HostMemoryPool& __pool__ = HostMemoryPool::Get();
+  const bool __enabled__ = __pool__.Enabled();
+  __pool__.SetEnabled(true);
+  __pool__.Trim();
+  __pool__.ResetStats();
+  const HostPoolStats __s0__ = __pool__.Stats();
+
+  Tensor<CPU, 2, float> A = NewTensor(makeShape2d(37, 53), true, 1.f, true, __stream__);
+  float* __a__ = A.__data_ptr;
+  CHECK_EQUAL(reinterpret_cast<size_t>(__a__) % 64, size_t(0), " the block is not aligned");
+  DeleteTensor(&A);
+  Tensor<CPU, 2, float> B = NewTensor(makeShape2d(37, 53), false, 0.f, true, __stream__);
+  CHECK_EQUAL(B.__data_ptr == __a__, true, " the block freed is not reused");
+  DeleteTensor(&B);
+
+  // Allocated on some threads, freed on others.
+  const int n = 64;
+  std::vector<Tensor<CPU, 2, double>> __ts__(n);
+#ifndef __CUDACC__
+#pragma omp parallel for
+#endif
+  for (openmp_index_t i = 0; i < n; ++i) {
+    __ts__[i] = NewTensor(makeShape2d(1, 100 + i * 37), true, double(i), false, __stream__);
+  }
+  for (int r = 0; r < 2; ++r) {
+#ifndef __CUDACC__
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for (openmp_index_t i = 0; i < n; ++i) {
+      const int j = n - 1 - static_cast<int>(i);
+      for (index_t k = 0; k < __ts__[j].size(1); ++k) {
+        CHECK_EQUAL(__ts__[j].__data_ptr[k], double(j), " tensor ", j, " at ", k);
+      }
+      DeleteTensor(&__ts__[j]);
+      __ts__[j] = NewTensor(makeShape2d(1, 100 + j * 37), true, double(j), false, __stream__);
+    }
+  }
+  for (int i = 0; i < n; ++i) { DeleteTensor(&__ts__[i]); }
+
+  const HostPoolStats __s__ = __pool__.Stats();
+  CHECK_EQUAL(__s__.m_allocs - __s0__.m_allocs, size_t(2 + 3 * n), " allocs");
+  CHECK_EQUAL(__s__.m_frees - __s0__.m_frees, size_t(2 + 3 * n), " frees");
+  CHECK_EQUAL(__s__.m_hits >= size_t(1 + n), true, " hits=", __s__.m_hits);
+  CHECK_EQUAL(__s__.m_bytes_in_use, __s0__.m_bytes_in_use, " bytes in use");
+  CHECK_EQUAL(__s__.m_bytes_reserved, __s__.m_bytes_in_use + __s__.m_bytes_cached,
+              " bytes reserved");
+  CHECK_EQUAL(__s__.m_peak_bytes > __s0__.m_bytes_in_use, true, " peak");
+  __pool__.SetEnabled(__enabled__);
+}
+
+/*!
+ *@brief    Off, a block goes back to the system when it is freed, the ones taken before as well.
+ */
+inline void __test_pool_disabled__(mgloria::Stream<mgloria::CPU>* __stream__) {
+  using namespace mgloria;
+  HostMemoryPool& __pool__ = HostMemoryPool::Get();
+  const bool __enabled__ = __pool__.Enabled();
+  __pool__.SetEnabled(true);
+  Tensor<CPU, 2, int32_t> A = NewTensor(makeShape2d(10, 10), true, 3, false, __stream__);
+  __pool__.SetEnabled(false);
+  CHECK_EQUAL(__pool__.Stats().m_bytes_cached, size_t(0), " the cache is not given back");
+  const size_t __hits__ = __pool__.Stats().m_hits;
+  DeleteTensor(&A);
+  for (int r = 0; r < 4; ++r) {
+    Tensor<CPU, 2, int32_t> B = NewTensor(makeShape2d(10, 10), true, r, false, __stream__);
+    DeleteTensor(&B);
+  }
+  const HostPoolStats __s__ = __pool__.Stats();
+  CHECK_EQUAL(__s__.m_hits, __hits__, " a block is cached while the pool is off");
+  CHECK_EQUAL(__s__.m_bytes_cached, size_t(0), " a block is cached while the pool is off");
+  __pool__.SetEnabled(__enabled__);
+}
+
+/*!
+ *@brief    Scratch memory is aligned, taken back in LIFO order, and one chunk once warm.
+ */
+inline void __test_workspace__(mgloria::Stream<mgloria::CPU>* __stream__) {
+  using namespace mgloria;
+  Workspace& __ws__ = __stream__->GetWorkspace();
+  __ws__.Reset();
+  const WorkspaceMark __m0__ = __ws__.Mark();
+  char* __a__ = static_cast<char*>(__ws__.Alloc(100));
+  CHECK_EQUAL(reinterpret_cast<size_t>(__a__) % Workspace::ms_Align, size_t(0), " not aligned");
+  const WorkspaceMark __m1__ = __ws__.Mark();
+  char* __b__ = static_cast<char*>(__ws__.Alloc(7));
+  CHECK_EQUAL(__b__ - __a__, std::ptrdiff_t(128), " the pointer is not bumped");
+  __ws__.Release(__m1__);
+  CHECK_EQUAL(static_cast<char*>(__ws__.Alloc(7)) == __b__, true, " not taken back to the mark");
+  __ws__.Release(__m0__);
+  CHECK_EQUAL(__ws__.Stats().m_used, size_t(0), " used after release");
+
+  // Larger than a chunk: several chunks the first time, one after the reset.
+  const size_t __big__ = size_t(MGLORIA_WORKSPACE_CHUNK);
+  for (int r = 0; r < 3; ++r) {
+    {
+      WorkspaceScope __s0__(__stream__);
+      int32_t* __x__ = __s0__.Alloc<int32_t>(__big__ / 8);
+      {
+        WorkspaceScope __s1__(__stream__);
+        int32_t* __y__ = __s1__.Alloc<int32_t>(__big__ / 2);
+        __y__[__big__ / 2 - 1] = 1;
+        char* __z__ = static_cast<char*>(__s1__.Alloc<char>(3 * __big__));
+        __z__[3 * __big__ - 1] = 2;
+        CHECK_EQUAL(__ws__.Stats().m_used >= __big__ / 2 + 5 * __big__, true, " used");
+      }
+      CHECK_EQUAL(__ws__.Stats().m_used, (__big__ / 2 + 63) / 64 * 64, " the inner scope");
+      __x__[0] = 3;
+    }
+    const WorkspaceStats __st__ = __ws__.Stats();
+    CHECK_EQUAL(__st__.m_used, size_t(0), " used at round ", r);
+    CHECK_EQUAL(__st__.m_chunks, size_t(1), " chunks at round ", r);
+    CHECK_EQUAL(__st__.m_capacity >= __st__.m_peak, true, " capacity at round ", r);
+    // 1, 2 and 4 chunks, merged into one of 7.
+    CHECK_EQUAL(__st__.m_grows, size_t(4), " grown at round ", r);
+  }
+
+  // A kernel on the stream gives back all it takes, and takes nothing new the second time.
+  const index_t M = 70, K = 300, N = 90;
+  Tensor<CPU, 2, int32_t> L = NewTensor(makeShape2d(M, K), true, 0, false, __stream__);
+  Tensor<CPU, 2, int32_t> R = NewTensor(makeShape2d(K, N), true, 0, false, __stream__);
+  Tensor<CPU, 2, int32_t> C = NewTensor(makeShape2d(M, N), true, 0, false, __stream__);
+  for (index_t i = 0; i < M * K; ++i) { L.__data_ptr[i] = int32_t(i % 7) - 3; }
+  for (index_t i = 0; i < K * N; ++i) { R.__data_ptr[i] = int32_t(i % 5) - 2; }
+  size_t __grows__ = 0;
+  for (int r = 0; r < 2; ++r) {
+    C = expr::dot(L, R);
+    const WorkspaceStats __st__ = __ws__.Stats();
+    CHECK_EQUAL(__st__.m_used, size_t(0), " the dot did not give its workspace back");
+    CHECK_EQUAL(__st__.m_peak >= sizeof(int32_t) * (M + N) * K, true, " peak=", __st__.m_peak);
+    if (r == 1) { CHECK_EQUAL(__st__.m_grows, __grows__, " the dot grew the workspace again"); }
+    __grows__ = __st__.m_grows;
+  }
+  for (index_t i = 0; i < M; ++i) {
+    for (index_t j = 0; j < N; ++j) {
+      int32_t __sum__ = 0;
+      for (index_t k = 0; k < K; ++k) {
+        __sum__ += L.__data_ptr[i * K + k] * R.__data_ptr[k * N + j];
+      }
+      CHECK_EQUAL(C.__data_ptr[i * C.m_Stride_ + j], __sum__, " at ", i, ", ", j);
+    }
+  }
+  DeleteTensor(&L);
+  DeleteTensor(&R);
+  DeleteTensor(&C);
+
+  // No stream: from the host pool.
+  {
+    WorkspaceScope __s__(nullptr);
+    double* __d__ = __s__.Alloc<double>(1000);
+    __d__[999] = 1.0;
+    CHECK_EQUAL(reinterpret_cast<size_t>(__d__) % 64, size_t(0), " not aligned");
+  }
+  __ws__.Trim();
+  CHECK_EQUAL(__ws__.Stats().m_capacity, size_t(0), " trimmed");
+}
+
+/*!
+ *@brief    A TensorT frees its memory once, when the last of its views goes.
+ */
+inline void __test_tensor_t__(mgloria::Stream<mgloria::CPU>* __stream__) {
+  using namespace mgloria;
+#if MGLORIA_HOST_POOL == 1
+  const size_t __in_use__ = HostMemoryPool::Get().Stats().m_bytes_in_use;
+#endif
+  {
+    TensorT<CPU, 2, float> A(makeShape2d(37, 53), true, __stream__);
+    A = 2.f;
+    CHECK_EQUAL(A.UseCount(), 1, " use count");
+    CHECK_EQUAL(A.m_Stride_ >= 53, true, " stride");
+    TensorT<CPU, 2, float> B = A;
+    CHECK_EQUAL(A.UseCount() == 2 && B.__data_ptr == A.__data_ptr, true, " a copy is a view");
+
+    TensorT<CPU, 1, float> __row__ = A[3];
+    CHECK_EQUAL(A.UseCount(), 3, " use count of the row");
+    __row__[5] = 7.f;
+    CHECK_EQUAL(A.__data_ptr[3 * A.m_Stride_ + 5], 7.f, " the row is not a view");
+    TensorT<CPU, 2, float> __rows__ = A.Slice(10, 20);
+    CHECK_EQUAL(__rows__.__data_ptr, A.__data_ptr + 10 * A.m_Stride_, " slice");
+    TensorT<CPU, 2, float> __flat__ = __rows__.Flatten2D();
+    CHECK_EQUAL(A.UseCount(), 5, " use count of the views");
+
+    TensorT<CPU, 2, float> C = A.Clone();
+    CHECK_EQUAL(C.UseCount() == 1 && C.__data_ptr != A.__data_ptr, true, " a clone is a copy");
+    CHECK_EQUAL(C.__data_ptr[3 * C.m_Stride_ + 5], 7.f, " clone data");
+    C = C + C;
+    CHECK_EQUAL(C.__data_ptr[3 * C.m_Stride_ + 5] == 14.f && A.__data_ptr[0] == 2.f, true,
+                " an expression computes into its own memory");
+
+    TensorT<CPU, 2, float> D = std::move(B);
+    CHECK_EQUAL(B.UseCount() == 0 && B.__data_ptr == nullptr && D.__data_ptr == A.__data_ptr,
+                true, " move");
+    B = D;
+    D = std::move(C);
+    CHECK_EQUAL(B.UseCount() == 5 && D.UseCount() == 1, true, " assign");
+
+    std::vector<TensorT<CPU, 1, double>> __ts__;
+    for (int i = 0; i < 8; ++i) {
+      __ts__.push_back(TensorT<CPU, 1, double>(makeShape1d(100 + i), false, __stream__));
+      __ts__.back() = double(i);
+    }
+    for (int i = 0; i < 8; ++i) {
+      CHECK_EQUAL(__ts__[i].UseCount() == 1 && __ts__[i][99] == double(i), true, " ", i);
+    }
+    A.Release();
+    CHECK_EQUAL(__row__.UseCount() == 4 && __row__[5] == 7.f, true, " the views keep it");
+  }
+#if MGLORIA_HOST_POOL == 1
+  CHECK_EQUAL(HostMemoryPool::Get().Stats().m_bytes_in_use, __in_use__, " not all freed");
+#endif
+}
+
+/*!
+ *@brief    A large tensor starts on a huge page and is zero after the first touch.
+ */
+inline void __test_huge_pages__(mgloria::Stream<mgloria::CPU>* __stream__) {
+  using namespace mgloria;
+  const index_t M = 1000, N = 4100;
+  HostMemoryPool::Get().Trim();
+  Tensor<CPU, 2, float> A = NewTensor(makeShape2d(M, N), false, 0.f, true, __stream__);
+#if MGLORIA_HUGE_PAGES == 1
+  CHECK_EQUAL((reinterpret_cast<size_t>(A.__data_ptr) - HostMemoryPool::ms_Align)
+                  % MGLORIA_HUGE_PAGE_BYTES,
+              size_t(0), " not on a huge page");
+#endif
+  for (index_t i = 0; i < M; ++i) {
+    for (index_t j = 0; j < N; j += 97) {
+      CHECK_EQUAL(A.__data_ptr[i * A.m_Stride_ + j], 0.f, " at ", i, ", ", j);
+    }
+  }
+  DeleteTensor(&A);
+  size_t __pitch__;
+  void* __p__ = vectorization::MallocAlignedPitch(&__pitch__, MGLORIA_HUGE_PAGE_MIN, 1);
+#if MGLORIA_HUGE_PAGES == 1
+  CHECK_EQUAL(reinterpret_cast<size_t>(__p__) % MGLORIA_HUGE_PAGE_BYTES, size_t(0),
+              " MallocAlignedPitch not on a huge page");
+#endif
+  vectorization::FreeAlignedPitch(__p__);
+}
+
+inline void __test_tensor_memory__() {
+  using namespace mgloria;
+  LOG << "-------- Starting test [Tensor][Memory] \n";
+  auto __stream__ = NewStream<CPU>(0);
+#if MGLORIA_HOST_POOL == 1
+  __test_pool_classes__();
+  __test_pool_reuse__(__stream__);
+  __test_pool_disabled__(__stream__);
+  __test_huge_pages__(__stream__);
+#endif
+  __test_workspace__(__stream__);
+  __test_tensor_t__(__stream__);
+  FreeStream(__stream__);
+  LOG << "-------- Successfully tested [Tensor][Memory] \n";
+}
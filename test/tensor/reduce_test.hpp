@@ -0,0 +1,197 @@
+#include "core.hpp"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+template<typename DataType>
+inline DataType __reduce_at__(const mgloria::Tensor<mgloria::CPU, 3, DataType>& T, int i, int j,
+                              int k) {
+  return T.__data_ptr[(i * T.size(1) + j) * T.m_Stride_ + k];
+}
+
+/*!
+ *@brief    The reference of one output of axis, computed in order with double.
+ */
+template<typename DataType>
+inline double __reduce_ref__(const mgloria::Tensor<mgloria::CPU, 3, DataType>& T, int axis,
+                             int p, int q, int what) {
+  using namespace mgloria;
+  const index_t n = T.size(axis);
+  double __sum__ = 0, __max__ = 0, __min__ = 0;
+  index_t __arg__ = 0;
+  for (index_t k = 0; k < n; ++k) {
+    double v = axis == 0 ? __reduce_at__(T, k, p, q)
+                         : (axis == 1 ? __reduce_at__(T, p, k, q) : __reduce_at__(T, p, q, k));
+    __sum__ += v;
+    if (k == 0 || v < __min__) { __min__ = v; }
+    if (k == 0 || v > __max__) {
+      __max__ = v;
+      __arg__ = k;
+    }
+  }
+  // The integer sums wrap around, the same as the adds of DataType.
+  const DataType __s__ = DataType(static_cast<int64_t>(__sum__));
+  switch (what) {
+    case 0: return __s__;
+    case 1: return static_cast<double>(DataType(__s__ / DataType(n)));
+    case 2: return __max__;
+    case 3: return __min__;
+    default: return __arg__;
+  }
+}
+
+template<typename DataType>
+inline void __check_reduced__(const mgloria::Tensor<mgloria::CPU, 3, DataType>& T,
+                              const mgloria::Tensor<mgloria::CPU, 2, DataType>& R, int axis,
+                              int what) {
+  using namespace mgloria;
+  for (index_t p = 0; p < R.size(0); ++p) {
+    for (index_t q = 0; q < R.size(1); ++q) {
+      CHECK_EQUAL(double(R.__data_ptr[p * R.m_Stride_ + q]), __reduce_ref__(T, axis, p, q, what),
+                  " axis=", axis, " op=", what, " at (", p, ", ", q, ")");
+    }
+  }
+}
+
+/*!
+ *@brief    Every axis of a [d0, d1, d2] tensor. The pattern is small integers, so the sums are
+ * exact whatever order they are added in.
+ */
+template<typename DataType>
+inline void __test_reduce_axes__(mgloria::Stream<mgloria::CPU>* __stream__, mgloria::index_t d0,
+                                 mgloria::index_t d1, mgloria::index_t d2) {
+  using namespace mgloria;
+  Tensor<CPU, 3, DataType> A = NewTensor(makeShape3d(d0, d1, d2), false, DataType(0), true,
+                                         __stream__);
+  Tensor<CPU, 3, DataType> B = A.Slice(1, d0);
+  Tensor<CPU, 2, DataType> R[3] = {
+      NewTensor(makeShape2d(d1, d2), false, DataType(0), true, __stream__),
+      NewTensor(makeShape2d(d0, d2), false, DataType(0), true, __stream__),
+      NewTensor(makeShape2d(d0, d1), false, DataType(0), true, __stream__)};
+  Tensor<CPU, 2, int32_t> I[3] = {
+      NewTensor(makeShape2d(d1, d2), false, int32_t(0), true, __stream__),
+      NewTensor(makeShape2d(d0, d2), false, int32_t(0), true, __stream__),
+      NewTensor(makeShape2d(d0, d1), false, int32_t(0), true, __stream__)};
+  Tensor<CPU, 2, DataType> a = A.Flatten2D();
+  for (index_t y = 0; y < a.size(0); ++y) {
+    for (index_t x = 0; x < a.size(1); ++x) {
+      a.__data_ptr[y * a.m_Stride_ + x] = DataType(((y * 5 + x * 13) % 17) - 8);
+    }
+  }
+
+  for (int axis = 0; axis < 3; ++axis) {
+    R[axis] = expr::reduce_sum(A, axis);
+    __check_reduced__(A, R[axis], axis, 0);
+    R[axis] = expr::reduce_mean(A, axis);
+    __check_reduced__(A, R[axis], axis, 1);
+    R[axis] = expr::reduce_max(A, axis);
+    __check_reduced__(A, R[axis], axis, 2);
+    R[axis] = expr::reduce_min(A, axis);
+    __check_reduced__(A, R[axis], axis, 3);
+    I[axis] = expr::argmax(A, axis);
+    for (index_t p = 0; p < I[axis].size(0); ++p) {
+      for (index_t q = 0; q < I[axis].size(1); ++q) {
+        CHECK_EQUAL(double(I[axis].__data_ptr[p * I[axis].m_Stride_ + q]),
+                    __reduce_ref__(A, axis, p, q, 4), " argmax axis=", axis, " at (", p, ", ", q,
+                    ")");
+      }
+    }
+  }
+
+  // A view of the rows from the second one on.
+  if (d0 > 1) {
+    Tensor<CPU, 2, DataType> S =
+        NewTensor(makeShape2d(d0 - 1, d1), false, DataType(0), true, __stream__);
+    S = expr::reduce_sum(B, 2);
+    __check_reduced__(B, S, 2, 0);
+    DeleteTensor(&S);
+  }
+
+  DeleteTensor(&A);
+  for (int axis = 0; axis < 3; ++axis) {
+    DeleteTensor(&R[axis]);
+    DeleteTensor(&I[axis]);
+  }
+}
+
+/*!
+ *@brief    The partials are combined in the same order for any number of threads.
+ */
+template<typename DataType>
+inline void __test_reduce_deterministic__(mgloria::Stream<mgloria::CPU>* __stream__) {
+  using namespace mgloria;
+  const index_t n = 3 * MGLORIA_REDUCE_CHUNK + 77;
+  // The 1D tensors are views of 2D ones, the 1D Tensor can not be allocated itself.
+  Tensor<CPU, 2, DataType> A2 = NewTensor(makeShape2d(1, n), false, DataType(0), false, __stream__);
+  Tensor<CPU, 2, DataType> R2 = NewTensor(makeShape2d(1, 1), false, DataType(0), false, __stream__);
+  Tensor<CPU, 2, DataType> C2 =
+      NewTensor(makeShape2d(1, 70), false, DataType(0), false, __stream__);
+  Tensor<CPU, 2, DataType> L = NewTensor(makeShape2d(300, 70), false, DataType(0), true,
+                                         __stream__);
+  Tensor<CPU, 1, DataType> A(A2.__data_ptr, makeShape1d(n), n, __stream__);
+  Tensor<CPU, 1, DataType> R(R2.__data_ptr, makeShape1d(1), 1, __stream__);
+  Tensor<CPU, 1, DataType> C(C2.__data_ptr, makeShape1d(70), 70, __stream__);
+  double __ref__ = 0;
+  for (index_t i = 0; i < n; ++i) {
+    A.__data_ptr[i] = DataType(1) / DataType(i % 97 + 3);
+    __ref__ += A.__data_ptr[i];
+  }
+  for (index_t y = 0; y < 300; ++y) {
+    for (index_t x = 0; x < 70; ++x) {
+      L.__data_ptr[y * L.m_Stride_ + x] = DataType(1) / DataType(y + x + 1);
+    }
+  }
+
+  R = expr::reduce_sum(A, 0);
+  C = expr::reduce_sum(L, 0);
+  const DataType __first__ = R.__data_ptr[0], __col__ = C.__data_ptr[69];
+  CHECK_EQUAL(std::fabs(__first__ - __ref__) < 1e-5 * __ref__, true, " sum=", __first__,
+              " ref=", __ref__);
+#ifdef _OPENMP
+  const int __threads__ = omp_get_max_threads();
+  for (int t = 1; t <= 3; ++t) {
+    omp_set_num_threads(t);
+    R = expr::reduce_sum(A, 0);
+    C = expr::reduce_sum(L, 0);
+    CHECK_EQUAL(R.__data_ptr[0] == __first__, true, " threads=", t);
+    CHECK_EQUAL(C.__data_ptr[69] == __col__, true, " threads=", t);
+  }
+  omp_set_num_threads(__threads__);
+#endif
+  DeleteTensor(&A2);
+  DeleteTensor(&R2);
+  DeleteTensor(&L);
+  DeleteTensor(&C2);
+}
+
+inline void __test_reduce_all_shapes__(mgloria::Stream<mgloria::CPU>* __stream__) {
+  using namespace mgloria;
+  // Tails for every arch, more rows than one row chunk and more columns than one tile.
+  __test_reduce_axes__<float>(__stream__, 3, 5, 37);
+  __test_reduce_axes__<float>(__stream__, 130, 2, 1100);
+  __test_reduce_axes__<float>(__stream__, 2, 3, MGLORIA_REDUCE_CHUNK + 13);
+  __test_reduce_axes__<double>(__stream__, 4, 7, 19);
+  __test_reduce_axes__<int32_t>(__stream__, 70, 3, 45);
+  __test_reduce_axes__<int8_t>(__stream__, 3, 4, 70);
+  __test_reduce_deterministic__<float>(__stream__);
+}
+
+inline void __test_tensor_reduce__() {
+  using namespace mgloria;
+  LOG << "-------- Starting test [Tensor][Reduce] \n";
+  auto __stream__ = NewStream<CPU>(0);
+#if MGLORIA_RUNTIME_DISPATCH == 1
+  const vectorization::VecArch __saved__ = vectorization::RuntimeVecArch();
+  const vectorization::VecArch __detected__ = vectorization::DetectVecArch();
+  for (int a = 0; a <= static_cast<int>(__detected__); ++a) {
+    vectorization::SetRuntimeVecArch(static_cast<vectorization::VecArch>(a));
+    LOG << "Reduce with " << vectorization::VecArchName(vectorization::RuntimeVecArch()) << "\n";
+    __test_reduce_all_shapes__(__stream__);
+  }
+  vectorization::SetRuntimeVecArch(__saved__);
+#else
+  __test_reduce_all_shapes__(__stream__);
+#endif
+  FreeStream(__stream__);
+  LOG << "-------- Successfully tested [Tensor][Reduce] \n";
+}
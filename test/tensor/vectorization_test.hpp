@@ -0,0 +1,536 @@
+#include "core.hpp"
+
+template<typename DataType, int Dims>
+inline void __fill_tensor_pattern__(mgloria::Tensor<mgloria::CPU, Dims, DataType> T, int seed) {
+  using namespace mgloria;
+  Tensor<CPU, 2, DataType> t = T.Flatten2D();
+  for (index_t y = 0; y < t.size(0); ++y) {
+    for (index_t x = 0; x < t.size(1); ++x) {
+      t.__data_ptr[y * t.m_Stride_ + x] = DataType(((y * 7 + x * 3 + seed) % 11) - 5);
+    }
+  }
+}
+
+template<typename DataType, int Dims>
+inline DataType __tensor_at__(const mgloria::Tensor<mgloria::CPU, Dims, DataType>& T, int y,
+                              int x) {
+  return T.__data_ptr[y * T.m_Stride_ + x];
+}
+
+template<typename DataType>
+inline void __test_vectorized_elementwise__(mgloria::Stream<mgloria::CPU>* __stream__,
+                                            mgloria::index_t cols) {
+  using namespace mgloria;
+  Shape<3> shape = makeShape3d(3, 7, cols);
+  Tensor<CPU, 3, DataType> A = NewTensor(shape, true, DataType(0), true, __stream__);
+  Tensor<CPU, 3, DataType> B = NewTensor(shape, false, DataType(0), true, __stream__);
+  Tensor<CPU, 3, DataType> C = NewTensor(shape, false, DataType(0), true, __stream__);
+  Tensor<CPU, 3, DataType> D = NewTensor(shape, false, DataType(0), true, __stream__);
+  __fill_tensor_pattern__(B, 1);
+  __fill_tensor_pattern__(C, 4);
+  __fill_tensor_pattern__(D, 9);
+
+  A = B + C * D - B / expr::scalar<DataType>(DataType(4));
+  A += DataType(1);
+  Tensor<CPU, 2, DataType> a = A.Flatten2D(), b = B.Flatten2D(), c = C.Flatten2D(),
+                           d = D.Flatten2D();
+  for (index_t y = 0; y < a.size(0); ++y) {
+    for (index_t x = 0; x < a.size(1); ++x) {
+      DataType ref = __tensor_at__(b, y, x) + __tensor_at__(c, y, x) * __tensor_at__(d, y, x)
+                     - __tensor_at__(b, y, x) / DataType(4) + DataType(1);
+      CHECK_EQUAL(__tensor_at__(a, y, x), ref, " at (", y, ", ", x, ")");
+    }
+  }
+  DeleteTensor(&A);
+  DeleteTensor(&B);
+  DeleteTensor(&C);
+  DeleteTensor(&D);
+}
+
+template<typename DataType>
+inline void __test_vectorized_integer__(mgloria::Stream<mgloria::CPU>* __stream__,
+                                        mgloria::index_t cols) {
+  using namespace mgloria;
+  Shape<2> shape = makeShape2d(5, cols);
+  Tensor<CPU, 2, DataType> A = NewTensor(shape, true, DataType(0), true, __stream__);
+  Tensor<CPU, 2, DataType> B = NewTensor(shape, false, DataType(0), true, __stream__);
+  Tensor<CPU, 2, DataType> C = NewTensor(shape, false, DataType(0), true, __stream__);
+  __fill_tensor_pattern__(B, 3);
+  __fill_tensor_pattern__(C, 8);
+
+  // Wrapping ops, the same as the scalar ones.
+  A = B * C + B - C;
+  A *= DataType(3);
+  for (index_t y = 0; y < A.size(0); ++y) {
+    for (index_t x = 0; x < A.size(1); ++x) {
+      DataType b = __tensor_at__(B, y, x), c = __tensor_at__(C, y, x);
+      DataType ref = DataType(b * c + b - c);
+      ref = DataType(ref * 3);
+      CHECK_EQUAL(int64_t(__tensor_at__(A, y, x)), int64_t(ref), " at (", y, ", ", x, ")");
+    }
+  }
+
+  // No SIMD integer division, it is done by the scalar job.
+  A = B / expr::scalar<DataType>(DataType(3));
+  A /= DataType(2);
+  for (index_t y = 0; y < A.size(0); ++y) {
+    for (index_t x = 0; x < A.size(1); ++x) {
+      DataType ref = DataType(DataType(__tensor_at__(B, y, x) / 3) / 2);
+      CHECK_EQUAL(int64_t(__tensor_at__(A, y, x)), int64_t(ref), " at (", y, ", ", x, ")");
+    }
+  }
+
+  // Saturating ops, mostly with values near the limits.
+  const int64_t lo = std::numeric_limits<DataType>::min();
+  const int64_t hi = std::numeric_limits<DataType>::max();
+  for (index_t y = 0; y < B.size(0); ++y) {
+    for (index_t x = 0; x < B.size(1); ++x) {
+      int64_t k = y * 31 + x * 7;
+      B.__data_ptr[y * B.m_Stride_ + x] = DataType(k % 3 == 0 ? hi - k % 7 : lo + k % 5);
+      C.__data_ptr[y * C.m_Stride_ + x] = DataType(k % 4 == 0 ? lo + k % 3 : hi - k % 9);
+    }
+  }
+  for (int minus = 0; minus < 2; ++minus) {
+    if (minus) {
+      A = expr::Func<op::_sat_minus>(B, C);
+    } else {
+      A = expr::Func<op::_sat_plus>(B, C);
+    }
+    for (index_t y = 0; y < A.size(0); ++y) {
+      for (index_t x = 0; x < A.size(1); ++x) {
+        int64_t b = __tensor_at__(B, y, x), c = __tensor_at__(C, y, x);
+        int64_t ref = std::max(lo, std::min(hi, minus ? b - c : b + c));
+        CHECK_EQUAL(int64_t(__tensor_at__(A, y, x)), ref, " at (", y, ", ", x, ")");
+      }
+    }
+  }
+
+  DeleteTensor(&A);
+  DeleteTensor(&B);
+  DeleteTensor(&C);
+}
+
+template<typename DataType>
+inline void __check_unary_math__(const mgloria::Tensor<mgloria::CPU, 2, DataType>& A,
+                                 const mgloria::Tensor<mgloria::CPU, 2, DataType>& B,
+                                 double (*ref_fn)(double), double tol, double arg_tol,
+                                 const char* name) {
+  using namespace mgloria;
+  for (index_t y = 0; y < A.size(0); ++y) {
+    for (index_t x = 0; x < A.size(1); ++x) {
+      double arg = __tensor_at__(B, y, x), got = __tensor_at__(A, y, x);
+      double ref = DataType(ref_fn(arg));
+      // Against double rounded to DataType, with the bounds documented in __vec_math.hpp. arg_tol
+      // is for the ops that cancel, e.g. gelu of a negative x, the error is relative to x there.
+      double bound = tol * std::fabs(ref) + arg_tol * std::fabs(arg) + 2e-38;
+      bool ok = std::isnan(ref) ? std::isnan(got) : (got == ref || std::fabs(got - ref) <= bound);
+      CHECK_EQUAL(ok, true, name, "(", arg, ") = ", got, ", want ", ref);
+    }
+  }
+}
+
+inline double __ref_rsqrt__(double a) { return 1.0 / std::sqrt(a); }
+inline double __ref_sigmoid__(double a) { return 1.0 / (1.0 + std::exp(-a)); }
+inline double __ref_gelu__(double a) {
+  return 0.5 * a * (1.0 + std::tanh(0.7978845608028654 * (a + 0.044715 * a * a * a)));
+}
+inline double __ref_exp__(double a) { return std::exp(a); }
+inline double __ref_log__(double a) { return std::log(a); }
+inline double __ref_sqrt__(double a) { return std::sqrt(a); }
+inline double __ref_tanh__(double a) { return std::tanh(a); }
+inline double __ref_abs__(double a) { return std::fabs(a); }
+
+template<typename DataType>
+inline void __test_vectorized_math__(mgloria::Stream<mgloria::CPU>* __stream__,
+                                     mgloria::index_t cols) {
+  using namespace mgloria;
+  Shape<2> shape = makeShape2d(9, cols);
+  Tensor<CPU, 2, DataType> A = NewTensor(shape, true, DataType(0), true, __stream__);
+  Tensor<CPU, 2, DataType> B = NewTensor(shape, false, DataType(0), true, __stream__);
+  Tensor<CPU, 2, DataType> C = NewTensor(shape, false, DataType(0), true, __stream__);
+  // Spread over [-100, 100] with a denser part around 0, plus the special values.
+  const DataType __special__[] = {DataType(0),
+                                  -DataType(0),
+                                  std::numeric_limits<DataType>::infinity(),
+                                  -std::numeric_limits<DataType>::infinity(),
+                                  std::numeric_limits<DataType>::quiet_NaN(),
+                                  std::numeric_limits<DataType>::denorm_min(),
+                                  std::numeric_limits<DataType>::min(),
+                                  DataType(88.5),
+                                  DataType(-87.5)};
+  for (index_t y = 0; y < B.size(0); ++y) {
+    for (index_t x = 0; x < B.size(1); ++x) {
+      int64_t k = y * B.size(1) + x;
+      double t = double(k % 97) / 48.0 - 1.0;
+      DataType v = DataType(k % 3 == 0 ? t * 100.0 : t * 4.0);
+      if (k % 29 == 5) v = __special__[(k / 29) % 9];
+      B.__data_ptr[y * B.m_Stride_ + x] = v;
+      C.__data_ptr[y * C.m_Stride_ + x] = DataType(std::fabs(double(v)) + 0.5);
+    }
+  }
+  const double tol = std::is_same<DataType, float>::value ? 1e-6 : 1e-14;
+
+  A = expr::Func<op::_exp>(B);
+  __check_unary_math__(A, B, __ref_exp__, tol, 0, "exp");
+  A = expr::Func<op::_tanh>(B);
+  __check_unary_math__(A, B, __ref_tanh__, tol, 0, "tanh");
+  A = expr::Func<op::_sigmoid>(B);
+  __check_unary_math__(A, B, __ref_sigmoid__, tol, 0, "sigmoid");
+  A = expr::Func<op::_gelu>(B);
+  __check_unary_math__(A, B, __ref_gelu__, tol, tol, "gelu");
+  A = expr::Func<op::_abs>(B);
+  __check_unary_math__(A, B, __ref_abs__, 0, 0, "abs");
+  A = expr::Func<op::_log>(B);
+  __check_unary_math__(A, B, __ref_log__, tol, 0, "log");
+  A = expr::Func<op::_sqrt>(C);
+  __check_unary_math__(A, C, __ref_sqrt__, tol, 0, "sqrt");
+  A = expr::Func<op::_rsqrt>(C);
+  __check_unary_math__(A, C, __ref_rsqrt__, tol, 0, "rsqrt");
+
+  // Chained with the other ops.
+  A = expr::Func<op::_relu>(B + C * expr::scalar<DataType>(DataType(-1)))
+      + expr::Func<op::_max>(B, C) - expr::Func<op::_min>(B, C);
+  for (index_t y = 0; y < A.size(0); ++y) {
+    for (index_t x = 0; x < A.size(1); ++x) {
+      DataType b = __tensor_at__(B, y, x), c = __tensor_at__(C, y, x);
+      if (!std::isfinite(b)) continue;
+      DataType r = b - c;
+      DataType ref = (r > 0 ? r : DataType(0)) + (b > c ? b : c) - (b < c ? b : c);
+      CHECK_EQUAL(__tensor_at__(A, y, x), ref, " at (", y, ", ", x, ")");
+    }
+  }
+  DeleteTensor(&A);
+  DeleteTensor(&B);
+  DeleteTensor(&C);
+}
+
+/*!
+ *@brief    The compares give 1 or 0, where blends by them. A NaN is put in B for the floating
+ * types, it is only != to anything.
+ */
+template<typename DataType>
+inline void __test_vectorized_where__(mgloria::Stream<mgloria::CPU>* __stream__,
+                                      mgloria::index_t cols) {
+  using namespace mgloria;
+  Shape<2> shape = makeShape2d(5, cols);
+  Tensor<CPU, 2, DataType> A = NewTensor(shape, true, DataType(0), true, __stream__);
+  Tensor<CPU, 2, DataType> B = NewTensor(shape, false, DataType(0), true, __stream__);
+  Tensor<CPU, 2, DataType> C = NewTensor(shape, false, DataType(0), true, __stream__);
+  Tensor<CPU, 2, DataType> D = NewTensor(shape, false, DataType(0), true, __stream__);
+  __fill_tensor_pattern__(B, 2);
+  __fill_tensor_pattern__(C, 6);
+  __fill_tensor_pattern__(D, 1);
+  if (std::numeric_limits<DataType>::has_quiet_NaN) {
+    for (index_t x = 0; x < cols; x += 5) {
+      B.__data_ptr[B.m_Stride_ + x] = std::numeric_limits<DataType>::quiet_NaN();
+    }
+  }
+
+  for (int cmp = 0; cmp < 6; ++cmp) {
+    switch (cmp) {
+      case 0: A = expr::Func<op::_lt>(B, C); break;
+      case 1: A = expr::Func<op::_le>(B, C); break;
+      case 2: A = expr::Func<op::_gt>(B, C); break;
+      case 3: A = expr::Func<op::_ge>(B, C); break;
+      case 4: A = expr::Func<op::_eq>(B, C); break;
+      default: A = expr::Func<op::_ne>(B, C); break;
+    }
+    for (index_t y = 0; y < A.size(0); ++y) {
+      for (index_t x = 0; x < A.size(1); ++x) {
+        DataType b = __tensor_at__(B, y, x), c = __tensor_at__(C, y, x);
+        bool ref = cmp == 0 ? b < c
+                            : (cmp == 1 ? b <= c
+                                        : (cmp == 2 ? b > c
+                                                    : (cmp == 3 ? b >= c
+                                                                : (cmp == 4 ? b == c : b != c))));
+        CHECK_EQUAL(int64_t(__tensor_at__(A, y, x)), int64_t(ref), " cmp=", cmp, " at (", y,
+                    ", ", x, ")");
+      }
+    }
+  }
+
+  // Blended by the compare's mask, by a threshold, and by a plain tensor as the cond.
+  A = expr::where(expr::Func<op::_gt>(B, C), B, C) * expr::scalar<DataType>(DataType(2))
+      + expr::where(expr::Func<op::_lt>(D, expr::scalar<DataType>(DataType(1))),
+                    expr::scalar<DataType>(DataType(0)), D)
+      - expr::where(D, C, expr::scalar<DataType>(DataType(3)));
+  for (index_t y = 0; y < A.size(0); ++y) {
+    for (index_t x = 0; x < A.size(1); ++x) {
+      DataType b = __tensor_at__(B, y, x), c = __tensor_at__(C, y, x), d = __tensor_at__(D, y, x);
+      DataType ref = DataType((b > c ? b : c) * DataType(2) + (d < DataType(1) ? DataType(0) : d)
+                              - (d != DataType(0) ? c : DataType(3)));
+      CHECK_EQUAL(int64_t(__tensor_at__(A, y, x)), int64_t(ref), " at (", y, ", ", x, ")");
+    }
+  }
+
+  // relu, abs, max, min and clip, which are the same blends for the integers.
+  __fill_tensor_pattern__(B, 3);
+  A = expr::Func<op::_relu>(B) + expr::Func<op::_abs>(C) + expr::Func<op::_max>(B, D)
+      - expr::Func<op::_min>(C, D)
+      + expr::Func<op::_clip>(D, expr::scalar<DataType>(DataType(-2)),
+                              expr::scalar<DataType>(DataType(3)));
+  for (index_t y = 0; y < A.size(0); ++y) {
+    for (index_t x = 0; x < A.size(1); ++x) {
+      DataType b = __tensor_at__(B, y, x), c = __tensor_at__(C, y, x), d = __tensor_at__(D, y, x);
+      DataType ref = DataType((b > 0 ? b : DataType(0)) + (c < 0 ? DataType(-c) : c)
+                              + (b > d ? b : d) - (c < d ? c : d)
+                              + (d < -2 ? DataType(-2) : (d > 3 ? DataType(3) : d)));
+      CHECK_EQUAL(int64_t(__tensor_at__(A, y, x)), int64_t(ref), " at (", y, ", ", x, ")");
+    }
+  }
+  DeleteTensor(&A);
+  DeleteTensor(&B);
+  DeleteTensor(&C);
+  DeleteTensor(&D);
+}
+
+template<typename E, typename DataType, mgloria::expr::exprType EType>
+inline mgloria::expr::TransposeExpr<E, DataType> __transpose__(
+    const mgloria::expr::Expression<E, DataType, EType>& e) {
+  return mgloria::expr::TransposeExpr<E, DataType>(e.Self());
+}
+
+template<typename DataType>
+inline void __test_vectorized_ternary_transpose__(mgloria::Stream<mgloria::CPU>* __stream__,
+                                                  mgloria::index_t cols) {
+  using namespace mgloria;
+  const index_t rows = 6;
+  Tensor<CPU, 2, DataType> A = NewTensor(makeShape2d(rows, cols), true, DataType(0), true,
+                                         __stream__);
+  Tensor<CPU, 2, DataType> B = NewTensor(makeShape2d(rows, cols), false, DataType(0), true,
+                                         __stream__);
+  Tensor<CPU, 2, DataType> C = NewTensor(makeShape2d(rows, cols), false, DataType(0), true,
+                                         __stream__);
+  Tensor<CPU, 2, DataType> T = NewTensor(makeShape2d(cols, rows), false, DataType(0), true,
+                                         __stream__);
+  __fill_tensor_pattern__(B, 2);
+  __fill_tensor_pattern__(C, 7);
+  __fill_tensor_pattern__(T, 5);
+
+  A = expr::Func<op::_fma>(B, C, B - expr::scalar<DataType>(DataType(1)));
+  for (index_t y = 0; y < rows; ++y) {
+    for (index_t x = 0; x < cols; ++x) {
+      DataType b = __tensor_at__(B, y, x), c = __tensor_at__(C, y, x);
+      CHECK_EQUAL(__tensor_at__(A, y, x), DataType(b * c + b - 1), " at (", y, ", ", x, ")");
+    }
+  }
+
+  // The tensor is gathered by columns, the expression is read lane by lane.
+  A = T.T() + __transpose__(T * T) - expr::Func<op::_clip>(B, expr::scalar<DataType>(DataType(-2)),
+                                                           expr::scalar<DataType>(DataType(3)));
+  for (index_t y = 0; y < rows; ++y) {
+    for (index_t x = 0; x < cols; ++x) {
+      DataType t = __tensor_at__(T, x, y), b = __tensor_at__(B, y, x);
+      DataType ref = t + t * t - (b < DataType(-2) ? DataType(-2) : (b > 3 ? DataType(3) : b));
+      CHECK_EQUAL(__tensor_at__(A, y, x), ref, " at (", y, ", ", x, ")");
+    }
+  }
+  DeleteTensor(&A);
+  DeleteTensor(&B);
+  DeleteTensor(&C);
+  DeleteTensor(&T);
+}
+
+template<typename OriDataType, typename DisDataType>
+inline void __test_vectorized_type_cast__(mgloria::Stream<mgloria::CPU>* __stream__,
+                                          mgloria::index_t cols) {
+  using namespace mgloria;
+  Shape<2> shape = makeShape2d(4, cols);
+  Tensor<CPU, 2, OriDataType> B = NewTensor(shape, false, OriDataType(0), true, __stream__);
+  Tensor<CPU, 2, DisDataType> A = NewTensor(shape, true, DisDataType(0), true, __stream__);
+  __fill_tensor_pattern__(B, 6);
+  // 3 / 2 makes the halves for the float types, to check the truncation of the cast.
+  A = expr::TypeCast<OriDataType, DisDataType>(B * expr::scalar<OriDataType>(OriDataType(3))
+                                               / expr::scalar<OriDataType>(OriDataType(2)))
+      + expr::scalar<DisDataType>(DisDataType(1));
+  for (index_t y = 0; y < A.size(0); ++y) {
+    for (index_t x = 0; x < A.size(1); ++x) {
+      DisDataType ref = DisDataType(OriDataType(__tensor_at__(B, y, x) * 3) / 2) + 1;
+      CHECK_EQUAL(__tensor_at__(A, y, x), ref, " at (", y, ", ", x, ")");
+    }
+  }
+  DeleteTensor(&A);
+  DeleteTensor(&B);
+}
+
+template<typename DataType>
+inline void __test_vectorized_unaligned__(mgloria::Stream<mgloria::CPU>* __stream__,
+                                          mgloria::index_t cols) {
+  using namespace mgloria;
+  // Views with odd offsets and strides into one buffer, as a slice or a user buffer has.
+  const index_t rows = 5, stride = cols + 3;
+  Tensor<CPU, 2, DataType> buf =
+      NewTensor(makeShape2d(1, 3 * rows * stride + 8), true, DataType(0), true, __stream__);
+  Tensor<CPU, 2, DataType> A(buf.__data_ptr + 1, makeShape2d(rows, cols), stride, __stream__);
+  Tensor<CPU, 2, DataType> B(buf.__data_ptr + rows * stride + 3, makeShape2d(rows, cols), stride,
+                             __stream__);
+  Tensor<CPU, 2, DataType> C(buf.__data_ptr + 2 * rows * stride + 6, makeShape2d(rows, cols),
+                             stride, __stream__);
+  __fill_tensor_pattern__(B, 4);
+  __fill_tensor_pattern__(C, 1);
+  A = B * C - B;
+  A += DataType(7);
+  for (index_t y = 0; y < rows; ++y) {
+    for (index_t x = 0; x < cols; ++x) {
+      DataType b = __tensor_at__(B, y, x), c = __tensor_at__(C, y, x);
+      CHECK_EQUAL(__tensor_at__(A, y, x), DataType(7 + b * c - b), " at (", y, ", ", x, ")");
+    }
+    // The padding between the rows of A is not touched.
+    for (index_t x = cols; x < stride && y + 1 < rows; ++x) {
+      CHECK_EQUAL(__tensor_at__(A, y, x), DataType(0), " at (", y, ", ", x, ")");
+    }
+  }
+  CHECK_EQUAL(buf.__data_ptr[0], DataType(0), " before A");
+
+  // A 1D slice.
+  Tensor<CPU, 1, DataType> a = A[1].Slice(1, cols), b = B[2].Slice(0, cols - 1);
+  a = b + b;
+  for (index_t x = 0; x + 1 < cols; ++x) {
+    CHECK_EQUAL(__tensor_at__(A, 1, x + 1), DataType(__tensor_at__(B, 2, x) * 2), " at ", x);
+  }
+  DeleteTensor(&buf);
+}
+
+/*!
+ *@brief    implicit_dot alone, fused into an element-wise expression and with a transposed lhs.
+ * The shapes cross the edges of the EvalTile blocks.
+ */
+template<typename DataType>
+inline void __test_vectorized_implicit_dot__(mgloria::Stream<mgloria::CPU>* __stream__,
+                                             mgloria::index_t M, mgloria::index_t K,
+                                             mgloria::index_t N) {
+  using namespace mgloria;
+  Tensor<CPU, 2, DataType> A = NewTensor(makeShape2d(M, K), false, DataType(0), true, __stream__);
+  Tensor<CPU, 2, DataType> At = NewTensor(makeShape2d(K, M), false, DataType(0), true, __stream__);
+  Tensor<CPU, 2, DataType> B = NewTensor(makeShape2d(K, N), false, DataType(0), true, __stream__);
+  Tensor<CPU, 2, DataType> C = NewTensor(makeShape2d(M, N), false, DataType(0), true, __stream__);
+  Tensor<CPU, 2, DataType> D = NewTensor(makeShape2d(M, N), false, DataType(0), true, __stream__);
+  Tensor<CPU, 2, DataType> E = NewTensor(makeShape2d(M, N), false, DataType(0), true, __stream__);
+  __fill_tensor_pattern__(A, 2);
+  __fill_tensor_pattern__(B, 5);
+  __fill_tensor_pattern__(D, 7);
+  for (index_t y = 0; y < M; ++y) {
+    for (index_t k = 0; k < K; ++k) {
+      At.__data_ptr[k * At.m_Stride_ + y] = __tensor_at__(A, y, k);
+    }
+  }
+  C = expr::implicit_dot(A, B);
+  E = expr::implicit_dot(At.T(), B) * D + D;
+  for (index_t y = 0; y < M; ++y) {
+    for (index_t x = 0; x < N; ++x) {
+      DataType ref = 0;
+      for (index_t k = 0; k < K; ++k) { ref += __tensor_at__(A, y, k) * __tensor_at__(B, k, x); }
+      CHECK_EQUAL(__tensor_at__(C, y, x), ref, " at (", y, ", ", x, ")");
+      const DataType d = __tensor_at__(D, y, x);
+      CHECK_EQUAL(__tensor_at__(E, y, x), DataType(ref * d + d),
+                  " fused at (", y, ", ", x, ")");
+    }
+  }
+  DeleteTensor(&A);
+  DeleteTensor(&At);
+  DeleteTensor(&B);
+  DeleteTensor(&C);
+  DeleteTensor(&D);
+  DeleteTensor(&E);
+}
+
+/*!
+ *@brief    The element-wise expressions saved to a FixedTensor, flat or with a transposed operand,
+ * a Saver that is not vectorized, and a FixedTensor saved to a Tensor.
+ */
+template<typename DataType, mgloria::index_t Rows, mgloria::index_t Cols>
+inline void __test_vectorized_fixed__(mgloria::Stream<mgloria::CPU>* __stream__) {
+  using namespace mgloria;
+  FixedTensor<Rows, Cols, DataType> A, B, C, D;
+  FixedTensor<Cols, Rows, DataType> BT;
+  __fill_tensor_pattern__(B.AsTensor(), 1);
+  __fill_tensor_pattern__(C.AsTensor(), 4);
+  __fill_tensor_pattern__(D.AsTensor(), 9);
+  for (index_t y = 0; y < Rows; ++y) {
+    for (index_t x = 0; x < Cols; ++x) { BT[x][y] = B[y][x]; }
+  }
+  Tensor<CPU, 2, DataType> T = NewTensor(makeShape2d(Rows, Cols), false, DataType(0), true,
+                                         __stream__);
+
+  for (int s = 0; s < 4; ++s) {
+    __fill_tensor_pattern__(A.AsTensor(), 2);
+    switch (s) {
+      case 0: A = B + C * D - B; break;
+      case 1: A += BT.T() * C + expr::scalar<DataType>(DataType(1)); break;
+      case 2: A /= C * C + expr::scalar<DataType>(DataType(1)); break;
+      default: T = B * C + D; break;
+    }
+    for (index_t y = 0; y < Rows; ++y) {
+      for (index_t x = 0; x < Cols; ++x) {
+        const DataType a = DataType(((y * 7 + x * 3 + 2) % 11) - 5);
+        DataType ref = B[y][x] + C[y][x] * D[y][x] - B[y][x];
+        if (s == 1) { ref = a + (B[y][x] * C[y][x] + DataType(1)); }
+        if (s == 2) { ref = a / DataType(C[y][x] * C[y][x] + DataType(1)); }
+        if (s == 3) { ref = B[y][x] * C[y][x] + D[y][x]; }
+        CHECK_EQUAL(s == 3 ? __tensor_at__(T, y, x) : A[y][x], ref, " Rows=", Rows, " Cols=",
+                    Cols, " expression=", s, " at (", y, ", ", x, ")");
+      }
+    }
+  }
+  DeleteTensor(&T);
+}
+
+inline void __test_vectorized_all_cols__(mgloria::Stream<mgloria::CPU>* __stream__) {
+  using namespace mgloria;
+  // Narrow rows leave a tail after the last full vector for every arch.
+  const index_t __cols__[] = {1, 13, 20, 37, 60, 64};
+  for (index_t cols : __cols__) {
+    __test_vectorized_elementwise__<float>(__stream__, cols);
+    __test_vectorized_elementwise__<double>(__stream__, cols);
+    __test_vectorized_integer__<int32_t>(__stream__, cols);
+    __test_vectorized_integer__<int8_t>(__stream__, cols);
+    __test_vectorized_integer__<uint8_t>(__stream__, cols);
+    __test_vectorized_math__<float>(__stream__, cols);
+    __test_vectorized_math__<double>(__stream__, cols);
+    __test_vectorized_ternary_transpose__<float>(__stream__, cols);
+    __test_vectorized_ternary_transpose__<double>(__stream__, cols);
+    __test_vectorized_where__<float>(__stream__, cols);
+    __test_vectorized_where__<double>(__stream__, cols);
+    __test_vectorized_where__<int32_t>(__stream__, cols);
+    __test_vectorized_where__<int8_t>(__stream__, cols);
+    __test_vectorized_type_cast__<float, int32_t>(__stream__, cols);
+    __test_vectorized_type_cast__<int32_t, float>(__stream__, cols);
+    __test_vectorized_type_cast__<float, double>(__stream__, cols);
+    __test_vectorized_type_cast__<int8_t, float>(__stream__, cols);
+    __test_vectorized_unaligned__<float>(__stream__, cols);
+    __test_vectorized_unaligned__<double>(__stream__, cols);
+    __test_vectorized_unaligned__<int8_t>(__stream__, cols);
+  }
+  __test_vectorized_fixed__<float, 3, 3>(__stream__);
+  __test_vectorized_fixed__<float, 4, 4>(__stream__);
+  __test_vectorized_fixed__<float, 16, 64>(__stream__);
+  __test_vectorized_fixed__<double, 5, 7>(__stream__);
+  __test_vectorized_fixed__<int32_t, 8, 8>(__stream__);
+  __test_vectorized_fixed__<int8_t, 3, 37>(__stream__);
+}
+
+inline void __test_tensor_vectorization__() {
+  using namespace mgloria;
+  LOG << "-------- Starting test [Tensor][Vectorization] \n";
+  auto __stream__ = NewStream<CPU>(0);
+#if MGLORIA_RUNTIME_DISPATCH == 1
+  // Run the same expressions with every arch this CPU has.
+  const vectorization::VecArch __saved__ = vectorization::RuntimeVecArch();
+  const vectorization::VecArch __detected__ = vectorization::DetectVecArch();
+  for (int a = 0; a <= static_cast<int>(__detected__); ++a) {
+    vectorization::SetRuntimeVecArch(static_cast<vectorization::VecArch>(a));
+    LOG << "Vectorized with " << vectorization::VecArchName(vectorization::RuntimeVecArch())
+        << "\n";
+    __test_vectorized_all_cols__(__stream__);
+  }
+  vectorization::SetRuntimeVecArch(__saved__);
+#else
+  __test_vectorized_all_cols__(__stream__);
+#endif
+  __test_vectorized_implicit_dot__<float>(__stream__, 5, 19, 6);
+  __test_vectorized_implicit_dot__<float>(__stream__, 19, 150, 70);
+  __test_vectorized_implicit_dot__<double>(__stream__, 5, 19, 6);
+  __test_vectorized_implicit_dot__<double>(__stream__, 17, 70, 131);
+  FreeStream(__stream__);
+  LOG << "-------- Successfully tested [Tensor][Vectorization] \n";
+}